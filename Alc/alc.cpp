@@ -54,6 +54,7 @@
 #include "alu.h"
 #include "alconfig.h"
 #include "ringbuffer.h"
+#include "trace.h"
 #include "filters/splitter.h"
 #include "bs2b.h"
 
@@ -363,6 +364,9 @@ constexpr struct {
     DECL(alEventCallbackSOFT),
     DECL(alGetPointerSOFT),
     DECL(alGetPointervSOFT),
+
+    DECL(alSourcesfvSOFT),
+    DECL(alSourcesivSOFT),
 };
 #undef DECL
 
@@ -440,6 +444,21 @@ constexpr struct {
 
     DECL(ALC_OUTPUT_LIMITER_SOFT),
 
+    DECL(ALC_PROPS_POOL_SIZE_SOFT),
+    DECL(ALC_PROPS_POOL_HIGH_WATER_SOFT),
+    DECL(ALC_PROPS_POOL_FALLBACKS_SOFT),
+
+    DECL(ALC_MIX_STAGE_TIMES_LAST_SOFT),
+    DECL(ALC_MIX_STAGE_TIMES_AVERAGE_SOFT),
+    DECL(ALC_MIX_STAGE_TIMES_MAX_SOFT),
+    DECL(ALC_MIX_ACTIVE_VOICES_SOFT),
+    DECL(ALC_MIX_VIRTUAL_VOICES_SOFT),
+    DECL(ALC_MIX_DSP_LOAD_SOFT),
+
+    DECL(ALC_QUALITY_LEVEL_SOFT),
+    DECL(ALC_MAX_QUALITY_LEVEL_SOFT),
+    DECL(ALC_QUALITY_LEVEL_CHANGES_SOFT),
+
     DECL(ALC_NO_ERROR),
     DECL(ALC_INVALID_DEVICE),
     DECL(ALC_INVALID_CONTEXT),
@@ -582,6 +601,7 @@ constexpr struct {
     DECL(AL_SPEED_OF_SOUND),
     DECL(AL_SOURCE_DISTANCE_MODEL),
     DECL(AL_DEFERRED_UPDATES_SOFT),
+    DECL(AL_DEFERRED_COMMANDS_SOFT),
     DECL(AL_GAIN_LIMIT_SOFT),
 
     DECL(AL_INVERSE_DISTANCE),
@@ -626,6 +646,7 @@ constexpr struct {
     DECL(AL_EFFECT_EQUALIZER),
     DECL(AL_EFFECT_DEDICATED_LOW_FREQUENCY_EFFECT),
     DECL(AL_EFFECT_DEDICATED_DIALOGUE),
+    DECL(AL_EFFECT_CONVOLUTION_REVERB_SOFT),
 
     DECL(AL_EFFECTSLOT_EFFECT),
     DECL(AL_EFFECTSLOT_GAIN),
@@ -791,6 +812,8 @@ constexpr ALchar alExtList[] =
     "AL_EXT_STEREO_ANGLES "
     "AL_LOKI_quadriphonic "
     "AL_SOFT_block_alignment "
+    "AL_SOFTX_convolution_reverb "
+    "AL_SOFTX_deferred_commands "
     "AL_SOFT_deferred_updates "
     "AL_SOFT_direct_channels "
     "AL_SOFTX_effect_chain "
@@ -800,6 +823,7 @@ constexpr ALchar alExtList[] =
     "AL_SOFT_loop_points "
     "AL_SOFTX_map_buffer "
     "AL_SOFT_MSADPCM "
+    "AL_SOFTX_source_batch "
     "AL_SOFT_source_latency "
     "AL_SOFT_source_length "
     "AL_SOFT_source_resampler "
@@ -835,6 +859,9 @@ thread_local ThreadCtx LocalContext;
 /* Process-wide current context */
 std::atomic<ALCcontext*> GlobalContext{nullptr};
 
+/* Serial for the next context's source command queues. Zero is never used. */
+std::atomic<ALuint> NextSourceCmdSerial{1u};
+
 /* Flag to trap ALC device errors */
 bool TrapALCError{false};
 
@@ -871,7 +898,10 @@ constexpr ALCchar alcExtensionList[] =
     "ALC_SOFT_HRTF "
     "ALC_SOFT_loopback "
     "ALC_SOFT_output_limiter "
-    "ALC_SOFT_pause_device";
+    "ALC_SOFT_pause_device "
+    "ALC_SOFTX_mixer_stats "
+    "ALC_SOFTX_props_pool "
+    "ALC_SOFTX_quality_governor";
 constexpr ALCint alcMajorVersion = 1;
 constexpr ALCint alcMinorVersion = 1;
 
@@ -957,6 +987,7 @@ static void alc_initconfig(void)
         TRACE("Supported backends: %s\n", names.c_str());
     }
     ReadALConfig();
+    InitTrace();
 
     str = getenv("__ALSOFT_SUSPEND_CONTEXT");
     if(str && *str)
@@ -1052,6 +1083,30 @@ static void alc_initconfig(void)
     if(ConfigValueFloat(nullptr, "reverb", "boost", &valf))
         ReverbBoost *= std::pow(10.0f, valf / 20.0f);
 
+    const char *quality{};
+    if(ConfigValueStr(nullptr, "pitch-shifter", "quality", &quality))
+    {
+        if(strcasecmp(quality, "low") == 0)
+            PshifterFftSize = 512;
+        else if(strcasecmp(quality, "medium") == 0)
+            PshifterFftSize = 1024;
+        else if(strcasecmp(quality, "high") == 0)
+            PshifterFftSize = 2048;
+        else
+            ERR("Unsupported pitch-shifter quality: %s\n", quality);
+    }
+    if(ConfigValueStr(nullptr, "frequency-shifter", "quality", &quality))
+    {
+        if(strcasecmp(quality, "low") == 0)
+            FshifterHilbertLength = 0;
+        else if(strcasecmp(quality, "medium") == 0)
+            FshifterHilbertLength = 255;
+        else if(strcasecmp(quality, "high") == 0)
+            FshifterHilbertLength = 1023;
+        else
+            ERR("Unsupported frequency-shifter quality: %s\n", quality);
+    }
+
     const char *devs{getenv("ALSOFT_DRIVERS")};
     if((devs && devs[0]) || ConfigValueStr(nullptr, nullptr, "drivers", &devs))
     {
@@ -1497,11 +1552,13 @@ void ALCcontext_DeferUpdates(ALCcontext *context)
 
 /* ALCcontext_ProcessUpdates
  *
- * Resumes update processing after being deferred.
+ * Applies any deferred source commands, and resumes update processing after
+ * being deferred.
  */
 void ALCcontext_ProcessUpdates(ALCcontext *context)
 {
     std::lock_guard<std::mutex> _{context->PropLock};
+    ProcessSourceCmds(context);
     if(context->DeferUpdates.exchange(false))
     {
         /* Tell the mixer to stop applying updates, then wait for any active
@@ -1573,6 +1630,29 @@ static inline void UpdateClockBase(ALCdevice *device)
     IncrementRef(&device->MixCount);
 }
 
+/* ResetFreeVoices
+ *
+ * Refills the context's lists of unused voices from scratch, after the voices
+ * were moved or changed state without the mixer. The mixer must not be
+ * running.
+ */
+static void ResetFreeVoices(ALCcontext *context)
+{
+    for(auto &list : context->FreeVoices)
+        list.store(nullptr, std::memory_order_relaxed);
+    context->FreeVoiceCount.store(0, std::memory_order_relaxed);
+
+    ALvoice **voices{context->Voices.load(std::memory_order_relaxed)->data()};
+    std::for_each(voices, voices+context->VoiceCount.load(std::memory_order_relaxed),
+        [context](ALvoice *voice) noexcept -> void
+        {
+            if(voice->mPlayState.load(std::memory_order_acquire) == ALvoice::Stopped &&
+                voice->mSourceID.load(std::memory_order_relaxed) == 0u)
+                RetireVoice(context, voice);
+        }
+    );
+}
+
 /* UpdateDeviceParams
  *
  * Updates device parameters according to the attribute list (caller is
@@ -1580,6 +1660,7 @@ static inline void UpdateClockBase(ALCdevice *device)
  */
 static ALCenum UpdateDeviceParams(ALCdevice *device, const ALCint *attrList)
 {
+    TraceSpan span{"UpdateDeviceParams"};
     HrtfRequestMode hrtf_userreq = Hrtf_Default;
     HrtfRequestMode hrtf_appreq = Hrtf_Default;
     ALCenum gainLimiter = device->LimiterState;
@@ -1988,6 +2069,56 @@ static ALCenum UpdateDeviceParams(ALCdevice *device, const ALCint *attrList)
         TRACE("Dithering enabled (%d-bit, %g)\n", float2int(std::log2(device->DitherDepth)+0.5f)+1,
               device->DitherDepth);
 
+    device->mPerfEventLoad = 10000;
+    ALfloat perfthreshold{};
+    if(ConfigValueFloat(device->DeviceName.c_str(), nullptr, "perf-event-threshold",
+        &perfthreshold))
+    {
+        if(!(perfthreshold > 0.0f))
+            device->mPerfEventLoad = 0;
+        else
+            device->mPerfEventLoad = static_cast<ALint64SOFT>(
+                minf(perfthreshold, 100.0f)*10000.0f + 0.5f);
+    }
+    if(device->mPerfEventLoad > 0)
+        TRACE("Performance events at %.2f%% load\n", device->mPerfEventLoad/100.0);
+    else
+        TRACE("Performance events disabled\n");
+
+    QualityGovernor &governor = device->mGovernor;
+    governor.HighLoad = 0;
+    governor.LowLoad = 0;
+    governor.MaxLevel = QualityFull;
+    governor.Level.store(QualityFull, std::memory_order_relaxed);
+    governor.HoldSamples = 0u;
+    governor.CalmSamples = 0u;
+    if(GetConfigValueBool(device->DeviceName.c_str(), nullptr, "quality-governor", 0))
+    {
+        ALfloat highload{0.8f}, lowload{0.5f};
+        ALuint maxlevel{QualityLevelCount-1};
+        ConfigValueFloat(device->DeviceName.c_str(), nullptr, "quality-governor-high-load",
+            &highload);
+        ConfigValueFloat(device->DeviceName.c_str(), nullptr, "quality-governor-low-load",
+            &lowload);
+        ConfigValueUInt(device->DeviceName.c_str(), nullptr, "quality-governor-max-level",
+            &maxlevel);
+
+        highload = clampf(highload, 0.01f, 100.0f);
+        lowload = clampf(lowload, 0.0f, highload);
+        governor.MaxLevel = minu(maxlevel, QualityLevelCount-1);
+        if(governor.MaxLevel > QualityFull)
+        {
+            governor.HighLoad = static_cast<ALint64SOFT>(highload*10000.0f + 0.5f);
+            governor.LowLoad = static_cast<ALint64SOFT>(lowload*10000.0f + 0.5f);
+        }
+    }
+    if(governor.HighLoad > 0)
+        TRACE("Quality governor enabled, lowering quality at %.2f%% load and restoring under "
+            "%.2f%%, down to level %u\n", governor.HighLoad/100.0, governor.LowLoad/100.0,
+            governor.MaxLevel);
+    else
+        TRACE("Quality governor disabled\n");
+
     device->LimiterState = gainLimiter;
     if(ConfigValueBool(device->DeviceName.c_str(), nullptr, "output-limiter", &val))
         gainLimiter = val ? ALC_TRUE : ALC_FALSE;
@@ -2133,24 +2264,26 @@ static ALCenum UpdateDeviceParams(ALCdevice *device, const ALCint *attrList)
             }
         }
 
-        /* Clear any pre-existing voice property structs, in case the number of
-         * auxiliary sends is changing. Active sources will have updates
-         * respecified in UpdateAllSourceProps.
+        /* Remake the voices if the number of auxiliary sends is changing, and
+         * clear any pending voice property updates. Active sources will have
+         * updates respecified in UpdateAllSourceProps.
          */
-        ALvoiceProps *vprops{context->FreeVoiceProps.exchange(nullptr, std::memory_order_acq_rel)};
-        while(vprops)
-        {
-            ALvoiceProps *next = vprops->next.load(std::memory_order_relaxed);
-            delete vprops;
-            vprops = next;
-        }
-
-        AllocateVoices(context, context->MaxVoices, old_sends);
-        auto voices_end = context->Voices + context->VoiceCount.load(std::memory_order_relaxed);
-        std::for_each(context->Voices, voices_end,
-            [device](ALvoice *voice) -> void
+        AllocateVoices(context, 0, old_sends);
+        ALvoice **voices{context->Voices.load(std::memory_order_relaxed)->data()};
+        std::for_each(voices, voices+context->VoiceCount.load(std::memory_order_relaxed),
+            [context,device](ALvoice *voice) -> void
             {
-                delete voice->mUpdate.exchange(nullptr, std::memory_order_acq_rel);
+                if(ALvoiceProps *vprops{voice->mUpdate.exchange(nullptr, std::memory_order_acq_rel)})
+                    context->FreeVoiceProps.push(vprops);
+                /* The render mode may have changed, so update the voice's HRTF
+                 * state to match.
+                 */
+                UpdateVoiceHrtfState(context, voice);
+                /* Only hybrid HRTF rendering keeps voices off HRTF after a
+                 * reset, with the quality governor back at full quality.
+                 */
+                if(device->mHrtfVoiceLimit == 0)
+                    voice->mFlags &= ~VOICE_HRTF_DEMOTED;
 
                 /* Force the voice to stopped if it was stopping. */
                 ALvoice::State vstate{ALvoice::Stopping};
@@ -2171,6 +2304,7 @@ static ALCenum UpdateDeviceParams(ALCdevice *device, const ALCint *attrList)
                 }
             }
         );
+        ResetFreeVoices(context);
         srclock.unlock();
 
         context->PropsClean.test_and_set(std::memory_order_release);
@@ -2312,7 +2446,8 @@ static DeviceRef VerifyDevice(ALCdevice *device)
 }
 
 
-ALCcontext::ALCcontext(ALCdevice *device) : Device{device}
+ALCcontext::ALCcontext(ALCdevice *device)
+  : SourceCmdSerial{NextSourceCmdSerial.fetch_add(1u, std::memory_order_relaxed)}, Device{device}
 {
     PropsClean.test_and_set(std::memory_order_relaxed);
 }
@@ -2359,11 +2494,203 @@ static ALvoid InitContext(ALCcontext *Context)
     listener.Params.mDistanceModel = Context->mDistanceModel;
 
 
+    /* Fill the property pools, so updates don't have to allocate. */
+    const char *devname{Context->Device->DeviceName.c_str()};
+    ALuint poolsize{DEFAULT_PROPS_POOL_SIZE};
+    ConfigValueUInt(devname, nullptr, "props-pool-size", &poolsize);
+    const char *policy{};
+    if(ConfigValueStr(devname, nullptr, "props-pool-policy", &policy))
+    {
+        if(strcasecmp(policy, "coalesce") == 0)
+            Context->mPropsPolicy = PropsPoolPolicy::Coalesce;
+        else if(strcasecmp(policy, "block") == 0)
+            Context->mPropsPolicy = PropsPoolPolicy::Block;
+        else
+            ERR("Unsupported props-pool-policy: %s\n", policy);
+    }
+    for(ALuint i{0u};i < poolsize;++i)
+    {
+        Context->FreeContextProps.add(
+            static_cast<ALcontextProps*>(al_calloc(16, sizeof(ALcontextProps))));
+        Context->FreeListenerProps.add(
+            static_cast<ALlistenerProps*>(al_calloc(16, sizeof(ALlistenerProps))));
+        Context->FreeEffectslotProps.add(
+            static_cast<ALeffectslotProps*>(al_calloc(16, sizeof(ALeffectslotProps))));
+        Context->FreeVoiceProps.add(new ALvoiceProps{});
+    }
+    TRACE("Property pool size: %u, %s policy\n", poolsize,
+        (Context->mPropsPolicy == PropsPoolPolicy::Block) ? "block" : "coalesce");
+
     Context->AsyncEvents = CreateRingBuffer(511, sizeof(AsyncEvent), false);
     StartEventThrd(Context);
 }
 
 
+bool WaitForPropsMix(ALCcontext *context)
+{
+    ALCdevice *device{context->Device};
+    /* A loopback device is mixed by the app, likely on this same thread. */
+    if(device->Type == Loopback || !(device->Flags&DEVICE_RUNNING)
+        || context->HoldUpdates.load(std::memory_order_acquire))
+        return false;
+
+    /* Updates are applied at the start of a mix, so wait for one to start and
+     * finish after this point. Give up after a couple periods, in case the
+     * device stalled.
+     */
+    const ALuint target{(ReadRef(&device->MixCount)+3u) & ~1u};
+    const auto timeout = std::chrono::steady_clock::now() +
+        nanoseconds{seconds{device->UpdateSize*2}}/device->Frequency;
+    while(static_cast<int>(ReadRef(&device->MixCount) - target) < 0)
+    {
+        if(std::chrono::steady_clock::now() >= timeout)
+            return false;
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+
+/* Creates an array for the given number of voice pointers. Space is allocated
+ * for twice as many pointers, so the mixer has scratch space to rank voices.
+ */
+static ALCcontext::ALvoiceArray *CreateVoiceArray(size_t count)
+{
+    void *ptr{al_calloc(DEF_ALIGN, ALCcontext::ALvoiceArray::Sizeof(count*2))};
+    return new (ptr) ALCcontext::ALvoiceArray{count};
+}
+
+/* Allocates storage for VOICE_CLUSTER_SIZE voices with the given number of
+ * sends, and fills in their pointers in the voice array starting at base.
+ */
+static ALvoice *CreateVoiceCluster(ALCcontext::ALvoiceArray *voices, ALsizei base,
+    ALsizei num_sends)
+{
+    const size_t sizeof_voice{RoundUp(ALvoice::Sizeof(static_cast<size_t>(num_sends)), 16)};
+    auto storage = static_cast<char*>(al_calloc(16, sizeof_voice*VOICE_CLUSTER_SIZE));
+
+    for(ALsizei i{0};i < VOICE_CLUSTER_SIZE;++i)
+    {
+        ALvoice *voice{new (storage + sizeof_voice*i) ALvoice{static_cast<size_t>(num_sends)}};
+        voice->mIndex = base + i;
+        (*voices)[static_cast<size_t>(base+i)] = voice;
+    }
+    return reinterpret_cast<ALvoice*>(storage);
+}
+
+/* Deinitializes all of the context's voices and frees their storage. */
+static void DestroyVoices(ALCcontext *context)
+{
+    ALCcontext::ALvoiceArray *voices{context->Voices.exchange(nullptr, std::memory_order_relaxed)};
+    if(voices)
+        std::for_each(voices->begin(), voices->end(), DeinitVoice);
+    std::for_each(context->VoiceClusters.begin(), context->VoiceClusters.end(),
+        [](ALvoice *cluster) noexcept -> void { al_free(cluster); });
+    context->VoiceClusters.clear();
+    delete voices;
+}
+
+/* Recreates the context's voices for the device's new number of sends,
+ * keeping their state. The mixer must not be running.
+ */
+static void ResizeVoiceSends(ALCcontext *context, ALsizei old_sends)
+{
+    const ALsizei num_sends{context->Device->NumAuxSends};
+    const ALsizei s_count{mini(old_sends, num_sends)};
+
+    ALCcontext::ALvoiceArray *oldvoices{context->Voices.load(std::memory_order_relaxed)};
+    al::vector<ALvoice*> oldclusters;
+    std::swap(oldclusters, context->VoiceClusters);
+
+    const auto num_voices = static_cast<ALsizei>(oldvoices->size());
+    ALCcontext::ALvoiceArray *voices{CreateVoiceArray(oldvoices->size())};
+    for(ALsizei base{0};base < num_voices;base += VOICE_CLUSTER_SIZE)
+        context->VoiceClusters.emplace_back(CreateVoiceCluster(voices, base, num_sends));
+
+    /* Copy the old voice data to the new storage. */
+    auto copy_voice = [s_count](ALvoice *old_voice, ALvoice *voice) -> ALvoice*
+    {
+        /* Make sure the old voice's Update (if any) is cleared so it doesn't
+         * get deleted on deinit.
+         */
+        voice->mUpdate.store(old_voice->mUpdate.exchange(nullptr, std::memory_order_relaxed),
+            std::memory_order_relaxed);
+
+        voice->mSourceID.store(old_voice->mSourceID.load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+        voice->mPlayState.store(old_voice->mPlayState.load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+
+        voice->mProps = old_voice->mProps;
+        /* Clear extraneous property set sends. */
+        std::fill(std::begin(voice->mProps.Send)+s_count, std::end(voice->mProps.Send),
+            ALvoiceProps::SendData{});
+
+        voice->mPosition.store(old_voice->mPosition.load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+        voice->mPositionFrac.store(old_voice->mPositionFrac.load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+
+        voice->mCurrentBuffer.store(old_voice->mCurrentBuffer.load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+        voice->mLoopBuffer.store(old_voice->mLoopBuffer.load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+
+        voice->mFrequency = old_voice->mFrequency;
+        voice->mFmtChannels = old_voice->mFmtChannels;
+        voice->mNumChannels = old_voice->mNumChannels;
+        voice->mSampleSize = old_voice->mSampleSize;
+
+        voice->mStep = old_voice->mStep;
+        voice->mResampler = old_voice->mResampler;
+
+        voice->mFlags = old_voice->mFlags;
+        voice->mHrtfPriority = old_voice->mHrtfPriority;
+
+        voice->mResampleState = old_voice->mResampleState;
+
+        /* The HRTF state moves over as-is. The rest of the per-channel state
+         * is copied to new storage for the new sends.
+         */
+        voice->mHrtfState = old_voice->mHrtfState;
+        old_voice->mHrtfState.fill(nullptr);
+
+        const ALsizei maxchans{old_voice->mMaxChannels};
+        if(maxchans > 0)
+        {
+            ReserveVoiceChannels(voice, maxchans);
+            std::copy_n(old_voice->mPrevSamples, maxchans, voice->mPrevSamples);
+            std::copy_n(old_voice->mAmbiScales, maxchans, voice->mAmbiScales);
+            std::copy_n(old_voice->mAmbiSplitter, maxchans, voice->mAmbiSplitter);
+
+            DirectParams *params{voice->mDirect.Params};
+            voice->mDirect = old_voice->mDirect;
+            voice->mDirect.Params = std::copy_n(old_voice->mDirect.Params, maxchans, params)
+                - maxchans;
+            for(ALsizei i{0};i < s_count;++i)
+            {
+                SendParams *sparams{voice->mSend[i].Params};
+                voice->mSend[i] = old_voice->mSend[i];
+                voice->mSend[i].Params = sparams;
+                std::copy_n(old_voice->mSend[i].Params, maxchans, sparams);
+            }
+        }
+        std::for_each(voice->mAmbiSplitter, voice->mAmbiSplitter+voice->mMaxChannels,
+            std::bind(std::mem_fn(&BandSplitter::clear), _1));
+        return voice;
+    };
+    std::transform(oldvoices->begin(), oldvoices->end(), voices->begin(), voices->begin(),
+        copy_voice);
+
+    /* Deinit old voices. */
+    std::for_each(oldvoices->begin(), oldvoices->end(), DeinitVoice);
+    std::for_each(oldclusters.begin(), oldclusters.end(),
+        [](ALvoice *cluster) noexcept -> void { al_free(cluster); });
+
+    context->Voices.store(voices, std::memory_order_release);
+    delete oldvoices;
+}
+
 /* ALCcontext::~ALCcontext()
  *
  * Cleans up the context, and destroys any remaining objects the app failed to
@@ -2380,7 +2707,7 @@ ALCcontext::~ALCcontext()
         al_free(cprops);
     }
     size_t count{0};
-    cprops = FreeContextProps.exchange(nullptr, std::memory_order_acquire);
+    cprops = FreeContextProps.release();
     while(cprops)
     {
         ALcontextProps *next{cprops->next.load(std::memory_order_relaxed)};
@@ -2390,6 +2717,8 @@ ALCcontext::~ALCcontext()
     }
     TRACE("Freed %zu context property object%s\n", count, (count==1)?"":"s");
 
+    FreeSourceCmdQueues(this);
+
     count = std::accumulate(SourceList.cbegin(), SourceList.cend(), size_t{0u},
         [](size_t cur, const SourceSubList &sublist) noexcept -> size_t
         { return cur + POPCNT64(~sublist.FreeMask); }
@@ -2400,7 +2729,7 @@ ALCcontext::~ALCcontext()
     NumSources = 0;
 
     count = 0;
-    ALeffectslotProps *eprops{FreeEffectslotProps.exchange(nullptr, std::memory_order_acquire)};
+    ALeffectslotProps *eprops{FreeEffectslotProps.release()};
     while(eprops)
     {
         ALeffectslotProps *next{eprops->next.load(std::memory_order_relaxed)};
@@ -2424,7 +2753,7 @@ ALCcontext::~ALCcontext()
     NumEffectSlots = 0;
 
     count = 0;
-    ALvoiceProps *vprops{FreeVoiceProps.exchange(nullptr, std::memory_order_acquire)};
+    ALvoiceProps *vprops{FreeVoiceProps.release()};
     while(vprops)
     {
         ALvoiceProps *next{vprops->next.load(std::memory_order_relaxed)};
@@ -2434,11 +2763,14 @@ ALCcontext::~ALCcontext()
     }
     TRACE("Freed %zu voice property object%s\n", count, (count==1)?"":"s");
 
-    std::for_each(Voices, Voices + MaxVoices, DeinitVoice);
-    al_free(Voices);
-    Voices = nullptr;
+    DestroyVoices(this);
     VoiceCount.store(0, std::memory_order_relaxed);
-    MaxVoices = 0;
+
+    count = FreeVoiceHrtf.size();
+    std::for_each(FreeVoiceHrtf.begin(), FreeVoiceHrtf.end(),
+        [](VoiceHrtfState *state) noexcept -> void { delete state; });
+    FreeVoiceHrtf.clear();
+    TRACE("Freed %zu voice HRTF state%s\n", count, (count==1)?"":"s");
 
     ALlistenerProps *lprops{Listener.Update.exchange(nullptr, std::memory_order_relaxed)};
     if(lprops)
@@ -2447,7 +2779,7 @@ ALCcontext::~ALCcontext()
         al_free(lprops);
     }
     count = 0;
-    lprops = FreeListenerProps.exchange(nullptr, std::memory_order_acquire);
+    lprops = FreeListenerProps.release();
     while(lprops)
     {
         ALlistenerProps *next{lprops->next.load(std::memory_order_relaxed)};
@@ -2585,105 +2917,31 @@ void AllocateVoices(ALCcontext *context, ALsizei num_voices, ALsizei old_sends)
     ALCdevice *device{context->Device};
     const ALsizei num_sends{device->NumAuxSends};
 
-    if(num_voices == context->MaxVoices && num_sends == old_sends)
+    ALCcontext::ALvoiceArray *curvoices{context->Voices.load(std::memory_order_relaxed)};
+    if(curvoices && num_sends != old_sends)
+        ResizeVoiceSends(context, old_sends);
+
+    curvoices = context->Voices.load(std::memory_order_relaxed);
+    const ALsizei cur_count{curvoices ? static_cast<ALsizei>(curvoices->size()) : 0};
+    if(num_voices <= cur_count)
         return;
 
-    /* Allocate the voice pointers, voices, and the voices' stored source
-     * property set (including the dynamically-sized Send[] array) in one
-     * chunk.
+    /* Add voices a cluster at a time. The existing voices stay where they are
+     * and only the pointer array is replaced, so the mixer can keep running
+     * while it's done.
      */
-    const size_t sizeof_voice{RoundUp(ALvoice::Sizeof(num_sends), 16)};
-    const size_t size{sizeof(ALvoice*) + sizeof_voice};
-
-    auto voices = static_cast<ALvoice**>(al_calloc(16, RoundUp(size*num_voices, 16)));
-    auto voice = reinterpret_cast<ALvoice*>(reinterpret_cast<char*>(voices) + RoundUp(num_voices*sizeof(ALvoice*), 16));
-
-    auto viter = voices;
-    if(context->Voices)
-    {
-        const ALsizei v_count = mini(context->VoiceCount.load(std::memory_order_relaxed),
-                                     num_voices);
-        const ALsizei s_count = mini(old_sends, num_sends);
-
-        /* Copy the old voice data to the new storage. */
-        auto copy_voice = [&voice,num_sends,sizeof_voice,s_count](ALvoice *old_voice) -> ALvoice*
-        {
-            voice = new (voice) ALvoice{static_cast<size_t>(num_sends)};
-
-            /* Make sure the old voice's Update (if any) is cleared so it
-             * doesn't get deleted on deinit.
-             */
-            voice->mUpdate.store(old_voice->mUpdate.exchange(nullptr, std::memory_order_relaxed),
-                std::memory_order_relaxed);
-
-            voice->mSourceID.store(old_voice->mSourceID.load(std::memory_order_relaxed),
-                std::memory_order_relaxed);
-            voice->mPlayState.store(old_voice->mPlayState.load(std::memory_order_relaxed),
-                std::memory_order_relaxed);
-
-            voice->mProps = old_voice->mProps;
-            /* Clear extraneous property set sends. */
-            std::fill(std::begin(voice->mProps.Send)+s_count, std::end(voice->mProps.Send),
-                ALvoiceProps::SendData{});
-
-            voice->mPosition.store(old_voice->mPosition.load(std::memory_order_relaxed),
-                std::memory_order_relaxed);
-            voice->mPositionFrac.store(old_voice->mPositionFrac.load(std::memory_order_relaxed),
-                std::memory_order_relaxed);
-
-            voice->mCurrentBuffer.store(old_voice->mCurrentBuffer.load(std::memory_order_relaxed),
-                std::memory_order_relaxed);
-            voice->mLoopBuffer.store(old_voice->mLoopBuffer.load(std::memory_order_relaxed),
-                std::memory_order_relaxed);
-
-            voice->mFrequency = old_voice->mFrequency;
-            voice->mFmtChannels = old_voice->mFmtChannels;
-            voice->mNumChannels = old_voice->mNumChannels;
-            voice->mSampleSize = old_voice->mSampleSize;
-
-            voice->mStep = old_voice->mStep;
-            voice->mResampler = old_voice->mResampler;
-
-            voice->mFlags = old_voice->mFlags;
-
-            std::copy(std::begin(old_voice->mPrevSamples), std::end(old_voice->mPrevSamples),
-                std::begin(voice->mPrevSamples));
-
-            voice->mResampleState = old_voice->mResampleState;
-
-            voice->mAmbiScales = old_voice->mAmbiScales;
-            voice->mAmbiSplitter = old_voice->mAmbiSplitter;
-            std::for_each(voice->mAmbiSplitter.begin(),voice->mAmbiSplitter.end(),
-                std::bind(std::mem_fn(&BandSplitter::clear), _1));
-
-            voice->mDirect = old_voice->mDirect;
-            std::copy_n(old_voice->mSend.begin(), s_count, voice->mSend.begin());
-
-            /* Set this voice's reference. */
-            ALvoice *ret = voice;
-            /* Increment pointer to the next storage space. */
-            voice = reinterpret_cast<ALvoice*>(reinterpret_cast<char*>(voice) + sizeof_voice);
-            return ret;
-        };
-        viter = std::transform(context->Voices, context->Voices+v_count, viter, copy_voice);
-
-        /* Deinit old voices. */
-        auto voices_end = context->Voices + context->MaxVoices;
-        std::for_each(context->Voices, voices_end, DeinitVoice);
-    }
-    /* Finish setting the voices and references. */
-    auto init_voice = [&voice,num_sends,sizeof_voice]() -> ALvoice*
-    {
-        ALvoice *ret = new (voice) ALvoice{static_cast<size_t>(num_sends)};
-        voice = reinterpret_cast<ALvoice*>(reinterpret_cast<char*>(voice) + sizeof_voice);
-        return ret;
-    };
-    std::generate(viter, voices+num_voices, init_voice);
-
-    al_free(context->Voices);
-    context->Voices = voices;
-    context->MaxVoices = num_voices;
-    context->VoiceCount = mini(context->VoiceCount.load(std::memory_order_relaxed), num_voices);
+    const auto new_count = static_cast<ALsizei>(RoundUp(static_cast<size_t>(num_voices),
+        VOICE_CLUSTER_SIZE));
+    ALCcontext::ALvoiceArray *newvoices{CreateVoiceArray(static_cast<size_t>(new_count))};
+    if(curvoices)
+        std::copy(curvoices->begin(), curvoices->end(), newvoices->begin());
+    for(ALsizei base{cur_count};base < new_count;base += VOICE_CLUSTER_SIZE)
+        context->VoiceClusters.emplace_back(CreateVoiceCluster(newvoices, base, num_sends));
+
+    curvoices = context->Voices.exchange(newvoices, std::memory_order_acq_rel);
+    while((device->MixCount.load(std::memory_order_acquire)&1))
+        std::this_thread::yield();
+    delete curvoices;
 }
 
 
@@ -3190,6 +3448,53 @@ START_API_FUNC
 }
 END_API_FUNC
 
+template<typename T>
+static ALCint64SOFT GetPropsPoolStat(const PropsPool<T> &pool, ALCenum param)
+{
+    if(param == ALC_PROPS_POOL_SIZE_SOFT)
+        return pool.mSize.load(std::memory_order_relaxed);
+    if(param == ALC_PROPS_POOL_HIGH_WATER_SOFT)
+        return pool.mHighWater.load(std::memory_order_relaxed);
+    return pool.mFallbacks.load(std::memory_order_relaxed);
+}
+
+/* Gets the given statistic for the context, listener, effect slot, and voice
+ * property pools, summed over the device's contexts (the high-water mark takes
+ * the largest of them instead).
+ */
+static void GetPropsPoolStats(ALCdevice *device, ALCenum param, ALCint64SOFT *values)
+{
+    std::fill_n(values, 4, 0);
+    ALCcontext *ctx{device->ContextList.load()};
+    while(ctx)
+    {
+        const ALCint64SOFT stats[4]{
+            GetPropsPoolStat(ctx->FreeContextProps, param),
+            GetPropsPoolStat(ctx->FreeListenerProps, param),
+            GetPropsPoolStat(ctx->FreeEffectslotProps, param),
+            GetPropsPoolStat(ctx->FreeVoiceProps, param)
+        };
+        for(size_t i{0};i < 4;++i)
+        {
+            if(param == ALC_PROPS_POOL_HIGH_WATER_SOFT)
+                values[i] = std::max(values[i], stats[i]);
+            else
+                values[i] += stats[i];
+        }
+        ctx = ctx->next.load(std::memory_order_relaxed);
+    }
+}
+
+/* Gets the last, average, or maximum value of the given mixer statistic. */
+static ALCint64SOFT GetMixStatValue(const MixStatValue &stat, ALCenum param)
+{
+    if(param == ALC_MIX_STAGE_TIMES_LAST_SOFT)
+        return stat.Last.load(std::memory_order_relaxed);
+    if(param == ALC_MIX_STAGE_TIMES_AVERAGE_SOFT)
+        return stat.Average.load(std::memory_order_relaxed);
+    return stat.Max.load(std::memory_order_relaxed);
+}
+
 ALC_API void ALC_APIENTRY alcGetInteger64vSOFT(ALCdevice *device, ALCenum pname, ALCsizei size, ALCint64SOFT *values)
 START_API_FUNC
 {
@@ -3313,6 +3618,66 @@ START_API_FUNC
                 }
                 break;
 
+            case ALC_PROPS_POOL_SIZE_SOFT:
+            case ALC_PROPS_POOL_HIGH_WATER_SOFT:
+            case ALC_PROPS_POOL_FALLBACKS_SOFT:
+                if(size < 4)
+                    alcSetError(dev.get(), ALC_INVALID_VALUE);
+                else
+                {
+                    std::lock_guard<std::mutex> _{dev->StateLock};
+                    GetPropsPoolStats(dev.get(), pname, values);
+                }
+                break;
+
+            case ALC_MIX_STAGE_TIMES_LAST_SOFT:
+            case ALC_MIX_STAGE_TIMES_AVERAGE_SOFT:
+            case ALC_MIX_STAGE_TIMES_MAX_SOFT:
+                if(size < MixStageCount)
+                    alcSetError(dev.get(), ALC_INVALID_VALUE);
+                else
+                {
+                    const auto &stages = dev->mMixStats.Stages;
+                    std::transform(stages.cbegin(), stages.cend(), values,
+                        std::bind(GetMixStatValue, _1, pname));
+                }
+                break;
+
+            case ALC_MIX_ACTIVE_VOICES_SOFT:
+                *values = dev->mMixStats.ActiveVoices.load(std::memory_order_relaxed);
+                break;
+
+            case ALC_MIX_VIRTUAL_VOICES_SOFT:
+                *values = dev->mMixStats.VirtualVoices.load(std::memory_order_relaxed);
+                break;
+
+            case ALC_MIX_DSP_LOAD_SOFT:
+                if(size < 3)
+                    alcSetError(dev.get(), ALC_INVALID_VALUE);
+                else
+                {
+                    const MixStatValue &load = dev->mMixStats.Load;
+                    values[0] = load.Last.load(std::memory_order_relaxed);
+                    values[1] = load.Average.load(std::memory_order_relaxed);
+                    values[2] = load.Max.load(std::memory_order_relaxed);
+                }
+                break;
+
+            case ALC_QUALITY_LEVEL_SOFT:
+                *values = dev->mGovernor.Level.load(std::memory_order_relaxed);
+                break;
+
+            case ALC_MAX_QUALITY_LEVEL_SOFT:
+                {
+                    std::lock_guard<std::mutex> _{dev->StateLock};
+                    *values = (dev->mGovernor.HighLoad > 0) ? dev->mGovernor.MaxLevel : 0;
+                }
+                break;
+
+            case ALC_QUALITY_LEVEL_CHANGES_SOFT:
+                *values = dev->mGovernor.Changes.load(std::memory_order_relaxed);
+                break;
+
             default:
                 al::vector<ALCint> ivals(size);
                 size = GetIntegerv(dev.get(), pname, size, ivals.data());
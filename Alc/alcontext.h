@@ -2,6 +2,7 @@
 #define ALCONTEXT_H
 
 #include <mutex>
+#include <array>
 #include <atomic>
 #include <memory>
 #include <thread>
@@ -27,7 +28,9 @@ struct ALlistenerProps;
 struct ALvoiceProps;
 struct ALeffectslotProps;
 struct ALvoice;
+struct VoiceHrtfState;
 struct RingBuffer;
+struct SourceCmdQueue;
 
 enum class DistanceModel {
     InverseClamped  = AL_INVERSE_DISTANCE_CLAMPED,
@@ -41,6 +44,87 @@ enum class DistanceModel {
     Default = InverseClamped
 };
 
+/* What to do when a property pool has no unused containers for an update. */
+enum class PropsPoolPolicy : unsigned char {
+    /* Take back the object's own update if the mixer hasn't applied it yet,
+     * and overwrite it with the new values.
+     */
+    Coalesce,
+    /* Wait for the mixer to apply pending updates and return their
+     * containers.
+     */
+    Block
+};
+
+/* A lock-free list of unused property containers, preallocated with the
+ * context. Containers are taken by the API under the PropLock, and returned
+ * by the mixer once applied (or by the API when an update is replaced). An
+ * empty list is handled according to the context's policy, before resorting
+ * to allocating a new container that then stays with the pool.
+ */
+template<typename T>
+struct PropsPool {
+    std::atomic<T*> mFree{nullptr};
+
+    /* Containers owned by the pool, most taken from it at once, and how many
+     * had to be allocated when it ran out.
+     */
+    std::atomic<ALuint> mSize{0u};
+    std::atomic<ALuint> mInUse{0u};
+    std::atomic<ALuint> mHighWater{0u};
+    std::atomic<ALuint> mFallbacks{0u};
+
+    /* Adds a newly allocated container to the unused list. */
+    void add(T *props) noexcept
+    {
+        mSize.fetch_add(1u, std::memory_order_relaxed);
+        AtomicReplaceHead(mFree, props);
+    }
+
+    /* Returns a container taken from the pool. */
+    void push(T *props) noexcept
+    {
+        mInUse.fetch_sub(1u, std::memory_order_relaxed);
+        AtomicReplaceHead(mFree, props);
+    }
+
+    /* Takes an unused container, or returns null if there are none. */
+    T *pop() noexcept
+    {
+        T *props{mFree.load(std::memory_order_acquire)};
+        T *next;
+        do {
+            if(!props) return nullptr;
+            next = props->next.load(std::memory_order_relaxed);
+        } while(mFree.compare_exchange_weak(props, next, std::memory_order_acq_rel,
+                std::memory_order_acquire) == 0);
+        markTaken();
+        return props;
+    }
+
+    void markTaken() noexcept
+    {
+        const ALuint inuse{mInUse.fetch_add(1u, std::memory_order_relaxed) + 1u};
+        if(inuse > mHighWater.load(std::memory_order_relaxed))
+            mHighWater.store(inuse, std::memory_order_relaxed);
+    }
+
+    /* Gets a container for replacing the given pending update, with alloc
+     * creating one if the pool can't provide it. Must be called with the
+     * PropLock held. If the caller also holds the backend lock, the mixer
+     * can't return anything so canwait must be false.
+     */
+    template<typename F>
+    T *get(ALCcontext *context, std::atomic<T*> &update, F alloc, bool canwait=true);
+
+    /* Removes all unused containers from the pool, for deletion. */
+    T *release() noexcept
+    {
+        mSize.store(0u, std::memory_order_relaxed);
+        return mFree.exchange(nullptr, std::memory_order_acquire);
+    }
+};
+
 struct SourceSubList {
     uint64_t FreeMask{~0_u64};
     ALsource *Sources{nullptr}; /* 64 */
@@ -95,6 +179,20 @@ struct ALCcontext {
 
     std::atomic_flag PropsClean;
     std::atomic<bool> DeferUpdates{false};
+    /* Set while a batch of source properties is applied, so the sources are
+     * only marked as changed until the updates are published together.
+     * Protected by the PropLock.
+     */
+    bool BatchSourceProps{false};
+
+    /* With AL_DEFERRED_COMMANDS_SOFT enabled, source calls are recorded to a
+     * queue owned by the calling thread, and applied when the queues are next
+     * drained. The queues are only added to the list while the context lives,
+     * and the serial (unique for each context) lets threads cache theirs.
+     */
+    std::atomic<bool> DeferCommands{false};
+    std::atomic<SourceCmdQueue*> SourceCmdQueues{nullptr};
+    const ALuint SourceCmdSerial;
 
     std::mutex PropLock;
 
@@ -103,22 +201,45 @@ struct ALCcontext {
      */
     RefCount UpdateCount{0u};
     std::atomic<bool> HoldUpdates{false};
+    /* The device quality level the mixer last updated the context's voices
+     * and effects for. Only used by the mixer.
+     */
+    ALuint mQualityLevel{0u};
 
     ALfloat GainBoost{1.0f};
 
     std::atomic<ALcontextProps*> Update{nullptr};
 
-    /* Linked lists of unused property containers, free to use for future
-     * updates.
+    /* Pools of unused property containers, free to use for future updates. */
+    PropsPool<ALcontextProps> FreeContextProps;
+    PropsPool<ALlistenerProps> FreeListenerProps;
+    PropsPool<ALvoiceProps> FreeVoiceProps;
+    PropsPool<ALeffectslotProps> FreeEffectslotProps;
+    PropsPoolPolicy mPropsPolicy{PropsPoolPolicy::Coalesce};
+
+    /* The voice pointers, replaced as a whole when more voices are added, and
+     * the number of them in use. The array has twice as many pointers as its
+     * size, to give the mixer scratch space. The mixer must load the count
+     * before the array.
      */
-    std::atomic<ALcontextProps*> FreeContextProps{nullptr};
-    std::atomic<ALlistenerProps*> FreeListenerProps{nullptr};
-    std::atomic<ALvoiceProps*> FreeVoiceProps{nullptr};
-    std::atomic<ALeffectslotProps*> FreeEffectslotProps{nullptr};
-
-    ALvoice **Voices{nullptr};
+    using ALvoiceArray = al::FlexArray<ALvoice*>;
+    std::atomic<ALvoiceArray*> Voices{nullptr};
     std::atomic<ALsizei> VoiceCount{0};
-    ALsizei MaxVoices{0};
+    /* Storage for the voices, allocated VOICE_CLUSTER_SIZE at a time. Voices
+     * stay where they are as more are added, and are only moved when the
+     * device's send count changes. Protected by the SourceLock.
+     */
+    al::vector<ALvoice*> VoiceClusters;
+    /* Lock-free lists of unused voices, by how many channels they have room
+     * for (none, 1, 2, 4, or 8). Voices are added by the mixer as they finish
+     * and by the API as they're stopped or activated, and are only taken by
+     * the API with the SourceLock held. The count may briefly lag behind the
+     * lists.
+     */
+    std::array<std::atomic<ALvoice*>,5> FreeVoices{};
+    std::atomic<ALsizei> FreeVoiceCount{0};
+    /* Unused voice HRTF filter states. Protected by the SourceLock. */
+    al::vector<VoiceHrtfState*> FreeVoiceHrtf;
 
     using ALeffectslotArray = al::FlexArray<ALeffectslot*>;
     std::atomic<ALeffectslotArray*> ActiveAuxSlots{nullptr};
@@ -153,6 +274,38 @@ struct ALCcontext {
 
 void ALCcontext_DecRef(ALCcontext *context);
 
+/* Waits for the mixer to finish a full update of the context. Returns false
+ * without waiting if it wouldn't apply pending updates, or if it timed out.
+ */
+bool WaitForPropsMix(ALCcontext *context);
+
+template<typename T> template<typename F>
+T *PropsPool<T>::get(ALCcontext *context, std::atomic<T*> &update, F alloc, bool canwait)
+{
+    T *props{pop()};
+    if(LIKELY(props)) return props;
+
+    if(context->mPropsPolicy == PropsPoolPolicy::Coalesce || !canwait)
+    {
+        /* Nothing is returned to the update slot except by the caller, so an
+         * update taken back here is still counted as in use.
+         */
+        props = update.exchange(nullptr, std::memory_order_acq_rel);
+        if(props) return props;
+    }
+    else if(WaitForPropsMix(context))
+    {
+        props = pop();
+        if(props) return props;
+    }
+
+    props = alloc();
+    mSize.fetch_add(1u, std::memory_order_relaxed);
+    mFallbacks.fetch_add(1u, std::memory_order_relaxed);
+    markTaken();
+    return props;
+}
+
 void UpdateContextProps(ALCcontext *context);
 
 void ALCcontext_DeferUpdates(ALCcontext *context);
@@ -29,8 +29,11 @@
 #include <cmath>
 #include <limits>
 #include <numeric>
+#include <chrono>
 #include <algorithm>
 #include <functional>
+#include <memory>
+#include <type_traits>
 
 #include "alMain.h"
 #include "alcontext.h"
@@ -45,12 +48,12 @@
 #include "uhjfilter.h"
 #include "bformatdec.h"
 #include "ringbuffer.h"
+#include "trace.h"
 #include "filters/splitter.h"
 
 #include "mixer/defs.h"
 #include "fpu_modes.h"
 #include "cpu_caps.h"
-#include "bsinc_inc.h"
 
 
 namespace {
@@ -109,6 +112,30 @@ struct ChanMap {
     ALfloat elevation;
 };
 
+/* With the quality governor lowering the quality, voices with a distance
+ * attenuation at or under the distant gain resample linearly, and voices with
+ * every gain at or under the quiet gain aren't mixed. With full HRTF
+ * rendering, the loudest voices keep their own HRTF filter and the rest are
+ * panned to the ambisonic mix.
+ */
+constexpr ALfloat GovernorDistantGain{0.5f}; /* -6dB */
+constexpr ALfloat GovernorQuietGain{0.001f}; /* -60dB */
+constexpr ALsizei GovernorHrtfVoices{8};
+
+inline ALuint GetQualityLevel(const ALCdevice *device) noexcept
+{ return device->mGovernor.Level.load(std::memory_order_relaxed); }
+
+/* Gets the number of voices that can have their own HRTF filter (0 =
+ * unlimited), which the quality governor may reduce.
+ */
+ALsizei GetHrtfVoiceLimit(const ALCdevice *device) noexcept
+{
+    const ALsizei limit{device->mHrtfVoiceLimit};
+    if(GetQualityLevel(device) < QualityHrtfReduced)
+        return limit;
+    return (limit > 0) ? maxi(limit/2, 1) : GovernorHrtfVoices;
+}
+
 HrtfDirectMixerFunc MixDirectHrtf = MixDirectHrtf_<CTag>;
 inline HrtfDirectMixerFunc SelectHrtfMixer(void)
 {
@@ -180,9 +207,140 @@ void aluInit(void)
 void DeinitVoice(ALvoice *voice) noexcept
 {
     delete voice->mUpdate.exchange(nullptr, std::memory_order_acq_rel);
+    std::for_each(voice->mHrtfState.begin(), voice->mHrtfState.end(),
+        [](VoiceHrtfState *state) noexcept -> void { delete state; });
+    al_free(voice->mPrevSamples);
     voice->~ALvoice();
 }
 
+void ReserveVoiceChannels(ALvoice *voice, ALsizei numchans)
+{
+    static_assert(std::is_trivially_destructible<BandSplitter>::value &&
+        std::is_trivially_destructible<DirectParams>::value &&
+        std::is_trivially_destructible<SendParams>::value,
+        "Per-channel voice state must be trivially destructible");
+    static_assert(alignof(BandSplitter) <= 16 && alignof(DirectParams) <= 16 &&
+        alignof(SendParams) <= 16, "Per-channel voice state must fit 16-byte alignment");
+
+    if(numchans <= voice->mMaxChannels)
+        return;
+
+    /* Round up to a power of two, so a voice that plays a few different
+     * layouts settles on one allocation.
+     */
+    const auto maxchans = static_cast<size_t>(mini(
+        static_cast<ALsizei>(NextPowerOf2(static_cast<ALuint>(numchans))), MAX_INPUT_CHANNELS));
+    const size_t numsends{voice->mSend.size()};
+
+    const size_t prev_size{RoundUp(maxchans*sizeof(ALvoice::ResamplePaddingArray), 16)};
+    const size_t scales_size{RoundUp(maxchans*sizeof(ALfloat), 16)};
+    const size_t splitter_size{RoundUp(maxchans*sizeof(BandSplitter), 16)};
+    const size_t direct_size{RoundUp(maxchans*sizeof(DirectParams), 16)};
+    const size_t send_size{RoundUp(maxchans*sizeof(SendParams), 16)};
+    auto storage = static_cast<char*>(al_calloc(16,
+        prev_size + scales_size + splitter_size + direct_size + send_size*numsends));
+
+    al_free(voice->mPrevSamples);
+    voice->mMaxChannels = static_cast<ALsizei>(maxchans);
+
+    voice->mPrevSamples = reinterpret_cast<ALvoice::ResamplePaddingArray*>(storage);
+    storage += prev_size;
+    voice->mAmbiScales = reinterpret_cast<ALfloat*>(storage);
+    storage += scales_size;
+    voice->mAmbiSplitter = reinterpret_cast<BandSplitter*>(storage);
+    std::uninitialized_fill_n(voice->mAmbiSplitter, maxchans, BandSplitter{});
+    storage += splitter_size;
+    voice->mDirect.Params = reinterpret_cast<DirectParams*>(storage);
+    std::uninitialized_fill_n(voice->mDirect.Params, maxchans, DirectParams{});
+    storage += direct_size;
+    for(ALvoice::SendData &send : voice->mSend)
+    {
+        send.Params = reinterpret_cast<SendParams*>(storage);
+        std::uninitialized_fill_n(send.Params, maxchans, SendParams{});
+        storage += send_size;
+    }
+}
+
+namespace {
+
+/* Gets the free list for a voice with room for the given number of channels
+ * (none or a power of two).
+ */
+inline size_t VoiceFreeList(ALsizei maxchans) noexcept
+{ return maxchans ? static_cast<size_t>(CTZ32(static_cast<ALuint>(maxchans)))+1 : 0; }
+
+} // namespace
+
+void RetireVoice(ALCcontext *context, ALvoice *voice) noexcept
+{
+    AtomicReplaceHead(context->FreeVoices[VoiceFreeList(voice->mMaxChannels)], voice);
+    context->FreeVoiceCount.fetch_add(1, std::memory_order_release);
+}
+
+ALvoice *AcquireVoice(ALCcontext *context, ALsizei numchans) noexcept
+{
+    auto pop_voice = [context](std::atomic<ALvoice*> &list) noexcept -> ALvoice*
+    {
+        /* Only one thread takes from the lists, so the head can't be taken and
+         * put back between loading it and replacing it.
+         */
+        ALvoice *voice{list.load(std::memory_order_acquire)};
+        ALvoice *next;
+        do {
+            if(!voice) return nullptr;
+            next = voice->next.load(std::memory_order_relaxed);
+        } while(!list.compare_exchange_weak(voice, next, std::memory_order_acq_rel,
+                std::memory_order_acquire));
+        context->FreeVoiceCount.fetch_sub(1, std::memory_order_relaxed);
+        return voice;
+    };
+
+    /* Look for the smallest voice with room first, then fall back to the
+     * largest of those without.
+     */
+    const auto lists = context->FreeVoices.begin();
+    const auto fits = lists + static_cast<ptrdiff_t>(VoiceFreeList(mini(
+        static_cast<ALsizei>(NextPowerOf2(static_cast<ALuint>(numchans))), MAX_INPUT_CHANNELS)));
+    for(auto list = fits;list != context->FreeVoices.end();++list)
+    {
+        if(ALvoice *voice{pop_voice(*list)})
+            return voice;
+    }
+    for(auto list = fits;list != lists;)
+    {
+        if(ALvoice *voice{pop_voice(*--list)})
+            return voice;
+    }
+    return nullptr;
+}
+
+void UpdateVoiceHrtfState(ALCcontext *context, ALvoice *voice)
+{
+    const ALsizei numchans{(context->Device->mRenderMode == HrtfRender) ?
+        voice->mNumChannels : 0};
+    auto &pool = context->FreeVoiceHrtf;
+    for(ALsizei c{0};c < MAX_INPUT_CHANNELS;++c)
+    {
+        VoiceHrtfState *&state = voice->mHrtfState[c];
+        if(c >= numchans)
+        {
+            if(state) pool.push_back(state);
+            state = nullptr;
+        }
+        else if(!state)
+        {
+            if(pool.empty())
+                state = new VoiceHrtfState{};
+            else
+            {
+                state = pool.back();
+                pool.pop_back();
+                *state = VoiceHrtfState{};
+            }
+        }
+    }
+}
+
 
 void aluSelectPostProcess(ALCdevice *device)
 {
@@ -199,36 +357,6 @@ void aluSelectPostProcess(ALCdevice *device)
 }
 
 
-/* Prepares the interpolator for a given rate (determined by increment).
- *
- * With a bit of work, and a trade of memory for CPU cost, this could be
- * modified for use with an interpolated increment for buttery-smooth pitch
- * changes.
- */
-void BsincPrepare(const ALuint increment, BsincState *state, const BSincTable *table)
-{
-    ALsizei si{BSINC_SCALE_COUNT - 1};
-    ALfloat sf{0.0f};
-
-    if(increment > FRACTIONONE)
-    {
-        sf = static_cast<ALfloat>FRACTIONONE / increment;
-        sf = maxf(0.0f, (BSINC_SCALE_COUNT-1) * (sf-table->scaleBase) * table->scaleRange);
-        si = float2int(sf);
-        /* The interpolation factor is fit to this diagonally-symmetric curve
-         * to reduce the transition ripple caused by interpolating different
-         * scales of the sinc function.
-         */
-        sf = 1.0f - std::cos(std::asin(sf - si));
-    }
-
-    state->sf = sf;
-    state->m = table->m[si];
-    state->l = (state->m/2) - 1;
-    state->filter = table->Tab + table->filterOffset[si];
-}
-
-
 namespace {
 
 /* This RNG method was created based on the math found in opusdec. It's quick,
@@ -286,7 +414,7 @@ bool CalcContextParams(ALCcontext *Context)
     Listener.Params.SourceDistanceModel = props->SourceDistanceModel;
     Listener.Params.mDistanceModel = props->mDistanceModel;
 
-    AtomicReplaceHead(Context->FreeContextProps, props);
+    Context->FreeContextProps.push(props);
     return true;
 }
 
@@ -322,7 +450,7 @@ bool CalcListenerParams(ALCcontext *Context)
 
     Listener.Params.Gain = props->Gain * Context->GainBoost;
 
-    AtomicReplaceHead(Context->FreeListenerProps, props);
+    Context->FreeListenerProps.push(props);
     return true;
 }
 
@@ -403,7 +531,7 @@ bool CalcEffectSlotParams(ALeffectslot *slot, ALCcontext *context, bool force)
             }
         }
 
-        AtomicReplaceHead(context->FreeEffectslotProps, props);
+        context->FreeEffectslotProps.push(props);
     }
 
     EffectTarget output;
@@ -435,7 +563,7 @@ void CalcPanningAndFilters(ALvoice *voice, const ALfloat xpos, const ALfloat ypo
     const ALfloat DryGainHF, const ALfloat DryGainLF, const ALfloat (&WetGain)[MAX_SENDS],
     const ALfloat (&WetGainLF)[MAX_SENDS], const ALfloat (&WetGainHF)[MAX_SENDS],
     ALeffectslot *(&SendSlots)[MAX_SENDS], const ALvoicePropsBase *props,
-    const ALlistener &Listener, const ALCdevice *Device)
+    const ALlistener &Listener, const ALCdevice *Device, const ALuint dirty)
 {
     static constexpr ChanMap MonoMap[1]{
         { FrontCenter, 0.0f, 0.0f }
@@ -482,6 +610,9 @@ void CalcPanningAndFilters(ALvoice *voice, const ALfloat xpos, const ALfloat ypo
     const ALsizei NumSends{Device->NumAuxSends};
     ASSUME(NumSends >= 0);
 
+    voice->mDirect.Buffer = Device->Dry.Buffer;
+    voice->mDirect.Channels = Device->Dry.NumChannels;
+
     bool DirectChannels{props->DirectChannels != AL_FALSE};
     const ChanMap *chans{nullptr};
     ALsizei num_channels{0};
@@ -553,24 +684,86 @@ void CalcPanningAndFilters(ALvoice *voice, const ALfloat xpos, const ALfloat ypo
     }
     ASSUME(num_channels > 0);
 
-    std::for_each(std::begin(voice->mDirect.Params),
-        std::begin(voice->mDirect.Params)+num_channels,
-        [](DirectParams &params) -> void
-        {
-            params.Hrtf.Target = HrtfParams{};
-            ClearArray(params.Gains.Target);
-        }
-    );
+    /* With hybrid HRTF rendering, a playing voice that switches between its
+     * own HRTF filter and the ambisonic mix fades out the old path while the
+     * new one fades in. A voice leaving HRTF keeps its last target so the
+     * fade-out uses the same filter.
+     */
+    const ALuint oldflags{voice->mFlags};
+    const bool hrtf_demote{(oldflags&(VOICE_HRTF_SWITCH|VOICE_HAS_HRTF|VOICE_HRTF_DEMOTED)) ==
+        (VOICE_HRTF_SWITCH|VOICE_HAS_HRTF|VOICE_HRTF_DEMOTED)};
+    const bool hrtf_promote{(oldflags&(VOICE_HRTF_SWITCH|VOICE_HAS_HRTF|VOICE_HRTF_DEMOTED)) ==
+        VOICE_HRTF_SWITCH};
+    /* A gain change leaves a voice's HRIRs as they are, so they don't need
+     * to be looked up again if it stays on HRTF.
+     */
+    const bool hrtf_keep{!(dirty&~VOICE_DIRTY_GAIN) &&
+        (oldflags&(VOICE_HRTF_SWITCH|VOICE_HAS_HRTF|VOICE_HRTF_DEMOTED)) == VOICE_HAS_HRTF};
+    voice->mHrtfPriority = (isbformat || DirectChannels) ? -1.0f : DryGain;
+
+    std::for_each(voice->mDirect.Params, voice->mDirect.Params+num_channels,
+        [](DirectParams &params) -> void { ClearArray(params.Gains.Target); });
+    if(!hrtf_demote && !hrtf_keep)
+        std::for_each(voice->mHrtfState.begin(), voice->mHrtfState.begin()+num_channels,
+            [](VoiceHrtfState *state) -> void
+            {
+                if(!state) return;
+                state->Target = HrtfParams{};
+                state->TargetSpectra = -1;
+            }
+        );
     std::for_each(voice->mSend.begin(), voice->mSend.end(),
         [num_channels](ALvoice::SendData &send) -> void
         {
-            std::for_each(std::begin(send.Params), std::begin(send.Params)+num_channels,
+            std::for_each(send.Params, send.Params+num_channels,
                 [](SendParams &params) -> void { ClearArray(params.Gains.Target); }
             );
         }
     );
 
-    voice->mFlags &= ~(VOICE_HAS_HRTF | VOICE_HAS_NFC);
+    voice->mFlags &= ~(VOICE_HAS_HRTF | VOICE_HAS_NFC | VOICE_SHARED_NFC | VOICE_IS_VIRTUAL);
+    if(GetQualityLevel(Device) >= QualityVirtualQuiet && !(DryGain > GovernorQuietGain))
+    {
+        bool quiet{true};
+        for(ALsizei i{0};i < NumSends;i++)
+            quiet = quiet && (!SendSlots[i] || !(WetGain[i] > GovernorQuietGain));
+        if(quiet) voice->mFlags |= VOICE_IS_VIRTUAL;
+    }
+    if((oldflags&VOICE_IS_VIRTUAL) && !(voice->mFlags&VOICE_IS_VIRTUAL))
+    {
+        /* A virtual voice doesn't update its sample history or filters, so
+         * clear what they held to avoid playing it back.
+         */
+        std::for_each(voice->mPrevSamples, voice->mPrevSamples+num_channels,
+            [](ALvoice::ResamplePaddingArray &samples) -> void
+            { std::fill(std::begin(samples), std::end(samples), 0.0f); });
+        std::for_each(voice->mHrtfState.begin(), voice->mHrtfState.begin()+num_channels,
+            [](VoiceHrtfState *state) -> void
+            { if(state) state->State = HrtfState{}; }
+        );
+        std::for_each(voice->mDirect.Params, voice->mDirect.Params+num_channels,
+            [](DirectParams &params) -> void
+            {
+                params.LowPass.clear();
+                params.HighPass.clear();
+                params.NFCtrlFilter.clear();
+            }
+        );
+        std::for_each(voice->mAmbiSplitter, voice->mAmbiSplitter+num_channels,
+            [](BandSplitter &splitter) -> void { splitter.clear(); });
+        std::for_each(voice->mSend.begin(), voice->mSend.end(),
+            [num_channels](ALvoice::SendData &send) -> void
+            {
+                std::for_each(send.Params, send.Params+num_channels,
+                    [](SendParams &params) -> void
+                    {
+                        params.LowPass.clear();
+                        params.HighPass.clear();
+                    }
+                );
+            }
+        );
+    }
     if(isbformat)
     {
         /* Special handling for B-Format sources. */
@@ -643,7 +836,10 @@ void CalcPanningAndFilters(ALvoice *voice, const ALfloat xpos, const ALfloat ypo
                 voice->mDirect.ChannelsPerOrder[1] = mini(voice->mDirect.Channels-1, 3);
                 std::fill(std::begin(voice->mDirect.ChannelsPerOrder)+2,
                           std::end(voice->mDirect.ChannelsPerOrder), 0);
-                voice->mFlags |= VOICE_HAS_NFC;
+                /* With a w0 of 0, every unpanned B-Format voice uses the same
+                 * first-order filter, so the device applies it to their mix.
+                 */
+                voice->mFlags |= VOICE_HAS_NFC | VOICE_SHARED_NFC;
             }
 
             /* Local B-Format sources have their XYZ channels rotated according
@@ -721,13 +917,33 @@ void CalcPanningAndFilters(ALvoice *voice, const ALfloat xpos, const ALfloat ypo
             }
         }
     }
-    else if(Device->mRenderMode == HrtfRender)
+    else if(Device->mRenderMode == HrtfRender && !(voice->mFlags&VOICE_HRTF_DEMOTED))
     {
         /* Full HRTF rendering. Skip the virtual channels and render to the
          * real outputs.
          */
-        voice->mDirect.Buffer = Device->RealOut.Buffer;
-        voice->mDirect.Channels = Device->RealOut.NumChannels;
+        if(!(voice->mFlags&VOICE_HRTF_SWITCH))
+        {
+            voice->mDirect.Buffer = Device->RealOut.Buffer;
+            voice->mDirect.Channels = Device->RealOut.NumChannels;
+        }
+        else
+        {
+            /* Keep mixing the fading-out panning to the dry buffer, and start
+             * the HRTF filter from silence.
+             */
+            voice->mFlags |= oldflags&VOICE_HAS_NFC;
+            if(hrtf_promote)
+                std::for_each(voice->mHrtfState.begin(),
+                    voice->mHrtfState.begin()+num_channels,
+                    [](VoiceHrtfState *state) -> void
+                    {
+                        state->Old.Gain = 0.0f;
+                        state->State.History.fill(0.0f);
+                        state->State.Values.fill(float2{});
+                    }
+                );
+        }
 
         if(Distance > std::numeric_limits<float>::epsilon())
         {
@@ -737,17 +953,26 @@ void CalcPanningAndFilters(ALvoice *voice, const ALfloat xpos, const ALfloat ypo
             /* Get the HRIR coefficients and delays just once, for the given
              * source direction.
              */
-            GetHrtfCoeffs(Device->mHrtf, ev, az, Distance, Spread,
-                voice->mDirect.Params[0].Hrtf.Target.Coeffs,
-                voice->mDirect.Params[0].Hrtf.Target.Delay);
-            voice->mDirect.Params[0].Hrtf.Target.Gain = DryGain * downmix_gain;
+            if(hrtf_keep)
+            {
+                /* Same direction as before. */
+            }
+            else if(HrtfCoeffCache *cache{Device->mHrtfCache.get()})
+                cache->getCoeffs(ev, az, Distance, Spread,
+                    voice->mHrtfState[0]->Target.Coeffs,
+                    voice->mHrtfState[0]->Target.Delay);
+            else
+                GetHrtfCoeffs(Device->mHrtf, ev, az, Distance, Spread,
+                    voice->mHrtfState[0]->Target.Coeffs,
+                    voice->mHrtfState[0]->Target.Delay);
+            voice->mHrtfState[0]->Target.Gain = DryGain * downmix_gain;
 
             /* Remaining channels use the same results as the first. */
             for(ALsizei c{1};c < num_channels;c++)
             {
                 /* Skip LFE */
                 if(chans[c].channel != LFE)
-                    voice->mDirect.Params[c].Hrtf.Target = voice->mDirect.Params[0].Hrtf.Target;
+                    voice->mHrtfState[c]->Target = voice->mHrtfState[0]->Target;
             }
 
             /* Calculate the directional coefficients once, which apply to all
@@ -783,11 +1008,21 @@ void CalcPanningAndFilters(ALvoice *voice, const ALfloat xpos, const ALfloat ypo
                 /* Get the HRIR coefficients and delays for this channel
                  * position.
                  */
-                GetHrtfCoeffs(Device->mHrtf, chans[c].elevation, chans[c].angle,
-                    std::numeric_limits<float>::infinity(), Spread,
-                    voice->mDirect.Params[c].Hrtf.Target.Coeffs,
-                    voice->mDirect.Params[c].Hrtf.Target.Delay);
-                voice->mDirect.Params[c].Hrtf.Target.Gain = DryGain;
+                if(hrtf_keep)
+                {
+                    /* Same channel positions as before. */
+                }
+                else if(HrtfCoeffCache *cache{Device->mHrtfCache.get()})
+                    cache->getCoeffs(chans[c].elevation, chans[c].angle,
+                        std::numeric_limits<float>::infinity(), Spread,
+                        voice->mHrtfState[c]->Target.Coeffs,
+                        voice->mHrtfState[c]->Target.Delay);
+                else
+                    GetHrtfCoeffs(Device->mHrtf, chans[c].elevation, chans[c].angle,
+                        std::numeric_limits<float>::infinity(), Spread,
+                        voice->mHrtfState[c]->Target.Coeffs,
+                        voice->mHrtfState[c]->Target.Delay);
+                voice->mHrtfState[c]->Target.Gain = DryGain;
 
                 /* Normal panning for auxiliary sends. */
                 ALfloat coeffs[MAX_AMBI_CHANNELS];
@@ -921,8 +1156,18 @@ void CalcPanningAndFilters(ALvoice *voice, const ALfloat xpos, const ALfloat ypo
                 }
             }
         }
+
+        /* Fade the panning in from silence after leaving HRTF. */
+        if(hrtf_demote)
+            std::for_each(voice->mDirect.Params, voice->mDirect.Params+num_channels,
+                [](DirectParams &params) -> void { ClearArray(params.Gains.Current); }
+            );
     }
 
+    /* The filters don't depend on the gain or pitch. */
+    if(!(dirty&~(VOICE_DIRTY_GAIN|VOICE_DIRTY_PITCH)))
+        return;
+
     {
         const ALfloat hfScale{props->Direct.HFReference / Frequency};
         const ALfloat lfScale{props->Direct.LFReference / Frequency};
@@ -968,13 +1213,21 @@ void CalcPanningAndFilters(ALvoice *voice, const ALfloat xpos, const ALfloat ypo
     }
 }
 
-void CalcNonAttnSourceParams(ALvoice *voice, const ALvoicePropsBase *props, const ALCcontext *ALContext)
+void PrepareResampler(ALvoice *voice, const Resampler resampler)
+{
+    if(resampler == BSinc24Resampler)
+        BsincPrepare(voice->mStep, &voice->mResampleState.bsinc, &bsinc24);
+    else if(resampler == BSinc12Resampler)
+        BsincPrepare(voice->mStep, &voice->mResampleState.bsinc, &bsinc12);
+    voice->mResampler = SelectResampler(resampler);
+}
+
+void CalcNonAttnSourceParams(ALvoice *voice, const ALvoicePropsBase *props,
+    const ALCcontext *ALContext, const ALuint dirty)
 {
     const ALCdevice *Device{ALContext->Device};
     ALeffectslot *SendSlots[MAX_SENDS];
 
-    voice->mDirect.Buffer = Device->Dry.Buffer;
-    voice->mDirect.Channels = Device->Dry.NumChannels;
     for(ALsizei i{0};i < Device->NumAuxSends;i++)
     {
         SendSlots[i] = props->Send[i].Slot;
@@ -1000,11 +1253,11 @@ void CalcNonAttnSourceParams(ALvoice *voice, const ALvoicePropsBase *props, cons
         voice->mStep = MAX_PITCH<<FRACTIONBITS;
     else
         voice->mStep = maxi(fastf2i(Pitch * FRACTIONONE), 1);
-    if(props->mResampler == BSinc24Resampler)
-        BsincPrepare(voice->mStep, &voice->mResampleState.bsinc, &bsinc24);
-    else if(props->mResampler == BSinc12Resampler)
-        BsincPrepare(voice->mStep, &voice->mResampleState.bsinc, &bsinc12);
-    voice->mResampler = SelectResampler(props->mResampler);
+    PrepareResampler(voice, props->mResampler);
+
+    /* Nothing else depends on the pitch. */
+    if(dirty == VOICE_DIRTY_PITCH)
+        return;
 
     /* Calculate gains */
     const ALlistener &Listener = ALContext->Listener;
@@ -1024,18 +1277,17 @@ void CalcNonAttnSourceParams(ALvoice *voice, const ALvoicePropsBase *props, cons
     }
 
     CalcPanningAndFilters(voice, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, DryGain, DryGainHF, DryGainLF,
-        WetGain, WetGainLF, WetGainHF, SendSlots, props, Listener, Device);
+        WetGain, WetGainLF, WetGainHF, SendSlots, props, Listener, Device, dirty);
 }
 
-void CalcAttnSourceParams(ALvoice *voice, const ALvoicePropsBase *props, const ALCcontext *ALContext)
+void CalcAttnSourceParams(ALvoice *voice, const ALvoicePropsBase *props,
+    const ALCcontext *ALContext, const ALuint dirty)
 {
     const ALCdevice *Device{ALContext->Device};
     const ALsizei NumSends{Device->NumAuxSends};
     const ALlistener &Listener = ALContext->Listener;
 
-    /* Set mixing buffers and get send parameters. */
-    voice->mDirect.Buffer = Device->Dry.Buffer;
-    voice->mDirect.Channels = Device->Dry.NumChannels;
+    /* Set send mixing buffers and get send parameters. */
     ALeffectslot *SendSlots[MAX_SENDS];
     ALfloat RoomRolloff[MAX_SENDS];
     ALfloat DecayDistance[MAX_SENDS];
@@ -1200,6 +1452,9 @@ void CalcAttnSourceParams(ALvoice *voice, const ALvoicePropsBase *props, const A
             break;
     }
 
+    /* The distance attenuation alone, for the quality governor. */
+    const ALfloat DistanceGain{(props->Gain > 0.0f) ? DryGain/props->Gain : 0.0f};
+
     /* Calculate directional soundcones */
     if(directional && props->InnerAngle < 360.0f)
     {
@@ -1338,11 +1593,15 @@ void CalcAttnSourceParams(ALvoice *voice, const ALvoicePropsBase *props, const A
         voice->mStep = MAX_PITCH<<FRACTIONBITS;
     else
         voice->mStep = maxi(fastf2i(Pitch * FRACTIONONE), 1);
-    if(props->mResampler == BSinc24Resampler)
-        BsincPrepare(voice->mStep, &voice->mResampleState.bsinc, &bsinc24);
-    else if(props->mResampler == BSinc12Resampler)
-        BsincPrepare(voice->mStep, &voice->mResampleState.bsinc, &bsinc12);
-    voice->mResampler = SelectResampler(props->mResampler);
+    Resampler resampler{props->mResampler};
+    if(resampler > LinearResampler && DistanceGain <= GovernorDistantGain
+        && GetQualityLevel(Device) >= QualityLinearDistant)
+        resampler = LinearResampler;
+    PrepareResampler(voice, resampler);
+
+    /* The pitch, resampler, and velocities only affect the stepping. */
+    if(dirty == VOICE_DIRTY_PITCH)
+        return;
 
     ALfloat spread{0.0f};
     if(props->Radius > Distance)
@@ -1352,7 +1611,7 @@ void CalcAttnSourceParams(ALvoice *voice, const ALvoicePropsBase *props, const A
 
     CalcPanningAndFilters(voice, ToSource[0], ToSource[1], ToSource[2]*ZScale,
         Distance*Listener.Params.MetersPerUnit, spread, DryGain, DryGainHF, DryGainLF, WetGain,
-        WetGainLF, WetGainHF, SendSlots, props, Listener, Device);
+        WetGainLF, WetGainHF, SendSlots, props, Listener, Device, dirty);
 }
 
 void CalcSourceParams(ALvoice *voice, ALCcontext *context, bool force)
@@ -1360,20 +1619,107 @@ void CalcSourceParams(ALvoice *voice, ALCcontext *context, bool force)
     ALvoiceProps *props{voice->mUpdate.exchange(nullptr, std::memory_order_acq_rel)};
     if(!props && !force) return;
 
+    /* A forced update is for a change outside the source, which may affect
+     * anything.
+     */
+    ALuint dirty{VOICE_DIRTY_ALL};
     if(props)
     {
         voice->mProps = *props;
+        if(!force) dirty = props->DirtyMask;
 
-        AtomicReplaceHead(context->FreeVoiceProps, props);
+        context->FreeVoiceProps.push(props);
     }
 
     if((voice->mProps.mSpatializeMode == SpatializeAuto && voice->mFmtChannels == FmtMono) ||
        voice->mProps.mSpatializeMode == SpatializeOn)
-        CalcAttnSourceParams(voice, &voice->mProps, context);
+        CalcAttnSourceParams(voice, &voice->mProps, context, dirty);
     else
-        CalcNonAttnSourceParams(voice, &voice->mProps, context);
+        CalcNonAttnSourceParams(voice, &voice->mProps, context, dirty);
+}
+
+
+/* For hybrid HRTF rendering, gives the loudest voices their own HRTF filter
+ * and pans the rest to the ambisonic mix, which is binauralized once for the
+ * device. Voices that already have HRTF get a bit of a boost to avoid them
+ * flipping back and forth when their gains are close. Without a limit, every
+ * voice gets its own HRTF filter.
+ */
+void UpdateHrtfVoices(ALCcontext *ctx)
+{
+    const ALsizei voicelimit{GetHrtfVoiceLimit(ctx->Device)};
+    const size_t limit{(voicelimit > 0) ? static_cast<size_t>(voicelimit) :
+        std::numeric_limits<size_t>::max()};
+
+    /* The voice array has scratch space after the end for the ranking. */
+    const ALsizei vcount{ctx->VoiceCount.load(std::memory_order_acquire)};
+    ALCcontext::ALvoiceArray *voices{ctx->Voices.load(std::memory_order_acquire)};
+    ALvoice **ranked{voices->end()};
+    ALvoice **ranked_end{std::copy_if(voices->begin(), voices->begin()+vcount, ranked,
+        [](const ALvoice *voice) -> bool
+        {
+            return voice->mSourceID.load(std::memory_order_relaxed) != 0
+                && voice->mHrtfPriority >= 0.0f;
+        }
+    )};
+    const auto num_ranked = static_cast<size_t>(ranked_end - ranked);
+
+    if(num_ranked > limit)
+    {
+        auto priority = [](const ALvoice *voice) noexcept -> ALfloat
+        {
+            return (voice->mFlags&VOICE_HRTF_DEMOTED) ? voice->mHrtfPriority :
+                voice->mHrtfPriority*1.25f;
+        };
+        std::nth_element(ranked, ranked+limit, ranked_end,
+            [priority](const ALvoice *lhs, const ALvoice *rhs) noexcept -> bool
+            { return priority(lhs) > priority(rhs); }
+        );
+    }
+
+    for(size_t i{0};i < num_ranked;i++)
+    {
+        ALvoice *voice{ranked[i]};
+        const bool demote{i >= limit};
+        if(demote == ((voice->mFlags&VOICE_HRTF_DEMOTED) != 0))
+            continue;
+
+        voice->mFlags ^= VOICE_HRTF_DEMOTED;
+        if((voice->mFlags&VOICE_IS_FADING))
+            voice->mFlags |= VOICE_HRTF_SWITCH;
+        CalcSourceParams(voice, ctx, true);
+    }
 }
 
+/* Accumulates the time spent in each mixer stage, and the number of voices
+ * processed, over an aluMixData call.
+ */
+class MixTimer {
+    using clock = std::chrono::steady_clock;
+
+    clock::time_point mStart{clock::now()};
+    clock::time_point mMark{mStart};
+
+public:
+    std::array<std::chrono::nanoseconds,MixStageCount> mTimes{};
+    ALuint mActiveVoices{0u};
+    /* Voices held by paused sources, and voices the quality governor left
+     * unmixed for being too quiet.
+     */
+    ALuint mPausedVoices{0u};
+    ALuint mQuietVoices{0u};
+    ALuint mActiveSlots{0u};
+
+    /* Adds the time since the previous mark to the given stage. */
+    void mark(MixStage stage) noexcept
+    {
+        const clock::time_point now{clock::now()};
+        mTimes[stage] += now - mMark;
+        mMark = now;
+    }
+
+    void finish() noexcept { mTimes[MixStageTotal] = clock::now() - mStart; }
+};
 
 void ProcessParamUpdates(ALCcontext *ctx, const ALeffectslotArray *slots)
 {
@@ -1381,31 +1727,70 @@ void ProcessParamUpdates(ALCcontext *ctx, const ALeffectslotArray *slots)
     if(LIKELY(!ctx->HoldUpdates.load(std::memory_order_acquire)))
     {
         bool cforce{CalcContextParams(ctx)};
+        /* A new quality level changes how voices and effects are rendered. */
+        const ALuint level{GetQualityLevel(ctx->Device)};
+        const bool qualitychange{level != ctx->mQualityLevel};
+        ctx->mQualityLevel = level;
+        cforce = cforce || qualitychange;
         bool force{CalcListenerParams(ctx) || cforce};
         force = std::accumulate(slots->begin(), slots->end(), force,
             [ctx,cforce](bool force, ALeffectslot *slot) -> bool
             { return CalcEffectSlotParams(slot, ctx, cforce) | force; }
         );
 
-        std::for_each(ctx->Voices, ctx->Voices+ctx->VoiceCount.load(std::memory_order_acquire),
+        const ALsizei vcount{ctx->VoiceCount.load(std::memory_order_acquire)};
+        ALvoice **voices{ctx->Voices.load(std::memory_order_acquire)->data()};
+        std::for_each(voices, voices+vcount,
             [ctx,force](ALvoice *voice) -> void
             {
                 ALuint sid{voice->mSourceID.load(std::memory_order_acquire)};
                 if(sid) CalcSourceParams(voice, ctx, force);
             }
         );
+
+        if(ctx->Device->mRenderMode == HrtfRender
+            && (ctx->Device->mHrtfVoiceLimit > 0 || level >= QualityHrtfReduced || qualitychange))
+            UpdateHrtfVoices(ctx);
     }
     IncrementRef(&ctx->UpdateCount);
 }
 
-void ProcessContext(ALCcontext *ctx, const ALsizei SamplesToDo)
+/* Trace span names for processing each type of effect. */
+const char *GetEffectSpanName(ALenum type) noexcept
 {
+    switch(type)
+    {
+    case AL_EFFECT_NULL: return "EffectState::process null";
+    case AL_EFFECT_EAXREVERB: return "EffectState::process eaxreverb";
+    case AL_EFFECT_REVERB: return "EffectState::process reverb";
+    case AL_EFFECT_AUTOWAH: return "EffectState::process autowah";
+    case AL_EFFECT_CHORUS: return "EffectState::process chorus";
+    case AL_EFFECT_COMPRESSOR: return "EffectState::process compressor";
+    case AL_EFFECT_DISTORTION: return "EffectState::process distortion";
+    case AL_EFFECT_ECHO: return "EffectState::process echo";
+    case AL_EFFECT_EQUALIZER: return "EffectState::process equalizer";
+    case AL_EFFECT_FLANGER: return "EffectState::process flanger";
+    case AL_EFFECT_FREQUENCY_SHIFTER: return "EffectState::process fshifter";
+    case AL_EFFECT_RING_MODULATOR: return "EffectState::process modulator";
+    case AL_EFFECT_PITCH_SHIFTER: return "EffectState::process pshifter";
+    case AL_EFFECT_DEDICATED_LOW_FREQUENCY_EFFECT:
+    case AL_EFFECT_DEDICATED_DIALOGUE: return "EffectState::process dedicated";
+    case AL_EFFECT_CONVOLUTION_REVERB_SOFT: return "EffectState::process convolution";
+    }
+    return "EffectState::process";
+}
+
+void ProcessContext(ALCcontext *ctx, const ALsizei SamplesToDo, MixTimer &timer)
+{
+    TraceSpan span{"ProcessContext"};
     ASSUME(SamplesToDo > 0);
 
     const ALeffectslotArray *auxslots{ctx->ActiveAuxSlots.load(std::memory_order_acquire)};
 
     /* Process pending propery updates for objects on the context. */
     ProcessParamUpdates(ctx, auxslots);
+    timer.mark(MixStageParams);
+    timer.mActiveSlots += static_cast<ALuint>(auxslots->size());
 
     /* Clear auxiliary effect slot mixing buffers. */
     std::for_each(auxslots->begin(), auxslots->end(),
@@ -1417,17 +1802,42 @@ void ProcessContext(ALCcontext *ctx, const ALsizei SamplesToDo)
     );
 
     /* Process voices that have a playing source. */
-    std::for_each(ctx->Voices, ctx->Voices+ctx->VoiceCount.load(std::memory_order_acquire),
-        [SamplesToDo,ctx](ALvoice *voice) -> void
+    const ALsizei vcount{ctx->VoiceCount.load(std::memory_order_acquire)};
+    ALvoice **voices{ctx->Voices.load(std::memory_order_acquire)->data()};
+    TraceSpan voices_span{"MixVoices"};
+    std::for_each(voices, voices+vcount,
+        [SamplesToDo,ctx,&timer](ALvoice *voice) -> void
         {
             const ALvoice::State vstate{voice->mPlayState.load(std::memory_order_acquire)};
-            if(vstate == ALvoice::Stopped) return;
             const ALuint sid{voice->mSourceID.load(std::memory_order_relaxed)};
-            if(voice->mStep < 1) return;
+            if(vstate == ALvoice::Stopped)
+            {
+                /* A stopped voice with a source is held by a paused source. */
+                if(sid != 0u) ++timer.mPausedVoices;
+                return;
+            }
+            if(voice->mStep < 1)
+            {
+                /* A voice stopped before it got its first update has nothing
+                 * to fade out.
+                 */
+                if(vstate == ALvoice::Stopping)
+                {
+                    voice->mPlayState.store(ALvoice::Stopped, std::memory_order_release);
+                    if(sid == 0u) RetireVoice(ctx, voice);
+                }
+                return;
+            }
 
             MixVoice(voice, vstate, sid, ctx, SamplesToDo);
+            if((voice->mFlags&VOICE_IS_VIRTUAL))
+                ++timer.mQuietVoices;
+            else
+                ++timer.mActiveVoices;
         }
     );
+    voices_span.end();
+    timer.mark(MixStageVoices);
 
     /* Process effects. */
     if(auxslots->size() < 1) return;
@@ -1468,11 +1878,13 @@ void ProcessContext(ALCcontext *ctx, const ALsizei SamplesToDo)
     std::for_each(sorted_slots, sorted_slots_end,
         [SamplesToDo](const ALeffectslot *slot) -> void
         {
+            TraceSpan span{GetEffectSpanName(slot->Params.EffectType), slot->id};
             EffectState *state{slot->Params.mEffectState};
             state->process(SamplesToDo, slot->Wet.Buffer, slot->Wet.NumChannels,
                 state->mOutBuffer, state->mOutChannels);
         }
     );
+    timer.mark(MixStageEffects);
 }
 
 
@@ -1687,20 +2099,181 @@ void Write(const ALfloat (*InBuffer)[BUFFERSIZE], ALvoid *OutBuffer, ALsizei Off
     std::for_each(InBuffer, InBuffer+numchans, conv_channel);
 }
 
+void ApplySharedNfc(ALCdevice *device, const ALsizei SamplesToDo)
+{
+    const size_t numchans{static_cast<size_t>(device->NumChannelsPerOrder[1])};
+    if(numchans < 1) return;
+    ASSUME(numchans <= COUNTOF(device->NfcFoaData));
+
+    float *buffers[COUNTOF(device->NfcFoaData)];
+    for(size_t c{0};c < numchans;c++)
+        buffers[c] = device->NfcFoaData[c];
+    NfcFilter::process1(device->NfcFoaFilter, buffers, buffers, numchans, SamplesToDo);
+
+    /* The first-order channels follow the single zeroth-order channel. */
+    for(size_t c{0};c < numchans;c++)
+        std::transform(buffers[c], buffers[c]+SamplesToDo, device->Dry.Buffer[1+c],
+            device->Dry.Buffer[1+c], std::plus<ALfloat>{});
+}
+
+/* Stores the stage times and voice counts of the last mix, and updates the
+ * averages and maximums once a full window is mixed. Returns the mix's DSP
+ * load.
+ */
+ALint64SOFT UpdateMixStats(ALCdevice *device, const MixTimer &timer, const ALsizei NumSamples)
+{
+    if(NumSamples < 1) return 0;
+    MixStats &stats = device->mMixStats;
+
+    for(size_t i{0};i < MixStageCount;++i)
+    {
+        const ALint64SOFT ns{timer.mTimes[i].count()};
+        stats.Stages[i].Last.store(ns, std::memory_order_relaxed);
+        stats.WindowSum[i] += ns;
+        stats.WindowMax[i] = std::max(stats.WindowMax[i], ns);
+    }
+
+    /* Hundredths of a percent of the time the samples cover. */
+    const ALint64SOFT freq{device->Frequency};
+    const ALint64SOFT load{timer.mTimes[MixStageTotal].count() * freq /
+        (ALint64SOFT{NumSamples} * 100000)};
+    stats.Load.Last.store(load, std::memory_order_relaxed);
+    stats.WindowLoadMax = std::max(stats.WindowLoadMax, load);
+
+    stats.ActiveVoices.store(timer.mActiveVoices, std::memory_order_relaxed);
+    stats.VirtualVoices.store(timer.mPausedVoices + timer.mQuietVoices,
+        std::memory_order_relaxed);
+
+    ++stats.WindowMixes;
+    stats.WindowSamples += static_cast<ALuint>(NumSamples);
+    if(stats.WindowSamples < device->Frequency)
+        return load;
+
+    for(size_t i{0};i < MixStageCount;++i)
+    {
+        stats.Stages[i].Average.store(stats.WindowSum[i] / stats.WindowMixes,
+            std::memory_order_relaxed);
+        stats.Stages[i].Max.store(stats.WindowMax[i], std::memory_order_relaxed);
+    }
+    stats.Load.Average.store(stats.WindowSum[MixStageTotal] * freq /
+        (ALint64SOFT{stats.WindowSamples} * 100000), std::memory_order_relaxed);
+    stats.Load.Max.store(stats.WindowLoadMax, std::memory_order_relaxed);
+
+    stats.WindowSum.fill(0);
+    stats.WindowMax.fill(0);
+    stats.WindowLoadMax = 0;
+    stats.WindowMixes = 0u;
+    stats.WindowSamples = 0u;
+    return load;
+}
+
+/* Sends a performance event to the contexts that want them, for a mix that
+ * went over the device's load threshold. The event's ID is the stage that
+ * took the most time, and its parameter is the load in percent.
+ */
+void SendPerformanceEvent(ALCdevice *device, const MixTimer &timer, const ALint64SOFT load,
+    const ALsizei NumSamples)
+{
+    static constexpr const char *StageNames[MixStageCount]{
+        "parameter updates", "voice mixing", "effects", "post-processing",
+        "front stablization", "limiting", "distance compensation", "dithering",
+        "output conversion", "mixing"
+    };
+
+    auto wants_event = [](const ALCcontext *ctx) noexcept -> bool
+    { return (ctx->EnabledEvts.load(std::memory_order_acquire)&EventType_Performance) != 0; };
+    ALCcontext *ctx{device->ContextList.load(std::memory_order_acquire)};
+    while(ctx && !wants_event(ctx))
+        ctx = ctx->next.load(std::memory_order_relaxed);
+    if(!ctx) return;
+
+    auto stage = std::max_element(timer.mTimes.cbegin(), timer.mTimes.cbegin()+MixStageTotal);
+    const auto stageidx = static_cast<size_t>(std::distance(timer.mTimes.cbegin(), stage));
+
+    AsyncEvent evt{EventType_Performance};
+    evt.u.user.type = AL_EVENT_TYPE_PERFORMANCE_SOFT;
+    evt.u.user.id = static_cast<ALuint>(stageidx);
+    evt.u.user.param = static_cast<ALuint>(load / 100);
+    snprintf(evt.u.user.msg, sizeof(evt.u.user.msg),
+        "Mixing %d samples took %.3fms of %.3fms (%.2f%%), mostly %s (%.3fms), with %u voices "
+        "(%u paused, %u virtual) and %u effect slots", NumSamples,
+        static_cast<double>(timer.mTimes[MixStageTotal].count()) / 1000000.0,
+        NumSamples * 1000.0 / device->Frequency, static_cast<double>(load) / 100.0,
+        StageNames[stageidx], static_cast<double>(stage->count()) / 1000000.0,
+        timer.mActiveVoices, timer.mPausedVoices, timer.mQuietVoices, timer.mActiveSlots);
+
+    for(;ctx;ctx = ctx->next.load(std::memory_order_relaxed))
+    {
+        if(!wants_event(ctx)) continue;
+        RingBuffer *ring{ctx->AsyncEvents.get()};
+        auto evt_data = ring->getWriteVector().first;
+        if(evt_data.len > 0)
+        {
+            new (evt_data.buf) AsyncEvent{evt};
+            ring->writeAdvance(1);
+            ctx->EventSem.post();
+        }
+    }
+}
+
+/* Lowers the quality a level when a mix goes over the governor's high load,
+ * after the last change had some time to take effect, and restores it a level
+ * for each second the load stays under the low load.
+ */
+void UpdateQualityLevel(ALCdevice *device, const ALint64SOFT load, const ALsizei NumSamples)
+{
+    QualityGovernor &governor = device->mGovernor;
+    const auto samples = static_cast<ALuint>(NumSamples);
+    governor.HoldSamples = minu(governor.HoldSamples+samples, device->Frequency);
+    if(load < governor.LowLoad)
+        governor.CalmSamples = minu(governor.CalmSamples+samples, device->Frequency);
+    else
+        governor.CalmSamples = 0u;
+
+    ALuint level{governor.Level.load(std::memory_order_relaxed)};
+    if(load >= governor.HighLoad)
+    {
+        if(level >= governor.MaxLevel || governor.HoldSamples < device->Frequency/20)
+            return;
+        ++level;
+    }
+    else if(level > QualityFull && governor.CalmSamples >= device->Frequency)
+        --level;
+    else
+        return;
+
+    governor.HoldSamples = 0u;
+    governor.CalmSamples = 0u;
+    governor.Level.store(level, std::memory_order_relaxed);
+    governor.Changes.fetch_add(1u, std::memory_order_relaxed);
+}
+
 } // namespace
 
 void aluMixData(ALCdevice *device, ALvoid *OutBuffer, ALsizei NumSamples)
 {
+    TraceSpan span{"aluMixData"};
     FPUCtl mixer_mode{};
+    MixTimer timer{};
     for(ALsizei SamplesDone{0};SamplesDone < NumSamples;)
     {
         const ALsizei SamplesToDo{mini(NumSamples-SamplesDone, BUFFERSIZE)};
+        timer.mActiveVoices = 0u;
+        timer.mPausedVoices = 0u;
+        timer.mQuietVoices = 0u;
+        timer.mActiveSlots = 0u;
 
         /* Clear main mixing buffers. */
         std::for_each(device->MixBuffer.begin(), device->MixBuffer.end(),
             [SamplesToDo](std::array<ALfloat,BUFFERSIZE> &buffer) -> void
             { std::fill_n(buffer.begin(), SamplesToDo, 0.0f); }
         );
+        if(device->AvgSpeakerDist > 0.0f)
+            std::for_each(std::begin(device->NfcFoaData), std::end(device->NfcFoaData),
+                [SamplesToDo](ALfloat (&buffer)[BUFFERSIZE]) -> void
+                { std::fill_n(buffer, SamplesToDo, 0.0f); }
+            );
+        timer.mark(MixStageVoices);
 
         /* Increment the mix count at the start (lsb should now be 1). */
         IncrementRef(&device->MixCount);
@@ -1711,11 +2284,18 @@ void aluMixData(ALCdevice *device, ALvoid *OutBuffer, ALsizei NumSamples)
         ALCcontext *ctx{device->ContextList.load(std::memory_order_acquire)};
         while(ctx)
         {
-            ProcessContext(ctx, SamplesToDo);
+            ProcessContext(ctx, SamplesToDo, timer);
 
             ctx = ctx->next.load(std::memory_order_relaxed);
         }
 
+        /* Apply the first-order NFC filters for the unpanned B-Format voices,
+         * and add them to the dry mix.
+         */
+        if(device->AvgSpeakerDist > 0.0f)
+            ApplySharedNfc(device, SamplesToDo);
+        timer.mark(MixStageVoices);
+
         /* Increment the clock time. Every second's worth of samples is
          * converted and added to clock base so that large sample counts don't
          * overflow during conversion. This also guarantees a stable
@@ -1732,7 +2312,10 @@ void aluMixData(ALCdevice *device, ALvoid *OutBuffer, ALsizei NumSamples)
          * RealOut (Ambisonic decode, UHJ encode, etc).
          */
         if(LIKELY(device->PostProcess))
+        {
             device->PostProcess(device, SamplesToDo);
+            timer.mark(MixStagePostProcess);
+        }
 
         /* Apply front image stablization for surround sound, if applicable. */
         if(device->Stablizer)
@@ -1744,22 +2327,33 @@ void aluMixData(ALCdevice *device, ALvoid *OutBuffer, ALsizei NumSamples)
 
             ApplyStablizer(device->Stablizer.get(), device->RealOut.Buffer, lidx, ridx, cidx,
                 SamplesToDo, device->RealOut.NumChannels);
+            timer.mark(MixStageStablizer);
         }
 
         /* Apply compression, limiting sample amplitude if needed or desired. */
         if(Compressor *comp{device->Limiter.get()})
+        {
             comp->process(SamplesToDo, device->RealOut.Buffer);
+            timer.mark(MixStageLimiter);
+        }
 
         /* Apply delays and attenuation for mismatched speaker distances. */
-        ApplyDistanceComp(device->RealOut.Buffer, device->ChannelDelay, SamplesToDo,
-            device->RealOut.NumChannels);
+        if(!device->ChannelDelay.empty())
+        {
+            ApplyDistanceComp(device->RealOut.Buffer, device->ChannelDelay, SamplesToDo,
+                device->RealOut.NumChannels);
+            timer.mark(MixStageDistanceComp);
+        }
 
         /* Apply dithering. The compressor should have left enough headroom for
          * the dither noise to not saturate.
          */
         if(device->DitherDepth > 0.0f)
+        {
             ApplyDither(device->RealOut.Buffer, &device->DitherSeed, device->DitherDepth,
                 SamplesToDo, device->RealOut.NumChannels);
+            timer.mark(MixStageDither);
+        }
 
         if(LIKELY(OutBuffer))
         {
@@ -1782,10 +2376,17 @@ void aluMixData(ALCdevice *device, ALvoid *OutBuffer, ALsizei NumSamples)
                 HANDLE_WRITE(DevFmtFloat)
 #undef HANDLE_WRITE
             }
+            timer.mark(MixStageWrite);
         }
 
         SamplesDone += SamplesToDo;
     }
+    timer.finish();
+    const ALint64SOFT load{UpdateMixStats(device, timer, NumSamples)};
+    if(device->mPerfEventLoad > 0 && load >= device->mPerfEventLoad)
+        SendPerformanceEvent(device, timer, load, NumSamples);
+    if(device->mGovernor.HighLoad > 0)
+        UpdateQualityLevel(device, load, NumSamples);
 }
 
 
@@ -1823,15 +2424,20 @@ void aluHandleDisconnect(ALCdevice *device, const char *msg, ...)
             }
         }
 
-        auto stop_voice = [](ALvoice *voice) -> void
+        auto stop_voice = [ctx](ALvoice *voice) -> void
         {
             voice->mCurrentBuffer.store(nullptr, std::memory_order_relaxed);
             voice->mLoopBuffer.store(nullptr, std::memory_order_relaxed);
-            voice->mSourceID.store(0u, std::memory_order_relaxed);
-            voice->mPlayState.store(ALvoice::Stopped, std::memory_order_release);
+            const ALuint sid{voice->mSourceID.exchange(0u, std::memory_order_relaxed)};
+            const ALvoice::State vstate{voice->mPlayState.exchange(ALvoice::Stopped,
+                std::memory_order_acq_rel)};
+            /* Voices that weren't already unused go on the free list. */
+            if(sid != 0u || vstate != ALvoice::Stopped)
+                RetireVoice(ctx, voice);
         };
-        std::for_each(ctx->Voices, ctx->Voices+ctx->VoiceCount.load(std::memory_order_acquire),
-            stop_voice);
+        const ALsizei vcount{ctx->VoiceCount.load(std::memory_order_acquire)};
+        ALvoice **voices{ctx->Voices.load(std::memory_order_acquire)->data()};
+        std::for_each(voices, voices+vcount, stop_voice);
 
         ctx = ctx->next.load(std::memory_order_relaxed);
     }
@@ -2,11 +2,15 @@
 #include "config.h"
 
 #include <cstdlib>
+#include <cstring>
 
 #include <thread>
+#include <functional>
 
 #include "alMain.h"
 #include "alu.h"
+#include "alconfig.h"
+#include "compat.h"
 
 #include "backends/base.h"
 
@@ -56,3 +60,116 @@ ClockLatency BackendBase::getClockLatency()
 
     return ret;
 }
+
+
+/* MixAhead method implementations. */
+MixAhead::MixAhead(BackendBase *backend, ALuint blocks) noexcept
+  : mBackend{backend}, mDevice{backend->mDevice}, mBlocks{blocks}
+{ }
+
+MixAhead::~MixAhead()
+{ stop(); }
+
+int MixAhead::mixerProc()
+{
+    SetRTPriority();
+    althrd_setname(MIXER_THREAD_NAME);
+
+    mBackend->lock();
+    while(!mKillNow.load(std::memory_order_acquire) &&
+          mDevice->Connected.load(std::memory_order_acquire))
+    {
+        if(mRing->writeSpace() < static_cast<ALuint>(mDevice->UpdateSize))
+        {
+            mBackend->unlock();
+            mSem.wait();
+            mBackend->lock();
+            continue;
+        }
+
+        auto data = mRing->getWriteVector();
+        auto todo = static_cast<ALuint>(data.first.len + data.second.len);
+        todo -= todo%mDevice->UpdateSize;
+
+        ALuint len1{minu(data.first.len, todo)};
+        ALuint len2{minu(data.second.len, todo-len1)};
+
+        aluMixData(mDevice, data.first.buf, len1);
+        if(len2 > 0)
+            aluMixData(mDevice, data.second.buf, len2);
+        mRing->writeAdvance(todo);
+    }
+    mBackend->unlock();
+
+    return 0;
+}
+
+bool MixAhead::reset()
+{
+    mRing = nullptr;
+    mRing = CreateRingBuffer(mBlocks*mDevice->UpdateSize, mDevice->frameSizeFromFmt(), true);
+    if(!mRing)
+    {
+        ERR("Failed to allocate %u-block mix-ahead buffer\n", mBlocks);
+        return false;
+    }
+    TRACE("Mixing ahead by %zu samples\n", mRing->writeSpace());
+    return true;
+}
+
+bool MixAhead::start()
+{
+    mRing->reset();
+    try {
+        mKillNow.store(false, std::memory_order_release);
+        mThread = std::thread{std::mem_fn(&MixAhead::mixerProc), this};
+        return true;
+    }
+    catch(std::exception& e) {
+        ERR("Could not create mix-ahead thread: %s\n", e.what());
+    }
+    catch(...) {
+    }
+    return false;
+}
+
+void MixAhead::stop()
+{
+    if(mKillNow.exchange(true, std::memory_order_acq_rel) || !mThread.joinable())
+        return;
+
+    mSem.post();
+    mThread.join();
+}
+
+void MixAhead::read(void *outbuf, ALuint frames) noexcept
+{
+    const size_t got{mRing->read(outbuf, frames)};
+    if(LIKELY(got > 0))
+        mSem.post();
+
+    if(UNLIKELY(got < frames))
+    {
+        const ALsizei frame_size{mDevice->frameSizeFromFmt()};
+        memset(static_cast<char*>(outbuf) + got*frame_size,
+            ((mDevice->FmtType==DevFmtUByte) ? 0x80 : 0), (frames-got)*frame_size);
+    }
+}
+
+std::chrono::nanoseconds MixAhead::getLatency() const noexcept
+{
+    std::chrono::nanoseconds ret{std::chrono::seconds{mRing->readSpace()}};
+    return ret / mDevice->Frequency;
+}
+
+std::unique_ptr<MixAhead> MixAhead::Create(BackendBase *backend)
+{
+    ALuint blocks{0u};
+    const ALCchar *devname{backend->mDevice->DeviceName.c_str()};
+    if(!ConfigValueUInt(devname, nullptr, "mix-ahead", &blocks) || blocks == 0)
+        return nullptr;
+
+    blocks = clampu(blocks, 2, 16);
+    TRACE("Using a %u-block mix-ahead thread\n", blocks);
+    return std::unique_ptr<MixAhead>{new MixAhead{backend, blocks}};
+}
@@ -5,8 +5,12 @@
 #include <chrono>
 #include <string>
 #include <mutex>
+#include <atomic>
+#include <thread>
 
 #include "alMain.h"
+#include "ringbuffer.h"
+#include "threads.h"
 
 
 struct ClockLatency {
@@ -54,6 +58,50 @@ using BackendPtr = std::unique_ptr<BackendBase>;
 using BackendUniqueLock = std::unique_lock<BackendBase>;
 using BackendLockGuard = std::lock_guard<BackendBase>;
 
+/* Mixes ahead of a callback-driven backend with a separate thread, so the
+ * audio callback only needs to copy already mixed samples. The backend must be
+ * locked with BackendBase::lock/unlock for this to exclude mixing.
+ */
+class MixAhead {
+    BackendBase *mBackend;
+    ALCdevice *mDevice;
+    ALuint mBlocks;
+
+    RingBufferPtr mRing{nullptr};
+    al::semaphore mSem;
+    std::atomic<bool> mKillNow{true};
+    std::thread mThread;
+
+    int mixerProc();
+
+public:
+    MixAhead(BackendBase *backend, ALuint blocks) noexcept;
+    ~MixAhead();
+
+    /* Allocates the ring buffer for the device's current format. */
+    bool reset();
+    bool start();
+    void stop();
+
+    /* Copies mixed samples out for the audio callback, padding with silence
+     * if the mixer thread fell behind.
+     */
+    void read(void *outbuf, ALuint frames) noexcept;
+
+    /* Number of mixed sample frames waiting to be read. */
+    ALuint available() const noexcept { return static_cast<ALuint>(mRing->readSpace()); }
+
+    /* Amount of mixed audio waiting to be read. The backend must be locked. */
+    std::chrono::nanoseconds getLatency() const noexcept;
+
+    /* Returns a mixer for the backend if the mix-ahead config option is set
+     * for its device, or null to mix in the callback.
+     */
+    static std::unique_ptr<MixAhead> Create(BackendBase *backend);
+
+    DEF_NEWDEL(MixAhead)
+};
+
 enum class BackendType {
     Playback,
     Capture
@@ -84,11 +84,14 @@ struct PortPlayback final : public BackendBase {
     ALCboolean reset() override;
     ALCboolean start() override;
     void stop() override;
+    ClockLatency getClockLatency() override;
 
     PaStream *mStream{nullptr};
     PaStreamParameters mParams{};
     ALuint mUpdateSize{0u};
 
+    std::unique_ptr<MixAhead> mMixAhead;
+
     static constexpr inline const char *CurrentPrefix() noexcept { return "PortPlayback::"; }
     DEF_NEWDEL(PortPlayback)
 };
@@ -114,6 +117,12 @@ int PortPlayback::writeCallback(const void* UNUSED(inputBuffer), void *outputBuf
     unsigned long framesPerBuffer, const PaStreamCallbackTimeInfo* UNUSED(timeInfo),
     const PaStreamCallbackFlags UNUSED(statusFlags))
 {
+    if(mMixAhead)
+    {
+        mMixAhead->read(outputBuffer, framesPerBuffer);
+        return 0;
+    }
+
     lock();
     aluMixData(mDevice, outputBuffer, framesPerBuffer);
     unlock();
@@ -176,6 +185,7 @@ retry_open:
     }
 
     mDevice->DeviceName = name;
+    mMixAhead = MixAhead::Create(this);
     return ALC_NO_ERROR;
 
 }
@@ -213,15 +223,22 @@ ALCboolean PortPlayback::reset()
     }
     SetDefaultChannelOrder(mDevice);
 
+    if(mMixAhead && !mMixAhead->reset())
+        return ALC_FALSE;
+
     return ALC_TRUE;
 }
 
 ALCboolean PortPlayback::start()
 {
+    if(mMixAhead && !mMixAhead->start())
+        return ALC_FALSE;
+
     PaError err{Pa_StartStream(mStream)};
     if(err != paNoError)
     {
         ERR("Pa_StartStream() returned an error: %s\n", Pa_GetErrorText(err));
+        if(mMixAhead) mMixAhead->stop();
         return ALC_FALSE;
     }
     return ALC_TRUE;
@@ -232,6 +249,20 @@ void PortPlayback::stop()
     PaError err{Pa_StopStream(mStream)};
     if(err != paNoError)
         ERR("Error stopping stream: %s\n", Pa_GetErrorText(err));
+    if(mMixAhead)
+        mMixAhead->stop();
+}
+
+ClockLatency PortPlayback::getClockLatency()
+{
+    if(!mMixAhead)
+        return BackendBase::getClockLatency();
+
+    lock();
+    ClockLatency ret{BackendBase::getClockLatency()};
+    ret.Latency += mMixAhead->getLatency();
+    unlock();
+    return ret;
 }
 
 
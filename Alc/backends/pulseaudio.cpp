@@ -681,6 +681,8 @@ struct PulsePlayback final : public BackendBase {
 
     ALuint mFrameSize{0u};
 
+    std::unique_ptr<MixAhead> mMixAhead;
+
     static constexpr inline const char *CurrentPrefix() noexcept { return "PulsePlayback::"; }
     DEF_NEWDEL(PulsePlayback)
 };
@@ -718,6 +720,11 @@ void PulsePlayback::contextStateCallback(pa_context *context)
     if(pa_context_get_state(context) == PA_CONTEXT_FAILED)
     {
         ERR("Received context failure!\n");
+        /* The pulse lock doesn't keep out the mixer thread when mixing
+         * ahead.
+         */
+        std::unique_lock<std::recursive_mutex> mixlock{mMutex, std::defer_lock};
+        if(mMixAhead) mixlock.lock();
         aluHandleDisconnect(mDevice, "Playback state failure");
     }
     pulse_condvar.notify_all();
@@ -731,6 +738,11 @@ void PulsePlayback::streamStateCallback(pa_stream *stream)
     if(pa_stream_get_state(stream) == PA_STREAM_FAILED)
     {
         ERR("Received stream failure!\n");
+        /* The pulse lock doesn't keep out the mixer thread when mixing
+         * ahead.
+         */
+        std::unique_lock<std::recursive_mutex> mixlock{mMutex, std::defer_lock};
+        if(mMixAhead) mixlock.lock();
         aluHandleDisconnect(mDevice, "Playback stream failure");
     }
     pulse_condvar.notify_all();
@@ -741,8 +753,23 @@ void PulsePlayback::streamWriteCallbackC(pa_stream *stream, size_t nbytes, void
 
 void PulsePlayback::streamWriteCallback(pa_stream *stream, size_t nbytes)
 {
+    if(mMixAhead)
+    {
+        /* The server may ask for more than is mixed ahead, particularly when
+         * starting. Only give what's ready (or an update's worth, if it fell
+         * behind), and it will ask again for the rest.
+         */
+        ALuint todo{static_cast<ALuint>(nbytes / mFrameSize)};
+        todo = minu(todo, maxu(mMixAhead->available(), mDevice->UpdateSize));
+        nbytes = todo * mFrameSize;
+        if(nbytes == 0) return;
+    }
+
     void *buf{pa_xmalloc(nbytes)};
-    aluMixData(mDevice, buf, nbytes/mFrameSize);
+    if(mMixAhead)
+        mMixAhead->read(buf, nbytes/mFrameSize);
+    else
+        aluMixData(mDevice, buf, nbytes/mFrameSize);
 
     int ret{pa_stream_write(stream, buf, nbytes, pa_xfree, 0, PA_SEEK_RELATIVE)};
     if(UNLIKELY(ret != PA_OK))
@@ -875,6 +902,7 @@ ALCenum PulsePlayback::open(const ALCchar *name)
     else
         mDevice->DeviceName = dev_name;
 
+    mMixAhead = MixAhead::Create(this);
     return ALC_NO_ERROR;
 }
 
@@ -1030,11 +1058,17 @@ ALCboolean PulsePlayback::reset()
                 len, mAttr.prebuf, mDevice->BufferSize);
     }
 
+    if(mMixAhead && !mMixAhead->reset())
+        return ALC_FALSE;
+
     return ALC_TRUE;
 }
 
 ALCboolean PulsePlayback::start()
 {
+    if(mMixAhead && !mMixAhead->start())
+        return ALC_FALSE;
+
     std::unique_lock<std::mutex> plock{pulse_lock};
 
     pa_stream_set_write_callback(mStream, &PulsePlayback::streamWriteCallbackC, this);
@@ -1051,6 +1085,10 @@ void PulsePlayback::stop()
     pa_stream_set_write_callback(mStream, nullptr, nullptr);
     pa_operation *op{pa_stream_cork(mStream, 1, stream_success_callback, nullptr)};
     wait_for_operation(op, plock);
+    plock.unlock();
+
+    if(mMixAhead)
+        mMixAhead->stop();
 }
 
 
@@ -1060,8 +1098,23 @@ ClockLatency PulsePlayback::getClockLatency()
     pa_usec_t latency;
     int neg, err;
 
-    { std::lock_guard<std::mutex> _{pulse_lock};
+    if(mMixAhead)
+    {
+        /* The mixer thread only holds the backend lock, which isn't the pulse
+         * lock in this case. The pulse lock must be taken first.
+         */
+        std::lock_guard<std::mutex> _{pulse_lock};
+        err = pa_stream_get_latency(mStream, &latency, &neg);
+
+        BackendLockGuard __{*this};
+        ret.ClockTime = GetDeviceClockTime(mDevice);
+        ret.Latency = mMixAhead->getLatency();
+    }
+    else
+    {
+        std::lock_guard<std::mutex> _{pulse_lock};
         ret.ClockTime = GetDeviceClockTime(mDevice);
+        ret.Latency = std::chrono::nanoseconds::zero();
         err = pa_stream_get_latency(mStream, &latency, &neg);
     }
 
@@ -1078,17 +1131,26 @@ ClockLatency PulsePlayback::getClockLatency()
     }
     else if(UNLIKELY(neg))
         latency = 0;
-    ret.Latency = std::chrono::microseconds{latency};
+    ret.Latency += std::chrono::microseconds{latency};
 
     return ret;
 }
 
 
+/* When mixing ahead, the stream callback doesn't mix so the device lock only
+ * needs to keep out the mixer thread.
+ */
 void PulsePlayback::lock()
-{ pulse_lock.lock(); }
+{
+    if(mMixAhead) BackendBase::lock();
+    else pulse_lock.lock();
+}
 
 void PulsePlayback::unlock()
-{ pulse_lock.unlock(); }
+{
+    if(mMixAhead) BackendBase::unlock();
+    else pulse_lock.unlock();
+}
 
 
 struct PulseCapture final : public BackendBase {
@@ -54,6 +54,7 @@ struct Sdl2Backend final : public BackendBase {
     ALCboolean reset() override;
     ALCboolean start() override;
     void stop() override;
+    ClockLatency getClockLatency() override;
     void lock() override;
     void unlock() override;
 
@@ -65,6 +66,8 @@ struct Sdl2Backend final : public BackendBase {
     DevFmtType     mFmtType{};
     ALuint mUpdateSize{0u};
 
+    std::unique_ptr<MixAhead> mMixAhead;
+
     static constexpr inline const char *CurrentPrefix() noexcept { return "ALCsdl2Playback::"; }
     DEF_NEWDEL(Sdl2Backend)
 };
@@ -82,7 +85,10 @@ void Sdl2Backend::audioCallbackC(void *ptr, Uint8 *stream, int len)
 void Sdl2Backend::audioCallback(Uint8 *stream, int len)
 {
     assert((len % mFrameSize) == 0);
-    aluMixData(mDevice, stream, len / mFrameSize);
+    if(mMixAhead)
+        mMixAhead->read(stream, len / mFrameSize);
+    else
+        aluMixData(mDevice, stream, len / mFrameSize);
 }
 
 ALCenum Sdl2Backend::open(const ALCchar *name)
@@ -155,6 +161,7 @@ ALCenum Sdl2Backend::open(const ALCchar *name)
     mUpdateSize = mDevice->UpdateSize;
 
     mDevice->DeviceName = name ? name : defaultDeviceName;
+    mMixAhead = MixAhead::Create(this);
     return ALC_NO_ERROR;
 }
 
@@ -166,23 +173,52 @@ ALCboolean Sdl2Backend::reset()
     mDevice->UpdateSize = mUpdateSize;
     mDevice->BufferSize = mUpdateSize * 2;
     SetDefaultWFXChannelOrder(mDevice);
+    if(mMixAhead && !mMixAhead->reset())
+        return ALC_FALSE;
     return ALC_TRUE;
 }
 
 ALCboolean Sdl2Backend::start()
 {
+    if(mMixAhead && !mMixAhead->start())
+        return ALC_FALSE;
     SDL_PauseAudioDevice(mDeviceID, 0);
     return ALC_TRUE;
 }
 
 void Sdl2Backend::stop()
-{ SDL_PauseAudioDevice(mDeviceID, 1); }
+{
+    SDL_PauseAudioDevice(mDeviceID, 1);
+    if(mMixAhead)
+        mMixAhead->stop();
+}
+
+ClockLatency Sdl2Backend::getClockLatency()
+{
+    if(!mMixAhead)
+        return BackendBase::getClockLatency();
+
+    lock();
+    ClockLatency ret{BackendBase::getClockLatency()};
+    ret.Latency += mMixAhead->getLatency();
+    unlock();
+    return ret;
+}
 
+/* When mixing ahead, the audio callback doesn't mix so the device lock only
+ * needs to keep out the mixer thread.
+ */
 void Sdl2Backend::lock()
-{ SDL_LockAudioDevice(mDeviceID); }
+{
+    if(mMixAhead) BackendBase::lock();
+    else SDL_LockAudioDevice(mDeviceID);
+}
 
 void Sdl2Backend::unlock()
-{ SDL_UnlockAudioDevice(mDeviceID); }
+{
+    if(mMixAhead) BackendBase::unlock();
+    else SDL_UnlockAudioDevice(mDeviceID);
+}
 
 } // namespace
 
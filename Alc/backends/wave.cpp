@@ -35,6 +35,8 @@
 #include "alMain.h"
 #include "alu.h"
 #include "alconfig.h"
+#include "ringbuffer.h"
+#include "threads.h"
 #include "compat.h"
 
 
@@ -46,6 +48,11 @@ using std::chrono::nanoseconds;
 
 constexpr ALCchar waveDevice[] = "Wave File Writer";
 
+/* Size of the 'ds64' chunk payload, reserved with a 'JUNK' chunk in case the
+ * file needs to become RF64.
+ */
+constexpr ALuint DS64Size{28};
+
 constexpr ALubyte SUBTYPE_PCM[]{
     0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xaa,
     0x00, 0x38, 0x9b, 0x71
@@ -78,12 +85,44 @@ void fwrite32le(ALuint val, FILE *f)
     fwrite(data, 1, 4, f);
 }
 
+void fwrite64le(uint64_t val, FILE *f)
+{
+    fwrite32le(static_cast<ALuint>(val&0xffffffff), f);
+    fwrite32le(static_cast<ALuint>(val>>32), f);
+}
+
+void SwapEndian(ALbyte *buffer, size_t len, ALsizei bytesize)
+{
+    if(bytesize == 2)
+    {
+        ALushort *samples = reinterpret_cast<ALushort*>(buffer);
+        len /= 2;
+        for(size_t i{0};i < len;i++)
+        {
+            ALushort samp = samples[i];
+            samples[i] = (samp>>8) | (samp<<8);
+        }
+    }
+    else if(bytesize == 4)
+    {
+        ALuint *samples = reinterpret_cast<ALuint*>(buffer);
+        len /= 4;
+        for(size_t i{0};i < len;i++)
+        {
+            ALuint samp = samples[i];
+            samples[i] = (samp>>24) | ((samp>>8)&0x0000ff00) |
+                         ((samp<<8)&0x00ff0000) | (samp<<24);
+        }
+    }
+}
+
 
 struct WaveBackend final : public BackendBase {
     WaveBackend(ALCdevice *device) noexcept : BackendBase{device} { }
     ~WaveBackend() override;
 
     int mixerProc();
+    int writerProc();
 
     ALCenum open(const ALCchar *name) override;
     ALCboolean reset() override;
@@ -92,11 +131,22 @@ struct WaveBackend final : public BackendBase {
 
     FILE *mFile{nullptr};
     long mDataStart{-1};
-
-    al::vector<ALbyte> mBuffer;
+    uint64_t mDataLen{0u};
+    bool mRealtime{true};
+
+    /* Mixed samples waiting to be written. The writer thread writes them out
+     * a chunk at a time, so the mixer can fill one half while the other is
+     * being written.
+     */
+    RingBufferPtr mRing{nullptr};
+    ALuint mChunkSize{0u};
+    al::semaphore mDataSem;
+    al::semaphore mSpaceSem;
 
     std::atomic<bool> mKillNow{true};
+    std::atomic<bool> mWriterDone{true};
     std::thread mThread;
+    std::thread mWriterThread;
 
     static constexpr inline const char *CurrentPrefix() noexcept { return "WaveBackend::"; }
     DEF_NEWDEL(WaveBackend)
@@ -122,59 +172,52 @@ int WaveBackend::mixerProc()
     while(!mKillNow.load(std::memory_order_acquire) &&
           mDevice->Connected.load(std::memory_order_acquire))
     {
-        auto now = std::chrono::steady_clock::now();
-
-        /* This converts from nanoseconds to nanosamples, then to samples. */
-        int64_t avail{std::chrono::duration_cast<seconds>((now-start) *
-            mDevice->Frequency).count()};
-        if(avail-done < mDevice->UpdateSize)
+        /* When not keeping to real time, always mix the next update. */
+        int64_t avail{done + mDevice->UpdateSize};
+        if(mRealtime)
         {
-            std::this_thread::sleep_for(restTime);
-            continue;
+            auto now = std::chrono::steady_clock::now();
+
+            /* This converts from nanoseconds to nanosamples, then to samples. */
+            avail = std::chrono::duration_cast<seconds>((now-start) * mDevice->Frequency).count();
+            if(avail-done < mDevice->UpdateSize)
+            {
+                std::this_thread::sleep_for(restTime);
+                continue;
+            }
         }
         while(avail-done >= mDevice->UpdateSize)
         {
+            if(mRing->writeSpace() < static_cast<ALuint>(mDevice->UpdateSize))
+            {
+                /* The writer thread is behind, wait for it to catch up. */
+                mSpaceSem.wait();
+                if(mKillNow.load(std::memory_order_acquire))
+                    break;
+                continue;
+            }
+
+            auto data = mRing->getWriteVector();
+            ALuint len1{minu(data.first.len, mDevice->UpdateSize)};
+            ALuint len2{minu(data.second.len, mDevice->UpdateSize-len1)};
+
             lock();
-            aluMixData(mDevice, mBuffer.data(), mDevice->UpdateSize);
+            aluMixData(mDevice, data.first.buf, len1);
+            if(len2 > 0)
+                aluMixData(mDevice, data.second.buf, len2);
             unlock();
             done += mDevice->UpdateSize;
 
             if(!IS_LITTLE_ENDIAN)
             {
                 const ALsizei bytesize{mDevice->bytesFromFmt()};
-                ALsizei i;
-
-                if(bytesize == 2)
-                {
-                    ALushort *samples = reinterpret_cast<ALushort*>(mBuffer.data());
-                    const auto len = static_cast<ALsizei>(mBuffer.size() / 2);
-                    for(i = 0;i < len;i++)
-                    {
-                        ALushort samp = samples[i];
-                        samples[i] = (samp>>8) | (samp<<8);
-                    }
-                }
-                else if(bytesize == 4)
-                {
-                    ALuint *samples = reinterpret_cast<ALuint*>(mBuffer.data());
-                    const auto len = static_cast<ALsizei>(mBuffer.size() / 4);
-                    for(i = 0;i < len;i++)
-                    {
-                        ALuint samp = samples[i];
-                        samples[i] = (samp>>24) | ((samp>>8)&0x0000ff00) |
-                                     ((samp<<8)&0x00ff0000) | (samp<<24);
-                    }
-                }
+                SwapEndian(reinterpret_cast<ALbyte*>(data.first.buf), len1*frameSize, bytesize);
+                SwapEndian(reinterpret_cast<ALbyte*>(data.second.buf), len2*frameSize, bytesize);
             }
 
-            size_t fs{fwrite(mBuffer.data(), frameSize, mDevice->UpdateSize, mFile)};
-            (void)fs;
-            if(ferror(mFile))
-            {
-                ERR("Error writing to file\n");
-                aluHandleDisconnect(mDevice, "Failed to write playback samples");
-                break;
-            }
+            mRing->writeAdvance(mDevice->UpdateSize);
+            if(mRing->readSpace() >= mChunkSize)
+                mDataSem.post();
         }
 
         /* For every completed second, increment the start time and reduce the
@@ -193,6 +236,53 @@ int WaveBackend::mixerProc()
     return 0;
 }
 
+int WaveBackend::writerProc()
+{
+    althrd_setname("alsoft-wave");
+
+    const ALsizei frameSize{mDevice->frameSizeFromFmt()};
+
+    bool failed{false};
+    while(true)
+    {
+        const size_t avail{mRing->readSpace()};
+        if(avail < mChunkSize)
+        {
+            /* Wait for a full chunk while mixing, then write whatever's left
+             * once it stops.
+             */
+            if(!mWriterDone.load(std::memory_order_acquire))
+            {
+                mDataSem.wait();
+                continue;
+            }
+            if(avail == 0)
+                break;
+        }
+
+        auto data = mRing->getReadVector();
+        if(!failed)
+        {
+            size_t fs{fwrite(data.first.buf, frameSize, data.first.len, mFile)};
+            if(data.second.len > 0)
+                fs += fwrite(data.second.buf, frameSize, data.second.len, mFile);
+            mDataLen += fs * frameSize;
+            if(ferror(mFile))
+            {
+                ERR("Error writing to file\n");
+                lock();
+                aluHandleDisconnect(mDevice, "Failed to write playback samples");
+                unlock();
+                failed = true;
+            }
+        }
+        mRing->readAdvance(data.first.len + data.second.len);
+        mSpaceSem.post();
+    }
+
+    return 0;
+}
+
 ALCenum WaveBackend::open(const ALCchar *name)
 {
     const char *fname{GetConfigValue(nullptr, "wave", "file", "")};
@@ -218,6 +308,9 @@ ALCenum WaveBackend::open(const ALCchar *name)
     }
 
     mDevice->DeviceName = name;
+    mRealtime = GetConfigValueBool(nullptr, "wave", "realtime", 1);
+    if(!mRealtime)
+        TRACE("Rendering as fast as possible\n");
 
     return ALC_NO_ERROR;
 }
@@ -282,6 +375,12 @@ ALCboolean WaveBackend::reset()
 
     fputs("WAVE", mFile);
 
+    // Reserve space for a 'ds64' chunk, if the file gets too big for 'RIFF'
+    fputs("JUNK", mFile);
+    fwrite32le(DS64Size, mFile);
+    for(ALuint i{0};i < DS64Size;i++)
+        fputc(0, mFile);
+
     fputs("fmt ", mFile);
     fwrite32le(40, mFile); // 'fmt ' header len; 40 bytes for EXTENSIBLE
 
@@ -318,17 +417,41 @@ ALCboolean WaveBackend::reset()
         return ALC_FALSE;
     }
     mDataStart = ftell(mFile);
+    mDataLen = 0;
 
     SetDefaultWFXChannelOrder(mDevice);
 
-    const ALuint bufsize{mDevice->frameSizeFromFmt() * mDevice->UpdateSize};
-    mBuffer.resize(bufsize);
+    /* Write out about a half second at a time, with room to mix another half
+     * second while that's being written.
+     */
+    mChunkSize = (mDevice->Frequency/2 + mDevice->UpdateSize-1) / mDevice->UpdateSize *
+        mDevice->UpdateSize;
+    mRing = nullptr;
+    mRing = CreateRingBuffer(mChunkSize*2, mDevice->frameSizeFromFmt(), true);
+    if(!mRing)
+    {
+        ERR("Failed to allocate %u-sample write buffer\n", mChunkSize*2);
+        return ALC_FALSE;
+    }
 
     return ALC_TRUE;
 }
 
 ALCboolean WaveBackend::start()
 {
+    mRing->reset();
+    try {
+        mWriterDone.store(false, std::memory_order_release);
+        mWriterThread = std::thread{std::mem_fn(&WaveBackend::writerProc), this};
+    }
+    catch(std::exception& e) {
+        ERR("Failed to start writer thread: %s\n", e.what());
+        return ALC_FALSE;
+    }
+    catch(...) {
+        return ALC_FALSE;
+    }
+
     try {
         mKillNow.store(false, std::memory_order_release);
         mThread = std::thread{std::mem_fn(&WaveBackend::mixerProc), this};
@@ -339,6 +462,9 @@ ALCboolean WaveBackend::start()
     }
     catch(...) {
     }
+    mWriterDone.store(true, std::memory_order_release);
+    mDataSem.post();
+    mWriterThread.join();
     return ALC_FALSE;
 }
 
@@ -346,17 +472,46 @@ void WaveBackend::stop()
 {
     if(mKillNow.exchange(true, std::memory_order_acq_rel) || !mThread.joinable())
         return;
+    mSpaceSem.post();
     mThread.join();
 
-    long size{ftell(mFile)};
-    if(size > 0)
+    /* Let the writer finish off what was mixed. */
+    mWriterDone.store(true, std::memory_order_release);
+    mDataSem.post();
+    mWriterThread.join();
+
+    const uint64_t size{static_cast<uint64_t>(mDataStart) + mDataLen};
+    if(size-8 > 0xffffffffu)
+    {
+        /* Too big for 'RIFF', so turn it into RF64 with the real sizes in the
+         * reserved 'ds64' chunk.
+         */
+        if(fseek(mFile, 0, SEEK_SET) == 0)
+        {
+            fputs("RF64", mFile);
+            fwrite32le(0xFFFFFFFF, mFile); // 'RF64' header len; in 'ds64'
+        }
+        if(fseek(mFile, 12, SEEK_SET) == 0)
+        {
+            fputs("ds64", mFile);
+            fwrite32le(DS64Size, mFile);
+            fwrite64le(size-8, mFile); // 'RF64' header len
+            fwrite64le(mDataLen, mFile); // 'data' header len
+            fwrite64le(mDataLen / mDevice->frameSizeFromFmt(), mFile); // sample frames
+            fwrite32le(0, mFile); // table length
+        }
+        if(fseek(mFile, mDataStart-4, SEEK_SET) == 0)
+            fwrite32le(0xFFFFFFFF, mFile); // 'data' header len; in 'ds64'
+    }
+    else
     {
-        long dataLen{size - mDataStart};
         if(fseek(mFile, mDataStart-4, SEEK_SET) == 0)
-            fwrite32le(dataLen, mFile); // 'data' header len
+            fwrite32le(static_cast<ALuint>(mDataLen), mFile); // 'data' header len
         if(fseek(mFile, 4, SEEK_SET) == 0)
-            fwrite32le(size-8, mFile); // 'WAVE' header len
+            fwrite32le(static_cast<ALuint>(size-8), mFile); // 'WAVE' header len
     }
+    /* Continue after the written samples if restarted. */
+    fseek(mFile, 0, SEEK_END);
 }
 
 } // namespace
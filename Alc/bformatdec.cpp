@@ -4,7 +4,6 @@
 #include <cmath>
 #include <array>
 #include <vector>
-#include <numeric>
 #include <algorithm>
 #include <functional>
 
@@ -64,11 +63,6 @@ BFormatDec::BFormatDec(const AmbDecConf *conf, const bool allow_2band, const ALs
     }
     mNumChannels = inchans;
 
-    mEnabled = std::accumulate(std::begin(chanmap), std::begin(chanmap)+conf->Speakers.size(), 0u,
-        [](ALuint mask, const ALsizei &chan) noexcept -> ALuint
-        { return mask | (1 << chan); }
-    );
-
     const ALfloat xover_norm{conf->XOverFreq / static_cast<float>(srate)};
 
     const bool periphonic{(conf->ChanMask&AMBI_PERIPHONIC_MASK) != 0};
@@ -94,8 +88,8 @@ BFormatDec::BFormatDec(const AmbDecConf *conf, const bool allow_2band, const ALs
     }
     else
     {
-        mXOver[0].init(xover_norm);
-        std::fill(std::begin(mXOver)+1, std::end(mXOver), mXOver[0]);
+        for(auto &xover : mXOver)
+            xover.init(xover_norm);
 
         const float ratio{std::pow(10.0f, conf->XOverRatio / 40.0f)};
         for(size_t i{0u};i < conf->Speakers.size();i++)
@@ -127,11 +121,6 @@ BFormatDec::BFormatDec(const ALsizei inchans, const ALsizei chancount,
     mNumChannels = inchans;
 
     ASSUME(chancount > 0);
-    mEnabled = std::accumulate(std::begin(chanmap), std::begin(chanmap)+chancount, 0u,
-        [](ALuint mask, const ALsizei &chan) noexcept -> ALuint
-        { return mask | (1 << chan); }
-    );
-
     const ChannelDec *incoeffs{chancoeffs};
     auto set_coeffs = [this,inchans,&incoeffs](const ALsizei chanidx) noexcept -> void
     {
@@ -153,33 +142,32 @@ void BFormatDec::process(ALfloat (*OutBuffer)[BUFFERSIZE], const ALsizei OutChan
 
     if(mDualBand)
     {
-        for(ALsizei i{0};i < mNumChannels;i++)
-            mXOver[i].process(mSamplesHF[i].data(), mSamplesLF[i].data(), InSamples[i],
-                              SamplesToDo);
-
-        for(ALsizei chan{0};chan < OutChannels;chan++)
+        for(ALsizei base{0};base < mNumChannels;base += 4)
         {
-            if(UNLIKELY(!(mEnabled&(1<<chan))))
-                continue;
-
-            MixRowSamples(OutBuffer[chan], mMatrix.Dual[chan][sHFBand],
-                &reinterpret_cast<ALfloat(&)[BUFFERSIZE]>(mSamplesHF[0]),
-                mNumChannels, 0, SamplesToDo);
-            MixRowSamples(OutBuffer[chan], mMatrix.Dual[chan][sLFBand],
-                &reinterpret_cast<ALfloat(&)[BUFFERSIZE]>(mSamplesLF[0]),
-                mNumChannels, 0, SamplesToDo);
+            const ALsizei todo{mini(4, mNumChannels-base)};
+            const ALfloat *input[4]{};
+            ALfloat *hfout[4]{}, *lfout[4]{};
+            for(ALsizei i{0};i < todo;i++)
+            {
+                input[i] = InSamples[base+i];
+                hfout[i] = mSamplesHF[base+i].data();
+                lfout[i] = mSamplesLF[base+i].data();
+            }
+            mXOver[base/4].process(hfout, lfout, input, static_cast<size_t>(todo), SamplesToDo);
         }
+
+        /* Unused outputs have silent matrix rows, which the mixer skips. */
+        MixMatrixSamples(OutBuffer, OutChannels, mMatrix.Dual[0][sHFBand],
+            sNumBands*MAX_AMBI_CHANNELS, &reinterpret_cast<ALfloat(&)[BUFFERSIZE]>(mSamplesHF[0]),
+            mNumChannels, 0, SamplesToDo);
+        MixMatrixSamples(OutBuffer, OutChannels, mMatrix.Dual[0][sLFBand],
+            sNumBands*MAX_AMBI_CHANNELS, &reinterpret_cast<ALfloat(&)[BUFFERSIZE]>(mSamplesLF[0]),
+            mNumChannels, 0, SamplesToDo);
     }
     else
     {
-        for(ALsizei chan{0};chan < OutChannels;chan++)
-        {
-            if(UNLIKELY(!(mEnabled&(1<<chan))))
-                continue;
-
-            MixRowSamples(OutBuffer[chan], mMatrix.Single[chan], InSamples,
-                          mNumChannels, 0, SamplesToDo);
-        }
+        MixMatrixSamples(OutBuffer, OutChannels, mMatrix.Single[0], MAX_AMBI_CHANNELS,
+            InSamples, mNumChannels, 0, SamplesToDo);
     }
 }
 
@@ -17,15 +17,15 @@ class BFormatDec {
     static constexpr size_t sLFBand{1};
     static constexpr size_t sNumBands{2};
 
-    ALuint mEnabled{0u}; /* Bitfield of enabled channels. */
-
     union MatrixU {
         ALfloat Dual[MAX_OUTPUT_CHANNELS][sNumBands][MAX_AMBI_CHANNELS];
         ALfloat Single[MAX_OUTPUT_CHANNELS][MAX_AMBI_CHANNELS];
     } mMatrix{};
 
-    /* NOTE: BandSplitter filters are unused with single-band decoding */
-    BandSplitter mXOver[MAX_AMBI_CHANNELS];
+    /* NOTE: BandSplitter filters are unused with single-band decoding. Each
+     * bank splits a group of four input channels.
+     */
+    BandSplitterBank<4> mXOver[MAX_AMBI_CHANNELS/4];
 
     al::vector<std::array<ALfloat,BUFFERSIZE>, 16> mSamples;
     /* These two alias into Samples */
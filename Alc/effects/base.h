@@ -8,6 +8,7 @@
 
 
 struct ALeffectslot;
+struct ALbuffer;
 
 
 union EffectProps {
@@ -150,6 +151,10 @@ struct EffectState {
     virtual ~EffectState() = default;
 
     virtual ALboolean deviceUpdate(const ALCdevice *device) = 0;
+    /* Sets the buffer data (e.g. an impulse response) used by the effect. This
+     * is called on a new state, before it's given to the mixer.
+     */
+    virtual void setBuffer(const ALCdevice* /*device*/, const ALbuffer* /*buffer*/) { }
     virtual void update(const ALCcontext *context, const ALeffectslot *slot, const EffectProps *props, const EffectTarget target) = 0;
     virtual void process(ALsizei samplesToDo, const ALfloat (*RESTRICT samplesIn)[BUFFERSIZE], const ALsizei numInput, ALfloat (*RESTRICT samplesOut)[BUFFERSIZE], const ALsizei numOutput) = 0;
 
@@ -180,6 +185,7 @@ EffectStateFactory *FlangerStateFactory_getFactory(void);
 EffectStateFactory *FshifterStateFactory_getFactory(void);
 EffectStateFactory *ModulatorStateFactory_getFactory(void);
 EffectStateFactory *PshifterStateFactory_getFactory(void);
+EffectStateFactory *ConvolutionStateFactory_getFactory(void);
 
 EffectStateFactory *DedicatedStateFactory_getFactory(void);
 
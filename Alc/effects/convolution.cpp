@@ -0,0 +1,627 @@
+/**
+ * OpenAL cross platform audio library
+ * This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ *  License along with this library; if not, write to the
+ *  Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * Or go to http://www.gnu.org/copyleft/lgpl.html
+ */
+
+#include "config.h"
+
+#include <cmath>
+#include <cstdlib>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <complex>
+#include <algorithm>
+#include <functional>
+
+#include "alMain.h"
+#include "alcontext.h"
+#include "alAuxEffectSlot.h"
+#include "alBuffer.h"
+#include "alError.h"
+#include "alu.h"
+#include "ambidefs.h"
+#include "converter.h"
+#include "alcomplex.h"
+#include "threads.h"
+#include "vector.h"
+
+
+namespace {
+
+using complex_f = std::complex<float>;
+
+/* The convolution is split into a short head, processed in the mixer with
+ * small partitions, and a long tail, processed with large partitions on a
+ * worker thread. The head covers the first two tail blocks, which gives the
+ * worker a full tail block of time to finish each job before its output is
+ * needed. The head's block size is also the effect's latency.
+ */
+constexpr ALsizei HeadBlockSize{256};
+constexpr ALsizei TailBlockSize{4096};
+constexpr ALsizei TailBlockRatio{TailBlockSize / HeadBlockSize};
+constexpr ALsizei HeadLength{TailBlockSize * 2};
+
+/* Impulse responses may be mono, stereo, or first-order B-Format. */
+constexpr ALsizei MaxIrChannels{4};
+
+
+/* Uniformly partitioned overlap-save convolver, applying multiple impulse
+ * response channels to one input. Filter partitions and the input history are
+ * stored as half spectra, since all of the signals are real.
+ */
+class PartitionedConvolver {
+    ALsizei mBlockSize{0};
+    ALsizei mNumParts{0};
+    ALsizei mNumChans{0};
+    ALsizei mCurrent{0};
+
+    /* The tail's transforms are larger than complex_fft keeps plans for, so
+     * each convolver makes its own when it's set up.
+     */
+    std::unique_ptr<ComplexFftPlan<float>> mFft;
+
+    /* Filter spectra, [part][chan][mBlockSize+1]. */
+    al::vector<complex_f,16> mFilter;
+    /* Frequency-domain delay line of input spectra, [part][mBlockSize+1]. */
+    al::vector<complex_f,16> mInputFdl;
+    /* The last two blocks of input. */
+    al::vector<ALfloat,16> mInput;
+    /* Accumulated output spectra, [chan][mBlockSize+1]. */
+    al::vector<complex_f,16> mAccum;
+    al::vector<complex_f,16> mFftBuffer;
+
+public:
+    ~PartitionedConvolver();
+
+    void init(const ALfloat *const *ir, ALsizei numchans, ALsizei offset, ALsizei length,
+        ALsizei blocksize);
+    void clear() noexcept;
+    void reset() noexcept;
+
+    bool empty() const noexcept { return mNumParts == 0; }
+
+    /* Processes one block of input, writing a block for each channel. */
+    void process(const ALfloat *RESTRICT input, ALfloat *const *RESTRICT output);
+};
+
+PartitionedConvolver::~PartitionedConvolver() = default;
+
+void PartitionedConvolver::init(const ALfloat *const *ir, ALsizei numchans, ALsizei offset,
+    ALsizei length, ALsizei blocksize)
+{
+    const ALsizei fftsize{blocksize * 2};
+    const ALsizei numbins{blocksize + 1};
+
+    mBlockSize = blocksize;
+    mNumChans = numchans;
+    mNumParts = (length > 0) ? (length+blocksize-1) / blocksize : 0;
+    mCurrent = 0;
+
+    mFilter.resize(static_cast<size_t>(mNumParts * numchans * numbins));
+    mInputFdl.resize(static_cast<size_t>(mNumParts * numbins));
+    mInput.resize(static_cast<size_t>(fftsize));
+    mAccum.resize(static_cast<size_t>(numchans * numbins));
+    mFftBuffer.resize(static_cast<size_t>(fftsize));
+    mFft.reset(new ComplexFftPlan<float>{static_cast<size_t>(fftsize)});
+    clear();
+
+    /* Scale the filter for the inverse FFT ahead of time. */
+    const ALfloat scale{1.0f / static_cast<ALfloat>(fftsize)};
+    auto filter = mFilter.begin();
+    for(ALsizei p{0};p < mNumParts;p++)
+    {
+        const ALsizei start{offset + p*blocksize};
+        const ALsizei todo{mini(blocksize, offset+length - start)};
+        for(ALsizei c{0};c < numchans;c++)
+        {
+            auto fftiter = std::transform(ir[c]+start, ir[c]+start+todo, mFftBuffer.begin(),
+                [scale](const ALfloat s) noexcept -> complex_f { return complex_f{s*scale, 0.0f}; });
+            std::fill(fftiter, mFftBuffer.end(), complex_f{});
+
+            mFft->forward(mFftBuffer.data());
+            filter = std::copy_n(mFftBuffer.begin(), numbins, filter);
+        }
+    }
+}
+
+void PartitionedConvolver::clear() noexcept
+{
+    std::fill(mInputFdl.begin(), mInputFdl.end(), complex_f{});
+    std::fill(mInput.begin(), mInput.end(), 0.0f);
+    mCurrent = 0;
+}
+
+void PartitionedConvolver::reset() noexcept
+{
+    mFilter.clear();
+    mInputFdl.clear();
+    mInput.clear();
+    mAccum.clear();
+    mFftBuffer.clear();
+    mFft = nullptr;
+    mNumParts = 0;
+    mNumChans = 0;
+    mCurrent = 0;
+}
+
+void PartitionedConvolver::process(const ALfloat *RESTRICT input, ALfloat *const *RESTRICT output)
+{
+    const ALsizei blocksize{mBlockSize};
+    const ALsizei fftsize{blocksize * 2};
+    const ALsizei numbins{blocksize + 1};
+
+    /* Move the previous block to the front and append the new one, then get
+     * the spectrum of the two-block window into the delay line.
+     */
+    std::copy(mInput.begin()+blocksize, mInput.end(), mInput.begin());
+    std::copy_n(input, blocksize, mInput.begin()+blocksize);
+    std::transform(mInput.begin(), mInput.end(), mFftBuffer.begin(),
+        [](const ALfloat s) noexcept -> complex_f { return complex_f{s, 0.0f}; });
+    mFft->forward(mFftBuffer.data());
+    std::copy_n(mFftBuffer.begin(), numbins, mInputFdl.begin() + mCurrent*numbins);
+
+    /* Multiply-accumulate each filter partition with its input spectrum. */
+    std::fill(mAccum.begin(), mAccum.end(), complex_f{});
+    ALsizei inpart{mCurrent};
+    for(ALsizei p{0};p < mNumParts;p++)
+    {
+        const complex_f *RESTRICT in{mInputFdl.data() + inpart*numbins};
+        const complex_f *RESTRICT filter{mFilter.data() + p*mNumChans*numbins};
+        for(ALsizei c{0};c < mNumChans;c++)
+        {
+            complex_f *RESTRICT accum{mAccum.data() + c*numbins};
+            for(ALsizei i{0};i < numbins;i++)
+                accum[i] += in[i] * filter[c*numbins + i];
+        }
+        inpart = (inpart ? inpart : mNumParts) - 1;
+    }
+    mCurrent = (mCurrent+1 < mNumParts) ? mCurrent+1 : 0;
+
+    /* The outputs are real, so two channels can share one inverse FFT with
+     * one in the real part and the other in the imaginary part.
+     */
+    for(ALsizei c{0};c < mNumChans;c += 2)
+    {
+        const complex_f *a{mAccum.data() + c*numbins};
+        const complex_f *b{(c+1 < mNumChans) ? a + numbins : nullptr};
+        if(b)
+        {
+            for(ALsizei i{0};i < numbins;i++)
+                mFftBuffer[i] = a[i] + complex_f{-b[i].imag(), b[i].real()};
+            for(ALsizei i{1};i < blocksize;i++)
+            {
+                const complex_f ca{std::conj(a[i])}, cb{std::conj(b[i])};
+                mFftBuffer[fftsize-i] = ca + complex_f{-cb.imag(), cb.real()};
+            }
+        }
+        else
+        {
+            std::copy_n(a, numbins, mFftBuffer.begin());
+            for(ALsizei i{1};i < blocksize;i++)
+                mFftBuffer[fftsize-i] = std::conj(a[i]);
+        }
+        mFft->inverse(mFftBuffer.data());
+
+        /* Only the last block of the window is valid output. */
+        std::transform(mFftBuffer.begin()+blocksize, mFftBuffer.end(), output[c],
+            [](const complex_f &v) noexcept -> ALfloat { return v.real(); });
+        if(b)
+            std::transform(mFftBuffer.begin()+blocksize, mFftBuffer.end(), output[c+1],
+                [](const complex_f &v) noexcept -> ALfloat { return v.imag(); });
+    }
+}
+
+
+struct ConvolutionState final : public EffectState {
+    /* The impulse response as loaded from the buffer, deinterleaved. */
+    al::vector<ALfloat,16> mSourceIr;
+    ALsizei mSourceLength{0};
+    ALuint mSourceRate{0};
+    FmtChannels mSourceChannels{FmtMono};
+    ALsizei mNumChannels{0};
+
+    PartitionedConvolver mHead;
+    PartitionedConvolver mTail;
+
+    /* Head input block being filled, and the last head output. */
+    alignas(16) ALfloat mInput[HeadBlockSize]{};
+    alignas(16) ALfloat mOutput[MaxIrChannels][HeadBlockSize]{};
+    ALsizei mFillPos{0};
+    ALuint mBlockCount{0u};
+
+    /* Output collected for the current update, aligned for mixing. */
+    alignas(16) ALfloat mTempOut[MaxIrChannels][BUFFERSIZE]{};
+
+    /* Tail input being collected, the input for the current tail job, and the
+     * double-buffered tail job output.
+     */
+    al::vector<ALfloat,16> mTailInput;
+    al::vector<ALfloat,16> mTailJobInput;
+    al::vector<ALfloat,16> mTailOutput;
+    ALuint mTailJobIndex{0u};
+
+    enum JobState { JobDone, JobPending, JobBusy };
+    std::atomic<int> mJobState{JobDone};
+    std::atomic<bool> mKillNow{false};
+    al::semaphore mJobSem;
+    std::thread mWorker;
+
+    struct {
+        ALfloat Current[MAX_OUTPUT_CHANNELS]{};
+        ALfloat Target[MAX_OUTPUT_CHANNELS]{};
+    } mGains[MaxIrChannels];
+
+
+    ~ConvolutionState() override;
+
+    void stopWorker();
+    void runTailJob();
+    void finishTailJob();
+    int workerProc();
+
+    void processBlock();
+
+    ALboolean deviceUpdate(const ALCdevice *device) override;
+    void setBuffer(const ALCdevice *device, const ALbuffer *buffer) override;
+    void update(const ALCcontext *context, const ALeffectslot *slot, const EffectProps *props, const EffectTarget target) override;
+    void process(ALsizei samplesToDo, const ALfloat (*RESTRICT samplesIn)[BUFFERSIZE], const ALsizei numInput, ALfloat (*RESTRICT samplesOut)[BUFFERSIZE], const ALsizei numOutput) override;
+
+    DEF_NEWDEL(ConvolutionState)
+};
+
+ConvolutionState::~ConvolutionState()
+{
+    stopWorker();
+}
+
+void ConvolutionState::stopWorker()
+{
+    if(!mWorker.joinable())
+        return;
+    mKillNow.store(true, std::memory_order_release);
+    mJobSem.post();
+    mWorker.join();
+    mKillNow.store(false, std::memory_order_relaxed);
+    mJobState.store(JobDone, std::memory_order_relaxed);
+}
+
+void ConvolutionState::runTailJob()
+{
+    ALfloat *outputs[MaxIrChannels];
+    ALfloat *dst{mTailOutput.data() + (mTailJobIndex&1)*mNumChannels*TailBlockSize};
+    for(ALsizei c{0};c < mNumChannels;c++)
+        outputs[c] = dst + c*TailBlockSize;
+    mTail.process(mTailJobInput.data(), outputs);
+}
+
+/* Makes sure the last posted tail job is complete. If the worker hasn't
+ * started it yet, the mixer takes it over instead of waiting.
+ */
+void ConvolutionState::finishTailJob()
+{
+    int state{JobPending};
+    if(mJobState.compare_exchange_strong(state, JobBusy, std::memory_order_acq_rel))
+    {
+        runTailJob();
+        mJobState.store(JobDone, std::memory_order_release);
+        return;
+    }
+    while(mJobState.load(std::memory_order_acquire) != JobDone)
+        std::this_thread::yield();
+}
+
+int ConvolutionState::workerProc()
+{
+    althrd_setname("alsoft-convolve");
+
+    while(true)
+    {
+        mJobSem.wait();
+        if(mKillNow.load(std::memory_order_acquire))
+            break;
+
+        int state{JobPending};
+        if(mJobState.compare_exchange_strong(state, JobBusy, std::memory_order_acq_rel))
+        {
+            runTailJob();
+            mJobState.store(JobDone, std::memory_order_release);
+        }
+    }
+    return 0;
+}
+
+ALboolean ConvolutionState::deviceUpdate(const ALCdevice *device)
+{
+    stopWorker();
+
+    mFillPos = 0;
+    mBlockCount = 0u;
+    std::fill(std::begin(mInput), std::end(mInput), 0.0f);
+    for(auto &chan : mOutput)
+        std::fill(std::begin(chan), std::end(chan), 0.0f);
+    for(auto &gains : mGains)
+    {
+        std::fill(std::begin(gains.Current), std::end(gains.Current), 0.0f);
+        std::fill(std::begin(gains.Target), std::end(gains.Target), 0.0f);
+    }
+
+    mHead.reset();
+    mTail.reset();
+    mTailInput.clear();
+    mTailJobInput.clear();
+    mTailOutput.clear();
+    if(mNumChannels < 1 || mSourceLength < 1)
+        return AL_TRUE;
+
+    /* Resample the impulse response to the device rate, if needed. */
+    al::vector<ALfloat,16> resampled;
+    const ALfloat *irdata{mSourceIr.data()};
+    ALsizei irlength{mSourceLength};
+    if(mSourceRate != device->Frequency)
+    {
+        const auto srcrate = static_cast<uint64_t>(mSourceRate);
+        irlength = static_cast<ALsizei>((mSourceLength*uint64_t{device->Frequency} + srcrate-1) /
+            srcrate);
+        resampled.resize(static_cast<size_t>(irlength * mNumChannels), 0.0f);
+
+        al::vector<ALfloat> padded(static_cast<size_t>(mSourceLength + MAX_RESAMPLE_PADDING*2),
+            0.0f);
+        for(ALsizei c{0};c < mNumChannels;c++)
+        {
+            SampleConverterPtr converter{CreateSampleConverter(DevFmtFloat, DevFmtFloat, 1,
+                static_cast<ALsizei>(mSourceRate), static_cast<ALsizei>(device->Frequency),
+                BSinc24Resampler)};
+            if(!converter) return AL_FALSE;
+
+            /* The converter centers its filter on the input, so pad both ends
+             * to keep the output aligned with the start of the response.
+             */
+            auto padend = std::copy_n(mSourceIr.begin() + c*mSourceLength, mSourceLength,
+                padded.begin()+MAX_RESAMPLE_PADDING);
+            std::fill(padend, padded.end(), 0.0f);
+
+            const ALvoid *src{padded.data()};
+            auto srcframes = static_cast<ALsizei>(padded.size());
+            ALfloat *dst{resampled.data() + c*irlength};
+            ALsizei dstframes{irlength};
+            while(dstframes > 0 && srcframes > 0)
+            {
+                const ALsizei done{converter->convert(&src, &srcframes, dst, dstframes)};
+                if(done < 1) break;
+                dst += done;
+                dstframes -= done;
+            }
+        }
+        irdata = resampled.data();
+    }
+
+    const ALfloat *irchans[MaxIrChannels];
+    for(ALsizei c{0};c < mNumChannels;c++)
+        irchans[c] = irdata + c*irlength;
+
+    mHead.init(irchans, mNumChannels, 0, mini(irlength, HeadLength), HeadBlockSize);
+    if(irlength > HeadLength)
+    {
+        mTail.init(irchans, mNumChannels, HeadLength, irlength-HeadLength, TailBlockSize);
+
+        mTailInput.resize(TailBlockSize, 0.0f);
+        mTailJobInput.resize(TailBlockSize, 0.0f);
+        mTailOutput.resize(static_cast<size_t>(2 * mNumChannels * TailBlockSize), 0.0f);
+        mTailJobIndex = 0u;
+        try {
+            mWorker = std::thread{std::mem_fn(&ConvolutionState::workerProc), this};
+        }
+        catch(std::exception& e) {
+            ERR("Failed to start convolution worker: %s\n", e.what());
+            return AL_FALSE;
+        }
+    }
+    TRACE("Convolving with %d sample impulse response, %d channel%s\n", irlength,
+        mNumChannels, (mNumChannels==1) ? "" : "s");
+
+    return AL_TRUE;
+}
+
+void ConvolutionState::setBuffer(const ALCdevice *device, const ALbuffer *buffer)
+{
+    mSourceIr.clear();
+    mSourceLength = 0;
+    mNumChannels = 0;
+    if(buffer && buffer->SampleLen > 0)
+    {
+        switch(buffer->mFmtChannels)
+        {
+        case FmtMono:
+        case FmtStereo:
+        case FmtBFormat2D:
+        case FmtBFormat3D:
+            break;
+        default:
+            ERR("Unsupported impulse response channel configuration\n");
+            buffer = nullptr;
+        }
+    }
+    if(buffer && buffer->SampleLen > 0)
+    {
+        const ALsizei numchans{ChannelsFromFmt(buffer->mFmtChannels)};
+        const ALsizei length{buffer->SampleLen};
+
+        /* Deinterleave the samples, and convert B-Format from FuMa to ACN/N3D
+         * ordering and scaling as it's loaded. 2D B-Format (WXY) is stored as
+         * ACN 0, 1, and 3.
+         */
+        mSourceIr.resize(static_cast<size_t>(numchans * length), 0.0f);
+        const bool isbformat{buffer->mFmtChannels == FmtBFormat2D ||
+            buffer->mFmtChannels == FmtBFormat3D};
+        const ALsizei samplesize{BytesFromFmt(buffer->mFmtType)};
+        for(ALsizei c{0};c < numchans;c++)
+        {
+            const ALsizei acn{isbformat ? AmbiIndex::FromFuMa[c] : c};
+            const ALsizei dstchan{mini(acn, numchans-1)};
+            ALfloat *dst{mSourceIr.data() + dstchan*length};
+            LoadSamples(dst, buffer->mData.data() + c*samplesize, numchans, buffer->mFmtType,
+                length);
+            if(isbformat)
+            {
+                const ALfloat scale{AmbiScale::FromFuMa[acn]};
+                std::transform(dst, dst+length, dst,
+                    [scale](const ALfloat s) noexcept -> ALfloat { return s * scale; });
+            }
+        }
+
+        mSourceLength = length;
+        mSourceRate = static_cast<ALuint>(buffer->Frequency);
+        mSourceChannels = buffer->mFmtChannels;
+        mNumChannels = numchans;
+    }
+
+    deviceUpdate(device);
+}
+
+void ConvolutionState::update(const ALCcontext* UNUSED(context), const ALeffectslot *slot, const EffectProps* UNUSED(props), const EffectTarget target)
+{
+    mOutBuffer = target.Main->Buffer;
+    mOutChannels = target.Main->NumChannels;
+
+    for(ALsizei c{0};c < mNumChannels;c++)
+    {
+        ALfloat coeffs[MAX_AMBI_CHANNELS]{};
+        if(mSourceChannels == FmtStereo)
+            CalcAngleCoeffs(al::MathDefs<float>::Pi()*((c==0) ? -0.5f : 0.5f), 0.0f, 0.0f,
+                coeffs);
+        else
+        {
+            /* Mono is omnidirectional, and B-Format channels are already in
+             * ACN order, so pass them straight through.
+             */
+            const ALsizei acn{(mSourceChannels == FmtBFormat2D && c == 2) ? 3 : c};
+            coeffs[acn] = 1.0f;
+        }
+        ComputePanGains(target.Main, coeffs, slot->Params.Gain, mGains[c].Target);
+    }
+}
+
+void ConvolutionState::processBlock()
+{
+    ALfloat *outputs[MaxIrChannels];
+    for(ALsizei c{0};c < mNumChannels;c++)
+        outputs[c] = mOutput[c];
+    mHead.process(mInput, outputs);
+
+    if(mTail.empty())
+        return;
+
+    /* Add the tail's contribution for this block, which comes from the job
+     * posted two tail blocks ago.
+     */
+    const ALuint tailblock{mBlockCount / TailBlockRatio};
+    const ALuint tailpos{mBlockCount % TailBlockRatio};
+    if(tailblock >= 2)
+    {
+        const ALfloat *src{mTailOutput.data() + ((tailblock-2)&1)*mNumChannels*TailBlockSize +
+            tailpos*HeadBlockSize};
+        for(ALsizei c{0};c < mNumChannels;c++)
+        {
+            const ALfloat *tail{src + c*TailBlockSize};
+            std::transform(std::begin(mOutput[c]), std::end(mOutput[c]), tail,
+                std::begin(mOutput[c]), std::plus<ALfloat>{});
+        }
+    }
+
+    /* Collect the input for the tail, and hand each full block to the worker
+     * once the previous job is done.
+     */
+    std::copy(std::begin(mInput), std::end(mInput), mTailInput.begin() + tailpos*HeadBlockSize);
+    if(tailpos == TailBlockRatio-1)
+    {
+        finishTailJob();
+        std::swap(mTailInput, mTailJobInput);
+        mTailJobIndex = tailblock;
+        mJobState.store(JobPending, std::memory_order_release);
+        mJobSem.post();
+    }
+}
+
+void ConvolutionState::process(ALsizei samplesToDo, const ALfloat (*RESTRICT samplesIn)[BUFFERSIZE], const ALsizei /*numInput*/, ALfloat (*RESTRICT samplesOut)[BUFFERSIZE], const ALsizei numOutput)
+{
+    if(mNumChannels < 1)
+        return;
+
+    for(ALsizei base{0};base < samplesToDo;)
+    {
+        const ALsizei todo{mini(HeadBlockSize-mFillPos, samplesToDo-base)};
+
+        std::copy_n(samplesIn[0]+base, todo, mInput+mFillPos);
+        for(ALsizei c{0};c < mNumChannels;c++)
+            std::copy_n(mOutput[c]+mFillPos, todo, mTempOut[c]+base);
+
+        mFillPos += todo;
+        base += todo;
+        if(mFillPos == HeadBlockSize)
+        {
+            processBlock();
+            mFillPos = 0;
+            ++mBlockCount;
+        }
+    }
+
+    /* The head blocks don't line up with updates, so the output is mixed in
+     * one go to keep the mixer's input and output aligned.
+     */
+    for(ALsizei c{0};c < mNumChannels;c++)
+        MixSamples(mTempOut[c], numOutput, samplesOut, mGains[c].Current, mGains[c].Target,
+            samplesToDo, 0, samplesToDo);
+}
+
+
+void Convolution_setParami(EffectProps*, ALCcontext *context, ALenum param, ALint)
+{ alSetError(context, AL_INVALID_ENUM, "Invalid convolution reverb integer property 0x%04x", param); }
+void Convolution_setParamiv(EffectProps*, ALCcontext *context, ALenum param, const ALint*)
+{ alSetError(context, AL_INVALID_ENUM, "Invalid convolution reverb integer-vector property 0x%04x", param); }
+void Convolution_setParamf(EffectProps*, ALCcontext *context, ALenum param, ALfloat)
+{ alSetError(context, AL_INVALID_ENUM, "Invalid convolution reverb float property 0x%04x", param); }
+void Convolution_setParamfv(EffectProps*, ALCcontext *context, ALenum param, const ALfloat*)
+{ alSetError(context, AL_INVALID_ENUM, "Invalid convolution reverb float-vector property 0x%04x", param); }
+
+void Convolution_getParami(const EffectProps*, ALCcontext *context, ALenum param, ALint*)
+{ alSetError(context, AL_INVALID_ENUM, "Invalid convolution reverb integer property 0x%04x", param); }
+void Convolution_getParamiv(const EffectProps*, ALCcontext *context, ALenum param, ALint*)
+{ alSetError(context, AL_INVALID_ENUM, "Invalid convolution reverb integer-vector property 0x%04x", param); }
+void Convolution_getParamf(const EffectProps*, ALCcontext *context, ALenum param, ALfloat*)
+{ alSetError(context, AL_INVALID_ENUM, "Invalid convolution reverb float property 0x%04x", param); }
+void Convolution_getParamfv(const EffectProps*, ALCcontext *context, ALenum param, ALfloat*)
+{ alSetError(context, AL_INVALID_ENUM, "Invalid convolution reverb float-vector property 0x%04x", param); }
+
+DEFINE_ALEFFECT_VTABLE(Convolution);
+
+
+struct ConvolutionStateFactory final : public EffectStateFactory {
+    EffectState *create() override { return new ConvolutionState{}; }
+    EffectProps getDefaultProps() const noexcept override { return EffectProps{}; }
+    const EffectVtable *getEffectVtable() const noexcept override { return &Convolution_vtable; }
+};
+
+} // namespace
+
+EffectStateFactory *ConvolutionStateFactory_getFactory()
+{
+    static ConvolutionStateFactory ConvolutionFactory{};
+    return &ConvolutionFactory;
+}
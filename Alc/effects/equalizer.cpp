@@ -24,7 +24,6 @@
 #include <cstdlib>
 
 #include <algorithm>
-#include <functional>
 
 #include "alMain.h"
 #include "alcontext.h"
@@ -80,16 +79,18 @@ namespace {
 
 
 struct EqualizerState final : public EffectState {
-    struct {
-        /* Effect parameters */
-        BiquadFilter filter[4];
+    /* Effect parameters. The four filters are applied to groups of four input
+     * channels at a time, with a channel in each lane.
+     */
+    BiquadBank<4> mFilter[MAX_AMBI_CHANNELS/4][4];
 
+    struct {
         /* Effect gains for each channel */
         ALfloat CurrentGains[MAX_OUTPUT_CHANNELS]{};
         ALfloat TargetGains[MAX_OUTPUT_CHANNELS]{};
     } mChans[MAX_AMBI_CHANNELS];
 
-    ALfloat mSampleBuffer[BUFFERSIZE]{};
+    alignas(16) ALfloat mSampleBuffer[4][BUFFERSIZE]{};
 
 
     ALboolean deviceUpdate(const ALCdevice *device) override;
@@ -101,12 +102,10 @@ struct EqualizerState final : public EffectState {
 
 ALboolean EqualizerState::deviceUpdate(const ALCdevice *UNUSED(device))
 {
+    for(auto &group : mFilter)
+        std::for_each(std::begin(group), std::end(group), [](BiquadBank<4> &bank) { bank.clear(); });
     for(auto &e : mChans)
-    {
-        std::for_each(std::begin(e.filter), std::end(e.filter),
-                      std::mem_fn(&BiquadFilter::clear));
         std::fill(std::begin(e.CurrentGains), std::end(e.CurrentGains), 0.0f);
-    }
     return AL_TRUE;
 }
 
@@ -114,6 +113,7 @@ void EqualizerState::update(const ALCcontext *context, const ALeffectslot *slot,
 {
     const ALCdevice *device = context->Device;
     auto frequency = static_cast<ALfloat>(device->Frequency);
+    BiquadFilter filter[4];
     ALfloat gain, f0norm;
 
     /* Calculate coefficients for the each type of filter. Note that the shelf
@@ -122,31 +122,31 @@ void EqualizerState::update(const ALCcontext *context, const ALeffectslot *slot,
      */
     gain = maxf(sqrtf(props->Equalizer.LowGain), 0.0625f); /* Limit -24dB */
     f0norm = props->Equalizer.LowCutoff/frequency;
-    mChans[0].filter[0].setParams(BiquadType::LowShelf, gain, f0norm,
+    filter[0].setParams(BiquadType::LowShelf, gain, f0norm,
         calc_rcpQ_from_slope(gain, 0.75f));
 
     gain = maxf(props->Equalizer.Mid1Gain, 0.0625f);
     f0norm = props->Equalizer.Mid1Center/frequency;
-    mChans[0].filter[1].setParams(BiquadType::Peaking, gain, f0norm,
+    filter[1].setParams(BiquadType::Peaking, gain, f0norm,
         calc_rcpQ_from_bandwidth(f0norm, props->Equalizer.Mid1Width));
 
     gain = maxf(props->Equalizer.Mid2Gain, 0.0625f);
     f0norm = props->Equalizer.Mid2Center/frequency;
-    mChans[0].filter[2].setParams(BiquadType::Peaking, gain, f0norm,
+    filter[2].setParams(BiquadType::Peaking, gain, f0norm,
         calc_rcpQ_from_bandwidth(f0norm, props->Equalizer.Mid2Width));
 
     gain = maxf(sqrtf(props->Equalizer.HighGain), 0.0625f);
     f0norm = props->Equalizer.HighCutoff/frequency;
-    mChans[0].filter[3].setParams(BiquadType::HighShelf, gain, f0norm,
+    filter[3].setParams(BiquadType::HighShelf, gain, f0norm,
         calc_rcpQ_from_slope(gain, 0.75f));
 
-    /* Copy the filter coefficients for the other input channels. */
-    for(ALsizei i{1};i < slot->Wet.NumChannels;++i)
+    /* Copy the filter coefficients to each input channel's lane. */
+    for(ALsizei i{0};i < slot->Wet.NumChannels;++i)
     {
-        mChans[i].filter[0].copyParamsFrom(mChans[0].filter[0]);
-        mChans[i].filter[1].copyParamsFrom(mChans[0].filter[1]);
-        mChans[i].filter[2].copyParamsFrom(mChans[0].filter[2]);
-        mChans[i].filter[3].copyParamsFrom(mChans[0].filter[3]);
+        mFilter[i/4][0].copyParamsFrom(static_cast<size_t>(i%4), filter[0]);
+        mFilter[i/4][1].copyParamsFrom(static_cast<size_t>(i%4), filter[1]);
+        mFilter[i/4][2].copyParamsFrom(static_cast<size_t>(i%4), filter[2]);
+        mFilter[i/4][3].copyParamsFrom(static_cast<size_t>(i%4), filter[3]);
     }
 
     mOutBuffer = target.Main->Buffer;
@@ -161,15 +161,23 @@ void EqualizerState::update(const ALCcontext *context, const ALeffectslot *slot,
 void EqualizerState::process(ALsizei samplesToDo, const ALfloat (*RESTRICT samplesIn)[BUFFERSIZE], const ALsizei numInput, ALfloat (*RESTRICT samplesOut)[BUFFERSIZE], const ALsizei numOutput)
 {
     ASSUME(numInput > 0);
-    for(ALsizei c{0};c < numInput;c++)
+    for(ALsizei base{0};base < numInput;base += 4)
     {
-        mChans[c].filter[0].process(mSampleBuffer, samplesIn[c], samplesToDo);
-        mChans[c].filter[1].process(mSampleBuffer, mSampleBuffer, samplesToDo);
-        mChans[c].filter[2].process(mSampleBuffer, mSampleBuffer, samplesToDo);
-        mChans[c].filter[3].process(mSampleBuffer, mSampleBuffer, samplesToDo);
-
-        MixSamples(mSampleBuffer, numOutput, samplesOut, mChans[c].CurrentGains,
-            mChans[c].TargetGains, samplesToDo, 0, samplesToDo);
+        const ALsizei todo{mini(4, numInput-base)};
+        const ALfloat *src[4]{};
+        ALfloat *dst[4]{};
+        for(ALsizei i{0};i < todo;i++)
+        {
+            src[i] = samplesIn[base+i];
+            dst[i] = mSampleBuffer[i];
+        }
+
+        BiquadBank<4>::processCascade(mFilter[base/4], 4, dst, src, static_cast<size_t>(todo),
+            samplesToDo);
+
+        for(ALsizei i{0};i < todo;i++)
+            MixSamples(mSampleBuffer[i], numOutput, samplesOut, mChans[base+i].CurrentGains,
+                mChans[base+i].TargetGains, samplesToDo, 0, samplesToDo);
     }
 }
 
@@ -20,10 +20,13 @@
 
 #include "config.h"
 
+#ifdef HAVE_SSE_INTRINSICS
+#include <xmmintrin.h>
+#endif
+
 #include <cmath>
 #include <cstdlib>
 #include <array>
-#include <complex>
 #include <algorithm>
 
 #include "alMain.h"
@@ -31,48 +34,133 @@
 #include "alAuxEffectSlot.h"
 #include "alError.h"
 #include "alu.h"
+#include "vector.h"
+
 
-#include "alcomplex.h"
+/* This is a user config option for the length of the Hilbert transformer,
+ * trading latency for accuracy at low frequencies. A length of 0 uses a pair
+ * of allpass filters instead, which has no latency but only approximates the
+ * phase difference.
+ */
+ALsizei FshifterHilbertLength = 1023;
 
 namespace {
 
-using complex_d = std::complex<double>;
+/* Sine of the phase for each step of a cycle. */
+std::array<ALfloat,FRACTIONONE> InitSinTable()
+{
+    std::array<ALfloat,FRACTIONONE> ret;
+    for(ALsizei i{0};i < FRACTIONONE;i++)
+        ret[i] = static_cast<ALfloat>(std::sin(al::MathDefs<double>::Tau() * i / double{FRACTIONONE}));
+    return ret;
+}
+const std::array<ALfloat,FRACTIONONE> SinTable = InitSinTable();
+
+
+/* Coefficients for a pair of allpass filter chains, whose outputs are about
+ * 90 degrees apart over most of the audible range (when the first is
+ * delayed by a sample). Each section is y[n] = c*(x[n] + y[n-2]) - x[n-2],
+ * with c being the square of these. Designed by Olli Niemitalo.
+ */
+constexpr ALfloat AllpassCoeffs[2][4]{
+    { 0.6923878f, 0.9360654322959f, 0.9882295226860f, 0.9987488452737f },
+    { 0.4021921162426f, 0.8561710882420f, 0.9722909545651f, 0.9952884791278f }
+};
+
+struct AllpassChain {
+    ALfloat Coeff[4];
+    ALfloat x[4][2];
+    ALfloat y[4][2];
+
+    void init(const ALfloat (&coeffs)[4])
+    {
+        for(ALsizei i{0};i < 4;i++)
+        {
+            Coeff[i] = coeffs[i] * coeffs[i];
+            x[i][0] = x[i][1] = 0.0f;
+            y[i][0] = y[i][1] = 0.0f;
+        }
+    }
 
-#define HIL_SIZE 1024
-#define OVERSAMP (1<<2)
+    void process(ALfloat *RESTRICT dst, const ALfloat *RESTRICT src, const ALsizei count)
+    {
+        std::copy_n(src, count, dst);
+        for(ALsizei i{0};i < 4;i++)
+        {
+            const ALfloat c{Coeff[i]};
+            ALfloat x1{x[i][0]}, x2{x[i][1]};
+            ALfloat y1{y[i][0]}, y2{y[i][1]};
+            for(ALsizei n{0};n < count;n++)
+            {
+                const ALfloat in{dst[n]};
+                const ALfloat out{c*(in + y2) - x2};
+                x2 = x1; x1 = in;
+                y2 = y1; y1 = out;
+                dst[n] = out;
+            }
+            x[i][0] = x1; x[i][1] = x2;
+            y[i][0] = y1; y[i][1] = y2;
+        }
+    }
+};
 
-#define HIL_STEP     (HIL_SIZE / OVERSAMP)
-#define FIFO_LATENCY (HIL_STEP * (OVERSAMP-1))
 
-/* Define a Hann window, used to filter the HIL input and output. */
-/* Making this constexpr seems to require C++14. */
-std::array<ALdouble,HIL_SIZE> InitHannWindow()
+/* Applies the odd taps of an antisymmetric (type III) FIR filter, centered on
+ * src. Only the taps at odd offsets are non-zero, so each output is the sum of
+ * coeffs[j]*(src[-(2j+1)] - src[2j+1]).
+ */
+void ApplyHilbert(ALfloat *RESTRICT dst, const ALfloat *RESTRICT src,
+    const ALfloat *RESTRICT coeffs, const ALsizei numcoeffs, const ALsizei count)
 {
-    std::array<ALdouble,HIL_SIZE> ret;
-    /* Create lookup table of the Hann window for the desired size, i.e. HIL_SIZE */
-    for(ALsizei i{0};i < HIL_SIZE>>1;i++)
+    ALsizei n{0};
+#ifdef HAVE_SSE_INTRINSICS
+    for(;n+4 <= count;n += 4)
     {
-        ALdouble val = std::sin(al::MathDefs<double>::Pi() * i / ALdouble{HIL_SIZE-1});
-        ret[i] = ret[HIL_SIZE-1-i] = val * val;
+        __m128 acc{_mm_setzero_ps()};
+        for(ALsizei j{0};j < numcoeffs;j++)
+        {
+            const ALsizei offset{j*2 + 1};
+            const __m128 diff{_mm_sub_ps(_mm_loadu_ps(src+n-offset),
+                _mm_loadu_ps(src+n+offset))};
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(coeffs[j]), diff));
+        }
+        _mm_storeu_ps(dst+n, acc);
+    }
+#endif
+    for(;n < count;n++)
+    {
+        ALfloat acc{0.0f};
+        for(ALsizei j{0};j < numcoeffs;j++)
+        {
+            const ALsizei offset{j*2 + 1};
+            acc += coeffs[j] * (src[n-offset] - src[n+offset]);
+        }
+        dst[n] = acc;
     }
-    return ret;
 }
-alignas(16) const std::array<ALdouble,HIL_SIZE> HannWindow = InitHannWindow();
 
 
 struct FshifterState final : public EffectState {
     /* Effect parameters */
-    ALsizei  mCount{};
-    ALsizei  mPhaseStep{};
-    ALsizei  mPhase{};
-    ALdouble mLdSign{};
-
-    /*Effects buffers*/ 
-    ALfloat   mInFIFO[HIL_SIZE]{};
-    complex_d mOutFIFO[HIL_SIZE]{};
-    complex_d mOutputAccum[HIL_SIZE]{};
-    complex_d mAnalytic[HIL_SIZE]{};
-    complex_d mOutdata[BUFFERSIZE]{};
+    ALsizei mPhaseStep{};
+    ALsizei mPhase{};
+    ALfloat mLdSign{};
+
+    /* The Hilbert transformer's length, and half its odd taps. */
+    ALsizei mHilbertLength{-1};
+    al::vector<ALfloat,16> mHilbertCoeffs;
+
+    /* Input history for the Hilbert transformer, with the current block
+     * following the previous mHilbertLength-1 samples.
+     */
+    al::vector<ALfloat,16> mHistory;
+
+    AllpassChain mAllpass[2];
+    ALfloat mAllpassDelay{};
+
+    /* Analytic signal of the current block. */
+    alignas(16) ALfloat mReal[BUFFERSIZE]{};
+    alignas(16) ALfloat mImag[BUFFERSIZE]{};
 
     alignas(16) ALfloat mBufferOut[BUFFERSIZE]{};
 
@@ -90,16 +178,34 @@ struct FshifterState final : public EffectState {
 
 ALboolean FshifterState::deviceUpdate(const ALCdevice *UNUSED(device))
 {
+    const ALsizei length{FshifterHilbertLength};
+    if(mHilbertLength != length)
+    {
+        /* Blackman-windowed ideal Hilbert transformer, which is 2/(pi*m) for
+         * odd offsets m from the center. The filter is antisymmetric, so only
+         * the taps for positive odd offsets are stored.
+         */
+        const ALsizei center{length/2};
+        mHilbertCoeffs.resize((center+1) / 2);
+        for(ALsizei j{0};j < (center+1)/2;j++)
+        {
+            const double m{static_cast<double>(j*2 + 1)};
+            const double x{al::MathDefs<double>::Tau() * (center+m) / (length-1)};
+            const double window{0.42 - 0.5*std::cos(x) + 0.08*std::cos(2.0*x)};
+            mHilbertCoeffs[j] = static_cast<ALfloat>(2.0 / (al::MathDefs<double>::Pi()*m) * window);
+        }
+        mHilbertLength = length;
+    }
+
     /* (Re-)initializing parameters and clear the buffers. */
-    mCount     = FIFO_LATENCY;
     mPhaseStep = 0;
     mPhase     = 0;
-    mLdSign    = 1.0;
+    mLdSign    = 1.0f;
 
-    std::fill(std::begin(mInFIFO),      std::end(mInFIFO),      0.0f);
-    std::fill(std::begin(mOutFIFO),     std::end(mOutFIFO),     complex_d{});
-    std::fill(std::begin(mOutputAccum), std::end(mOutputAccum), complex_d{});
-    std::fill(std::begin(mAnalytic),    std::end(mAnalytic),    complex_d{});
+    mHistory.assign(maxi(length-1, 0) + BUFFERSIZE, 0.0f);
+    mAllpass[0].init(AllpassCoeffs[0]);
+    mAllpass[1].init(AllpassCoeffs[1]);
+    mAllpassDelay = 0.0f;
 
     std::fill(std::begin(mCurrentGains), std::end(mCurrentGains), 0.0f);
     std::fill(std::begin(mTargetGains),  std::end(mTargetGains),  0.0f);
@@ -117,11 +223,11 @@ void FshifterState::update(const ALCcontext *context, const ALeffectslot *slot,
     switch(props->Fshifter.LeftDirection)
     {
         case AL_FREQUENCY_SHIFTER_DIRECTION_DOWN:
-            mLdSign = -1.0;
+            mLdSign = -1.0f;
             break;
 
         case AL_FREQUENCY_SHIFTER_DIRECTION_UP:
-            mLdSign = 1.0;
+            mLdSign = 1.0f;
             break;
 
         case AL_FREQUENCY_SHIFTER_DIRECTION_OFF:
@@ -140,58 +246,39 @@ void FshifterState::update(const ALCcontext *context, const ALeffectslot *slot,
 
 void FshifterState::process(ALsizei samplesToDo, const ALfloat (*RESTRICT samplesIn)[BUFFERSIZE], const ALsizei /*numInput*/, ALfloat (*RESTRICT samplesOut)[BUFFERSIZE], const ALsizei numOutput)
 {
-    static constexpr complex_d complex_zero{0.0, 0.0};
-    ALfloat *RESTRICT BufferOut = mBufferOut;
-    ALsizei j, k, base;
+    ALfloat *RESTRICT BufferOut{mBufferOut};
 
-    for(base = 0;base < samplesToDo;)
+    /* Get the analytic signal of the input. */
+    if(mHilbertLength > 0)
     {
-        const ALsizei todo{mini(HIL_SIZE-mCount, samplesToDo-base)};
-
-        ASSUME(todo > 0);
-
-        /* Fill FIFO buffer with samples data */
-        k = mCount;
-        for(j = 0;j < todo;j++,k++)
-        {
-            mInFIFO[k] = samplesIn[0][base+j];
-            mOutdata[base+j]  = mOutFIFO[k-FIFO_LATENCY];
-        }
-        mCount += todo;
-        base += todo;
-
-        /* Check whether FIFO buffer is filled */
-        if(mCount < HIL_SIZE) continue;
-        mCount = FIFO_LATENCY;
-
-        /* Real signal windowing and store in Analytic buffer */
-        for(k = 0;k < HIL_SIZE;k++)
-        {
-            mAnalytic[k].real(mInFIFO[k] * HannWindow[k]);
-            mAnalytic[k].imag(0.0);
-        }
-
-        /* Processing signal by Discrete Hilbert Transform (analytical signal). */
-        complex_hilbert(mAnalytic, HIL_SIZE);
-
-        /* Windowing and add to output accumulator */
-        for(k = 0;k < HIL_SIZE;k++)
-            mOutputAccum[k] += 2.0/OVERSAMP*HannWindow[k]*mAnalytic[k];
-
-        /* Shift accumulator, input & output FIFO */
-        for(k = 0;k < HIL_STEP;k++) mOutFIFO[k] = mOutputAccum[k];
-        for(j = 0;k < HIL_SIZE;k++,j++) mOutputAccum[j] = mOutputAccum[k];
-        for(;j < HIL_SIZE;j++) mOutputAccum[j] = complex_zero;
-        for(k = 0;k < FIFO_LATENCY;k++)
-            mInFIFO[k] = mInFIFO[k+HIL_STEP];
+        /* The real part is the input delayed to the center of the Hilbert
+         * transformer, which gives the imaginary part.
+         */
+        const ALsizei histlen{mHilbertLength - 1};
+        const ALfloat *center{mHistory.data() + histlen/2};
+        std::copy_n(samplesIn[0], samplesToDo, mHistory.begin()+histlen);
+        std::copy_n(center, samplesToDo, std::begin(mReal));
+        ApplyHilbert(mImag, center, mHilbertCoeffs.data(),
+            static_cast<ALsizei>(mHilbertCoeffs.size()), samplesToDo);
+        std::copy(mHistory.begin()+samplesToDo, mHistory.begin()+samplesToDo+histlen,
+            mHistory.begin());
+    }
+    else
+    {
+        /* The first allpass chain's output is delayed by a sample. */
+        mAllpass[0].process(mBufferOut, samplesIn[0], samplesToDo);
+        mAllpass[1].process(mReal, samplesIn[0], samplesToDo);
+        mImag[0] = mAllpassDelay;
+        std::copy_n(std::begin(mBufferOut), samplesToDo-1, std::begin(mImag)+1);
+        mAllpassDelay = mBufferOut[samplesToDo-1];
     }
 
     /* Process frequency shifter using the analytic signal obtained. */
-    for(k = 0;k < samplesToDo;k++)
+    for(ALsizei k{0};k < samplesToDo;k++)
     {
-        double phase = mPhase * ((1.0/FRACTIONONE) * al::MathDefs<double>::Tau());
-        BufferOut[k] = static_cast<float>(mOutdata[k].real()*std::cos(phase) +
-            mOutdata[k].imag()*std::sin(phase)*mLdSign);
+        const ALfloat s{SinTable[mPhase]};
+        const ALfloat c{SinTable[(mPhase + FRACTIONONE/4) & FRACTIONMASK]};
+        BufferOut[k] = mReal[k]*c - mImag[k]*s*mLdSign;
 
         mPhase += mPhaseStep;
         mPhase &= FRACTIONMASK;
@@ -27,122 +27,223 @@
 #include <cmath>
 #include <cstdlib>
 #include <array>
+#include <memory>
 #include <complex>
 #include <algorithm>
+#include <functional>
 
 #include "alMain.h"
 #include "alcontext.h"
 #include "alAuxEffectSlot.h"
 #include "alError.h"
 #include "alu.h"
+#include "vector.h"
 
 #include "alcomplex.h"
 
 
-namespace {
-
-using complex_d = std::complex<double>;
-
-#define STFT_SIZE      1024
-#define STFT_HALF_SIZE (STFT_SIZE>>1)
-#define OVERSAMP       (1<<2)
-
-#define STFT_STEP    (STFT_SIZE / OVERSAMP)
-#define FIFO_LATENCY (STFT_STEP * (OVERSAMP-1))
-
-inline int double2int(double d)
-{
-#if defined(HAVE_SSE_INTRINSICS)
-    return _mm_cvttsd_si32(_mm_set_sd(d));
+/* This is a user config option for the STFT size, trading latency for
+ * frequency resolution.
+ */
+ALsizei PshifterFftSize = 1024;
 
-#elif ((defined(__GNUC__) || defined(__clang__)) && (defined(__i386__) || defined(__x86_64__)) && \
-       !defined(__SSE2_MATH__)) || (defined(_MSC_VER) && defined(_M_IX86_FP) && _M_IX86_FP < 2)
+namespace {
 
-    int sign, shift;
-    int64_t mant;
-    union {
-        double d;
-        int64_t i64;
-    } conv;
+using complex_f = std::complex<float>;
 
-    conv.d = d;
-    sign = (conv.i64>>63) | 1;
-    shift = ((conv.i64>>52)&0x7ff) - (1023+52);
+#define OVERSAMP (1<<2)
 
-    /* Over/underflow */
-    if(UNLIKELY(shift >= 63 || shift < -52))
-        return 0;
+constexpr ALfloat Pi{al::MathDefs<float>::Pi()};
+constexpr ALfloat Tau{al::MathDefs<float>::Tau()};
+constexpr ALfloat HalfPi{al::MathDefs<float>::Pi() * 0.5f};
 
-    mant = (conv.i64&0xfffffffffffff_i64) | 0x10000000000000_i64;
-    if(LIKELY(shift < 0))
-        return (int)(mant >> -shift) * sign;
-    return (int)(mant << shift) * sign;
+/* The expected phase advance of bin 1 over one step. */
+constexpr ALfloat Expected{Tau / OVERSAMP};
 
-#else
 
-    return static_cast<int>(d);
-#endif
+/* Approximates atan2(y, x), to within about 1e-5 radians. */
+inline ALfloat approx_atan2(ALfloat y, ALfloat x)
+{
+    const ALfloat ax{std::fabs(x)}, ay{std::fabs(y)};
+    const ALfloat mx{maxf(ax, ay)};
+    const ALfloat a{(mx > 0.0f) ? minf(ax, ay)/mx : 0.0f};
+    const ALfloat s{a*a};
+    ALfloat r{((-0.0464964749f*s + 0.15931422f)*s - 0.327622764f)*s*a + a};
+    if(ay > ax) r = HalfPi - r;
+    if(x < 0.0f) r = Pi - r;
+    return std::copysign(r, y);
 }
 
-/* Define a Hann window, used to filter the STFT input and output. */
-/* Making this constexpr seems to require C++14. */
-std::array<ALdouble,STFT_SIZE> InitHannWindow()
+/* Approximates the sine and cosine of a phase within [-pi, pi], to within
+ * about 1e-6.
+ */
+inline void approx_sincos(ALfloat phase, ALfloat &s, ALfloat &c)
 {
-    std::array<ALdouble,STFT_SIZE> ret;
-    /* Create lookup table of the Hann window for the desired size, i.e. HIL_SIZE */
-    for(ALsizei i{0};i < STFT_SIZE>>1;i++)
+    const int q{fastf2i(phase * (1.0f/HalfPi))};
+    const ALfloat r{phase - static_cast<ALfloat>(q)*HalfPi};
+    const ALfloat r2{r*r};
+    const ALfloat sr{r * (1.0f + r2*(-1.0f/6.0f + r2*(1.0f/120.0f + r2*(-1.0f/5040.0f))))};
+    const ALfloat cr{1.0f + r2*(-0.5f + r2*(1.0f/24.0f + r2*(-1.0f/720.0f + r2*(1.0f/40320.0f))))};
+    switch(q&3)
     {
-        ALdouble val = std::sin(al::MathDefs<double>::Pi() * i / ALdouble{STFT_SIZE-1});
-        ret[i] = ret[STFT_SIZE-1-i] = val * val;
+        case 0: s =  sr; c =  cr; break;
+        case 1: s =  cr; c = -sr; break;
+        case 2: s = -sr; c = -cr; break;
+        case 3: s = -cr; c =  sr; break;
     }
-    return ret;
 }
-alignas(16) const std::array<ALdouble,STFT_SIZE> HannWindow = InitHannWindow();
 
+/* Wraps a phase into [-pi, pi]. */
+inline ALfloat wrap_phase(ALfloat phase)
+{ return phase - Tau*static_cast<ALfloat>(fastf2i(phase * (1.0f/Tau))); }
 
-struct ALphasor {
-    ALdouble Amplitude;
-    ALdouble Phase;
-};
 
-struct ALfrequencyDomain {
-    ALdouble Amplitude;
-    ALdouble Frequency;
-};
+/* Converts the given bins to amplitudes and true frequencies (in bins), using
+ * the phase change since the last step.
+ */
+void AnalyzeBins(const complex_f *RESTRICT bins, ALfloat *RESTRICT lastPhase,
+    ALfloat *RESTRICT amps, ALfloat *RESTRICT freqs, const ALsizei count)
+{
+    ALsizei k{0};
+#ifdef HAVE_SSE_INTRINSICS
+    const __m128 signmask{_mm_castsi128_ps(_mm_set1_epi32(0x80000000))};
+    const __m128 kstep{_mm_set1_ps(4.0f)};
+    __m128 kvec{_mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f)};
+    for(;k+4 <= count;k += 4)
+    {
+        const __m128 lo{_mm_loadu_ps(reinterpret_cast<const float*>(bins+k))};
+        const __m128 hi{_mm_loadu_ps(reinterpret_cast<const float*>(bins+k+2))};
+        const __m128 re{_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2,0,2,0))};
+        const __m128 im{_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3,1,3,1))};
+
+        const __m128 amp{_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im)))};
+
+        /* approx_atan2(im, re) */
+        const __m128 ax{_mm_andnot_ps(signmask, re)}, ay{_mm_andnot_ps(signmask, im)};
+        const __m128 mx{_mm_max_ps(ax, ay)};
+        const __m128 a{_mm_and_ps(_mm_div_ps(_mm_min_ps(ax, ay), mx),
+            _mm_cmpgt_ps(mx, _mm_setzero_ps()))};
+        const __m128 s{_mm_mul_ps(a, a)};
+        __m128 r{_mm_add_ps(_mm_mul_ps(_mm_set1_ps(-0.0464964749f), s), _mm_set1_ps(0.15931422f))};
+        r = _mm_sub_ps(_mm_mul_ps(r, s), _mm_set1_ps(0.327622764f));
+        r = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(r, s), a), a);
+        __m128 mask{_mm_cmpgt_ps(ay, ax)};
+        r = _mm_or_ps(_mm_and_ps(mask, _mm_sub_ps(_mm_set1_ps(HalfPi), r)), _mm_andnot_ps(mask, r));
+        mask = _mm_cmplt_ps(re, _mm_setzero_ps());
+        r = _mm_or_ps(_mm_and_ps(mask, _mm_sub_ps(_mm_set1_ps(Pi), r)), _mm_andnot_ps(mask, r));
+        const __m128 phase{_mm_or_ps(r, _mm_and_ps(im, signmask))};
+
+        /* Subtract the expected phase change, and wrap to [-pi, pi]. */
+        __m128 delta{_mm_sub_ps(_mm_sub_ps(phase, _mm_loadu_ps(lastPhase+k)),
+            _mm_mul_ps(kvec, _mm_set1_ps(Expected)))};
+        const __m128 turns{_mm_cvtepi32_ps(_mm_cvtps_epi32(
+            _mm_mul_ps(delta, _mm_set1_ps(1.0f/Tau))))};
+        delta = _mm_sub_ps(delta, _mm_mul_ps(turns, _mm_set1_ps(Tau)));
+        _mm_storeu_ps(lastPhase+k, phase);
+
+        /* Twice the amplitude to maintain the gain, since only half the bins
+         * are used.
+         */
+        _mm_storeu_ps(amps+k, _mm_add_ps(amp, amp));
+        _mm_storeu_ps(freqs+k, _mm_add_ps(kvec, _mm_mul_ps(delta, _mm_set1_ps(1.0f/Expected))));
+        kvec = _mm_add_ps(kvec, kstep);
+    }
+#endif
+    for(;k < count;k++)
+    {
+        const ALfloat phase{approx_atan2(bins[k].imag(), bins[k].real())};
+        const ALfloat delta{wrap_phase(phase - lastPhase[k] - static_cast<ALfloat>(k)*Expected)};
+        lastPhase[k] = phase;
 
+        amps[k] = 2.0f * std::sqrt(std::norm(bins[k]));
+        freqs[k] = static_cast<ALfloat>(k) + delta*(1.0f/Expected);
+    }
+}
 
-/* Converts complex to ALphasor */
-inline ALphasor rect2polar(const complex_d &number)
+/* Converts the given amplitudes and frequencies (in bins) back to bins,
+ * accumulating the phase for each.
+ */
+void SynthesizeBins(const ALfloat *RESTRICT amps, const ALfloat *RESTRICT freqs,
+    ALfloat *RESTRICT sumPhase, complex_f *RESTRICT bins, const ALsizei count)
 {
-    ALphasor polar;
-    polar.Amplitude = std::abs(number);
-    polar.Phase     = std::arg(number);
-    return polar;
-}
+    ALsizei k{0};
+#ifdef HAVE_SSE_INTRINSICS
+    const __m128i one{_mm_set1_epi32(1)}, two{_mm_set1_epi32(2)};
+    for(;k+4 <= count;k += 4)
+    {
+        __m128 phase{_mm_add_ps(_mm_loadu_ps(sumPhase+k),
+            _mm_mul_ps(_mm_loadu_ps(freqs+k), _mm_set1_ps(Expected)))};
+        const __m128 turns{_mm_cvtepi32_ps(_mm_cvtps_epi32(
+            _mm_mul_ps(phase, _mm_set1_ps(1.0f/Tau))))};
+        phase = _mm_sub_ps(phase, _mm_mul_ps(turns, _mm_set1_ps(Tau)));
+        _mm_storeu_ps(sumPhase+k, phase);
+
+        /* approx_sincos(phase) */
+        const __m128i q{_mm_cvtps_epi32(_mm_mul_ps(phase, _mm_set1_ps(1.0f/HalfPi)))};
+        const __m128 r{_mm_sub_ps(phase, _mm_mul_ps(_mm_cvtepi32_ps(q), _mm_set1_ps(HalfPi)))};
+        const __m128 r2{_mm_mul_ps(r, r)};
+        __m128 sr{_mm_add_ps(_mm_mul_ps(r2, _mm_set1_ps(-1.0f/5040.0f)), _mm_set1_ps(1.0f/120.0f))};
+        sr = _mm_add_ps(_mm_mul_ps(r2, sr), _mm_set1_ps(-1.0f/6.0f));
+        sr = _mm_mul_ps(r, _mm_add_ps(_mm_mul_ps(r2, sr), _mm_set1_ps(1.0f)));
+        __m128 cr{_mm_add_ps(_mm_mul_ps(r2, _mm_set1_ps(1.0f/40320.0f)), _mm_set1_ps(-1.0f/720.0f))};
+        cr = _mm_add_ps(_mm_mul_ps(r2, cr), _mm_set1_ps(1.0f/24.0f));
+        cr = _mm_add_ps(_mm_mul_ps(r2, cr), _mm_set1_ps(-0.5f));
+        cr = _mm_add_ps(_mm_mul_ps(r2, cr), _mm_set1_ps(1.0f));
+
+        /* Odd quadrants swap sine and cosine, and the sign bits flip in the
+         * lower half (for sine) and left half (for cosine).
+         */
+        const __m128 swap{_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, one), one))};
+        __m128 s{_mm_or_ps(_mm_and_ps(swap, cr), _mm_andnot_ps(swap, sr))};
+        __m128 c{_mm_or_ps(_mm_and_ps(swap, sr), _mm_andnot_ps(swap, cr))};
+        s = _mm_xor_ps(s, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, two), 30)));
+        c = _mm_xor_ps(c, _mm_castsi128_ps(_mm_slli_epi32(
+            _mm_and_si128(_mm_add_epi32(q, one), two), 30)));
+
+        const __m128 amp{_mm_loadu_ps(amps+k)};
+        const __m128 re{_mm_mul_ps(amp, c)}, im{_mm_mul_ps(amp, s)};
+        _mm_storeu_ps(reinterpret_cast<float*>(bins+k), _mm_unpacklo_ps(re, im));
+        _mm_storeu_ps(reinterpret_cast<float*>(bins+k+2), _mm_unpackhi_ps(re, im));
+    }
+#endif
+    for(;k < count;k++)
+    {
+        const ALfloat phase{wrap_phase(sumPhase[k] + freqs[k]*Expected)};
+        sumPhase[k] = phase;
 
-/* Converts ALphasor to complex */
-inline complex_d polar2rect(const ALphasor &number)
-{ return std::polar<double>(number.Amplitude, number.Phase); }
+        ALfloat s, c;
+        approx_sincos(phase, s, c);
+        bins[k] = complex_f{amps[k]*c, amps[k]*s};
+    }
+}
 
 
 struct PshifterState final : public EffectState {
     /* Effect parameters */
+    ALsizei mFftSize{0};
+    ALsizei mStepSize{0};
+    ALsizei mLatency{0};
     ALsizei mCount;
     ALsizei mPitchShiftI;
     ALfloat mPitchShift;
-    ALfloat mFreqPerBin;
-
-    /* Effects buffers */
-    ALfloat mInFIFO[STFT_SIZE];
-    ALfloat mOutFIFO[STFT_STEP];
-    ALdouble mLastPhase[STFT_HALF_SIZE+1];
-    ALdouble mSumPhase[STFT_HALF_SIZE+1];
-    ALdouble mOutputAccum[STFT_SIZE];
 
-    complex_d mFFTbuffer[STFT_SIZE];
+    std::unique_ptr<RealFftPlan<float>> mFft;
+    al::vector<ALfloat,16> mWindow;
 
-    ALfrequencyDomain mAnalysis_buffer[STFT_HALF_SIZE+1];
-    ALfrequencyDomain mSyntesis_buffer[STFT_HALF_SIZE+1];
+    /* Effects buffers */
+    al::vector<ALfloat,16> mInFIFO;
+    al::vector<ALfloat,16> mOutFIFO;
+    al::vector<ALfloat,16> mOutputAccum;
+    al::vector<ALfloat,16> mFftSamples;
+    al::vector<complex_f,16> mFftBins;
+
+    /* Per-bin state, and the analysis and synthesis of each step. */
+    al::vector<ALfloat,16> mLastPhase;
+    al::vector<ALfloat,16> mSumPhase;
+    al::vector<ALfloat,16> mAnalysisAmp;
+    al::vector<ALfloat,16> mAnalysisFreq;
+    al::vector<ALfloat,16> mSynthesisAmp;
+    al::vector<ALfloat,16> mSynthesisFreq;
 
     alignas(16) ALfloat mBufferOut[BUFFERSIZE];
 
@@ -151,6 +252,8 @@ struct PshifterState final : public EffectState {
     ALfloat mTargetGains[MAX_OUTPUT_CHANNELS];
 
 
+    void processStep();
+
     ALboolean deviceUpdate(const ALCdevice *device) override;
     void update(const ALCcontext *context, const ALeffectslot *slot, const EffectProps *props, const EffectTarget target) override;
     void process(ALsizei samplesToDo, const ALfloat (*RESTRICT samplesIn)[BUFFERSIZE], const ALsizei numInput, ALfloat (*RESTRICT samplesOut)[BUFFERSIZE], const ALsizei numOutput) override;
@@ -158,22 +261,43 @@ struct PshifterState final : public EffectState {
     DEF_NEWDEL(PshifterState)
 };
 
-ALboolean PshifterState::deviceUpdate(const ALCdevice *device)
+ALboolean PshifterState::deviceUpdate(const ALCdevice* UNUSED(device))
 {
+    const ALsizei fftsize{PshifterFftSize};
+    const ALsizei numbins{fftsize/2 + 1};
+    if(mFftSize != fftsize)
+    {
+        mFft.reset(new RealFftPlan<float>{static_cast<size_t>(fftsize)});
+
+        /* Define a Hann window, used to filter the STFT input and output. */
+        mWindow.resize(fftsize);
+        for(ALsizei i{0};i < fftsize>>1;i++)
+        {
+            const double val{std::sin(al::MathDefs<double>::Pi() * i / double(fftsize-1))};
+            mWindow[i] = mWindow[fftsize-1-i] = static_cast<ALfloat>(val * val);
+        }
+
+        mFftSize = fftsize;
+        mStepSize = fftsize / OVERSAMP;
+        mLatency = mStepSize * (OVERSAMP-1);
+    }
+
     /* (Re-)initializing parameters and clear the buffers. */
-    mCount       = FIFO_LATENCY;
+    mCount       = mLatency;
     mPitchShiftI = FRACTIONONE;
     mPitchShift  = 1.0f;
-    mFreqPerBin  = device->Frequency / static_cast<ALfloat>(STFT_SIZE);
 
-    std::fill(std::begin(mInFIFO),          std::end(mInFIFO),          0.0f);
-    std::fill(std::begin(mOutFIFO),         std::end(mOutFIFO),         0.0f);
-    std::fill(std::begin(mLastPhase),       std::end(mLastPhase),       0.0);
-    std::fill(std::begin(mSumPhase),        std::end(mSumPhase),        0.0);
-    std::fill(std::begin(mOutputAccum),     std::end(mOutputAccum),     0.0);
-    std::fill(std::begin(mFFTbuffer),       std::end(mFFTbuffer),       complex_d{});
-    std::fill(std::begin(mAnalysis_buffer), std::end(mAnalysis_buffer), ALfrequencyDomain{});
-    std::fill(std::begin(mSyntesis_buffer), std::end(mSyntesis_buffer), ALfrequencyDomain{});
+    mInFIFO.assign(fftsize, 0.0f);
+    mOutFIFO.assign(mStepSize, 0.0f);
+    mOutputAccum.assign(fftsize, 0.0f);
+    mFftSamples.assign(fftsize, 0.0f);
+    mFftBins.assign(numbins, complex_f{});
+    mLastPhase.assign(numbins, 0.0f);
+    mSumPhase.assign(numbins, 0.0f);
+    mAnalysisAmp.assign(numbins, 0.0f);
+    mAnalysisFreq.assign(numbins, 0.0f);
+    mSynthesisAmp.assign(numbins, 0.0f);
+    mSynthesisFreq.assign(numbins, 0.0f);
 
     std::fill(std::begin(mCurrentGains), std::end(mCurrentGains), 0.0f);
     std::fill(std::begin(mTargetGains),  std::end(mTargetGains),  0.0f);
@@ -197,128 +321,87 @@ void PshifterState::update(const ALCcontext* UNUSED(context), const ALeffectslot
     ComputePanGains(target.Main, coeffs, slot->Params.Gain, mTargetGains);
 }
 
-void PshifterState::process(ALsizei samplesToDo, const ALfloat (*RESTRICT samplesIn)[BUFFERSIZE], const ALsizei /*numInput*/, ALfloat (*RESTRICT samplesOut)[BUFFERSIZE], const ALsizei numOutput)
+void PshifterState::processStep()
 {
     /* Pitch shifter engine based on the work of Stephan Bernsee.
      * http://blogs.zynaptiq.com/bernsee/pitch-shifting-using-the-ft/
      */
+    const ALsizei fftsize{mFftSize};
+    const ALsizei halfsize{fftsize >> 1};
 
-    static constexpr ALdouble expected{al::MathDefs<double>::Tau() / OVERSAMP};
-    const ALdouble freq_per_bin{mFreqPerBin};
-    ALfloat *RESTRICT bufferOut{mBufferOut};
-    ALsizei count{mCount};
-
-    for(ALsizei i{0};i < samplesToDo;)
+    /* Real signal windowing, and apply the real FFT. Since the real FFT is
+     * symmetric, only halfsize+1 bins are needed.
+     */
+    std::transform(mInFIFO.cbegin(), mInFIFO.cend(), mWindow.cbegin(), mFftSamples.begin(),
+        std::multiplies<ALfloat>{});
+    mFft->forward(mFftSamples.data(), mFftBins.data());
+
+    /* ANALYSIS */
+    AnalyzeBins(mFftBins.data(), mLastPhase.data(), mAnalysisAmp.data(), mAnalysisFreq.data(),
+        halfsize+1);
+
+    /* PROCESSING */
+    /* pitch shifting */
+    std::fill(mSynthesisAmp.begin(), mSynthesisAmp.end(), 0.0f);
+    std::fill(mSynthesisFreq.begin(), mSynthesisFreq.end(), 0.0f);
+    for(ALsizei k{0};k < halfsize+1;k++)
     {
-        do {
-            /* Fill FIFO buffer with samples data */
-            mInFIFO[count] = samplesIn[0][i];
-            bufferOut[i] = mOutFIFO[count - FIFO_LATENCY];
-
-            count++;
-        } while(++i < samplesToDo && count < STFT_SIZE);
-
-        /* Check whether FIFO buffer is filled */
-        if(count < STFT_SIZE) break;
-        count = FIFO_LATENCY;
-
-        /* Real signal windowing and store in FFTbuffer */
-        for(ALsizei k{0};k < STFT_SIZE;k++)
-        {
-            mFFTbuffer[k].real(mInFIFO[k] * HannWindow[k]);
-            mFFTbuffer[k].imag(0.0);
-        }
-
-        /* ANALYSIS */
-        /* Apply FFT to FFTbuffer data */
-        complex_fft(mFFTbuffer, STFT_SIZE, -1.0);
-
-        /* Analyze the obtained data. Since the real FFT is symmetric, only
-         * STFT_HALF_SIZE+1 samples are needed.
-         */
-        for(ALsizei k{0};k < STFT_HALF_SIZE+1;k++)
-        {
-            /* Compute amplitude and phase */
-            ALphasor component{rect2polar(mFFTbuffer[k])};
-
-            /* Compute phase difference and subtract expected phase difference */
-            double tmp{(component.Phase - mLastPhase[k]) - k*expected};
-
-            /* Map delta phase into +/- Pi interval */
-            int qpd{double2int(tmp / al::MathDefs<double>::Pi())};
-            tmp -= al::MathDefs<double>::Pi() * (qpd + (qpd%2));
+        const ALsizei j{(k*mPitchShiftI) >> FRACTIONBITS};
+        if(j >= halfsize+1) break;
 
-            /* Get deviation from bin frequency from the +/- Pi interval */
-            tmp /= expected;
-
-            /* Compute the k-th partials' true frequency, twice the amplitude
-             * for maintain the gain (because half of bins are used) and store
-             * amplitude and true frequency in analysis buffer.
-             */
-            mAnalysis_buffer[k].Amplitude = 2.0 * component.Amplitude;
-            mAnalysis_buffer[k].Frequency = (k + tmp) * freq_per_bin;
-
-            /* Store actual phase[k] for the calculations in the next frame*/
-            mLastPhase[k] = component.Phase;
-        }
-
-        /* PROCESSING */
-        /* pitch shifting */
-        for(ALsizei k{0};k < STFT_HALF_SIZE+1;k++)
-        {
-            mSyntesis_buffer[k].Amplitude = 0.0;
-            mSyntesis_buffer[k].Frequency = 0.0;
-        }
-
-        for(ALsizei k{0};k < STFT_HALF_SIZE+1;k++)
-        {
-            ALsizei j{(k*mPitchShiftI) >> FRACTIONBITS};
-            if(j >= STFT_HALF_SIZE+1) break;
+        mSynthesisAmp[j] += mAnalysisAmp[k];
+        mSynthesisFreq[j] = mAnalysisFreq[k] * mPitchShift;
+    }
 
-            mSyntesis_buffer[j].Amplitude += mAnalysis_buffer[k].Amplitude;
-            mSyntesis_buffer[j].Frequency  = mAnalysis_buffer[k].Frequency * mPitchShift;
-        }
+    /* SYNTHESIS */
+    SynthesizeBins(mSynthesisAmp.data(), mSynthesisFreq.data(), mSumPhase.data(),
+        mFftBins.data(), halfsize+1);
 
-        /* SYNTHESIS */
-        /* Synthesis the processing data */
-        for(ALsizei k{0};k < STFT_HALF_SIZE+1;k++)
-        {
-            ALphasor component;
-            ALdouble tmp;
+    /* Apply the real iFFT to reconstruct a real signal. This includes the
+     * mirrored negative frequencies, so it gives twice the response of the
+     * positive frequencies alone except for DC and Nyquist, which are doubled
+     * to match.
+     */
+    mFftBins[0] *= 2.0f;
+    mFftBins[halfsize] *= 2.0f;
+    mFft->inverse(mFftBins.data(), mFftSamples.data());
+
+    /* Windowing and add to output */
+    const ALfloat scale{1.0f / static_cast<ALfloat>(halfsize * OVERSAMP)};
+    for(ALsizei k{0};k < fftsize;k++)
+        mOutputAccum[k] += mWindow[k] * mFftSamples[k] * scale;
+
+    /* Shift accumulator, input & output FIFO */
+    const ALsizei step{mStepSize};
+    std::copy_n(mOutputAccum.begin(), step, mOutFIFO.begin());
+    std::copy(mOutputAccum.begin()+step, mOutputAccum.end(), mOutputAccum.begin());
+    std::fill(mOutputAccum.end()-step, mOutputAccum.end(), 0.0f);
+    std::copy(mInFIFO.begin()+step, mInFIFO.end(), mInFIFO.begin());
+}
 
-            /* Compute bin deviation from scaled freq */
-            tmp = mSyntesis_buffer[k].Frequency/freq_per_bin - k;
+void PshifterState::process(ALsizei samplesToDo, const ALfloat (*RESTRICT samplesIn)[BUFFERSIZE], const ALsizei /*numInput*/, ALfloat (*RESTRICT samplesOut)[BUFFERSIZE], const ALsizei numOutput)
+{
+    /* The input is collected and the output delivered a step at a time. The
+     * output is mono, so each step is analyzed and synthesized once
+     * regardless of how many channels it's mixed to.
+     */
+    ALfloat *RESTRICT bufferOut{mBufferOut};
+    for(ALsizei base{0};base < samplesToDo;)
+    {
+        const ALsizei todo{mini(mFftSize-mCount, samplesToDo-base)};
+        ASSUME(todo > 0);
 
-            /* Calculate actual delta phase and accumulate it to get bin phase */
-            mSumPhase[k] += (k + tmp) * expected;
+        std::copy_n(samplesIn[0]+base, todo, mInFIFO.begin()+mCount);
+        std::copy_n(mOutFIFO.begin()+(mCount-mLatency), todo, bufferOut+base);
+        mCount += todo;
+        base += todo;
 
-            component.Amplitude = mSyntesis_buffer[k].Amplitude;
-            component.Phase     = mSumPhase[k];
+        /* Check whether FIFO buffer is filled */
+        if(mCount < mFftSize) break;
+        mCount = mLatency;
 
-            /* Compute phasor component to cartesian complex number and storage it into FFTbuffer*/
-            mFFTbuffer[k] = polar2rect(component);
-        }
-        /* zero negative frequencies for recontruct a real signal */
-        for(ALsizei k{STFT_HALF_SIZE+1};k < STFT_SIZE;k++)
-            mFFTbuffer[k] = complex_d{};
-
-        /* Apply iFFT to buffer data */
-        complex_fft(mFFTbuffer, STFT_SIZE, 1.0);
-
-        /* Windowing and add to output */
-        for(ALsizei k{0};k < STFT_SIZE;k++)
-            mOutputAccum[k] += HannWindow[k] * mFFTbuffer[k].real() /
-                               (0.5 * STFT_HALF_SIZE * OVERSAMP);
-
-        /* Shift accumulator, input & output FIFO */
-        ALsizei j, k;
-        for(k = 0;k < STFT_STEP;k++) mOutFIFO[k] = static_cast<ALfloat>(mOutputAccum[k]);
-        for(j = 0;k < STFT_SIZE;k++,j++) mOutputAccum[j] = mOutputAccum[k];
-        for(;j < STFT_SIZE;j++) mOutputAccum[j] = 0.0;
-        for(k = 0;k < FIFO_LATENCY;k++)
-            mInFIFO[k] = mInFIFO[k+STFT_STEP];
+        processStep();
     }
-    mCount = count;
 
     /* Now, mix the processed sound data to the output. */
     MixSamples(bufferOut, numOutput, samplesOut, mCurrentGains, mTargetGains,
@@ -334,11 +334,8 @@ struct ReverbState final : public EffectState {
         ALfloat LFReference{AL_EAXREVERB_DEFAULT_LFREFERENCE};
     } mParams;
 
-    /* Master effect filters */
-    struct {
-        BiquadFilter Lp;
-        BiquadFilter Hp;
-    } mFilter[NUM_LINES];
+    /* Master effect filters (low- then high-pass), with a line in each lane. */
+    BiquadBank<NUM_LINES> mFilter[2];
 
     /* Core delay line (early reflections and late reverb tap from this). */
     DelayLineI mDelay;
@@ -377,8 +374,13 @@ struct ReverbState final : public EffectState {
         ALfloat (*samplesOut)[BUFFERSIZE], const ALsizei todo);
 
     MixOutT mMixOut{&ReverbState::MixOutPlain};
+    MixOutT mFullMixOut{&ReverbState::MixOutPlain};
     std::array<ALfloat,MAX_AMBI_ORDER+1> mOrderScales{};
-    std::array<std::array<BandSplitter,NUM_LINES>,2> mAmbiSplitter;
+    /* Set when the quality governor has lowered the quality, skipping the late
+     * all-pass diffusion and the HF scaling for higher-order output.
+     */
+    bool mReduced{false};
+    std::array<BandSplitterBank<NUM_LINES>,2> mAmbiSplitter;
 
 
     void MixOutPlain(const ALsizei numOutput, ALfloat (*samplesOut)[BUFFERSIZE],
@@ -388,20 +390,20 @@ struct ReverbState final : public EffectState {
 
         /* Convert back to B-Format, and mix the results to output. */
         for(ALsizei c{0};c < NUM_LINES;c++)
-        {
-            std::fill_n(std::begin(mTempSamples[0]), todo, 0.0f);
-            MixRowSamples(mTempSamples[0], A2B[c], mEarlyBuffer, NUM_LINES, 0, todo);
-            MixSamples(mTempSamples[0], numOutput, samplesOut, mEarly.CurrentGain[c],
+            std::fill_n(std::begin(mTempSamples[c]), todo, 0.0f);
+        MixMatrixSamples(mTempSamples, NUM_LINES, A2B[0], NUM_LINES, mEarlyBuffer, NUM_LINES, 0,
+            todo);
+        for(ALsizei c{0};c < NUM_LINES;c++)
+            MixSamples(mTempSamples[c], numOutput, samplesOut, mEarly.CurrentGain[c],
                 mEarly.PanGain[c], todo, 0, todo);
-        }
 
         for(ALsizei c{0};c < NUM_LINES;c++)
-        {
-            std::fill_n(std::begin(mTempSamples[0]), todo, 0.0f);
-            MixRowSamples(mTempSamples[0], A2B[c], mLateBuffer, NUM_LINES, 0, todo);
-            MixSamples(mTempSamples[0], numOutput, samplesOut, mLate.CurrentGain[c],
+            std::fill_n(std::begin(mTempSamples[c]), todo, 0.0f);
+        MixMatrixSamples(mTempSamples, NUM_LINES, A2B[0], NUM_LINES, mLateBuffer, NUM_LINES, 0,
+            todo);
+        for(ALsizei c{0};c < NUM_LINES;c++)
+            MixSamples(mTempSamples[c], numOutput, samplesOut, mLate.CurrentGain[c],
                 mLate.PanGain[c], todo, 0, todo);
-        }
     }
 
     void MixOutAmbiUp(const ALsizei numOutput, ALfloat (*samplesOut)[BUFFERSIZE],
@@ -409,32 +411,32 @@ struct ReverbState final : public EffectState {
     {
         ASSUME(todo > 0);
 
+        /* Apply scaling to the B-Format's HF response to "upsample" it to
+         * higher-order output.
+         */
+        const ALfloat hfscales[NUM_LINES]{mOrderScales[0], mOrderScales[1], mOrderScales[1],
+            mOrderScales[1]};
+        ALfloat *bformat[NUM_LINES];
         for(ALsizei c{0};c < NUM_LINES;c++)
-        {
-            std::fill_n(std::begin(mTempSamples[0]), todo, 0.0f);
-            MixRowSamples(mTempSamples[0], A2B[c], mEarlyBuffer, NUM_LINES, 0, todo);
-
-            /* Apply scaling to the B-Format's HF response to "upsample" it to
-             * higher-order output.
-             */
-            const ALfloat hfscale{(c==0) ? mOrderScales[0] : mOrderScales[1]};
-            mAmbiSplitter[0][c].applyHfScale(mTempSamples[0], hfscale, todo);
+            bformat[c] = mTempSamples[c];
 
-            MixSamples(mTempSamples[0], numOutput, samplesOut, mEarly.CurrentGain[c],
+        for(ALsizei c{0};c < NUM_LINES;c++)
+            std::fill_n(std::begin(mTempSamples[c]), todo, 0.0f);
+        MixMatrixSamples(mTempSamples, NUM_LINES, A2B[0], NUM_LINES, mEarlyBuffer, NUM_LINES, 0,
+            todo);
+        mAmbiSplitter[0].applyHfScale(bformat, hfscales, NUM_LINES, todo);
+        for(ALsizei c{0};c < NUM_LINES;c++)
+            MixSamples(mTempSamples[c], numOutput, samplesOut, mEarly.CurrentGain[c],
                 mEarly.PanGain[c], todo, 0, todo);
-        }
 
         for(ALsizei c{0};c < NUM_LINES;c++)
-        {
-            std::fill_n(std::begin(mTempSamples[0]), todo, 0.0f);
-            MixRowSamples(mTempSamples[0], A2B[c], mLateBuffer, NUM_LINES, 0, todo);
-
-            const ALfloat hfscale{(c==0) ? mOrderScales[0] : mOrderScales[1]};
-            mAmbiSplitter[1][c].applyHfScale(mTempSamples[0], hfscale, todo);
-
-            MixSamples(mTempSamples[0], numOutput, samplesOut, mLate.CurrentGain[c],
+            std::fill_n(std::begin(mTempSamples[c]), todo, 0.0f);
+        MixMatrixSamples(mTempSamples, NUM_LINES, A2B[0], NUM_LINES, mLateBuffer, NUM_LINES, 0,
+            todo);
+        mAmbiSplitter[1].applyHfScale(bformat, hfscales, NUM_LINES, todo);
+        for(ALsizei c{0};c < NUM_LINES;c++)
+            MixSamples(mTempSamples[c], numOutput, samplesOut, mLate.CurrentGain[c],
                 mLate.PanGain[c], todo, 0, todo);
-        }
     }
 
     bool allocLines(const ALfloat frequency);
@@ -571,10 +573,7 @@ ALboolean ReverbState::deviceUpdate(const ALCdevice *device)
      * cleared (if not reallocated).
      */
     for(auto &filter : mFilter)
-    {
-        filter.Lp.clear();
-        filter.Hp.clear();
-    }
+        filter.clear();
 
     for(auto &coeff : mEarlyDelayCoeff)
         std::fill(std::begin(coeff), std::end(coeff), 0.0f);
@@ -607,17 +606,18 @@ ALboolean ReverbState::deviceUpdate(const ALCdevice *device)
 
     if(device->mAmbiOrder > 1)
     {
-        mMixOut = &ReverbState::MixOutAmbiUp;
+        mFullMixOut = &ReverbState::MixOutAmbiUp;
         mOrderScales = BFormatDec::GetHFOrderScales(1, device->mAmbiOrder);
     }
     else
     {
-        mMixOut = &ReverbState::MixOutPlain;
+        mFullMixOut = &ReverbState::MixOutPlain;
         mOrderScales.fill(1.0f);
     }
-    mAmbiSplitter[0][0].init(400.0f / frequency);
-    std::fill(mAmbiSplitter[0].begin()+1, mAmbiSplitter[0].end(), mAmbiSplitter[0][0]);
-    std::fill(mAmbiSplitter[1].begin(), mAmbiSplitter[1].end(), mAmbiSplitter[0][0]);
+    mMixOut = mFullMixOut;
+    mReduced = false;
+    mAmbiSplitter[0].init(400.0f / frequency);
+    mAmbiSplitter[1].init(400.0f / frequency);
 
     return AL_TRUE;
 }
@@ -915,16 +915,16 @@ void ReverbState::update(const ALCcontext *Context, const ALeffectslot *Slot, co
      * killing most of the signal.
      */
     ALfloat gainhf{maxf(props->Reverb.GainHF, 0.001f)};
-    mFilter[0].Lp.setParams(BiquadType::HighShelf, gainhf, hf0norm,
+    mFilter[0].setParams(0, BiquadType::HighShelf, gainhf, hf0norm,
         calc_rcpQ_from_slope(gainhf, 1.0f));
     ALfloat lf0norm{minf(props->Reverb.LFReference / frequency, 0.49f)};
     ALfloat gainlf{maxf(props->Reverb.GainLF, 0.001f)};
-    mFilter[0].Hp.setParams(BiquadType::LowShelf, gainlf, lf0norm,
+    mFilter[1].setParams(0, BiquadType::LowShelf, gainlf, lf0norm,
         calc_rcpQ_from_slope(gainlf, 1.0f));
-    for(ALsizei i{1};i < NUM_LINES;i++)
+    for(size_t i{1};i < NUM_LINES;i++)
     {
-        mFilter[i].Lp.copyParamsFrom(mFilter[0].Lp);
-        mFilter[i].Hp.copyParamsFrom(mFilter[0].Hp);
+        mFilter[0].copyParamsFrom(i, mFilter[0], 0);
+        mFilter[1].copyParamsFrom(i, mFilter[1], 0);
     }
 
     /* Update the main effect delay and associated taps. */
@@ -990,6 +990,20 @@ void ReverbState::update(const ALCcontext *Context, const ALeffectslot *Slot, co
     mParams.LFDecayTime = lfDecayTime;
     mParams.HFReference = props->Reverb.HFReference;
     mParams.LFReference = props->Reverb.LFReference;
+
+    const bool reduced{Device->mGovernor.Level.load(std::memory_order_relaxed) >=
+        QualityReverbReduced};
+    if(mReduced != reduced)
+    {
+        /* Clear what was left in the skipped filters, so it doesn't play back
+         * when they're used again.
+         */
+        std::fill_n(mLate.VecAp.Delay.Line[0], (mLate.VecAp.Delay.Mask+1)*NUM_LINES, 0.0f);
+        mAmbiSplitter[0].clear();
+        mAmbiSplitter[1].clear();
+    }
+    mReduced = reduced;
+    mMixOut = reduced ? &ReverbState::MixOutPlain : mFullMixOut;
 }
 
 
@@ -1374,7 +1388,8 @@ void LateReverb_Unfaded(ReverbState *State, const ALsizei offset, const ALsizei
     /* Apply a vector all-pass to improve micro-surface diffusion, and write
      * out the results for mixing.
      */
-    State->mLate.VecAp.processUnfaded(temps, offset, mixX, mixY, todo);
+    if(!State->mReduced)
+        State->mLate.VecAp.processUnfaded(temps, offset, mixX, mixY, todo);
 
     for(ALsizei j{0};j < NUM_LINES;j++)
         std::copy_n(temps[j], todo, out[j]+base);
@@ -1435,7 +1450,8 @@ void LateReverb_Faded(ReverbState *State, const ALsizei offset, const ALsizei to
         State->mLate.T60[j].process(temps[j], todo);
     }
 
-    State->mLate.VecAp.processFaded(temps, offset, mixX, mixY, fade, todo);
+    if(!State->mReduced)
+        State->mLate.VecAp.processFaded(temps, offset, mixX, mixY, fade, todo);
 
     for(ALsizei j{0};j < NUM_LINES;j++)
         std::copy_n(temps[j], todo, out[j]+base);
@@ -1452,13 +1468,17 @@ void ReverbState::process(ALsizei samplesToDo, const ALfloat (*RESTRICT samplesI
     /* Convert B-Format to A-Format for processing. */
     ALfloat (&afmt)[NUM_LINES][BUFFERSIZE] = mTempSamples;
     for(ALsizei c{0};c < NUM_LINES;c++)
-    {
         std::fill_n(std::begin(afmt[c]), samplesToDo, 0.0f);
-        MixRowSamples(afmt[c], B2A[c], samplesIn, numInput, 0, samplesToDo);
+    MixMatrixSamples(afmt, NUM_LINES, B2A[0], MAX_AMBI_CHANNELS, samplesIn, numInput, 0,
+        samplesToDo);
 
-        /* Band-pass the incoming samples. */
-        mFilter[c].Lp.process(afmt[c], afmt[c], samplesToDo);
-        mFilter[c].Hp.process(afmt[c], afmt[c], samplesToDo);
+    /* Band-pass the incoming samples. */
+    {
+        ALfloat *lines[NUM_LINES];
+        for(ALsizei c{0};c < NUM_LINES;c++)
+            lines[c] = afmt[c];
+        BiquadBank<NUM_LINES>::processCascade(mFilter, 2, lines, lines, NUM_LINES,
+            samplesToDo);
     }
 
     /* Process reverb for these samples. */
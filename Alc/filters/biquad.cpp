@@ -2,12 +2,18 @@
 #include "config.h"
 
 #include <cmath>
+#include <algorithm>
+
+#ifdef HAVE_SSE_INTRINSICS
+#include <xmmintrin.h>
+#endif
 
 #include "AL/alc.h"
 #include "AL/al.h"
 
 #include "alMain.h"
 #include "biquad.h"
+#include "lanes.h"
 
 
 template<typename Real>
@@ -125,3 +131,168 @@ void BiquadFilterR<Real>::process(Real *dst, const Real *src, int numsamples)
 
 template class BiquadFilterR<float>;
 template class BiquadFilterR<double>;
+
+
+template<size_t N>
+BiquadBank<N>::BiquadBank() noexcept
+{
+    std::fill(std::begin(mB0), std::end(mB0), 1.0f);
+    std::fill(std::begin(mB1), std::end(mB1), 0.0f);
+    std::fill(std::begin(mB2), std::end(mB2), 0.0f);
+    std::fill(std::begin(mA1), std::end(mA1), 0.0f);
+    std::fill(std::begin(mA2), std::end(mA2), 0.0f);
+}
+
+template<size_t N>
+void BiquadBank<N>::clear() noexcept
+{
+    std::fill(std::begin(mZ1), std::end(mZ1), 0.0f);
+    std::fill(std::begin(mZ2), std::end(mZ2), 0.0f);
+}
+
+template<size_t N>
+void BiquadBank<N>::setParams(size_t lane, BiquadType type, float gain, float f0norm,
+    float rcpQ)
+{
+    BiquadFilter filter;
+    filter.setParams(type, gain, f0norm, rcpQ);
+    copyParamsFrom(lane, filter);
+}
+
+template<size_t N>
+void BiquadBank<N>::copyParamsFrom(size_t lane, const BiquadFilter &other) noexcept
+{
+    mB0[lane] = other.b0;
+    mB1[lane] = other.b1;
+    mB2[lane] = other.b2;
+    mA1[lane] = other.a1;
+    mA2[lane] = other.a2;
+}
+
+template<size_t N>
+void BiquadBank<N>::copyParamsFrom(size_t lane, const BiquadBank &other, size_t otherlane) noexcept
+{
+    mB0[lane] = other.mB0[otherlane];
+    mB1[lane] = other.mB1[otherlane];
+    mB2[lane] = other.mB2[otherlane];
+    mA1[lane] = other.mA1[otherlane];
+    mA2[lane] = other.mA2[otherlane];
+}
+
+template<size_t N>
+void BiquadBank<N>::load(size_t lane, const BiquadFilter &filter) noexcept
+{
+    copyParamsFrom(lane, filter);
+    mZ1[lane] = filter.z1;
+    mZ2[lane] = filter.z2;
+}
+
+template<size_t N>
+void BiquadBank<N>::store(size_t lane, BiquadFilter &filter) const noexcept
+{
+    filter.z1 = mZ1[lane];
+    filter.z2 = mZ2[lane];
+}
+
+template<size_t N>
+void BiquadBank<N>::processLanes(float *samples, int numsamples)
+{
+    ASSUME(numsamples > 0);
+
+    /* The same Transposed Direct Form II as BiquadFilterR::process, with each
+     * step done for all lanes at once.
+     */
+#ifdef HAVE_SSE_INTRINSICS
+    constexpr size_t NumVecs{N / 4};
+    __m128 b0[NumVecs], b1[NumVecs], b2[NumVecs], a1[NumVecs], a2[NumVecs];
+    __m128 z1[NumVecs], z2[NumVecs];
+    for(size_t v{0};v < NumVecs;++v)
+    {
+        b0[v] = _mm_load_ps(&mB0[v*4]);
+        b1[v] = _mm_load_ps(&mB1[v*4]);
+        b2[v] = _mm_load_ps(&mB2[v*4]);
+        a1[v] = _mm_load_ps(&mA1[v*4]);
+        a2[v] = _mm_load_ps(&mA2[v*4]);
+        z1[v] = _mm_load_ps(&mZ1[v*4]);
+        z2[v] = _mm_load_ps(&mZ2[v*4]);
+    }
+    for(int i{0};i < numsamples;++i)
+    {
+        for(size_t v{0};v < NumVecs;++v)
+        {
+            const __m128 input{_mm_load_ps(samples + v*4)};
+            const __m128 output{_mm_add_ps(_mm_mul_ps(input, b0[v]), z1[v])};
+            z1[v] = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(input, b1[v]), _mm_mul_ps(output, a1[v])),
+                z2[v]);
+            z2[v] = _mm_sub_ps(_mm_mul_ps(input, b2[v]), _mm_mul_ps(output, a2[v]));
+            _mm_store_ps(samples + v*4, output);
+        }
+        samples += N;
+    }
+    for(size_t v{0};v < NumVecs;++v)
+    {
+        _mm_store_ps(&mZ1[v*4], z1[v]);
+        _mm_store_ps(&mZ2[v*4], z2[v]);
+    }
+#else
+    alignas(16) float z1[N], z2[N];
+    std::copy(std::begin(mZ1), std::end(mZ1), std::begin(z1));
+    std::copy(std::begin(mZ2), std::end(mZ2), std::begin(z2));
+    for(int i{0};i < numsamples;++i)
+    {
+        for(size_t l{0};l < N;++l)
+        {
+            const float input{samples[l]};
+            const float output{input*mB0[l] + z1[l]};
+            z1[l] = input*mB1[l] - output*mA1[l] + z2[l];
+            z2[l] = input*mB2[l] - output*mA2[l];
+            samples[l] = output;
+        }
+        samples += N;
+    }
+    std::copy(std::begin(z1), std::end(z1), std::begin(mZ1));
+    std::copy(std::begin(z2), std::end(z2), std::begin(mZ2));
+#endif
+}
+
+template<size_t N>
+void BiquadBank<N>::process(float *const *dst, const float *const *src, size_t numlanes,
+    int numsamples)
+{
+    ASSUME(numsamples > 0);
+
+    alignas(16) float samples[LaneBlockSize*N];
+    for(int base{0};base < numsamples;)
+    {
+        const int todo{std::min(LaneBlockSize, numsamples-base)};
+
+        InterleaveLanes<N>(samples, src, numlanes, base, todo);
+        processLanes(samples, todo);
+        DeinterleaveLanes<N>(dst, samples, numlanes, base, todo);
+
+        base += todo;
+    }
+}
+
+template<size_t N>
+void BiquadBank<N>::processCascade(BiquadBank *banks, size_t numbanks, float *const *dst,
+    const float *const *src, size_t numlanes, int numsamples)
+{
+    ASSUME(numsamples > 0);
+
+    alignas(16) float samples[LaneBlockSize*N];
+    for(int base{0};base < numsamples;)
+    {
+        const int todo{std::min(LaneBlockSize, numsamples-base)};
+
+        InterleaveLanes<N>(samples, src, numlanes, base, todo);
+        for(size_t i{0};i < numbanks;++i)
+            banks[i].processLanes(samples, todo);
+        DeinterleaveLanes<N>(dst, samples, numlanes, base, todo);
+
+        base += todo;
+    }
+}
+
+template class BiquadBank<4>;
+template class BiquadBank<8>;
@@ -2,6 +2,7 @@
 #define FILTERS_BIQUAD_H
 
 #include <cmath>
+#include <cstddef>
 #include <utility>
 
 #include "AL/al.h"
@@ -43,6 +44,9 @@ class BiquadFilterR {
     /* Transfer function coefficients "a" (denominator; a0 is pre-applied). */
     Real a1{0.0f}, a2{0.0f};
 
+    template<size_t N>
+    friend class BiquadBank;
+
 public:
     void clear() noexcept { z1 = z2 = 0.0f; }
 
@@ -104,6 +108,56 @@ public:
 
 using BiquadFilter = BiquadFilterR<float>;
 
+/**
+ * A bank of N independent biquad filters (N being a multiple of 4). The
+ * coefficients and state are stored as a structure of arrays, so the filters
+ * run side by side in SIMD lanes rather than one after another, with each lane
+ * having its own coefficients. This gets around a lone filter's recurrence not
+ * being able to vectorize along time.
+ */
+template<size_t N>
+class BiquadBank {
+    static_assert(N > 0 && (N%4) == 0, "Lane count must be a multiple of 4");
+
+    alignas(16) float mZ1[N]{}, mZ2[N]{};
+    alignas(16) float mB0[N], mB1[N], mB2[N];
+    alignas(16) float mA1[N], mA2[N];
+
+    void processLanes(float *samples, int numsamples);
+
+public:
+    BiquadBank() noexcept;
+
+    void clear() noexcept;
+    void clear(size_t lane) noexcept { mZ1[lane] = mZ2[lane] = 0.0f; }
+
+    /** Sets a lane's filter parameters, as with BiquadFilter::setParams. */
+    void setParams(size_t lane, BiquadType type, float gain, float f0norm, float rcpQ);
+    void copyParamsFrom(size_t lane, const BiquadFilter &other) noexcept;
+    void copyParamsFrom(size_t lane, const BiquadBank &other, size_t otherlane) noexcept;
+
+    /* Loads a filter's coefficients and state into a lane, and stores a lane's
+     * state back to a filter. These let a bank process filters that are kept
+     * elsewhere.
+     */
+    void load(size_t lane, const BiquadFilter &filter) noexcept;
+    void store(size_t lane, BiquadFilter &filter) const noexcept;
+
+    /**
+     * Filters the first numlanes lanes, with lane i reading from src[i] and
+     * writing to dst[i] (the remaining lanes are given silence). Lanes may
+     * share the same source, and a source may also be a destination.
+     */
+    void process(float *const *dst, const float *const *src, size_t numlanes, int numsamples);
+
+    /**
+     * As process, but runs the lanes through each of numbanks banks in turn,
+     * without deinterleaving the signal between them.
+     */
+    static void processCascade(BiquadBank *banks, size_t numbanks, float *const *dst,
+        const float *const *src, size_t numlanes, int numsamples);
+};
+
 /**
  * Calculates the rcpQ (i.e. 1/Q) coefficient for shelving filters, using the
  * reference gain and shelf slope parameter.
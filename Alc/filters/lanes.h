@@ -0,0 +1,106 @@
+#ifndef FILTER_LANES_H
+#define FILTER_LANES_H
+
+#include <cstddef>
+#include <algorithm>
+
+#ifdef HAVE_SSE_INTRINSICS
+#include <xmmintrin.h>
+#endif
+
+#include "alMain.h"
+
+/* Helpers for the filter banks, which process N channels side by side by
+ * interleaving them into frames of N samples, with each channel in its own
+ * (SIMD) lane.
+ */
+
+/* Number of samples a filter bank interleaves at a time. */
+constexpr int LaneBlockSize{128};
+
+/* Interleaves todo samples of each lane's source (starting at offset) into
+ * dst, as dst[sample*N + lane]. Lanes from numlanes on are silent.
+ */
+template<size_t N>
+void InterleaveLanes(float *RESTRICT dst, const float *const *src, const size_t numlanes,
+    const int offset, const int todo)
+{
+    for(size_t base{0};base < N;base += 4)
+    {
+        int i{0};
+#ifdef HAVE_SSE_INTRINSICS
+        if(base+4 <= numlanes)
+        {
+            const float *RESTRICT src0{src[base+0] + offset};
+            const float *RESTRICT src1{src[base+1] + offset};
+            const float *RESTRICT src2{src[base+2] + offset};
+            const float *RESTRICT src3{src[base+3] + offset};
+            for(;i+4 <= todo;i += 4)
+            {
+                __m128 r0{_mm_loadu_ps(src0+i)};
+                __m128 r1{_mm_loadu_ps(src1+i)};
+                __m128 r2{_mm_loadu_ps(src2+i)};
+                __m128 r3{_mm_loadu_ps(src3+i)};
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                _mm_store_ps(dst + (i+0)*N + base, r0);
+                _mm_store_ps(dst + (i+1)*N + base, r1);
+                _mm_store_ps(dst + (i+2)*N + base, r2);
+                _mm_store_ps(dst + (i+3)*N + base, r3);
+            }
+        }
+#endif
+        for(size_t lane{base};lane < base+4;++lane)
+        {
+            if(lane < numlanes)
+            {
+                const float *RESTRICT lanesrc{src[lane] + offset};
+                for(int j{i};j < todo;++j)
+                    dst[j*N + lane] = lanesrc[j];
+            }
+            else for(int j{i};j < todo;++j)
+                dst[j*N + lane] = 0.0f;
+        }
+    }
+}
+
+/* Writes the first numlanes lanes of the interleaved src out to each lane's
+ * destination (starting at offset).
+ */
+template<size_t N>
+void DeinterleaveLanes(float *const *dst, const float *RESTRICT src, const size_t numlanes,
+    const int offset, const int todo)
+{
+    for(size_t base{0};base < numlanes;base += 4)
+    {
+        int i{0};
+#ifdef HAVE_SSE_INTRINSICS
+        if(base+4 <= numlanes)
+        {
+            float *RESTRICT dst0{dst[base+0] + offset};
+            float *RESTRICT dst1{dst[base+1] + offset};
+            float *RESTRICT dst2{dst[base+2] + offset};
+            float *RESTRICT dst3{dst[base+3] + offset};
+            for(;i+4 <= todo;i += 4)
+            {
+                __m128 r0{_mm_load_ps(src + (i+0)*N + base)};
+                __m128 r1{_mm_load_ps(src + (i+1)*N + base)};
+                __m128 r2{_mm_load_ps(src + (i+2)*N + base)};
+                __m128 r3{_mm_load_ps(src + (i+3)*N + base)};
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                _mm_storeu_ps(dst0+i, r0);
+                _mm_storeu_ps(dst1+i, r1);
+                _mm_storeu_ps(dst2+i, r2);
+                _mm_storeu_ps(dst3+i, r3);
+            }
+        }
+#endif
+        for(size_t lane{base};lane < std::min(base+4, numlanes);++lane)
+        {
+            float *RESTRICT lanedst{dst[lane] + offset};
+            for(int j{i};j < todo;++j)
+                lanedst[j] = src[j*N + lane];
+        }
+    }
+}
+
+#endif /* FILTER_LANES_H */
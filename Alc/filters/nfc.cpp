@@ -5,7 +5,12 @@
 
 #include <algorithm>
 
+#ifdef HAVE_SSE_INTRINSICS
+#include <xmmintrin.h>
+#endif
+
 #include "alMain.h"
+#include "lanes.h"
 
 
 /* Near-field control filters are the basis for handling the near-field effect.
@@ -259,6 +264,117 @@ void NfcFilterAdjust4(NfcFilter4 *nfc, const float w0) noexcept
     nfc->b4 = 4.0f * b_01 / g_0;
 }
 
+
+/* Four filters processed side by side, each in a SIMD lane. Every lane is run
+ * as a fourth-order filter (a second-order section followed by another), with
+ * lower-order filters leaving the extra coefficients at 0. The m2/m3/m4 masks
+ * are 1 for the state a lane's filter uses, and 0 to keep the unused state at
+ * 0. This gives the same results as the scalar process1..process4.
+ */
+struct NfcLanes {
+    alignas(16) float gain[4]{}, b1[4]{}, b2[4]{}, b3[4]{}, b4[4]{};
+    alignas(16) float a1[4]{}, a2[4]{}, a3[4]{}, a4[4]{};
+    alignas(16) float m2[4]{}, m3[4]{}, m4[4]{};
+    alignas(16) float z1[4]{}, z2[4]{}, z3[4]{}, z4[4]{};
+
+    void load(const size_t lane, const NfcFilter1 &nfc) noexcept
+    {
+        gain[lane] = nfc.gain;
+        b1[lane] = nfc.b1; a1[lane] = nfc.a1;
+        z1[lane] = nfc.z[0];
+    }
+    void load(const size_t lane, const NfcFilter2 &nfc) noexcept
+    {
+        gain[lane] = nfc.gain;
+        b1[lane] = nfc.b1; b2[lane] = nfc.b2; a1[lane] = nfc.a1; a2[lane] = nfc.a2;
+        m2[lane] = 1.0f;
+        z1[lane] = nfc.z[0]; z2[lane] = nfc.z[1];
+    }
+    void load(const size_t lane, const NfcFilter3 &nfc) noexcept
+    {
+        gain[lane] = nfc.gain;
+        b1[lane] = nfc.b1; b2[lane] = nfc.b2; a1[lane] = nfc.a1; a2[lane] = nfc.a2;
+        b3[lane] = nfc.b3; a3[lane] = nfc.a3;
+        m2[lane] = 1.0f; m3[lane] = 1.0f;
+        z1[lane] = nfc.z[0]; z2[lane] = nfc.z[1]; z3[lane] = nfc.z[2];
+    }
+    void load(const size_t lane, const NfcFilter4 &nfc) noexcept
+    {
+        gain[lane] = nfc.gain;
+        b1[lane] = nfc.b1; b2[lane] = nfc.b2; a1[lane] = nfc.a1; a2[lane] = nfc.a2;
+        b3[lane] = nfc.b3; b4[lane] = nfc.b4; a3[lane] = nfc.a3; a4[lane] = nfc.a4;
+        m2[lane] = 1.0f; m3[lane] = 1.0f; m4[lane] = 1.0f;
+        z1[lane] = nfc.z[0]; z2[lane] = nfc.z[1]; z3[lane] = nfc.z[2]; z4[lane] = nfc.z[3];
+    }
+
+    void store(const size_t lane, NfcFilter1 &nfc) const noexcept
+    { nfc.z[0] = z1[lane]; }
+    void store(const size_t lane, NfcFilter2 &nfc) const noexcept
+    { nfc.z[0] = z1[lane]; nfc.z[1] = z2[lane]; }
+    void store(const size_t lane, NfcFilter3 &nfc) const noexcept
+    { nfc.z[0] = z1[lane]; nfc.z[1] = z2[lane]; nfc.z[2] = z3[lane]; }
+    void store(const size_t lane, NfcFilter4 &nfc) const noexcept
+    {
+        nfc.z[0] = z1[lane]; nfc.z[1] = z2[lane];
+        nfc.z[2] = z3[lane]; nfc.z[3] = z4[lane];
+    }
+
+    /* Filters count interleaved frames of four samples in-place. */
+    void process(float *samples, const int count) noexcept;
+};
+
+void NfcLanes::process(float *samples, const int count) noexcept
+{
+    ASSUME(count > 0);
+
+#ifdef HAVE_SSE_INTRINSICS
+    const __m128 g4{_mm_load_ps(gain)};
+    const __m128 b14{_mm_load_ps(b1)}, b24{_mm_load_ps(b2)};
+    const __m128 b34{_mm_load_ps(b3)}, b44{_mm_load_ps(b4)};
+    const __m128 a14{_mm_load_ps(a1)}, a24{_mm_load_ps(a2)};
+    const __m128 a34{_mm_load_ps(a3)}, a44{_mm_load_ps(a4)};
+    const __m128 m24{_mm_load_ps(m2)}, m34{_mm_load_ps(m3)}, m44{_mm_load_ps(m4)};
+    __m128 z14{_mm_load_ps(z1)}, z24{_mm_load_ps(z2)};
+    __m128 z34{_mm_load_ps(z3)}, z44{_mm_load_ps(z4)};
+    for(int i{0};i < count;++i)
+    {
+        const __m128 in{_mm_load_ps(samples + i*4)};
+        __m128 y{_mm_sub_ps(_mm_sub_ps(_mm_mul_ps(in, g4), _mm_mul_ps(a14, z14)),
+            _mm_mul_ps(a24, z24))};
+        __m128 out{_mm_add_ps(_mm_add_ps(y, _mm_mul_ps(b14, z14)), _mm_mul_ps(b24, z24))};
+        z24 = _mm_add_ps(z24, _mm_mul_ps(z14, m24));
+        z14 = _mm_add_ps(z14, y);
+
+        y = _mm_sub_ps(_mm_sub_ps(out, _mm_mul_ps(a34, z34)), _mm_mul_ps(a44, z44));
+        out = _mm_add_ps(_mm_add_ps(y, _mm_mul_ps(b34, z34)), _mm_mul_ps(b44, z44));
+        z44 = _mm_add_ps(z44, _mm_mul_ps(z34, m44));
+        z34 = _mm_add_ps(z34, _mm_mul_ps(y, m34));
+        _mm_store_ps(samples + i*4, out);
+    }
+    _mm_store_ps(z1, z14); _mm_store_ps(z2, z24);
+    _mm_store_ps(z3, z34); _mm_store_ps(z4, z44);
+#else
+    for(size_t lane{0};lane < 4;++lane)
+    {
+        float lz1{z1[lane]}, lz2{z2[lane]}, lz3{z3[lane]}, lz4{z4[lane]};
+        for(int i{0};i < count;++i)
+        {
+            float y{samples[i*4 + lane]*gain[lane] - a1[lane]*lz1 - a2[lane]*lz2};
+            float out{y + b1[lane]*lz1 + b2[lane]*lz2};
+            lz2 += lz1*m2[lane];
+            lz1 += y;
+
+            y = out - a3[lane]*lz3 - a4[lane]*lz4;
+            out = y + b3[lane]*lz3 + b4[lane]*lz4;
+            lz4 += lz3*m4[lane];
+            lz3 += y*m3[lane];
+            samples[i*4 + lane] = out;
+        }
+        z1[lane] = lz1; z2[lane] = lz2; z3[lane] = lz3; z4[lane] = lz4;
+    }
+#endif
+}
+
 } // namespace
 
 void NfcFilter::init(const float w1) noexcept
@@ -389,3 +505,61 @@ void NfcFilter::process4(float *RESTRICT dst, const float *RESTRICT src, const i
     fourth.z[2] = z3;
     fourth.z[3] = z4;
 }
+
+
+void NfcFilter::processOrders(float *const *dst, const float *src, const size_t numorders,
+    const int count)
+{
+    ASSUME(count > 0);
+    ASSUME(numorders > 0 && numorders <= 4);
+
+    NfcLanes lanes;
+    lanes.load(0, first);
+    if(numorders > 1) lanes.load(1, second);
+    if(numorders > 2) lanes.load(2, third);
+    if(numorders > 3) lanes.load(3, fourth);
+
+    const float *const srcs[4]{src, src, src, src};
+    alignas(16) float samples[LaneBlockSize*4];
+    for(int base{0};base < count;)
+    {
+        const int todo{std::min(LaneBlockSize, count-base)};
+
+        InterleaveLanes<4>(samples, srcs, numorders, base, todo);
+        lanes.process(samples, todo);
+        DeinterleaveLanes<4>(dst, samples, numorders, base, todo);
+
+        base += todo;
+    }
+
+    lanes.store(0, first);
+    if(numorders > 1) lanes.store(1, second);
+    if(numorders > 2) lanes.store(2, third);
+    if(numorders > 3) lanes.store(3, fourth);
+}
+
+void NfcFilter::process1(NfcFilter *filters, float *const *dst, const float *const *src,
+    const size_t numchans, const int count)
+{
+    ASSUME(count > 0);
+    ASSUME(numchans > 0 && numchans <= 4);
+
+    NfcLanes lanes;
+    for(size_t c{0};c < numchans;++c)
+        lanes.load(c, filters[c].first);
+
+    alignas(16) float samples[LaneBlockSize*4];
+    for(int base{0};base < count;)
+    {
+        const int todo{std::min(LaneBlockSize, count-base)};
+
+        InterleaveLanes<4>(samples, src, numchans, base, todo);
+        lanes.process(samples, todo);
+        DeinterleaveLanes<4>(dst, samples, numchans, base, todo);
+
+        base += todo;
+    }
+
+    for(size_t c{0};c < numchans;++c)
+        lanes.store(c, filters[c].first);
+}
@@ -1,6 +1,8 @@
 #ifndef FILTER_NFC_H
 #define FILTER_NFC_H
 
+#include <cstddef>
+
 struct NfcFilter1 {
     float base_gain, gain;
     float b1, a1;
@@ -42,6 +44,15 @@ public:
     void init(const float w1) noexcept;
     void adjust(const float w0) noexcept;
 
+    /* Clears the filter history, keeping the coefficients. */
+    void clear() noexcept
+    {
+        first.z[0] = 0.0f;
+        second.z[0] = second.z[1] = 0.0f;
+        third.z[0] = third.z[1] = third.z[2] = 0.0f;
+        fourth.z[0] = fourth.z[1] = fourth.z[2] = fourth.z[3] = 0.0f;
+    }
+
     /* Near-field control filter for first-order ambisonic channels (1-3). */
     void process1(float *RESTRICT dst, const float *RESTRICT src, const int count);
 
@@ -53,6 +64,21 @@ public:
 
     /* Near-field control filter for fourth-order ambisonic channels (16-24). */
     void process4(float *RESTRICT dst, const float *RESTRICT src, const int count);
+
+    /* Near-field control filters for orders 1 through numorders (up to 4),
+     * applied to the same input together with each order in a SIMD lane.
+     * Order n's output is written to dst[n-1].
+     */
+    void processOrders(float *const *dst, const float *src, const size_t numorders,
+        const int count);
+
+    /* First-order near-field control filters of numchans (up to 4) filters,
+     * applied together with each channel in a SIMD lane. The filters should
+     * all have the same coefficients, as for the first-order channels of a
+     * mix.
+     */
+    static void process1(NfcFilter *filters, float *const *dst, const float *const *src,
+        const size_t numchans, const int count);
 };
 
 #endif /* FILTER_NFC_H */
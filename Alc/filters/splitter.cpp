@@ -7,7 +7,12 @@
 #include <limits>
 #include <algorithm>
 
+#ifdef HAVE_SSE_INTRINSICS
+#include <xmmintrin.h>
+#endif
+
 #include "math_defs.h"
+#include "lanes.h"
 
 template<typename Real>
 void BandSplitterR<Real>::init(Real f0norm)
@@ -98,6 +103,227 @@ template class BandSplitterR<float>;
 template class BandSplitterR<double>;
 
 
+template<size_t N>
+void BandSplitterBank<N>::init(float f0norm)
+{
+    const float w{f0norm * al::MathDefs<float>::Tau()};
+    const float cw{std::cos(w)};
+    if(cw > std::numeric_limits<float>::epsilon())
+        mCoeff = (std::sin(w) - 1.0f) / cw;
+    else
+        mCoeff = cw * -0.5f;
+
+    clear();
+}
+
+template<size_t N>
+void BandSplitterBank<N>::clear() noexcept
+{
+    std::fill(std::begin(mLpZ1), std::end(mLpZ1), 0.0f);
+    std::fill(std::begin(mLpZ2), std::end(mLpZ2), 0.0f);
+    std::fill(std::begin(mApZ1), std::end(mApZ1), 0.0f);
+}
+
+/* The same processing as BandSplitterR::process, with each step done for all
+ * lanes of the interleaved input at once.
+ */
+template<size_t N>
+void BandSplitterBank<N>::processLanes(float *hpout, float *lpout, const float *input,
+    int count)
+{
+    ASSUME(count > 0);
+
+#ifdef HAVE_SSE_INTRINSICS
+    constexpr size_t NumVecs{N / 4};
+    const __m128 ap_coeff{_mm_set1_ps(mCoeff)};
+    const __m128 lp_coeff{_mm_set1_ps(mCoeff*0.5f + 0.5f)};
+    __m128 lp_z1[NumVecs], lp_z2[NumVecs], ap_z1[NumVecs];
+    for(size_t v{0};v < NumVecs;++v)
+    {
+        lp_z1[v] = _mm_load_ps(&mLpZ1[v*4]);
+        lp_z2[v] = _mm_load_ps(&mLpZ2[v*4]);
+        ap_z1[v] = _mm_load_ps(&mApZ1[v*4]);
+    }
+    for(int i{0};i < count;++i)
+    {
+        for(size_t v{0};v < NumVecs;++v)
+        {
+            const __m128 in{_mm_load_ps(input + v*4)};
+
+            __m128 d{_mm_mul_ps(_mm_sub_ps(in, lp_z1[v]), lp_coeff)};
+            __m128 lp_y{_mm_add_ps(lp_z1[v], d)};
+            lp_z1[v] = _mm_add_ps(lp_y, d);
+
+            d = _mm_mul_ps(_mm_sub_ps(lp_y, lp_z2[v]), lp_coeff);
+            lp_y = _mm_add_ps(lp_z2[v], d);
+            lp_z2[v] = _mm_add_ps(lp_y, d);
+
+            const __m128 ap_y{_mm_add_ps(_mm_mul_ps(in, ap_coeff), ap_z1[v])};
+            ap_z1[v] = _mm_sub_ps(in, _mm_mul_ps(ap_y, ap_coeff));
+
+            _mm_store_ps(lpout + v*4, lp_y);
+            _mm_store_ps(hpout + v*4, _mm_sub_ps(ap_y, lp_y));
+        }
+        input += N;
+        hpout += N;
+        lpout += N;
+    }
+    for(size_t v{0};v < NumVecs;++v)
+    {
+        _mm_store_ps(&mLpZ1[v*4], lp_z1[v]);
+        _mm_store_ps(&mLpZ2[v*4], lp_z2[v]);
+        _mm_store_ps(&mApZ1[v*4], ap_z1[v]);
+    }
+#else
+    const float ap_coeff{mCoeff};
+    const float lp_coeff{mCoeff*0.5f + 0.5f};
+    for(int i{0};i < count;++i)
+    {
+        for(size_t l{0};l < N;++l)
+        {
+            const float in{input[l]};
+
+            float d{(in - mLpZ1[l]) * lp_coeff};
+            float lp_y{mLpZ1[l] + d};
+            mLpZ1[l] = lp_y + d;
+
+            d = (lp_y - mLpZ2[l]) * lp_coeff;
+            lp_y = mLpZ2[l] + d;
+            mLpZ2[l] = lp_y + d;
+
+            const float ap_y{in*ap_coeff + mApZ1[l]};
+            mApZ1[l] = in - ap_y*ap_coeff;
+
+            lpout[l] = lp_y;
+            hpout[l] = ap_y - lp_y;
+        }
+        input += N;
+        hpout += N;
+        lpout += N;
+    }
+#endif
+}
+
+template<size_t N>
+void BandSplitterBank<N>::applyHfScaleLanes(float *samples, const float *hfscales, int count)
+{
+    ASSUME(count > 0);
+
+#ifdef HAVE_SSE_INTRINSICS
+    constexpr size_t NumVecs{N / 4};
+    const __m128 ap_coeff{_mm_set1_ps(mCoeff)};
+    const __m128 lp_coeff{_mm_set1_ps(mCoeff*0.5f + 0.5f)};
+    __m128 hfscale[NumVecs], lp_z1[NumVecs], lp_z2[NumVecs], ap_z1[NumVecs];
+    for(size_t v{0};v < NumVecs;++v)
+    {
+        hfscale[v] = _mm_loadu_ps(&hfscales[v*4]);
+        lp_z1[v] = _mm_load_ps(&mLpZ1[v*4]);
+        lp_z2[v] = _mm_load_ps(&mLpZ2[v*4]);
+        ap_z1[v] = _mm_load_ps(&mApZ1[v*4]);
+    }
+    for(int i{0};i < count;++i)
+    {
+        for(size_t v{0};v < NumVecs;++v)
+        {
+            const __m128 in{_mm_load_ps(samples + v*4)};
+
+            __m128 d{_mm_mul_ps(_mm_sub_ps(in, lp_z1[v]), lp_coeff)};
+            __m128 lp_y{_mm_add_ps(lp_z1[v], d)};
+            lp_z1[v] = _mm_add_ps(lp_y, d);
+
+            d = _mm_mul_ps(_mm_sub_ps(lp_y, lp_z2[v]), lp_coeff);
+            lp_y = _mm_add_ps(lp_z2[v], d);
+            lp_z2[v] = _mm_add_ps(lp_y, d);
+
+            const __m128 ap_y{_mm_add_ps(_mm_mul_ps(in, ap_coeff), ap_z1[v])};
+            ap_z1[v] = _mm_sub_ps(in, _mm_mul_ps(ap_y, ap_coeff));
+
+            const __m128 hp_y{_mm_sub_ps(ap_y, lp_y)};
+            _mm_store_ps(samples + v*4, _mm_add_ps(_mm_mul_ps(hp_y, hfscale[v]), lp_y));
+        }
+        samples += N;
+    }
+    for(size_t v{0};v < NumVecs;++v)
+    {
+        _mm_store_ps(&mLpZ1[v*4], lp_z1[v]);
+        _mm_store_ps(&mLpZ2[v*4], lp_z2[v]);
+        _mm_store_ps(&mApZ1[v*4], ap_z1[v]);
+    }
+#else
+    const float ap_coeff{mCoeff};
+    const float lp_coeff{mCoeff*0.5f + 0.5f};
+    for(int i{0};i < count;++i)
+    {
+        for(size_t l{0};l < N;++l)
+        {
+            const float in{samples[l]};
+
+            float d{(in - mLpZ1[l]) * lp_coeff};
+            float lp_y{mLpZ1[l] + d};
+            mLpZ1[l] = lp_y + d;
+
+            d = (lp_y - mLpZ2[l]) * lp_coeff;
+            lp_y = mLpZ2[l] + d;
+            mLpZ2[l] = lp_y + d;
+
+            const float ap_y{in*ap_coeff + mApZ1[l]};
+            mApZ1[l] = in - ap_y*ap_coeff;
+
+            samples[l] = (ap_y-lp_y)*hfscales[l] + lp_y;
+        }
+        samples += N;
+    }
+#endif
+}
+
+template<size_t N>
+void BandSplitterBank<N>::process(float *const *hpout, float *const *lpout,
+    const float *const *input, size_t numlanes, int count)
+{
+    ASSUME(count > 0);
+
+    alignas(16) float samples[LaneBlockSize*N];
+    alignas(16) float hpsamples[LaneBlockSize*N];
+    alignas(16) float lpsamples[LaneBlockSize*N];
+    for(int base{0};base < count;)
+    {
+        const int todo{std::min(LaneBlockSize, count-base)};
+
+        InterleaveLanes<N>(samples, input, numlanes, base, todo);
+        processLanes(hpsamples, lpsamples, samples, todo);
+        DeinterleaveLanes<N>(hpout, hpsamples, numlanes, base, todo);
+        DeinterleaveLanes<N>(lpout, lpsamples, numlanes, base, todo);
+
+        base += todo;
+    }
+}
+
+template<size_t N>
+void BandSplitterBank<N>::applyHfScale(float *const *samples, const float *hfscales,
+    size_t numlanes, int count)
+{
+    ASSUME(count > 0);
+
+    float scales[N];
+    std::fill(std::copy_n(hfscales, numlanes, std::begin(scales)), std::end(scales), 1.0f);
+
+    alignas(16) float lanes[LaneBlockSize*N];
+    for(int base{0};base < count;)
+    {
+        const int todo{std::min(LaneBlockSize, count-base)};
+
+        InterleaveLanes<N>(lanes, samples, numlanes, base, todo);
+        applyHfScaleLanes(lanes, scales, todo);
+        DeinterleaveLanes<N>(samples, lanes, numlanes, base, todo);
+
+        base += todo;
+    }
+}
+
+template class BandSplitterBank<4>;
+template class BandSplitterBank<8>;
+
+
 template<typename Real>
 void SplitterAllpassR<Real>::init(Real f0norm)
 {
@@ -21,6 +21,36 @@ public:
 };
 using BandSplitter = BandSplitterR<float>;
 
+/* A bank of N band splitters (N being a multiple of 4) with the same crossover
+ * frequency, processed side by side in SIMD lanes as with BiquadBank.
+ */
+template<size_t N>
+class BandSplitterBank {
+    static_assert(N > 0 && (N%4) == 0, "Lane count must be a multiple of 4");
+
+    float mCoeff{0.0f};
+    alignas(16) float mLpZ1[N]{};
+    alignas(16) float mLpZ2[N]{};
+    alignas(16) float mApZ1[N]{};
+
+    void processLanes(float *hpout, float *lpout, const float *input, int count);
+    void applyHfScaleLanes(float *samples, const float *hfscales, int count);
+
+public:
+    void init(float f0norm);
+    void clear() noexcept;
+
+    /* Splits the first numlanes lanes, with lane i reading from input[i] and
+     * writing to hpout[i] and lpout[i].
+     */
+    void process(float *const *hpout, float *const *lpout, const float *const *input,
+        size_t numlanes, int count);
+    /* Scales the high frequencies of the first numlanes lanes in place, each
+     * by its own scale.
+     */
+    void applyHfScale(float *const *samples, const float *hfscales, size_t numlanes, int count);
+};
+
 /* The all-pass portion of the band splitter. Applies the same phase shift
  * without splitting the signal.
  */
@@ -286,6 +286,119 @@ void GetHrtfCoeffs(const HrtfEntry *Hrtf, ALfloat elevation, ALfloat azimuth, AL
 }
 
 
+namespace {
+
+/* Angles are cached with a resolution of half a degree, and spread with 128
+ * steps over a full circle.
+ */
+constexpr ALsizei CacheAngleSteps{360};
+constexpr ALfloat CacheAngleScale{CacheAngleSteps / al::MathDefs<float>::Pi()};
+constexpr ALsizei CacheSpreadSteps{128};
+constexpr ALfloat CacheSpreadScale{CacheSpreadSteps / al::MathDefs<float>::Tau()};
+
+inline ALuint HashCacheKey(ALuint key) noexcept
+{
+    key ^= key >> 16;
+    key *= 0x45d9f3bu;
+    key ^= key >> 16;
+    return key;
+}
+
+} // namespace
+
+HrtfCoeffCache::HrtfCoeffCache(const HrtfEntry *hrtf, size_t count)
+  : mHrtf{hrtf}, mEntries(count), mBuckets(NextPowerOf2(static_cast<ALuint>(count)), -1)
+{ }
+
+void HrtfCoeffCache::unlinkEntry(ALsizei idx) noexcept
+{
+    Entry &entry = mEntries[idx];
+    if(entry.Prev >= 0) mEntries[entry.Prev].Next = entry.Next;
+    else mHead = entry.Next;
+    if(entry.Next >= 0) mEntries[entry.Next].Prev = entry.Prev;
+    else mTail = entry.Prev;
+}
+
+void HrtfCoeffCache::pushFront(ALsizei idx) noexcept
+{
+    Entry &entry = mEntries[idx];
+    entry.Prev = -1;
+    entry.Next = mHead;
+    if(mHead >= 0) mEntries[mHead].Prev = idx;
+    else mTail = idx;
+    mHead = idx;
+}
+
+void HrtfCoeffCache::getCoeffs(ALfloat elevation, ALfloat azimuth, ALfloat distance,
+    ALfloat spread, HrirArray<ALfloat> &coeffs, ALsizei (&delays)[2])
+{
+    /* Find the field used for this distance, same as GetHrtfCoeffs. */
+    ALsizei fdidx{0};
+    while(fdidx < mHrtf->fdCount-1 && distance < mHrtf->field[fdidx].distance)
+        ++fdidx;
+
+    const ALsizei evidx{clampi(
+        fastf2i((elevation + al::MathDefs<float>::Pi()*0.5f) * CacheAngleScale),
+        0, CacheAngleSteps)};
+    ALsizei azidx{fastf2i((azimuth + al::MathDefs<float>::Pi()) * CacheAngleScale) %
+        (CacheAngleSteps*2)};
+    if(azidx < 0) azidx += CacheAngleSteps*2;
+    const ALsizei spidx{clampi(fastf2i(spread * CacheSpreadScale), 0, CacheSpreadSteps)};
+
+    /* 9 bits elevation, 10 bits azimuth, 8 bits spread, 5 bits field. */
+    const ALuint key{static_cast<ALuint>(evidx) | (static_cast<ALuint>(azidx)<<9) |
+        (static_cast<ALuint>(spidx)<<19) | (static_cast<ALuint>(fdidx)<<27)};
+    ALsizei &bucket = mBuckets[HashCacheKey(key) & (mBuckets.size()-1)];
+
+    const ALsizei irSize{mHrtf->irSize};
+    ALsizei idx{bucket};
+    while(idx >= 0 && mEntries[idx].Key != key)
+        idx = mEntries[idx].HashNext;
+    if(idx >= 0)
+    {
+        if(idx != mHead)
+        {
+            unlinkEntry(idx);
+            pushFront(idx);
+        }
+    }
+    else
+    {
+        if(mUsed < static_cast<ALsizei>(mEntries.size()))
+            idx = mUsed++;
+        else
+        {
+            /* Evict the least recently used entry, removing it from its hash
+             * chain.
+             */
+            idx = mTail;
+            unlinkEntry(idx);
+
+            ALsizei *prev{&mBuckets[HashCacheKey(mEntries[idx].Key) & (mBuckets.size()-1)]};
+            while(*prev != idx)
+                prev = &mEntries[*prev].HashNext;
+            *prev = mEntries[idx].HashNext;
+        }
+
+        Entry &entry = mEntries[idx];
+        GetHrtfCoeffs(mHrtf,
+            static_cast<ALfloat>(evidx)/CacheAngleScale - al::MathDefs<float>::Pi()*0.5f,
+            static_cast<ALfloat>(azidx)/CacheAngleScale - al::MathDefs<float>::Pi(),
+            mHrtf->field[fdidx].distance, static_cast<ALfloat>(spidx)/CacheSpreadScale,
+            entry.Coeffs, entry.Delay);
+        entry.Key = key;
+        entry.HashNext = bucket;
+        bucket = idx;
+        pushFront(idx);
+    }
+
+    const Entry &entry = mEntries[idx];
+    std::copy_n(entry.Coeffs.cbegin(), irSize, coeffs.begin());
+    delays[0] = entry.Delay[0];
+    delays[1] = entry.Delay[1];
+}
+
+
 std::unique_ptr<DirectHrtfState> DirectHrtfState::Create(size_t num_chans)
 {
     void *ptr{al_calloc(16, DirectHrtfState::Sizeof(num_chans))};
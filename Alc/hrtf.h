@@ -3,6 +3,7 @@
 
 #include <array>
 #include <memory>
+#include <complex>
 #include <string>
 
 #include "AL/al.h"
@@ -10,6 +11,7 @@
 
 #include "vector.h"
 #include "almalloc.h"
+#include "alcomplex.h"
 
 
 #define HRTF_HISTORY_BITS   (6)
@@ -20,6 +22,9 @@
 #define HRIR_LENGTH      (1<<HRIR_BITS)
 #define HRIR_MASK        (HRIR_LENGTH-1)
 
+/* Transform size for the frequency-domain HRTF mixers. */
+#define HRTF_FFT_SIZE    (HRIR_LENGTH*4)
+
 
 struct HrtfHandle;
 
@@ -76,6 +81,24 @@ struct HrtfParams {
     ALfloat Gain;
 };
 
+/* An HRIR pair's frequency response, packed for the FFT mixers. */
+struct HrtfSpectra {
+    alignas(16) std::array<std::complex<float>,HRTF_FFT_SIZE> A;
+    alignas(16) std::array<std::complex<float>,HRTF_FFT_SIZE> B;
+};
+
+/* Temp storage for the FFT mixers, and the transform plan they use. Blending
+ * uses both inputs. The plan is made along with the buffers (i.e. when the
+ * device is), so the mixer never has to allocate one.
+ */
+struct HrtfFftBuffers {
+    alignas(16) std::complex<float> Input[2][HRTF_FFT_SIZE];
+    alignas(16) std::complex<float> RevInput[2][HRTF_FFT_SIZE];
+    alignas(16) std::complex<float> Output[HRTF_FFT_SIZE];
+
+    ComplexFftPlan<float> Plan{HRTF_FFT_SIZE};
+};
+
 struct DirectHrtfState {
     /* HRTF filter state for dry buffer content */
     ALsizei IrSize{0};
@@ -108,6 +131,38 @@ HrtfEntry *GetLoadedHrtf(HrtfHandle *handle);
 void GetHrtfCoeffs(const HrtfEntry *Hrtf, ALfloat elevation, ALfloat azimuth, ALfloat distance,
     ALfloat spread, HrirArray<ALfloat> &coeffs, ALsizei (&delays)[2]);
 
+/* Least-recently-used cache of blended HRIRs. Requests are quantized by
+ * elevation, azimuth, distance field, and spread, and the coefficients are
+ * built for the quantized direction, so a hit gives the same result as a miss.
+ * This lets slowly moving sources skip the blend on most updates. Only the
+ * mixer thread should use it.
+ */
+class HrtfCoeffCache {
+    struct Entry {
+        alignas(16) HrirArray<ALfloat> Coeffs;
+        ALsizei Delay[2];
+        ALuint Key;
+        /* Hash bucket chain, and LRU list links. */
+        ALsizei HashNext;
+        ALsizei Prev, Next;
+    };
+
+    const HrtfEntry *mHrtf;
+    al::vector<Entry,16> mEntries;
+    al::vector<ALsizei> mBuckets;
+    ALsizei mHead{-1}, mTail{-1};
+    ALsizei mUsed{0};
+
+    void unlinkEntry(ALsizei idx) noexcept;
+    void pushFront(ALsizei idx) noexcept;
+
+public:
+    HrtfCoeffCache(const HrtfEntry *hrtf, size_t count);
+
+    void getCoeffs(ALfloat elevation, ALfloat azimuth, ALfloat distance, ALfloat spread,
+        HrirArray<ALfloat> &coeffs, ALsizei (&delays)[2]);
+};
+
 /**
  * Produces HRTF filter coefficients for decoding B-Format, given a set of
  * virtual speaker positions, a matching decoding matrix, and per-order high-
@@ -28,6 +28,52 @@ extern "C" {
 #define ALC_N3D_SOFT                             0x0002
 #endif
 
+#ifndef ALC_SOFT_props_pool
+#define ALC_SOFT_props_pool 1
+/* Queried with alcGetInteger64vSOFT on a playback device, each returning four
+ * values: for the context, listener, effect slot, and voice property pools.
+ */
+#define ALC_PROPS_POOL_SIZE_SOFT                 0x19A0
+#define ALC_PROPS_POOL_HIGH_WATER_SOFT           0x19A1
+#define ALC_PROPS_POOL_FALLBACKS_SOFT            0x19A2
+#endif
+
+#ifndef ALC_SOFT_mixer_stats
+#define ALC_SOFT_mixer_stats 1
+/* Queried with alcGetInteger64vSOFT on a playback device. The stage times each
+ * return ten values, in nanoseconds per mix: parameter updates, voice mixing,
+ * effect processing, post-processing, front stablization, limiting, distance
+ * compensation, dithering, output conversion, and the whole mix. The averages
+ * and maximums cover the last complete window of about a second.
+ */
+#define ALC_MIX_STAGE_TIMES_LAST_SOFT            0x19A3
+#define ALC_MIX_STAGE_TIMES_AVERAGE_SOFT         0x19A4
+#define ALC_MIX_STAGE_TIMES_MAX_SOFT             0x19A5
+/* Voices mixed, and voices held by paused sources or left unmixed by the
+ * quality governor, in the last update.
+ */
+#define ALC_MIX_ACTIVE_VOICES_SOFT               0x19A6
+#define ALC_MIX_VIRTUAL_VOICES_SOFT              0x19A7
+/* Three values, the last, average, and maximum time spent mixing, relative to
+ * the time covered by the mixed samples, in hundredths of a percent.
+ */
+#define ALC_MIX_DSP_LOAD_SOFT                    0x19A8
+#endif
+
+#ifndef ALC_SOFT_quality_governor
+#define ALC_SOFT_quality_governor 1
+/* Queried with alcGetInteger64vSOFT on a playback device. The quality level
+ * goes from 0 (full quality) up to the max level (0 when the governor is
+ * off), with each level lowering the quality further: distant voices using
+ * linear resampling, fewer voices getting their own HRTF filter, a reduced
+ * reverb, and quiet voices not being mixed. The changes count how many times
+ * the level changed.
+ */
+#define ALC_QUALITY_LEVEL_SOFT                   0x19A9
+#define ALC_MAX_QUALITY_LEVEL_SOFT               0x19AA
+#define ALC_QUALITY_LEVEL_CHANGES_SOFT           0x19AB
+#endif
+
 #ifndef AL_SOFT_map_buffer
 #define AL_SOFT_map_buffer 1
 typedef unsigned int ALbitfieldSOFT;
@@ -85,6 +131,35 @@ AL_API void AL_APIENTRY alSourceQueueBufferLayersSOFT(ALuint src, ALsizei nb, co
 #define AL_EFFECTSLOT_TARGET_SOFT                0xf000
 #endif
 
+#ifndef AL_SOFT_convolution_reverb
+#define AL_SOFT_convolution_reverb
+#define AL_EFFECT_CONVOLUTION_REVERB_SOFT        0xA000
+/* The impulse response is set with AL_BUFFER on the effect slot. */
+#endif
+
+#ifndef AL_SOFT_deferred_commands
+#define AL_SOFT_deferred_commands
+/* Capability for alEnable/alDisable. While enabled, source property and state
+ * calls are recorded to a queue for the calling thread instead of taking the
+ * context's locks, and are applied (with any errors reported then) by the next
+ * alProcessUpdatesSOFT, or by a source query, deletion, or buffer queue call.
+ */
+#define AL_DEFERRED_COMMANDS_SOFT                0xC004
+#endif
+
+#ifndef AL_SOFT_source_batch
+#define AL_SOFT_source_batch
+/* Sets params[i] on sources[i] for each of the count entries, with each entry
+ * taking as many values as the property has.
+ */
+typedef void (AL_APIENTRY*LPALSOURCESFVSOFT)(ALsizei count, const ALuint *sources, const ALenum *params, const ALfloat *values);
+typedef void (AL_APIENTRY*LPALSOURCESIVSOFT)(ALsizei count, const ALuint *sources, const ALenum *params, const ALint *values);
+#ifdef AL_ALEXT_PROTOTYPES
+AL_API void AL_APIENTRY alSourcesfvSOFT(ALsizei count, const ALuint *sources, const ALenum *params, const ALfloat *values);
+AL_API void AL_APIENTRY alSourcesivSOFT(ALsizei count, const ALuint *sources, const ALenum *params, const ALint *values);
+#endif
+#endif
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
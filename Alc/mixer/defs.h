@@ -10,7 +10,10 @@
 struct MixGains;
 struct MixHrtfParams;
 struct HrtfState;
+struct HrtfSpectra;
+struct HrtfFftBuffers;
 struct DirectHrtfState;
+template<typename T> class ComplexFftPlan;
 
 
 struct CTag { };
@@ -33,12 +36,20 @@ template<typename InstTag>
 void Mix_(const ALfloat *data, const ALsizei OutChans, ALfloat (*OutBuffer)[BUFFERSIZE], ALfloat *CurrentGains, const ALfloat *TargetGains, const ALsizei Counter, const ALsizei OutPos, const ALsizei BufferSize);
 template<typename InstTag>
 void MixRow_(ALfloat *OutBuffer, const ALfloat *Gains, const ALfloat (*data)[BUFFERSIZE], const ALsizei InChans, const ALsizei InPos, const ALsizei BufferSize);
+template<typename InstTag>
+void MixMatrix_(ALfloat (*OutBuffer)[BUFFERSIZE], const ALsizei OutChans, const ALfloat *Gains, const ALsizei GainStride, const ALfloat (*data)[BUFFERSIZE], const ALsizei InChans, const ALsizei InPos, const ALsizei BufferSize);
 
 template<typename InstTag>
 void MixHrtf_(ALfloat *RESTRICT LeftOut, ALfloat *RESTRICT RightOut, const ALfloat *data, float2 *RESTRICT AccumSamples, const ALsizei OutPos, const ALsizei IrSize, MixHrtfParams *hrtfparams, const ALsizei BufferSize);
 template<typename InstTag>
 void MixHrtfBlend_(ALfloat *RESTRICT LeftOut, ALfloat *RESTRICT RightOut, const ALfloat *data, float2 *RESTRICT AccumSamples, const ALsizei OutPos, const ALsizei IrSize, const HrtfParams *oldparams, MixHrtfParams *newparams, const ALsizei BufferSize);
 template<typename InstTag>
+void MixHrtfFft_(ALfloat *RESTRICT LeftOut, ALfloat *RESTRICT RightOut, const ALfloat *data, float2 *RESTRICT AccumSamples, const ALsizei OutPos, const ALsizei IrSize, const HrtfSpectra *spectra, MixHrtfParams *hrtfparams, HrtfFftBuffers *buffers, const ALsizei BufferSize);
+template<typename InstTag>
+void MixHrtfFftBlend_(ALfloat *RESTRICT LeftOut, ALfloat *RESTRICT RightOut, const ALfloat *data, float2 *RESTRICT AccumSamples, const ALsizei OutPos, const ALsizei IrSize, const HrtfParams *oldparams, const HrtfSpectra *oldspectra, MixHrtfParams *newparams, const HrtfSpectra *newspectra, HrtfFftBuffers *buffers, const ALsizei BufferSize);
+/* Calculates the spectra the FFT mixers use for the given coefficients. */
+void CalcHrtfSpectra(const HrirArray<ALfloat> &coeffs, const ALsizei irSize, HrtfSpectra &spectra, const ComplexFftPlan<float> &plan);
+template<typename InstTag>
 void MixDirectHrtf_(ALfloat *RESTRICT LeftOut, ALfloat *RESTRICT RightOut, const ALfloat (*data)[BUFFERSIZE], float2 *RESTRICT AccumSamples, DirectHrtfState *State, const ALsizei NumChans, const ALsizei BufferSize);
 
 /* Vectorized resampler helpers */
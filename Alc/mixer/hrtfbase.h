@@ -2,10 +2,12 @@
 #define MIXER_HRTFBASE_H
 
 #include <algorithm>
+#include <complex>
 
 #include "alu.h"
 #include "../hrtf.h"
 #include "opthelpers.h"
+#include "alcomplex.h"
 
 
 using ApplyCoeffsT = void(ALsizei Offset, float2 *RESTRICT Values, const ALsizei irSize,
@@ -94,6 +96,160 @@ inline void MixHrtfBlendBase(ALfloat *RESTRICT LeftOut, ALfloat *RESTRICT RightO
     newparams->Gain = newGainStep*stepcount;
 }
 
+
+/* The frequency-domain mixers convolve the input with an overlap-add of
+ * HRTF_FFT_SIZE-point transforms. The left and right ear inputs are packed
+ * into the real and imaginary parts of one complex transform, and the filter
+ * spectra (from CalcHrtfSpectra) are arranged so the output of a single
+ * inverse transform holds the left and right results in its real and
+ * imaginary parts.
+ */
+using complex_f = std::complex<float>;
+
+/* Accumulates In*FilterA + conj(RevIn)*FilterB into Out, where RevIn holds
+ * the mirrored bins of In (RevIn[k] = In[N-k]).
+ */
+using ApplySpectrumT = void(complex_f *RESTRICT Out, const complex_f *RESTRICT In,
+    const complex_f *RESTRICT RevIn, const complex_f *RESTRICT FilterA,
+    const complex_f *RESTRICT FilterB, const ALsizei Count);
+
+/* Transforms the packed left/right input and creates its mirrored copy. */
+inline void TransformHrtfInput(const ComplexFftPlan<float> &plan, complex_f *RESTRICT In,
+    complex_f *RESTRICT RevIn)
+{
+    plan.forward(In);
+    RevIn[0] = In[0];
+    std::reverse_copy(In+1, In+HRTF_FFT_SIZE, RevIn+1);
+}
+
+template<ApplySpectrumT &ApplySpectrum>
+void MixHrtfFftBase(ALfloat *RESTRICT LeftOut, ALfloat *RESTRICT RightOut,
+    const ALfloat *data, float2 *RESTRICT AccumSamples, const ALsizei OutPos, const ALsizei IrSize,
+    const HrtfSpectra *spectra, MixHrtfParams *hrtfparams, HrtfFftBuffers *buffers,
+    const ALsizei BufferSize)
+{
+    ASSUME(OutPos >= 0);
+    ASSUME(IrSize >= 4 && IrSize <= HRIR_LENGTH);
+    ASSUME(BufferSize > 0);
+
+    const ALfloat gainstep{hrtfparams->GainStep};
+    const ALfloat gain{hrtfparams->Gain};
+    ALfloat stepcount{0.0f};
+
+    ALsizei Delay[2]{
+        HRTF_HISTORY_LENGTH - hrtfparams->Delay[0],
+        HRTF_HISTORY_LENGTH - hrtfparams->Delay[1] };
+    ASSUME(Delay[0] >= 0 && Delay[1] >= 0);
+
+    complex_f *RESTRICT input{buffers->Input[0]};
+    complex_f *RESTRICT revinput{buffers->RevInput[0]};
+    complex_f *RESTRICT output{buffers->Output};
+    const ALsizei chunksize{HRTF_FFT_SIZE - IrSize + 1};
+    for(ALsizei base{0};base < BufferSize;)
+    {
+        const ALsizei todo{mini(chunksize, BufferSize-base)};
+        for(ALsizei i{0};i < todo;++i)
+        {
+            const ALfloat g{gain + gainstep*stepcount};
+            input[i] = complex_f{data[Delay[0]++] * g, data[Delay[1]++] * g};
+            stepcount += 1.0f;
+        }
+        std::fill(input+todo, input+HRTF_FFT_SIZE, complex_f{});
+        TransformHrtfInput(buffers->Plan, input, revinput);
+
+        std::fill_n(output, HRTF_FFT_SIZE, complex_f{});
+        ApplySpectrum(output, input, revinput, spectra->A.data(), spectra->B.data(),
+            HRTF_FFT_SIZE);
+        buffers->Plan.inverse(output);
+
+        const ALsizei outlen{todo + IrSize - 1};
+        for(ALsizei i{0};i < outlen;++i)
+        {
+            AccumSamples[base+i][0] += output[i].real();
+            AccumSamples[base+i][1] += output[i].imag();
+        }
+        base += todo;
+    }
+    for(ALsizei i{0};i < BufferSize;++i)
+        LeftOut[OutPos+i]  += AccumSamples[i][0];
+    for(ALsizei i{0};i < BufferSize;++i)
+        RightOut[OutPos+i] += AccumSamples[i][1];
+
+    hrtfparams->Gain = gain + gainstep*stepcount;
+}
+
+template<ApplySpectrumT &ApplySpectrum>
+void MixHrtfFftBlendBase(ALfloat *RESTRICT LeftOut, ALfloat *RESTRICT RightOut,
+    const ALfloat *data, float2 *RESTRICT AccumSamples, const ALsizei OutPos, const ALsizei IrSize,
+    const HrtfParams *oldparams, const HrtfSpectra *oldspectra, MixHrtfParams *newparams,
+    const HrtfSpectra *newspectra, HrtfFftBuffers *buffers, const ALsizei BufferSize)
+{
+    const ALfloat oldGain{oldparams->Gain};
+    const ALfloat oldGainStep{-oldGain / static_cast<ALfloat>(BufferSize)};
+    const ALfloat newGainStep{newparams->GainStep};
+    ALfloat stepcount{0.0f};
+
+    ASSUME(OutPos >= 0);
+    ASSUME(IrSize >= 4 && IrSize <= HRIR_LENGTH);
+    ASSUME(BufferSize > 0);
+
+    ALsizei OldDelay[2]{
+        HRTF_HISTORY_LENGTH - oldparams->Delay[0],
+        HRTF_HISTORY_LENGTH - oldparams->Delay[1] };
+    ASSUME(OldDelay[0] >= 0 && OldDelay[1] >= 0);
+    ALsizei NewDelay[2]{
+        HRTF_HISTORY_LENGTH - newparams->Delay[0],
+        HRTF_HISTORY_LENGTH - newparams->Delay[1] };
+    ASSUME(NewDelay[0] >= 0 && NewDelay[1] >= 0);
+
+    /* The old and new inputs are filtered separately, but the results are
+     * crossfaded in the frequency domain, needing only one inverse transform.
+     */
+    complex_f *RESTRICT oldin{buffers->Input[0]};
+    complex_f *RESTRICT oldrev{buffers->RevInput[0]};
+    complex_f *RESTRICT newin{buffers->Input[1]};
+    complex_f *RESTRICT newrev{buffers->RevInput[1]};
+    complex_f *RESTRICT output{buffers->Output};
+    const ALsizei chunksize{HRTF_FFT_SIZE - IrSize + 1};
+    for(ALsizei base{0};base < BufferSize;)
+    {
+        const ALsizei todo{mini(chunksize, BufferSize-base)};
+        for(ALsizei i{0};i < todo;++i)
+        {
+            const ALfloat og{oldGain + oldGainStep*stepcount};
+            oldin[i] = complex_f{data[OldDelay[0]++] * og, data[OldDelay[1]++] * og};
+            const ALfloat ng{newGainStep*stepcount};
+            newin[i] = complex_f{data[NewDelay[0]++] * ng, data[NewDelay[1]++] * ng};
+            stepcount += 1.0f;
+        }
+        std::fill(oldin+todo, oldin+HRTF_FFT_SIZE, complex_f{});
+        std::fill(newin+todo, newin+HRTF_FFT_SIZE, complex_f{});
+        TransformHrtfInput(buffers->Plan, oldin, oldrev);
+        TransformHrtfInput(buffers->Plan, newin, newrev);
+
+        std::fill_n(output, HRTF_FFT_SIZE, complex_f{});
+        ApplySpectrum(output, oldin, oldrev, oldspectra->A.data(), oldspectra->B.data(),
+            HRTF_FFT_SIZE);
+        ApplySpectrum(output, newin, newrev, newspectra->A.data(), newspectra->B.data(),
+            HRTF_FFT_SIZE);
+        buffers->Plan.inverse(output);
+
+        const ALsizei outlen{todo + IrSize - 1};
+        for(ALsizei i{0};i < outlen;++i)
+        {
+            AccumSamples[base+i][0] += output[i].real();
+            AccumSamples[base+i][1] += output[i].imag();
+        }
+        base += todo;
+    }
+    for(ALsizei i{0};i < BufferSize;++i)
+        LeftOut[OutPos+i]  += AccumSamples[i][0];
+    for(ALsizei i{0};i < BufferSize;++i)
+        RightOut[OutPos+i] += AccumSamples[i][1];
+
+    newparams->Gain = newGainStep*stepcount;
+}
+
 template<ApplyCoeffsT &ApplyCoeffs>
 inline void MixDirectHrtfBase(ALfloat *RESTRICT LeftOut, ALfloat *RESTRICT RightOut,
     const ALfloat (*data)[BUFFERSIZE], float2 *RESTRICT AccumSamples, DirectHrtfState *State,
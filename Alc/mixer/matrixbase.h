@@ -0,0 +1,107 @@
+#ifndef MIXER_MATRIXBASE_H
+#define MIXER_MATRIXBASE_H
+
+#include <algorithm>
+
+#include "alu.h"
+#include "opthelpers.h"
+
+
+/* Number of samples a matrix mix processes for all outputs before moving on,
+ * keeping that part of every input channel in the cache.
+ */
+constexpr ALsizei MatrixTileSize{256};
+
+/* Most output rows mixed together, with each input sample being loaded once
+ * for all of them.
+ */
+constexpr ALsizei MatrixRowBlock{4};
+
+/* Mixes todo samples of each of the NumIns inputs to NumRows (up to
+ * MatrixRowBlock) outputs, with Gains[c][r] being the gain from input c to
+ * output r. Each output's terms are added in input order, as with MixRow_.
+ */
+using ApplyMatrixRowsT = void(ALfloat *const *RESTRICT OutBuffer, const ALsizei NumRows,
+    const ALfloat (*RESTRICT Gains)[MatrixRowBlock], const ALfloat *const *RESTRICT InSamples,
+    const ALsizei NumIns, const ALsizei todo);
+
+template<ApplyMatrixRowsT &ApplyRows>
+void MixMatrixBase(ALfloat (*OutBuffer)[BUFFERSIZE], const ALsizei OutChans,
+    const ALfloat *Gains, const ALsizei GainStride, const ALfloat (*data)[BUFFERSIZE],
+    const ALsizei InChans, const ALsizei InPos, const ALsizei BufferSize)
+{
+    ASSUME(OutChans > 0);
+    ASSUME(OutChans <= MAX_OUTPUT_CHANNELS);
+    ASSUME(InChans > 0);
+    ASSUME(InChans <= static_cast<ALsizei>(MAX_AMBI_CHANNELS));
+    ASSUME(BufferSize > 0);
+
+    struct RowBlock {
+        ALsizei NumRows;
+        ALsizei NumIns;
+        ALsizei Rows[MatrixRowBlock];
+        ALsizei Ins[MAX_AMBI_CHANNELS];
+        ALfloat Gains[MAX_AMBI_CHANNELS][MatrixRowBlock];
+    };
+    RowBlock blocks[(MAX_OUTPUT_CHANNELS+MatrixRowBlock-1) / MatrixRowBlock];
+    ALsizei numblocks{0};
+
+    auto is_audible = [](const ALfloat gain) noexcept -> bool
+    { return std::fabs(gain) > GAIN_SILENCE_THRESHOLD; };
+
+    /* Group the outputs that have any audible gain into blocks, and for each
+     * block, find the inputs with any audible gain to its outputs. Inaudible
+     * gains are zeroed, which leaves the sums the same as skipping them.
+     */
+    for(ALsizei out{0};out < OutChans;++out)
+    {
+        const ALfloat *row{Gains + out*GainStride};
+        if(std::none_of(row, row+InChans, is_audible))
+            continue;
+
+        if(numblocks == 0 || blocks[numblocks-1].NumRows == MatrixRowBlock)
+            blocks[numblocks++].NumRows = 0;
+        RowBlock &block = blocks[numblocks-1];
+        block.Rows[block.NumRows++] = out;
+    }
+    std::for_each(blocks, blocks+numblocks,
+        [Gains,GainStride,InChans,is_audible](RowBlock &block) -> void
+        {
+            block.NumIns = 0;
+            for(ALsizei c{0};c < InChans;++c)
+            {
+                ALfloat (&gains)[MatrixRowBlock] = block.Gains[block.NumIns];
+                bool audible{false};
+                for(ALsizei r{0};r < MatrixRowBlock;++r)
+                {
+                    const ALfloat gain{(r < block.NumRows) ?
+                        Gains[block.Rows[r]*GainStride + c] : 0.0f};
+                    gains[r] = is_audible(gain) ? gain : 0.0f;
+                    audible |= is_audible(gain);
+                }
+                if(audible)
+                    block.Ins[block.NumIns++] = c;
+            }
+        }
+    );
+
+    for(ALsizei base{0};base < BufferSize;base += MatrixTileSize)
+    {
+        const ALsizei todo{mini(MatrixTileSize, BufferSize-base)};
+        std::for_each(blocks, blocks+numblocks,
+            [OutBuffer,data,InPos,base,todo](const RowBlock &block) -> void
+            {
+                ALfloat *outs[MatrixRowBlock];
+                for(ALsizei r{0};r < block.NumRows;++r)
+                    outs[r] = OutBuffer[block.Rows[r]] + base;
+                const ALfloat *ins[MAX_AMBI_CHANNELS];
+                for(ALsizei c{0};c < block.NumIns;++c)
+                    ins[c] = data[block.Ins[c]] + InPos + base;
+
+                ApplyRows(outs, block.NumRows, block.Gains, ins, block.NumIns, todo);
+            }
+        );
+    }
+}
+
+#endif /* MIXER_MATRIXBASE_H */
@@ -1,6 +1,7 @@
 #include "config.h"
 
 #include <cassert>
+#include <cmath>
 
 #include <limits>
 
@@ -10,6 +11,37 @@
 #include "alAuxEffectSlot.h"
 #include "defs.h"
 #include "hrtfbase.h"
+#include "bsinc_inc.h"
+
+
+/* Prepares the interpolator for a given rate (determined by increment).
+ *
+ * With a bit of work, and a trade of memory for CPU cost, this could be
+ * modified for use with an interpolated increment for buttery-smooth pitch
+ * changes.
+ */
+void BsincPrepare(const ALuint increment, BsincState *state, const BSincTable *table)
+{
+    ALsizei si{BSINC_SCALE_COUNT - 1};
+    ALfloat sf{0.0f};
+
+    if(increment > FRACTIONONE)
+    {
+        sf = static_cast<ALfloat>FRACTIONONE / increment;
+        sf = maxf(0.0f, (BSINC_SCALE_COUNT-1) * (sf-table->scaleBase) * table->scaleRange);
+        si = float2int(sf);
+        /* The interpolation factor is fit to this diagonally-symmetric curve
+         * to reduce the transition ripple caused by interpolating different
+         * scales of the sinc function.
+         */
+        sf = 1.0f - std::cos(std::asin(sf - si));
+    }
+
+    state->sf = sf;
+    state->m = table->m[si];
+    state->l = (state->m/2) - 1;
+    state->filter = table->Tab + table->filterOffset[si];
+}
 
 
 static inline ALfloat do_point(const InterpState&, const ALfloat *RESTRICT vals, const ALsizei) noexcept
@@ -114,6 +146,61 @@ static inline void ApplyCoeffs(ALsizei /*Offset*/, float2 *RESTRICT Values, cons
     }
 }
 
+static inline void ApplySpectrum(complex_f *RESTRICT Out, const complex_f *RESTRICT In,
+    const complex_f *RESTRICT RevIn, const complex_f *RESTRICT FilterA,
+    const complex_f *RESTRICT FilterB, const ALsizei Count)
+{
+    ASSUME(Count > 0);
+    for(ALsizei i{0};i < Count;++i)
+    {
+        const ALfloat ar{FilterA[i].real()}, ai{FilterA[i].imag()};
+        const ALfloat br{FilterB[i].real()}, bi{FilterB[i].imag()};
+        const ALfloat xr{In[i].real()}, xi{In[i].imag()};
+        const ALfloat yr{RevIn[i].real()}, yi{RevIn[i].imag()};
+        /* Out += In*A + conj(RevIn)*B */
+        Out[i] += complex_f{xr*ar - xi*ai + yr*br + yi*bi,
+                            xr*ai + xi*ar + yr*bi - yi*br};
+    }
+}
+
+void CalcHrtfSpectra(const HrirArray<ALfloat> &coeffs, const ALsizei irSize,
+    HrtfSpectra &spectra, const ComplexFftPlan<float> &plan)
+{
+    /* Transform the left and right responses together, as the real and
+     * imaginary parts of one signal. B holds the result until it's separated.
+     */
+    auto &resp = spectra.B;
+    auto resp_end = std::transform(coeffs.cbegin(), coeffs.cbegin()+irSize, resp.begin(),
+        [](const std::array<ALfloat,2> &c) noexcept -> complex_f
+        { return complex_f{c[0], c[1]}; });
+    std::fill(resp_end, resp.end(), complex_f{});
+    plan.forward(resp.data());
+
+    /* Separate the left and right responses (L = (G[k] + G*[N-k]) / 2,
+     * R = (G[k] - G*[N-k]) / 2i), then store (L+R)/2 and (L-R)/2 with the
+     * inverse transform's scaling. Bins k and N-k are read before either is
+     * written, so this can work in place.
+     */
+    constexpr ALfloat scale{0.5f / HRTF_FFT_SIZE};
+    auto store = [&spectra](const size_t k, const complex_f g, const complex_f gr) noexcept
+        -> void
+    {
+        const complex_f left{(g.real()+gr.real())*0.5f, (g.imag()+gr.imag())*0.5f};
+        const complex_f right{(g.imag()-gr.imag())*0.5f, (gr.real()-g.real())*0.5f};
+        spectra.A[k] = complex_f{(left.real()+right.real())*scale,
+            (left.imag()+right.imag())*scale};
+        spectra.B[k] = complex_f{(left.real()-right.real())*scale,
+            (left.imag()-right.imag())*scale};
+    };
+    for(size_t k{0};k <= HRTF_FFT_SIZE/2;++k)
+    {
+        const size_t m{(HRTF_FFT_SIZE-k) & (HRTF_FFT_SIZE-1)};
+        const complex_f gk{resp[k]}, gm{resp[m]};
+        store(k, gk, std::conj(gm));
+        store(m, gm, std::conj(gk));
+    }
+}
+
 template<>
 void MixHrtf_<CTag>(ALfloat *RESTRICT LeftOut, ALfloat *RESTRICT RightOut, const ALfloat *data,
     float2 *RESTRICT AccumSamples, const ALsizei OutPos, const ALsizei IrSize,
@@ -132,6 +219,26 @@ void MixHrtfBlend_<CTag>(ALfloat *RESTRICT LeftOut, ALfloat *RESTRICT RightOut,
         newparams, BufferSize);
 }
 
+template<>
+void MixHrtfFft_<CTag>(ALfloat *RESTRICT LeftOut, ALfloat *RESTRICT RightOut,
+    const ALfloat *data, float2 *RESTRICT AccumSamples, const ALsizei OutPos, const ALsizei IrSize,
+    const HrtfSpectra *spectra, MixHrtfParams *hrtfparams, HrtfFftBuffers *buffers,
+    const ALsizei BufferSize)
+{
+    MixHrtfFftBase<ApplySpectrum>(LeftOut, RightOut, data, AccumSamples, OutPos, IrSize,
+        spectra, hrtfparams, buffers, BufferSize);
+}
+
+template<>
+void MixHrtfFftBlend_<CTag>(ALfloat *RESTRICT LeftOut, ALfloat *RESTRICT RightOut,
+    const ALfloat *data, float2 *RESTRICT AccumSamples, const ALsizei OutPos, const ALsizei IrSize,
+    const HrtfParams *oldparams, const HrtfSpectra *oldspectra, MixHrtfParams *newparams,
+    const HrtfSpectra *newspectra, HrtfFftBuffers *buffers, const ALsizei BufferSize)
+{
+    MixHrtfFftBlendBase<ApplySpectrum>(LeftOut, RightOut, data, AccumSamples, OutPos, IrSize,
+        oldparams, oldspectra, newparams, newspectra, buffers, BufferSize);
+}
+
 template<>
 void MixDirectHrtf_<CTag>(ALfloat *RESTRICT LeftOut, ALfloat *RESTRICT RightOut,
     const ALfloat (*data)[BUFFERSIZE], float2 *RESTRICT AccumSamples, DirectHrtfState *State,
@@ -206,3 +313,19 @@ void MixRow_<CTag>(ALfloat *OutBuffer, const ALfloat *Gains, const ALfloat (*dat
             OutBuffer[i] += src[i] * gain;
     }
 }
+
+/* Applies a whole matrix transform, mixing each of the inputs to each of the
+ * outputs. Without SIMD, there's nothing to gain from blocking rows together
+ * (the compiler can vectorize the row mixer better on its own), so this just
+ * mixes each row in turn.
+ */
+template<>
+void MixMatrix_<CTag>(ALfloat (*OutBuffer)[BUFFERSIZE], const ALsizei OutChans,
+    const ALfloat *Gains, const ALsizei GainStride, const ALfloat (*data)[BUFFERSIZE],
+    const ALsizei InChans, const ALsizei InPos, const ALsizei BufferSize)
+{
+    ASSUME(OutChans > 0);
+
+    for(ALsizei c{0};c < OutChans;c++)
+        MixRow_<CTag>(OutBuffer[c], Gains + c*GainStride, data, InChans, InPos, BufferSize);
+}
@@ -11,6 +11,7 @@
 #include "hrtf.h"
 #include "defs.h"
 #include "hrtfbase.h"
+#include "matrixbase.h"
 
 
 
@@ -162,6 +163,39 @@ static inline void ApplyCoeffs(ALsizei /*Offset*/, float2 *RESTRICT Values, cons
     }
 }
 
+static inline void ApplySpectrum(complex_f *RESTRICT Out, const complex_f *RESTRICT In,
+    const complex_f *RESTRICT RevIn, const complex_f *RESTRICT FilterA,
+    const complex_f *RESTRICT FilterB, const ALsizei Count)
+{
+    alignas(16) static constexpr float negre_vals[4]{-1.0f, 1.0f, -1.0f, 1.0f};
+    alignas(16) static constexpr float negim_vals[4]{1.0f, -1.0f, 1.0f, -1.0f};
+    const float32x4_t negre{vld1q_f32(negre_vals)};
+    const float32x4_t negim{vld1q_f32(negim_vals)};
+
+    ASSUME(Count > 0);
+    /* Processes two complex values at a time, [r0 i0 r1 i1]. */
+    for(ALsizei i{0};i < Count;i += 2)
+    {
+        const float32x4_t x{vld1q_f32(reinterpret_cast<const float*>(&In[i]))};
+        const float32x4_t y{vld1q_f32(reinterpret_cast<const float*>(&RevIn[i]))};
+        const float32x4_t a{vld1q_f32(reinterpret_cast<const float*>(&FilterA[i]))};
+        const float32x4_t b{vld1q_f32(reinterpret_cast<const float*>(&FilterB[i]))};
+        float32x4_t out{vld1q_f32(reinterpret_cast<float*>(&Out[i]))};
+
+        /* out += x*a = [xr*ar - xi*ai, xr*ai + xi*ar] */
+        const float32x4x2_t xri{vtrnq_f32(x, x)};
+        out = vmlaq_f32(out, xri.val[0], a);
+        out = vmlaq_f32(out, vmulq_f32(xri.val[1], vrev64q_f32(a)), negre);
+
+        /* out += conj(y)*b = [yr*br + yi*bi, yr*bi - yi*br] */
+        const float32x4x2_t yri{vtrnq_f32(y, y)};
+        out = vmlaq_f32(out, yri.val[0], b);
+        out = vmlaq_f32(out, vmulq_f32(yri.val[1], vrev64q_f32(b)), negim);
+
+        vst1q_f32(reinterpret_cast<float*>(&Out[i]), out);
+    }
+}
+
 template<>
 void MixHrtf_<NEONTag>(ALfloat *RESTRICT LeftOut, ALfloat *RESTRICT RightOut, const ALfloat *data,
     float2 *RESTRICT AccumSamples, const ALsizei OutPos, const ALsizei IrSize,
@@ -180,6 +214,16 @@ void MixHrtfBlend_<NEONTag>(ALfloat *RESTRICT LeftOut, ALfloat *RESTRICT RightOu
         newparams, BufferSize);
 }
 
+template<>
+void MixHrtfFft_<NEONTag>(ALfloat *RESTRICT LeftOut, ALfloat *RESTRICT RightOut,
+    const ALfloat *data, float2 *RESTRICT AccumSamples, const ALsizei OutPos, const ALsizei IrSize,
+    const HrtfSpectra *spectra, MixHrtfParams *hrtfparams, HrtfFftBuffers *buffers,
+    const ALsizei BufferSize)
+{
+    MixHrtfFftBase<ApplySpectrum>(LeftOut, RightOut, data, AccumSamples, OutPos, IrSize,
+        spectra, hrtfparams, buffers, BufferSize);
+}
+
 template<>
 void MixDirectHrtf_<NEONTag>(ALfloat *RESTRICT LeftOut, ALfloat *RESTRICT RightOut,
     const ALfloat (*data)[BUFFERSIZE], float2 *RESTRICT AccumSamples, DirectHrtfState *State,
@@ -307,3 +351,89 @@ void MixRow_<NEONTag>(ALfloat *OutBuffer, const ALfloat *Gains, const ALfloat (*
             OutBuffer[pos] += src[pos]*gain;
     }
 }
+
+template<ALsizei NumRows>
+static void ApplyMatrixRowsNEON(ALfloat *const *RESTRICT OutBuffer,
+    const ALfloat (*RESTRICT Gains)[MatrixRowBlock], const ALfloat *const *RESTRICT InSamples,
+    const ALsizei NumIns, const ALsizei todo)
+{
+    static_assert(NumRows > 0 && NumRows <= 4, "Invalid row count");
+
+    /* The sums are kept in named registers (the compiler won't reliably keep
+     * an array of them out of memory), with two vectors of samples done at a
+     * time so each output has two independent sums in flight.
+     */
+#define LOAD_ROW(r) do {                                                      \
+    if(NumRows > r)                                                           \
+    {                                                                         \
+        sum##r##a = vld1q_f32(&OutBuffer[r][pos]);                            \
+        sum##r##b = vld1q_f32(&OutBuffer[r][pos+4]);                          \
+    }                                                                         \
+} while(0)
+#define MIX_ROW(r) do {                                                       \
+    if(NumRows > r)                                                           \
+    {                                                                         \
+        sum##r##a = vmlaq_n_f32(sum##r##a, val4a, Gains[c][r]);               \
+        sum##r##b = vmlaq_n_f32(sum##r##b, val4b, Gains[c][r]);               \
+    }                                                                         \
+} while(0)
+#define STORE_ROW(r) do {                                                     \
+    if(NumRows > r)                                                           \
+    {                                                                         \
+        vst1q_f32(&OutBuffer[r][pos], sum##r##a);                             \
+        vst1q_f32(&OutBuffer[r][pos+4], sum##r##b);                           \
+    }                                                                         \
+} while(0)
+
+    ALsizei pos{0};
+    for(;pos+8 <= todo;pos += 8)
+    {
+        float32x4_t sum0a{}, sum0b{}, sum1a{}, sum1b{}, sum2a{}, sum2b{}, sum3a{}, sum3b{};
+        LOAD_ROW(0); LOAD_ROW(1); LOAD_ROW(2); LOAD_ROW(3);
+        for(ALsizei c{0};c < NumIns;c++)
+        {
+            const float32x4_t val4a{vld1q_f32(&InSamples[c][pos])};
+            const float32x4_t val4b{vld1q_f32(&InSamples[c][pos+4])};
+            MIX_ROW(0); MIX_ROW(1); MIX_ROW(2); MIX_ROW(3);
+        }
+        STORE_ROW(0); STORE_ROW(1); STORE_ROW(2); STORE_ROW(3);
+    }
+#undef STORE_ROW
+#undef MIX_ROW
+#undef LOAD_ROW
+    for(;pos < todo;pos++)
+    {
+        for(ALsizei r{0};r < NumRows;r++)
+        {
+            ALfloat accum{OutBuffer[r][pos]};
+            for(ALsizei c{0};c < NumIns;c++)
+                accum += InSamples[c][pos] * Gains[c][r];
+            OutBuffer[r][pos] = accum;
+        }
+    }
+}
+
+static void ApplyMatrixRows(ALfloat *const *RESTRICT OutBuffer, const ALsizei NumRows,
+    const ALfloat (*RESTRICT Gains)[MatrixRowBlock], const ALfloat *const *RESTRICT InSamples,
+    const ALsizei NumIns, const ALsizei todo)
+{
+    ASSUME(NumIns > 0);
+    ASSUME(todo > 0);
+
+    switch(NumRows)
+    {
+    case 1: ApplyMatrixRowsNEON<1>(OutBuffer, Gains, InSamples, NumIns, todo); break;
+    case 2: ApplyMatrixRowsNEON<2>(OutBuffer, Gains, InSamples, NumIns, todo); break;
+    case 3: ApplyMatrixRowsNEON<3>(OutBuffer, Gains, InSamples, NumIns, todo); break;
+    case 4: ApplyMatrixRowsNEON<4>(OutBuffer, Gains, InSamples, NumIns, todo); break;
+    }
+}
+
+template<>
+void MixMatrix_<NEONTag>(ALfloat (*OutBuffer)[BUFFERSIZE], const ALsizei OutChans,
+    const ALfloat *Gains, const ALsizei GainStride, const ALfloat (*data)[BUFFERSIZE],
+    const ALsizei InChans, const ALsizei InPos, const ALsizei BufferSize)
+{
+    MixMatrixBase<ApplyMatrixRows>(OutBuffer, OutChans, Gains, GainStride, data, InChans, InPos,
+        BufferSize);
+}
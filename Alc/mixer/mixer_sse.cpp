@@ -2,6 +2,7 @@
 
 #include <xmmintrin.h>
 
+#include <cassert>
 #include <limits>
 
 #include "AL/al.h"
@@ -13,6 +14,7 @@
 #include "alAuxEffectSlot.h"
 #include "defs.h"
 #include "hrtfbase.h"
+#include "matrixbase.h"
 
 
 template<>
@@ -119,6 +121,41 @@ static inline void ApplyCoeffs(ALsizei Offset, float2 *RESTRICT Values, const AL
     }
 }
 
+static inline void ApplySpectrum(complex_f *RESTRICT Out, const complex_f *RESTRICT In,
+    const complex_f *RESTRICT RevIn, const complex_f *RESTRICT FilterA,
+    const complex_f *RESTRICT FilterB, const ALsizei Count)
+{
+    const __m128 negre{_mm_setr_ps(-1.0f, 1.0f, -1.0f, 1.0f)};
+    const __m128 negim{_mm_setr_ps(1.0f, -1.0f, 1.0f, -1.0f)};
+
+    ASSUME(Count > 0);
+    /* Processes two complex values at a time, [r0 i0 r1 i1]. */
+    for(ALsizei i{0};i < Count;i += 2)
+    {
+        const __m128 x{_mm_load_ps(reinterpret_cast<const float*>(&In[i]))};
+        const __m128 y{_mm_load_ps(reinterpret_cast<const float*>(&RevIn[i]))};
+        const __m128 a{_mm_load_ps(reinterpret_cast<const float*>(&FilterA[i]))};
+        const __m128 b{_mm_load_ps(reinterpret_cast<const float*>(&FilterB[i]))};
+        __m128 out{_mm_load_ps(reinterpret_cast<float*>(&Out[i]))};
+
+        /* out += x*a = [xr*ar - xi*ai, xr*ai + xi*ar] */
+        const __m128 xr{_mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 2, 0, 0))};
+        const __m128 xi{_mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 1, 1))};
+        const __m128 aswap{_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1))};
+        out = _mm_add_ps(out, _mm_mul_ps(xr, a));
+        out = _mm_add_ps(out, _mm_mul_ps(_mm_mul_ps(xi, aswap), negre));
+
+        /* out += conj(y)*b = [yr*br + yi*bi, yr*bi - yi*br] */
+        const __m128 yr{_mm_shuffle_ps(y, y, _MM_SHUFFLE(2, 2, 0, 0))};
+        const __m128 yi{_mm_shuffle_ps(y, y, _MM_SHUFFLE(3, 3, 1, 1))};
+        const __m128 bswap{_mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 3, 0, 1))};
+        out = _mm_add_ps(out, _mm_mul_ps(yr, b));
+        out = _mm_add_ps(out, _mm_mul_ps(_mm_mul_ps(yi, bswap), negim));
+
+        _mm_store_ps(reinterpret_cast<float*>(&Out[i]), out);
+    }
+}
+
 template<>
 void MixHrtf_<SSETag>(ALfloat *RESTRICT LeftOut, ALfloat *RESTRICT RightOut, const ALfloat *data,
     float2 *RESTRICT AccumSamples, const ALsizei OutPos, const ALsizei IrSize,
@@ -137,6 +174,16 @@ void MixHrtfBlend_<SSETag>(ALfloat *RESTRICT LeftOut, ALfloat *RESTRICT RightOut
         newparams, BufferSize);
 }
 
+template<>
+void MixHrtfFft_<SSETag>(ALfloat *RESTRICT LeftOut, ALfloat *RESTRICT RightOut,
+    const ALfloat *data, float2 *RESTRICT AccumSamples, const ALsizei OutPos, const ALsizei IrSize,
+    const HrtfSpectra *spectra, MixHrtfParams *hrtfparams, HrtfFftBuffers *buffers,
+    const ALsizei BufferSize)
+{
+    MixHrtfFftBase<ApplySpectrum>(LeftOut, RightOut, data, AccumSamples, OutPos, IrSize,
+        spectra, hrtfparams, buffers, BufferSize);
+}
+
 template<>
 void MixDirectHrtf_<SSETag>(ALfloat *RESTRICT LeftOut, ALfloat *RESTRICT RightOut,
     const ALfloat (*data)[BUFFERSIZE], float2 *RESTRICT AccumSamples, DirectHrtfState *State,
@@ -261,3 +308,101 @@ void MixRow_<SSETag>(ALfloat *OutBuffer, const ALfloat *Gains, const ALfloat (*d
             OutBuffer[pos] += src[pos]*gain;
     }
 }
+
+template<ALsizei NumRows>
+static void ApplyMatrixRowsSSE(ALfloat *const *RESTRICT OutBuffer,
+    const ALfloat (*RESTRICT Gains)[MatrixRowBlock], const ALfloat *const *RESTRICT InSamples,
+    const ALsizei NumIns, const ALsizei todo)
+{
+    static_assert(NumRows > 0 && NumRows <= 4, "Invalid row count");
+
+    alignas(16) ALfloat gains4[MAX_AMBI_CHANNELS][MatrixRowBlock][4];
+    for(ALsizei c{0};c < NumIns;c++)
+    {
+        for(ALsizei r{0};r < NumRows;r++)
+            _mm_store_ps(gains4[c][r], _mm_set1_ps(Gains[c][r]));
+    }
+
+    /* The sums are kept in named registers (the compiler won't reliably keep
+     * an array of them out of memory), with two vectors of samples done at a
+     * time so each output has two independent sums in flight.
+     */
+#define LOAD_ROW(r) do {                                                      \
+    if(NumRows > r)                                                           \
+    {                                                                         \
+        sum##r##a = _mm_load_ps(al::assume_aligned<16>(&OutBuffer[r][pos]));  \
+        sum##r##b = _mm_load_ps(al::assume_aligned<16>(&OutBuffer[r][pos+4])); \
+    }                                                                         \
+} while(0)
+#define MIX_ROW(r) do {                                                       \
+    if(NumRows > r)                                                           \
+    {                                                                         \
+        const __m128 gain4{_mm_load_ps(gains4[c][r])};                        \
+        sum##r##a = _mm_add_ps(sum##r##a, _mm_mul_ps(val4a, gain4));          \
+        sum##r##b = _mm_add_ps(sum##r##b, _mm_mul_ps(val4b, gain4));          \
+    }                                                                         \
+} while(0)
+#define STORE_ROW(r) do {                                                     \
+    if(NumRows > r)                                                           \
+    {                                                                         \
+        _mm_store_ps(al::assume_aligned<16>(&OutBuffer[r][pos]), sum##r##a);  \
+        _mm_store_ps(al::assume_aligned<16>(&OutBuffer[r][pos+4]), sum##r##b); \
+    }                                                                         \
+} while(0)
+
+    ALsizei pos{0};
+    for(;pos+8 <= todo;pos += 8)
+    {
+        __m128 sum0a{}, sum0b{}, sum1a{}, sum1b{}, sum2a{}, sum2b{}, sum3a{}, sum3b{};
+        LOAD_ROW(0); LOAD_ROW(1); LOAD_ROW(2); LOAD_ROW(3);
+        for(ALsizei c{0};c < NumIns;c++)
+        {
+            const __m128 val4a{_mm_load_ps(al::assume_aligned<16>(&InSamples[c][pos]))};
+            const __m128 val4b{_mm_load_ps(al::assume_aligned<16>(&InSamples[c][pos+4]))};
+            MIX_ROW(0); MIX_ROW(1); MIX_ROW(2); MIX_ROW(3);
+        }
+        STORE_ROW(0); STORE_ROW(1); STORE_ROW(2); STORE_ROW(3);
+    }
+#undef STORE_ROW
+#undef MIX_ROW
+#undef LOAD_ROW
+    for(;pos < todo;pos++)
+    {
+        for(ALsizei r{0};r < NumRows;r++)
+        {
+            ALfloat accum{OutBuffer[r][pos]};
+            for(ALsizei c{0};c < NumIns;c++)
+                accum += InSamples[c][pos] * Gains[c][r];
+            OutBuffer[r][pos] = accum;
+        }
+    }
+}
+
+static void ApplyMatrixRows(ALfloat *const *RESTRICT OutBuffer, const ALsizei NumRows,
+    const ALfloat (*RESTRICT Gains)[MatrixRowBlock], const ALfloat *const *RESTRICT InSamples,
+    const ALsizei NumIns, const ALsizei todo)
+{
+    ASSUME(NumIns > 0);
+    ASSUME(todo > 0);
+
+    switch(NumRows)
+    {
+    case 1: ApplyMatrixRowsSSE<1>(OutBuffer, Gains, InSamples, NumIns, todo); break;
+    case 2: ApplyMatrixRowsSSE<2>(OutBuffer, Gains, InSamples, NumIns, todo); break;
+    case 3: ApplyMatrixRowsSSE<3>(OutBuffer, Gains, InSamples, NumIns, todo); break;
+    case 4: ApplyMatrixRowsSSE<4>(OutBuffer, Gains, InSamples, NumIns, todo); break;
+    }
+}
+
+template<>
+void MixMatrix_<SSETag>(ALfloat (*OutBuffer)[BUFFERSIZE], const ALsizei OutChans,
+    const ALfloat *Gains, const ALsizei GainStride, const ALfloat (*data)[BUFFERSIZE],
+    const ALsizei InChans, const ALsizei InPos, const ALsizei BufferSize)
+{
+    /* The input samples are read with aligned loads, so the offset has to
+     * keep them 16-byte aligned.
+     */
+    assert((InPos&3) == 0);
+    MixMatrixBase<ApplyMatrixRows>(OutBuffer, OutChans, Gains, GainStride, data, InChans, InPos,
+        BufferSize);
+}
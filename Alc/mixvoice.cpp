@@ -28,6 +28,7 @@
 
 #include <numeric>
 #include <algorithm>
+#include <type_traits>
 
 #include "AL/al.h"
 #include "AL/alc.h"
@@ -38,7 +39,6 @@
 #include "alBuffer.h"
 #include "alListener.h"
 #include "alAuxEffectSlot.h"
-#include "sample_cvt.h"
 #include "alu.h"
 #include "alconfig.h"
 #include "ringbuffer.h"
@@ -58,8 +58,18 @@ Resampler ResamplerDefault = LinearResampler;
 
 MixerFunc MixSamples = Mix_<CTag>;
 RowMixerFunc MixRowSamples = MixRow_<CTag>;
+MatrixMixerFunc MixMatrixSamples = MixMatrix_<CTag>;
 static HrtfMixerFunc MixHrtfSamples = MixHrtf_<CTag>;
 static HrtfMixerBlendFunc MixHrtfBlendSamples = MixHrtfBlend_<CTag>;
+static HrtfFftMixerFunc MixHrtfFftSamples = MixHrtfFft_<CTag>;
+static HrtfFftMixerBlendFunc MixHrtfFftBlendSamples = MixHrtfFftBlend_<CTag>;
+
+/* Minimum HRIR length to use frequency-domain convolution for, and the minimum
+ * number of samples for the non-blending mixer (shorter mixes don't amortize
+ * the transforms well enough).
+ */
+constexpr ALsizei HrtfFftMinIrSize{96};
+constexpr ALsizei HrtfFftMinSamples{512};
 
 static MixerFunc SelectMixer()
 {
@@ -87,6 +97,19 @@ static RowMixerFunc SelectRowMixer()
     return MixRow_<CTag>;
 }
 
+static MatrixMixerFunc SelectMatrixMixer()
+{
+#ifdef HAVE_NEON
+    if((CPUCapFlags&CPU_CAP_NEON))
+        return MixMatrix_<NEONTag>;
+#endif
+#ifdef HAVE_SSE
+    if((CPUCapFlags&CPU_CAP_SSE))
+        return MixMatrix_<SSETag>;
+#endif
+    return MixMatrix_<CTag>;
+}
+
 static inline HrtfMixerFunc SelectHrtfMixer()
 {
 #ifdef HAVE_NEON
@@ -113,6 +136,35 @@ static inline HrtfMixerBlendFunc SelectHrtfBlendMixer()
     return MixHrtfBlend_<CTag>;
 }
 
+static inline HrtfFftMixerFunc SelectHrtfFftMixer()
+{
+#ifdef HAVE_NEON
+    if((CPUCapFlags&CPU_CAP_NEON))
+        return MixHrtfFft_<NEONTag>;
+#endif
+#ifdef HAVE_SSE
+    if((CPUCapFlags&CPU_CAP_SSE))
+        return MixHrtfFft_<SSETag>;
+#endif
+    return MixHrtfFft_<CTag>;
+}
+
+/* Blends are no more than 128 samples, which is too short for the transforms
+ * to beat the SIMD time-domain mixers. They're only used over the C one.
+ */
+static inline HrtfFftMixerBlendFunc SelectHrtfFftBlendMixer()
+{
+#ifdef HAVE_NEON
+    if((CPUCapFlags&CPU_CAP_NEON))
+        return nullptr;
+#endif
+#ifdef HAVE_SSE
+    if((CPUCapFlags&CPU_CAP_SSE))
+        return nullptr;
+#endif
+    return MixHrtfFftBlend_<CTag>;
+}
+
 ResamplerFunc SelectResampler(Resampler resampler)
 {
     switch(resampler)
@@ -191,8 +243,11 @@ void aluInitMixer()
 
     MixHrtfBlendSamples = SelectHrtfBlendMixer();
     MixHrtfSamples = SelectHrtfMixer();
+    MixHrtfFftBlendSamples = SelectHrtfFftBlendMixer();
+    MixHrtfFftSamples = SelectHrtfFftMixer();
     MixSamples = SelectMixer();
     MixRowSamples = SelectRowMixer();
+    MixMatrixSamples = SelectMatrixMixer();
 }
 
 
@@ -250,53 +305,92 @@ const ALfloat *DoFilters(BiquadFilter *lpfilter, BiquadFilter *hpfilter,
     return src;
 }
 
+/* A direct or send path to filter, and the resulting samples. */
+struct FilterPath {
+    BiquadFilter *LowPass;
+    BiquadFilter *HighPass;
+    int FilterType;
+    ALfloat *Buffer;
+
+    const ALfloat *Samples;
+};
 
-/* Base template left undefined. Should be marked =delete, but Clang 3.8.1
- * chokes on that given the inline specializations.
+/* Applies the filters of several paths (up to four) to the same source. The
+ * filters needed by each stage are processed together, in the lanes of a
+ * filter bank. A lone filter is processed by itself.
  */
-template<FmtType T>
-inline ALfloat LoadSample(typename FmtTypeTraits<T>::Type val);
-
-template<> inline ALfloat LoadSample<FmtUByte>(FmtTypeTraits<FmtUByte>::Type val)
-{ return (val-128) * (1.0f/128.0f); }
-template<> inline ALfloat LoadSample<FmtShort>(FmtTypeTraits<FmtShort>::Type val)
-{ return val * (1.0f/32768.0f); }
-template<> inline ALfloat LoadSample<FmtFloat>(FmtTypeTraits<FmtFloat>::Type val)
-{ return val; }
-template<> inline ALfloat LoadSample<FmtDouble>(FmtTypeTraits<FmtDouble>::Type val)
-{ return static_cast<ALfloat>(val); }
-template<> inline ALfloat LoadSample<FmtMulaw>(FmtTypeTraits<FmtMulaw>::Type val)
-{ return muLawDecompressionTable[val] * (1.0f/32768.0f); }
-template<> inline ALfloat LoadSample<FmtAlaw>(FmtTypeTraits<FmtAlaw>::Type val)
-{ return aLawDecompressionTable[val] * (1.0f/32768.0f); }
-
-template<FmtType T>
-inline void LoadSampleArray(ALfloat *RESTRICT dst, const void *src, ALint srcstep,
-    const ptrdiff_t samples)
+void DoFilterPaths(FilterPath *paths, const size_t numpaths, const ALfloat *RESTRICT src,
+    const ALsizei numsamples)
 {
-    using SampleType = typename FmtTypeTraits<T>::Type;
+    BiquadFilter *filters[4];
+    ALfloat *dsts[4];
+    const ALfloat *srcs[4];
+    size_t numlanes{0};
 
-    const SampleType *ssrc = static_cast<const SampleType*>(src);
-    for(ALsizei i{0};i < samples;i++)
-        dst[i] += LoadSample<T>(ssrc[i*srcstep]);
-}
+    auto add_lane = [&filters,&dsts,&srcs,&numlanes](BiquadFilter *filter, ALfloat *dst,
+        const ALfloat *lanesrc) noexcept -> void
+    {
+        filters[numlanes] = filter;
+        dsts[numlanes] = dst;
+        srcs[numlanes] = lanesrc;
+        ++numlanes;
+    };
+    auto run_lanes = [&filters,&dsts,&srcs,&numlanes,numsamples]() -> void
+    {
+        if(numlanes == 1)
+            filters[0]->process(dsts[0], srcs[0], numsamples);
+        else if(numlanes > 1)
+        {
+            BiquadBank<4> bank;
+            for(size_t i{0};i < numlanes;i++)
+                bank.load(i, *filters[i]);
+            bank.process(dsts, srcs, numlanes, numsamples);
+            for(size_t i{0};i < numlanes;i++)
+                bank.store(i, *filters[i]);
+        }
+        numlanes = 0;
+    };
 
-void LoadSamples(ALfloat *RESTRICT dst, const ALvoid *RESTRICT src, ALint srcstep, FmtType srctype,
-    const ptrdiff_t samples)
-{
-#define HANDLE_FMT(T)  case T: LoadSampleArray<T>(dst, src, srcstep, samples); break
-    switch(srctype)
+    for(size_t i{0};i < numpaths;i++)
     {
-        HANDLE_FMT(FmtUByte);
-        HANDLE_FMT(FmtShort);
-        HANDLE_FMT(FmtFloat);
-        HANDLE_FMT(FmtDouble);
-        HANDLE_FMT(FmtMulaw);
-        HANDLE_FMT(FmtAlaw);
+        FilterPath &path = paths[i];
+        switch(path.FilterType)
+        {
+            case AF_None:
+                path.LowPass->passthru(numsamples);
+                path.HighPass->passthru(numsamples);
+                path.Samples = src;
+                break;
+
+            case AF_LowPass:
+            case AF_BandPass:
+                if(path.FilterType == AF_LowPass)
+                    path.HighPass->passthru(numsamples);
+                add_lane(path.LowPass, path.Buffer, src);
+                path.Samples = path.Buffer;
+                break;
+            case AF_HighPass:
+                path.LowPass->passthru(numsamples);
+                add_lane(path.HighPass, path.Buffer, src);
+                path.Samples = path.Buffer;
+                break;
+        }
     }
-#undef HANDLE_FMT
+    run_lanes();
+
+    /* Band-pass paths then apply their high-pass filter to the low-passed
+     * result.
+     */
+    for(size_t i{0};i < numpaths;i++)
+    {
+        FilterPath &path = paths[i];
+        if(path.FilterType == AF_BandPass)
+            add_lane(path.HighPass, path.Buffer, path.Buffer);
+    }
+    run_lanes();
 }
 
+
 ALfloat *LoadBufferStatic(ALbufferlistitem *BufferListItem, ALbufferlistitem *&BufferLoopItem,
     const ALsizei NumChannels, const ALsizei SampleSize, const ALsizei chan, ALsizei DataPosInt,
     ALfloat *SrcData, const ALfloat *const SrcDataEnd)
@@ -439,6 +533,32 @@ ALfloat *LoadBufferQueue(ALbufferlistitem *BufferListItem, ALbufferlistitem *Buf
     return SrcData;
 }
 
+/* Get the FFT mixer spectra for a voice channel's old or target coefficients,
+ * calculating them if they changed since last time. The two use different
+ * slots, unless the old coefficients were set from the target.
+ */
+const HrtfSpectra *GetOldHrtfSpectra(VoiceHrtfState &hrtf, const ALsizei IrSize,
+    const ComplexFftPlan<float> &plan)
+{
+    if(hrtf.OldSpectra < 0)
+    {
+        hrtf.OldSpectra = (hrtf.TargetSpectra == 0) ? 1 : 0;
+        CalcHrtfSpectra(hrtf.Old.Coeffs, IrSize, hrtf.Spectra[hrtf.OldSpectra], plan);
+    }
+    return &hrtf.Spectra[hrtf.OldSpectra];
+}
+
+const HrtfSpectra *GetTargetHrtfSpectra(VoiceHrtfState &hrtf, const ALsizei IrSize,
+    const ComplexFftPlan<float> &plan)
+{
+    if(hrtf.TargetSpectra < 0)
+    {
+        hrtf.TargetSpectra = (hrtf.OldSpectra == 0) ? 1 : 0;
+        CalcHrtfSpectra(hrtf.Target.Coeffs, IrSize, hrtf.Spectra[hrtf.TargetSpectra], plan);
+    }
+    return &hrtf.Spectra[hrtf.TargetSpectra];
+}
+
 } // namespace
 
 void MixVoice(ALvoice *voice, ALvoice::State vstate, const ALuint SourceID, ALCcontext *Context, const ALsizei SamplesToDo)
@@ -471,7 +591,15 @@ void MixVoice(ALvoice *voice, ALvoice::State vstate, const ALuint SourceID, ALCc
     ResamplerFunc Resample{(increment == FRACTIONONE && DataPosFrac == 0) ?
                            Resample_<CopyTag,CTag> : voice->mResampler};
 
-    ALsizei Counter{(voice->mFlags&VOICE_IS_FADING) ? SamplesToDo : 0};
+    /* A virtual voice only advances its position. Its gains are too quiet to
+     * fade from or to, so the targets are taken as they are.
+     */
+    const ALsizei MixChannels{(voice->mFlags&VOICE_IS_VIRTUAL) ? 0 : NumChannels};
+    ALsizei Counter{(MixChannels && (voice->mFlags&VOICE_IS_FADING)) ? SamplesToDo : 0};
+    /* A voice switching between its own HRTF filter and panning (for hybrid
+     * HRTF rendering) mixes both paths while fading.
+     */
+    const bool hrtf_switch{Counter && (voice->mFlags&VOICE_HRTF_SWITCH)};
     if(!Counter)
     {
         /* No fading, just overwrite the old/current params. */
@@ -482,7 +610,11 @@ void MixVoice(ALvoice *voice, ALvoice::State vstate, const ALuint SourceID, ALCc
                 std::copy(std::begin(parms.Gains.Target), std::end(parms.Gains.Target),
                     std::begin(parms.Gains.Current));
             else
-                parms.Hrtf.Old = parms.Hrtf.Target;
+            {
+                VoiceHrtfState &hrtf = *voice->mHrtfState[chan];
+                hrtf.Old = hrtf.Target;
+                hrtf.OldSpectra = hrtf.TargetSpectra;
+            }
             auto set_current = [chan](ALvoice::SendData &send) -> void
             {
                 if(!send.Buffer)
@@ -499,15 +631,16 @@ void MixVoice(ALvoice *voice, ALvoice::State vstate, const ALuint SourceID, ALCc
     {
         for(ALsizei chan{0};chan < NumChannels;chan++)
         {
-            DirectParams &parms = voice->mDirect.Params[chan];
-            if(!(parms.Hrtf.Old.Gain > GAIN_SILENCE_THRESHOLD))
+            VoiceHrtfState &hrtf = *voice->mHrtfState[chan];
+            if(!(hrtf.Old.Gain > GAIN_SILENCE_THRESHOLD))
             {
                 /* The old HRTF params are silent, so overwrite the old
                  * coefficients with the new, and reset the old gain to 0. The
                  * future mix will then fade from silence.
                  */
-                parms.Hrtf.Old = parms.Hrtf.Target;
-                parms.Hrtf.Old.Gain = 0.0f;
+                hrtf.Old = hrtf.Target;
+                hrtf.Old.Gain = 0.0f;
+                hrtf.OldSpectra = hrtf.TargetSpectra;
             }
         }
     }
@@ -545,7 +678,7 @@ void MixVoice(ALvoice *voice, ALvoice::State vstate, const ALuint SourceID, ALCc
                 DstBufferSize &= ~3;
         }
 
-        for(ALsizei chan{0};chan < NumChannels;chan++)
+        for(ALsizei chan{0};chan < MixChannels;chan++)
         {
             auto &SrcData = Device->SourceData;
 
@@ -604,42 +737,64 @@ void MixVoice(ALvoice *voice, ALvoice::State vstate, const ALuint SourceID, ALCc
                     hfscale, DstBufferSize);
             }
 
-            /* Now filter and mix to the appropriate outputs. */
+            /* Filter the direct path and the first few sends together. Any
+             * other sends are filtered as they're mixed.
+             */
+            FilterPath FilterPaths[std::extent<decltype(ALCdevice::FilteredData)>::value];
+            size_t NumFilterPaths{0};
+            {
+                DirectParams &parms = voice->mDirect.Params[chan];
+                FilterPaths[NumFilterPaths++] = FilterPath{&parms.LowPass, &parms.HighPass,
+                    voice->mDirect.FilterType, Device->FilteredData[0], nullptr};
+            }
+            for(ALvoice::SendData &send : voice->mSend)
+            {
+                if(NumFilterPaths == COUNTOF(FilterPaths))
+                    break;
+                SendParams &parms = send.Params[chan];
+                /* Sends without a target don't need filtering. */
+                const int type{send.Buffer ? send.FilterType : AF_None};
+                FilterPaths[NumFilterPaths] = FilterPath{&parms.LowPass, &parms.HighPass, type,
+                    Device->FilteredData[NumFilterPaths], nullptr};
+                ++NumFilterPaths;
+            }
+            DoFilterPaths(FilterPaths, NumFilterPaths, ResampledData, DstBufferSize);
+
+            /* Now mix to the appropriate outputs. */
             {
                 DirectParams &parms = voice->mDirect.Params[chan];
-                const ALfloat *samples{DoFilters(&parms.LowPass, &parms.HighPass,
-                    Device->FilteredData, ResampledData, DstBufferSize,
-                    voice->mDirect.FilterType)};
+                const ALfloat *samples{FilterPaths[0].Samples};
 
-                if((voice->mFlags&VOICE_HAS_HRTF))
+                if((voice->mFlags&VOICE_HAS_HRTF) || hrtf_switch)
                 {
+                    VoiceHrtfState &hrtf = *voice->mHrtfState[chan];
                     const int OutLIdx{GetChannelIdxByName(Device->RealOut, FrontLeft)};
                     const int OutRIdx{GetChannelIdxByName(Device->RealOut, FrontRight)};
                     ASSUME(OutLIdx >= 0 && OutRIdx >= 0);
 
                     auto &HrtfSamples = Device->HrtfSourceData;
                     auto &AccumSamples = Device->HrtfAccumData;
-                    const ALfloat TargetGain{UNLIKELY(vstate == ALvoice::Stopping) ? 0.0f :
-                        parms.Hrtf.Target.Gain};
+                    const ALfloat TargetGain{(UNLIKELY(vstate == ALvoice::Stopping) ||
+                        !(voice->mFlags&VOICE_HAS_HRTF)) ? 0.0f : hrtf.Target.Gain};
                     ALsizei fademix{0};
 
                     /* Copy the HRTF history and new input samples into a temp
                      * buffer.
                      */
-                    auto src_iter = std::copy(parms.Hrtf.State.History.begin(),
-                        parms.Hrtf.State.History.end(), std::begin(HrtfSamples));
+                    auto src_iter = std::copy(hrtf.State.History.begin(),
+                        hrtf.State.History.end(), std::begin(HrtfSamples));
                     std::copy_n(samples, DstBufferSize, src_iter);
                     /* Copy the last used samples back into the history buffer
                      * for later.
                      */
                     std::copy_n(std::begin(HrtfSamples) + DstBufferSize,
-                        parms.Hrtf.State.History.size(), parms.Hrtf.State.History.begin());
+                        hrtf.State.History.size(), hrtf.State.History.begin());
 
                     /* Copy the current filtered values being accumulated into
                      * the temp buffer.
                      */
-                    auto accum_iter = std::copy_n(parms.Hrtf.State.Values.begin(),
-                        parms.Hrtf.State.Values.size(), std::begin(AccumSamples));
+                    auto accum_iter = std::copy_n(hrtf.State.Values.begin(),
+                        hrtf.State.Values.size(), std::begin(AccumSamples));
 
                     /* Clear the accumulation buffer that will start getting
                      * filled in.
@@ -649,7 +804,7 @@ void MixVoice(ALvoice *voice, ALvoice::State vstate, const ALuint SourceID, ALCc
                     /* If fading, the old gain is not silence, and this is the
                      * first mixing pass, fade between the IRs.
                      */
-                    if(Counter && (parms.Hrtf.Old.Gain > GAIN_SILENCE_THRESHOLD) && OutPos == 0)
+                    if(Counter && (hrtf.Old.Gain > GAIN_SILENCE_THRESHOLD) && OutPos == 0)
                     {
                         fademix = mini(DstBufferSize, 128);
 
@@ -665,25 +820,38 @@ void MixVoice(ALvoice *voice, ALvoice::State vstate, const ALuint SourceID, ALCc
                         {
                             const ALfloat a{static_cast<ALfloat>(fademix) /
                                 static_cast<ALfloat>(Counter)};
-                            gain = lerp(parms.Hrtf.Old.Gain, TargetGain, a);
+                            gain = lerp(hrtf.Old.Gain, TargetGain, a);
                         }
                         MixHrtfParams hrtfparams;
-                        hrtfparams.Coeffs = &parms.Hrtf.Target.Coeffs;
-                        hrtfparams.Delay[0] = parms.Hrtf.Target.Delay[0];
-                        hrtfparams.Delay[1] = parms.Hrtf.Target.Delay[1];
+                        hrtfparams.Coeffs = &hrtf.Target.Coeffs;
+                        hrtfparams.Delay[0] = hrtf.Target.Delay[0];
+                        hrtfparams.Delay[1] = hrtf.Target.Delay[1];
                         hrtfparams.Gain = 0.0f;
                         hrtfparams.GainStep = gain / static_cast<ALfloat>(fademix);
 
-                        MixHrtfBlendSamples(
-                            voice->mDirect.Buffer[OutLIdx], voice->mDirect.Buffer[OutRIdx],
-                            HrtfSamples, AccumSamples, OutPos, IrSize, &parms.Hrtf.Old,
-                            &hrtfparams, fademix);
+                        if(MixHrtfFftBlendSamples && IrSize >= HrtfFftMinIrSize)
+                        {
+                            const ComplexFftPlan<float> &plan = Device->HrtfFftData.Plan;
+                            const HrtfSpectra *oldspectra{GetOldHrtfSpectra(hrtf, IrSize, plan)};
+                            const HrtfSpectra *newspectra{
+                                GetTargetHrtfSpectra(hrtf, IrSize, plan)};
+                            MixHrtfFftBlendSamples(
+                                Device->RealOut.Buffer[OutLIdx], Device->RealOut.Buffer[OutRIdx],
+                                HrtfSamples, AccumSamples, OutPos, IrSize, &hrtf.Old, oldspectra,
+                                &hrtfparams, newspectra, &Device->HrtfFftData, fademix);
+                        }
+                        else
+                            MixHrtfBlendSamples(
+                                Device->RealOut.Buffer[OutLIdx], Device->RealOut.Buffer[OutRIdx],
+                                HrtfSamples, AccumSamples, OutPos, IrSize, &hrtf.Old,
+                                &hrtfparams, fademix);
                         /* Update the old parameters with the result. */
-                        parms.Hrtf.Old = parms.Hrtf.Target;
+                        hrtf.Old = hrtf.Target;
+                        hrtf.OldSpectra = hrtf.TargetSpectra;
                         if(fademix < Counter)
-                            parms.Hrtf.Old.Gain = hrtfparams.Gain;
+                            hrtf.Old.Gain = hrtfparams.Gain;
                         else
-                            parms.Hrtf.Old.Gain = TargetGain;
+                            hrtf.Old.Gain = TargetGain;
                     }
 
                     if(LIKELY(fademix < DstBufferSize))
@@ -698,79 +866,113 @@ void MixVoice(ALvoice *voice, ALvoice::State vstate, const ALuint SourceID, ALCc
                         {
                             const ALfloat a{static_cast<ALfloat>(todo) /
                                 static_cast<ALfloat>(Counter-fademix)};
-                            gain = lerp(parms.Hrtf.Old.Gain, TargetGain, a);
+                            gain = lerp(hrtf.Old.Gain, TargetGain, a);
                         }
 
                         MixHrtfParams hrtfparams;
-                        hrtfparams.Coeffs = &parms.Hrtf.Target.Coeffs;
-                        hrtfparams.Delay[0] = parms.Hrtf.Target.Delay[0];
-                        hrtfparams.Delay[1] = parms.Hrtf.Target.Delay[1];
-                        hrtfparams.Gain = parms.Hrtf.Old.Gain;
-                        hrtfparams.GainStep = (gain - parms.Hrtf.Old.Gain) /
+                        hrtfparams.Coeffs = &hrtf.Target.Coeffs;
+                        hrtfparams.Delay[0] = hrtf.Target.Delay[0];
+                        hrtfparams.Delay[1] = hrtf.Target.Delay[1];
+                        hrtfparams.Gain = hrtf.Old.Gain;
+                        hrtfparams.GainStep = (gain - hrtf.Old.Gain) /
                             static_cast<ALfloat>(todo);
-                        MixHrtfSamples(
-                            voice->mDirect.Buffer[OutLIdx], voice->mDirect.Buffer[OutRIdx],
-                            HrtfSamples+fademix, AccumSamples+fademix, OutPos+fademix, IrSize,
-                            &hrtfparams, todo);
+                        if(MixHrtfFftSamples && IrSize >= HrtfFftMinIrSize &&
+                            todo >= HrtfFftMinSamples)
+                            MixHrtfFftSamples(
+                                Device->RealOut.Buffer[OutLIdx], Device->RealOut.Buffer[OutRIdx],
+                                HrtfSamples+fademix, AccumSamples+fademix, OutPos+fademix, IrSize,
+                                GetTargetHrtfSpectra(hrtf, IrSize, Device->HrtfFftData.Plan),
+                                &hrtfparams, &Device->HrtfFftData, todo);
+                        else
+                            MixHrtfSamples(
+                                Device->RealOut.Buffer[OutLIdx], Device->RealOut.Buffer[OutRIdx],
+                                HrtfSamples+fademix, AccumSamples+fademix, OutPos+fademix, IrSize,
+                                &hrtfparams, todo);
                         /* Store the interpolated gain or the final target gain
                          * depending if the fade is done.
                          */
                         if(DstBufferSize < Counter)
-                            parms.Hrtf.Old.Gain = gain;
+                            hrtf.Old.Gain = gain;
                         else
-                            parms.Hrtf.Old.Gain = TargetGain;
+                            hrtf.Old.Gain = TargetGain;
                     }
 
                     /* Copy the new in-progress accumulation values back for
                      * the next mix.
                      */
                     std::copy_n(std::begin(AccumSamples) + DstBufferSize,
-                        parms.Hrtf.State.Values.size(), parms.Hrtf.State.Values.begin());
+                        hrtf.State.Values.size(), hrtf.State.Values.begin());
                 }
-                else if((voice->mFlags&VOICE_HAS_NFC))
+                if(!(voice->mFlags&VOICE_HAS_HRTF) || hrtf_switch)
                 {
-                    const ALfloat *TargetGains{UNLIKELY(vstate == ALvoice::Stopping) ?
-                        SilentTarget : parms.Gains.Target};
+                    const ALfloat *TargetGains{(UNLIKELY(vstate == ALvoice::Stopping) ||
+                        (voice->mFlags&VOICE_HAS_HRTF)) ? SilentTarget : parms.Gains.Target};
 
-                    MixSamples(samples, voice->mDirect.ChannelsPerOrder[0],
-                        voice->mDirect.Buffer, parms.Gains.Current, TargetGains, Counter,
-                        OutPos, DstBufferSize);
+                    if((voice->mFlags&VOICE_HAS_NFC))
+                    {
+                        MixSamples(samples, voice->mDirect.ChannelsPerOrder[0],
+                            voice->mDirect.Buffer, parms.Gains.Current, TargetGains, Counter,
+                            OutPos, DstBufferSize);
 
-                    ALfloat (&nfcsamples)[BUFFERSIZE] = Device->NfcSampleData;
-                    ALsizei chanoffset{voice->mDirect.ChannelsPerOrder[0]};
-                    using FilterProc = void (NfcFilter::*)(float*,const float*,int);
-                    auto apply_nfc = [voice,&parms,samples,TargetGains,DstBufferSize,Counter,OutPos,&chanoffset,&nfcsamples](FilterProc process, ALsizei order) -> void
+                        if((voice->mFlags&VOICE_SHARED_NFC))
+                        {
+                            /* The device filters the first-order mix for all
+                             * voices like this one.
+                             */
+                            MixSamples(samples, voice->mDirect.ChannelsPerOrder[1],
+                                Device->NfcFoaData, parms.Gains.Current+1, TargetGains+1,
+                                Counter, OutPos, DstBufferSize);
+                        }
+                        else
+                        {
+                            /* Run the filters for each order in use together. */
+                            size_t numorders{0};
+                            while(numorders < MAX_AMBI_ORDER &&
+                                voice->mDirect.ChannelsPerOrder[numorders+1] > 0)
+                                ++numorders;
+
+                            float *nfcsamples[MAX_AMBI_ORDER];
+                            for(size_t i{0};i < numorders;++i)
+                                nfcsamples[i] = Device->NfcSampleData[i];
+                            if(numorders > 0)
+                                parms.NFCtrlFilter.processOrders(nfcsamples, samples, numorders,
+                                    DstBufferSize);
+
+                            ALsizei chanoffset{voice->mDirect.ChannelsPerOrder[0]};
+                            for(size_t i{0};i < numorders;++i)
+                            {
+                                const ALsizei numchans{voice->mDirect.ChannelsPerOrder[i+1]};
+                                MixSamples(nfcsamples[i], numchans,
+                                    voice->mDirect.Buffer+chanoffset,
+                                    parms.Gains.Current+chanoffset, TargetGains+chanoffset,
+                                    Counter, OutPos, DstBufferSize);
+                                chanoffset += numchans;
+                            }
+                        }
+                    }
+                    else
                     {
-                        if(voice->mDirect.ChannelsPerOrder[order] < 1)
-                            return;
-                        (parms.NFCtrlFilter.*process)(nfcsamples, samples, DstBufferSize);
-                        MixSamples(nfcsamples, voice->mDirect.ChannelsPerOrder[order],
-                            voice->mDirect.Buffer+chanoffset, parms.Gains.Current+chanoffset,
-                            TargetGains+chanoffset, Counter, OutPos, DstBufferSize);
-                        chanoffset += voice->mDirect.ChannelsPerOrder[order];
-                    };
-                    apply_nfc(&NfcFilter::process1, 1);
-                    apply_nfc(&NfcFilter::process2, 2);
-                    apply_nfc(&NfcFilter::process3, 3);
-                }
-                else
-                {
-                    const ALfloat *TargetGains{UNLIKELY(vstate == ALvoice::Stopping) ?
-                        SilentTarget : parms.Gains.Target};
-                    MixSamples(samples, voice->mDirect.Channels, voice->mDirect.Buffer,
-                        parms.Gains.Current, TargetGains, Counter, OutPos, DstBufferSize);
+                        MixSamples(samples, voice->mDirect.Channels, voice->mDirect.Buffer,
+                            parms.Gains.Current, TargetGains, Counter, OutPos, DstBufferSize);
+                    }
                 }
             }
 
-            ALfloat (&FilterBuf)[BUFFERSIZE] = Device->FilteredData;
-            auto mix_send = [vstate,Counter,OutPos,DstBufferSize,chan,ResampledData,&FilterBuf](ALvoice::SendData &send) -> void
+            /* Sends past the filtered paths reuse the direct path's buffer,
+             * which has been mixed already.
+             */
+            ALfloat (&FilterBuf)[BUFFERSIZE] = Device->FilteredData[0];
+            size_t sendidx{0};
+            auto mix_send = [vstate,Counter,OutPos,DstBufferSize,chan,ResampledData,&FilterBuf,&FilterPaths,NumFilterPaths,&sendidx](ALvoice::SendData &send) -> void
             {
+                const size_t pathidx{++sendidx};
                 if(!send.Buffer)
                     return;
 
                 SendParams &parms = send.Params[chan];
-                const ALfloat *samples{DoFilters(&parms.LowPass, &parms.HighPass,
-                    FilterBuf, ResampledData, DstBufferSize, send.FilterType)};
+                const ALfloat *samples{(pathidx < NumFilterPaths) ? FilterPaths[pathidx].Samples :
+                    DoFilters(&parms.LowPass, &parms.HighPass, FilterBuf, ResampledData,
+                        DstBufferSize, send.FilterType)};
 
                 const ALfloat *TargetGains{UNLIKELY(vstate==ALvoice::Stopping) ? SilentTarget :
                     parms.Gains.Target};
@@ -836,12 +1038,15 @@ void MixVoice(ALvoice *voice, ALvoice::State vstate, const ALuint SourceID, ALCc
         }
     } while(OutPos < SamplesToDo);
 
-    voice->mFlags |= VOICE_IS_FADING;
+    voice->mFlags = (voice->mFlags&~VOICE_HRTF_SWITCH) | VOICE_IS_FADING;
 
     /* Don't update positions and buffers if we were stopping. */
     if(UNLIKELY(vstate == ALvoice::Stopping))
     {
         voice->mPlayState.store(ALvoice::Stopped, std::memory_order_release);
+        /* A voice that isn't just paused can be used again. */
+        if(voice->mSourceID.load(std::memory_order_relaxed) == 0u)
+            RetireVoice(Context, voice);
         return;
     }
 
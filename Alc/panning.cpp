@@ -244,6 +244,13 @@ void InitNearFieldCtrl(ALCdevice *device, ALfloat ctrl_dist, ALsizei order, cons
     auto iter = std::copy(chans_per_order, chans_per_order+order+1,
         std::begin(device->NumChannelsPerOrder));
     std::fill(iter, std::end(device->NumChannelsPerOrder), 0);
+
+    /* The shared first-order filters for unpanned B-Format voices use a w0 of
+     * 0, as set by init.
+     */
+    const ALfloat w1{SPEEDOFSOUNDMETRESPERSEC / (device->AvgSpeakerDist * device->Frequency)};
+    for(NfcFilter &filter : device->NfcFoaFilter)
+        filter.init(w1);
 }
 
 void InitDistanceComp(ALCdevice *device, const AmbDecConf *conf, const ALsizei (&speakermap)[MAX_OUTPUT_CHANNELS])
@@ -556,10 +563,11 @@ void InitHrtfPanning(ALCdevice *device)
     static_assert(COUNTOF(AmbiPoints) == COUNTOF(AmbiMatrix), "Ambisonic HRTF mismatch");
 
     /* Don't bother with HOA when using full HRTF rendering. Nothing needs it,
-     * and it eases the CPU/memory load.
+     * and it eases the CPU/memory load. Hybrid rendering pans most voices to
+     * the ambisonic mix, so it uses HOA like basic rendering.
      */
     ALsizei ambi_order{1};
-    if(device->mRenderMode != HrtfRender)
+    if(device->mRenderMode != HrtfRender || device->mHrtfVoiceLimit > 0)
     {
         ambi_order = 2;
         AmbiOrderHFGain = AmbiOrderHFGainHOA;
@@ -719,7 +727,9 @@ void aluInitRenderer(ALCdevice *device, ALint hrtf_id, HrtfRequestMode hrtf_appr
     HrtfEntry *old_hrtf{device->mHrtf};
 
     device->mHrtfState = nullptr;
+    device->mHrtfCache = nullptr;
     device->mHrtf = nullptr;
+    device->mHrtfVoiceLimit = 0;
     device->HrtfName.clear();
     device->mRenderMode = NormalRender;
 
@@ -916,14 +926,33 @@ void aluInitRenderer(ALCdevice *device, ALint hrtf_id, HrtfRequestMode hrtf_appr
                 device->mRenderMode = HrtfRender;
             else if(strcasecmp(mode, "basic") == 0)
                 device->mRenderMode = NormalRender;
+            else if(strcasecmp(mode, "hybrid") == 0)
+            {
+                ALuint maxvoices{16};
+                ConfigValueUInt(device->DeviceName.c_str(), nullptr, "hrtf-voices", &maxvoices);
+                device->mHrtfVoiceLimit = static_cast<ALsizei>(minu(maxvoices, 4096));
+            }
             else
                 ERR("Unexpected hrtf-mode: %s\n", mode);
         }
 
         TRACE("%s HRTF rendering enabled, using \"%s\"\n",
-            ((device->mRenderMode == HrtfRender) ? "Full" : "Basic"), device->HrtfName.c_str()
+            ((device->mRenderMode != HrtfRender) ? "Basic" :
+             (device->mHrtfVoiceLimit > 0) ? "Hybrid" : "Full"), device->HrtfName.c_str()
         );
+        if(device->mHrtfVoiceLimit > 0)
+            TRACE("Using per-source HRTF for up to %d voices\n", device->mHrtfVoiceLimit);
         InitHrtfPanning(device);
+
+        if(device->mRenderMode == HrtfRender)
+        {
+            ALuint cachesize{128};
+            ConfigValueUInt(device->DeviceName.c_str(), nullptr, "hrtf-cache-size", &cachesize);
+            cachesize = minu(cachesize, 65536);
+            if(cachesize > 0)
+                device->mHrtfCache = al::make_unique<HrtfCoeffCache>(device->mHrtf, cachesize);
+            TRACE("HRTF coefficient cache %u entries\n", cachesize);
+        }
         return;
     }
     device->HrtfStatus = ALC_HRTF_UNSUPPORTED_FORMAT_SOFT;
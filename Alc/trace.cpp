@@ -0,0 +1,239 @@
+/**
+ * OpenAL cross platform audio library
+ * This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ *  License along with this library; if not, write to the
+ *  Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * Or go to http://www.gnu.org/copyleft/lgpl.html
+ */
+
+#include "config.h"
+
+#include "trace.h"
+
+#include <stdio.h>
+
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#include "alconfig.h"
+#include "compat.h"
+#include "logging.h"
+#include "ringbuffer.h"
+#include "threads.h"
+
+
+std::atomic<bool> gTraceEnabled{false};
+
+namespace {
+
+using std::chrono::steady_clock;
+using std::chrono::nanoseconds;
+
+/* Number of spans each thread can have waiting to be written. */
+constexpr size_t TraceRingSize{4096};
+
+struct TraceEvent {
+    const char *mName;
+    unsigned int mId;
+    nanoseconds mStart;
+    nanoseconds mDuration;
+};
+
+/* Spans recorded by a thread, for the flush thread to write out. A ring is
+ * given to another thread once its thread ends and it's been emptied, and
+ * they're never freed.
+ */
+struct TraceRing {
+    RingBufferPtr mEvents;
+    std::atomic<unsigned int> mThreadId{0u};
+    std::atomic<bool> mInUse{true};
+    std::atomic<size_t> mDropped{0u};
+    TraceRing *mNext{nullptr};
+};
+
+std::atomic<TraceRing*> TraceRings{nullptr};
+std::mutex TraceRingLock;
+unsigned int NextThreadId{1u};
+
+steady_clock::time_point TraceEpoch;
+FILE *TraceFile{nullptr};
+
+std::thread FlushThread;
+std::mutex FlushLock;
+std::condition_variable FlushCond;
+bool FlushQuit{false};
+
+
+/* Gives up the thread's ring when the thread ends. */
+struct ThreadTraceRing {
+    TraceRing *mRing{nullptr};
+
+    ~ThreadTraceRing()
+    {
+        if(mRing)
+            mRing->mInUse.store(false, std::memory_order_release);
+    }
+};
+thread_local ThreadTraceRing LocalRing;
+
+TraceRing *GetThreadRing()
+{
+    std::lock_guard<std::mutex> _{TraceRingLock};
+
+    TraceRing *ring{TraceRings.load(std::memory_order_acquire)};
+    while(ring)
+    {
+        if(!ring->mInUse.load(std::memory_order_acquire) && ring->mEvents->readSpace() == 0)
+            break;
+        ring = ring->mNext;
+    }
+    if(ring)
+        ring->mInUse.store(true, std::memory_order_relaxed);
+    else
+    {
+        ring = new TraceRing{};
+        ring->mEvents = CreateRingBuffer(TraceRingSize, sizeof(TraceEvent), false);
+        ring->mNext = TraceRings.load(std::memory_order_relaxed);
+        TraceRings.store(ring, std::memory_order_release);
+    }
+    ring->mThreadId.store(NextThreadId++, std::memory_order_relaxed);
+    return ring;
+}
+
+
+void FlushTraceRings()
+{
+    for(TraceRing *ring{TraceRings.load(std::memory_order_acquire)};ring;ring = ring->mNext)
+    {
+        const unsigned int tid{ring->mThreadId.load(std::memory_order_relaxed)};
+        TraceEvent evt;
+        while(ring->mEvents->read(&evt, 1) == 1)
+        {
+            fprintf(TraceFile, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+                "\"ts\":%.3f,\"dur\":%.3f", evt.mName, tid,
+                static_cast<double>(evt.mStart.count()) / 1000.0,
+                static_cast<double>(evt.mDuration.count()) / 1000.0);
+            if(evt.mId != 0u)
+                fprintf(TraceFile, ",\"args\":{\"id\":%u}}", evt.mId);
+            else
+                fputc('}', TraceFile);
+        }
+
+        if(const size_t dropped{ring->mDropped.exchange(0u, std::memory_order_relaxed)})
+            WARN("Dropped %zu trace span%s from thread %u\n", dropped, (dropped==1)?"":"s", tid);
+    }
+    fflush(TraceFile);
+}
+
+int TraceFlushProc()
+{
+    althrd_setname("alsoft-trace");
+
+    std::unique_lock<std::mutex> lock{FlushLock};
+    while(!FlushQuit)
+    {
+        FlushCond.wait_for(lock, std::chrono::milliseconds{100});
+        FlushTraceRings();
+    }
+    return 0;
+}
+
+/* Stops the flush thread and writes out what's left at library shutdown. */
+struct TraceShutdown {
+    ~TraceShutdown()
+    {
+        if(!FlushThread.joinable())
+            return;
+
+        gTraceEnabled.store(false, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> _{FlushLock};
+            FlushQuit = true;
+        }
+        FlushCond.notify_one();
+        FlushThread.join();
+
+        FlushTraceRings();
+        fputs("\n]\n", TraceFile);
+        fclose(TraceFile);
+        TraceFile = nullptr;
+    }
+};
+TraceShutdown TraceShutdownHelper;
+
+} // namespace
+
+
+void TraceRecord(const char *name, unsigned int id, steady_clock::time_point start,
+    steady_clock::time_point end) noexcept
+{
+    TraceRing *ring{LocalRing.mRing};
+    if(UNLIKELY(!ring))
+    {
+        try {
+            ring = GetThreadRing();
+        }
+        catch(...) {
+            return;
+        }
+        LocalRing.mRing = ring;
+    }
+
+    auto evt_data = ring->mEvents->getWriteVector().first;
+    if(UNLIKELY(evt_data.len == 0))
+    {
+        ring->mDropped.fetch_add(1u, std::memory_order_relaxed);
+        return;
+    }
+    new (evt_data.buf) TraceEvent{name, id, start-TraceEpoch, end-start};
+    ring->mEvents->writeAdvance(1);
+}
+
+void InitTrace()
+{
+    const char *fname{};
+    if(!ConfigValueStr(nullptr, nullptr, "trace-file", &fname) || !fname[0])
+        return;
+
+#ifdef _WIN32
+    TraceFile = _wfopen(utf8_to_wstr(fname).c_str(), L"wt");
+#else
+    TraceFile = fopen(fname, "wt");
+#endif
+    if(!TraceFile)
+    {
+        ERR("Failed to open trace file '%s'\n", fname);
+        return;
+    }
+
+    /* This is the JSON array form of the trace event format, which doesn't
+     * need the closing bracket if the process ends without it.
+     */
+    fputs("[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+        "\"args\":{\"name\":\"OpenAL Soft\"}}", TraceFile);
+
+    TraceEpoch = steady_clock::now();
+    try {
+        FlushThread = std::thread{TraceFlushProc};
+    }
+    catch(std::exception &e) {
+        ERR("Failed to start trace thread: %s\n", e.what());
+        fclose(TraceFile);
+        TraceFile = nullptr;
+        return;
+    }
+    gTraceEnabled.store(true, std::memory_order_release);
+    TRACE("Writing trace to '%s'\n", fname);
+}
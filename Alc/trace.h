@@ -0,0 +1,57 @@
+#ifndef ALC_TRACE_H
+#define ALC_TRACE_H
+
+#include <atomic>
+#include <chrono>
+
+#include "opthelpers.h"
+
+
+/* Set while spans are being recorded for the trace file. */
+extern std::atomic<bool> gTraceEnabled;
+
+/* Records a span to the calling thread's trace buffer. The name must have
+ * static storage, and not need escaping for JSON. A non-0 ID (e.g. of the
+ * object the span processed) is written as the span's "id" argument.
+ */
+void TraceRecord(const char *name, unsigned int id, std::chrono::steady_clock::time_point start,
+    std::chrono::steady_clock::time_point end) noexcept;
+
+/* Opens the file named by the trace-file config option, if any, and starts the
+ * thread that writes recorded spans to it.
+ */
+void InitTrace();
+
+/* Records the lifetime of the object as a span, if tracing is enabled. */
+class TraceSpan {
+    const char *mName{nullptr};
+    unsigned int mId{0u};
+    std::chrono::steady_clock::time_point mStart;
+
+public:
+    explicit TraceSpan(const char *name, unsigned int id=0u) noexcept
+    {
+        if(UNLIKELY(gTraceEnabled.load(std::memory_order_relaxed)))
+        {
+            mName = name;
+            mId = id;
+            mStart = std::chrono::steady_clock::now();
+        }
+    }
+    ~TraceSpan() { end(); }
+
+    /* Ends the span early. */
+    void end() noexcept
+    {
+        if(UNLIKELY(mName != nullptr))
+        {
+            TraceRecord(mName, mId, mStart, std::chrono::steady_clock::now());
+            mName = nullptr;
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+};
+
+#endif /* ALC_TRACE_H */
@@ -13,6 +13,7 @@
 
 
 struct ALeffectslot;
+struct ALbuffer;
 
 
 using ALeffectslotArray = al::FlexArray<ALeffectslot*>;
@@ -36,6 +37,8 @@ struct ALeffectslot {
     ALfloat   Gain{1.0f};
     ALboolean AuxSendAuto{AL_TRUE};
     ALeffectslot *Target{nullptr};
+    /* Buffer data used by the effect (e.g. a convolution impulse response). */
+    ALbuffer *Buffer{nullptr};
 
     struct {
         ALenum Type{AL_EFFECT_NULL};
@@ -96,5 +99,6 @@ void UpdateAllEffectSlotProps(ALCcontext *context);
 
 
 ALenum InitializeEffect(ALCcontext *Context, ALeffectslot *EffectSlot, ALeffect *effect);
+ALenum SetEffectSlotBuffer(ALCcontext *Context, ALeffectslot *EffectSlot, ALbuffer *buffer);
 
 #endif
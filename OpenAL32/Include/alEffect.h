@@ -19,19 +19,22 @@ enum {
     MODULATOR_EFFECT,
     PSHIFTER_EFFECT,
     DEDICATED_EFFECT,
+    CONVOLUTION_EFFECT,
 
     MAX_EFFECTS
 };
 extern ALboolean DisabledEffects[MAX_EFFECTS];
 
 extern ALfloat ReverbBoost;
+extern ALsizei PshifterFftSize;
+extern ALsizei FshifterHilbertLength;
 
 struct EffectList {
     const char name[16];
     int type;
     ALenum val;
 };
-extern const EffectList gEffectList[14];
+extern const EffectList gEffectList[15];
 
 
 struct ALeffect {
@@ -31,6 +31,7 @@
 #include "threads.h"
 #include "ambidefs.h"
 #include "hrtf.h"
+#include "filters/nfc.h"
 
 
 template<typename T, size_t N>
@@ -85,6 +86,11 @@ struct bs2b;
 #define DEFAULT_UPDATE_SIZE  882 /* 20ms */
 #define DEFAULT_NUM_UPDATES  3
 
+#define DEFAULT_PROPS_POOL_SIZE 64
+
+/* Number of voices allocated together as the voice array grows. */
+#define VOICE_CLUSTER_SIZE 64
+
 
 enum Channel {
     FrontLeft = 0,
@@ -294,6 +300,7 @@ public:
 
     ALfloat *data() noexcept { return mSamples.data(); }
     const ALfloat *data() const noexcept { return mSamples.data(); }
+    bool empty() const noexcept { return mSamples.empty(); }
 
     DistData& operator[](size_t o) noexcept { return mChannel[o]; }
     const DistData& operator[](size_t o) const noexcept { return mChannel[o]; }
@@ -332,6 +339,89 @@ struct RealMixParams {
     ALsizei NumChannels{0};
 };
 
+/* Stages of the mixer that are timed separately, in the order reported by
+ * the ALC_MIX_STAGE_TIMES_*_SOFT queries. The last is the whole mix.
+ */
+enum MixStage {
+    MixStageParams = 0,
+    MixStageVoices,
+    MixStageEffects,
+    MixStagePostProcess,
+    MixStageStablizer,
+    MixStageLimiter,
+    MixStageDistanceComp,
+    MixStageDither,
+    MixStageWrite,
+    MixStageTotal,
+
+    MixStageCount
+};
+
+struct MixStatValue {
+    std::atomic<ALint64SOFT> Last{0};
+    std::atomic<ALint64SOFT> Average{0};
+    std::atomic<ALint64SOFT> Max{0};
+};
+
+/* Statistics of the mixer's time, updated by the mixer after each aluMixData
+ * call. Stage times are in nanoseconds per call, and the DSP load is the time
+ * spent over the time covered by the samples mixed, in hundredths of a
+ * percent. The average and max cover the last full window of about a second
+ * of output.
+ */
+struct MixStats {
+    std::array<MixStatValue,MixStageCount> Stages;
+    MixStatValue Load;
+
+    /* Voices that were mixed, and voices held by paused sources or left
+     * unmixed by the quality governor, during the last update.
+     */
+    std::atomic<ALuint> ActiveVoices{0u};
+    std::atomic<ALuint> VirtualVoices{0u};
+
+    /* Totals for the current window, only used by the mixer. */
+    std::array<ALint64SOFT,MixStageCount> WindowSum{};
+    std::array<ALint64SOFT,MixStageCount> WindowMax{};
+    ALint64SOFT WindowLoadMax{0};
+    ALuint WindowMixes{0u};
+    ALuint WindowSamples{0u};
+};
+
+/* Quality levels the governor steps through as the mixer nears its deadline,
+ * in the order reported by ALC_QUALITY_LEVEL_SOFT. Each level keeps the
+ * reductions of the ones before it.
+ */
+enum QualityLevel : ALuint {
+    QualityFull = 0,
+    QualityLinearDistant, /* Distant voices resample with linear interpolation. */
+    QualityHrtfReduced,   /* Fewer voices get their own HRTF filter. */
+    QualityReverbReduced, /* Reverb skips the late diffusion and HF upsampling. */
+    QualityVirtualQuiet,  /* Quiet voices play without being mixed. */
+
+    QualityLevelCount
+};
+
+/* State of the quality governor, which lowers the quality level when a mix
+ * goes over the high load and restores it a level at a time once the load
+ * stays under the low load. Loads are as with MixStats. The level is only
+ * changed by the mixer.
+ */
+struct QualityGovernor {
+    /* Load at which the quality is lowered, or 0 when the governor is off. */
+    ALint64SOFT HighLoad{0};
+    ALint64SOFT LowLoad{0};
+    ALuint MaxLevel{QualityFull};
+
+    std::atomic<ALuint> Level{QualityFull};
+    std::atomic<ALuint> Changes{0u};
+
+    /* Samples mixed since the level last changed, and since the load was last
+     * at or over the low load. Only used by the mixer.
+     */
+    ALuint HoldSamples{0u};
+    ALuint CalmSamples{0u};
+};
+
 using POSTPROCESS = void(*)(ALCdevice *device, const ALsizei SamplesToDo);
 
 struct ALCdevice {
@@ -403,12 +493,21 @@ struct ALCdevice {
     /* Temp storage used for mixer processing. */
     alignas(16) ALfloat SourceData[BUFFERSIZE + MAX_RESAMPLE_PADDING*2];
     alignas(16) ALfloat ResampledData[BUFFERSIZE];
-    alignas(16) ALfloat FilteredData[BUFFERSIZE];
+    /* Filtered samples for the direct path and the first three sends. */
+    alignas(16) ALfloat FilteredData[4][BUFFERSIZE];
     union {
         alignas(16) ALfloat HrtfSourceData[BUFFERSIZE + HRTF_HISTORY_LENGTH];
-        alignas(16) ALfloat NfcSampleData[BUFFERSIZE];
+        alignas(16) ALfloat NfcSampleData[MAX_AMBI_ORDER][BUFFERSIZE];
     };
     alignas(16) float2 HrtfAccumData[BUFFERSIZE + HRIR_LENGTH];
+    HrtfFftBuffers HrtfFftData;
+
+    /* First-order channels of unpanned B-Format voices, which all use a w0 of
+     * 0 for NFC. They're mixed here unfiltered, and filtered once for all of
+     * them after the contexts are processed.
+     */
+    alignas(16) ALfloat NfcFoaData[3][BUFFERSIZE];
+    NfcFilter NfcFoaFilter[3];
 
     /* Mixing buffer used by the Dry mix and Real output. */
     al::vector<std::array<ALfloat,BUFFERSIZE>, 16> MixBuffer;
@@ -424,7 +523,10 @@ struct ALCdevice {
 
     /* HRTF state and info */
     std::unique_ptr<DirectHrtfState> mHrtfState;
+    std::unique_ptr<HrtfCoeffCache> mHrtfCache;
     HrtfEntry *mHrtf{nullptr};
+    /* Max number of voices given their own HRTF filter (0 = unlimited). */
+    ALsizei mHrtfVoiceLimit{0};
 
     /* Ambisonic-to-UHJ encoder */
     std::unique_ptr<Uhj2Encoder> Uhj_Encoder;
@@ -455,6 +557,14 @@ struct ALCdevice {
      */
     RefCount MixCount{0u};
 
+    MixStats mMixStats;
+    /* DSP load (as with MixStats) at which a mix sends a performance event, or
+     * 0 to not send them.
+     */
+    ALint64SOFT mPerfEventLoad{10000};
+
+    QualityGovernor mGovernor;
+
     // Contexts created on this device
     std::atomic<ALCcontext*> ContextList{nullptr};
 
@@ -105,6 +105,8 @@ struct ALsource {
     ALbufferlistitem *queue;
 
     std::atomic_flag PropsClean;
+    /* VOICE_DIRTY_* groups changed since the last voice update. */
+    ALuint PropsDirty;
 
     /* Index into the context's Voices array. Lazily updated, only checked and
      * reset when looking up the voice.
@@ -124,4 +126,10 @@ struct ALsource {
 
 void UpdateAllSourceProps(ALCcontext *context);
 
+/* Applies the source commands deferred by all threads. Must be called with the
+ * context's PropLock held.
+ */
+void ProcessSourceCmds(ALCcontext *context);
+void FreeSourceCmdQueues(ALCcontext *context);
+
 #endif
@@ -118,18 +118,32 @@ struct DirectParams {
 
     NfcFilter NFCtrlFilter;
 
-    struct {
-        HrtfParams Old;
-        HrtfParams Target;
-        HrtfState State;
-    } Hrtf;
-
     struct {
         ALfloat Current[MAX_OUTPUT_CHANNELS];
         ALfloat Target[MAX_OUTPUT_CHANNELS];
     } Gains;
 };
 
+/* HRTF filter parameters and history for one channel of a voice. Voices only
+ * hold these while the device renders with HRTF, and the context pools them
+ * for reuse.
+ */
+struct VoiceHrtfState {
+    HrtfParams Old;
+    HrtfParams Target;
+    HrtfState State;
+
+    /* Spectra of the old and target coefficients for the FFT mixers, which
+     * are calculated when first needed. OldSpectra and TargetSpectra index
+     * Spectra, or are -1 when not calculated.
+     */
+    HrtfSpectra Spectra[2];
+    ALsizei OldSpectra{-1};
+    ALsizei TargetSpectra{-1};
+
+    DEF_NEWDEL(VoiceHrtfState)
+};
+
 struct SendParams {
     BiquadFilter LowPass;
     BiquadFilter HighPass;
@@ -194,7 +208,17 @@ struct ALvoicePropsBase {
     } Send[MAX_SENDS];
 };
 
+/* Groups of voice properties an update changes, letting the mixer skip the
+ * calculations that don't depend on them.
+ */
+#define VOICE_DIRTY_PITCH  (1u<<0) /* Pitch, resampler, and doppler inputs. */
+#define VOICE_DIRTY_GAIN   (1u<<1) /* Source gain and its limits. */
+#define VOICE_DIRTY_OTHER  (1u<<2)
+#define VOICE_DIRTY_ALL    (VOICE_DIRTY_PITCH | VOICE_DIRTY_GAIN | VOICE_DIRTY_OTHER)
+
 struct ALvoiceProps : public ALvoicePropsBase {
+    ALuint DirtyMask{VOICE_DIRTY_ALL};
+
     std::atomic<ALvoiceProps*> next{nullptr};
 
     DEF_NEWDEL(ALvoiceProps)
@@ -205,6 +229,20 @@ struct ALvoiceProps : public ALvoicePropsBase {
 #define VOICE_IS_AMBISONIC (1u<<2) /* Voice needs HF scaling for ambisonic upsampling. */
 #define VOICE_HAS_HRTF     (1u<<3)
 #define VOICE_HAS_NFC      (1u<<4)
+/* Hybrid binaural rendering: the voice is panned to the ambisonic mix instead
+ * of getting its own HRTF filter, and the voice is crossfading between the two
+ * paths after its mode changed.
+ */
+#define VOICE_HRTF_DEMOTED (1u<<5)
+#define VOICE_HRTF_SWITCH  (1u<<6)
+/* The voice's first-order channels are mixed to the device's shared NFC mix
+ * instead of being filtered by the voice (implies VOICE_HAS_NFC).
+ */
+#define VOICE_SHARED_NFC   (1u<<7)
+/* The quality governor found the voice too quiet to hear, so it advances
+ * without being mixed.
+ */
+#define VOICE_IS_VIRTUAL   (1u<<8)
 
 struct ALvoice {
     enum State {
@@ -218,6 +256,12 @@ struct ALvoice {
     std::atomic<ALuint> mSourceID{0u};
     std::atomic<State> mPlayState{Stopped};
 
+    /* Index in the context's voice array, and the link for the context's list
+     * of unused voices.
+     */
+    ALint mIndex{-1};
+    std::atomic<ALvoice*> next{nullptr};
+
     ALvoicePropsBase mProps;
 
     /**
@@ -249,17 +293,29 @@ struct ALvoice {
 
     ALuint mFlags;
 
-    using ResamplePaddingArray = std::array<ALfloat,MAX_RESAMPLE_PADDING*2>;
-    alignas(16) std::array<ResamplePaddingArray,MAX_INPUT_CHANNELS> mPrevSamples;
+    /* Ranking value for hybrid binaural rendering (the voice's dry gain), or
+     * negative if the voice can't use a per-source HRTF.
+     */
+    ALfloat mHrtfPriority{-1.0f};
 
     InterpState mResampleState;
 
-    std::array<ALfloat,MAX_INPUT_CHANNELS> mAmbiScales;
-    std::array<BandSplitter,MAX_INPUT_CHANNELS> mAmbiSplitter;
+    /* Per-channel state, allocated together for mMaxChannels channels (and
+     * the device's sends) and kept with the voice. It's only reallocated when
+     * the voice plays a buffer with more channels than it has room for.
+     */
+    using ResamplePaddingArray = std::array<ALfloat,MAX_RESAMPLE_PADDING*2>;
+    ALsizei mMaxChannels{0};
+    ResamplePaddingArray *mPrevSamples{nullptr};
+    ALfloat *mAmbiScales{nullptr};
+    BandSplitter *mAmbiSplitter{nullptr};
+
+    /* HRTF filter state for each channel, while the device renders with HRTF. */
+    std::array<VoiceHrtfState*,MAX_INPUT_CHANNELS> mHrtfState{};
 
     struct {
         int FilterType;
-        DirectParams Params[MAX_INPUT_CHANNELS];
+        DirectParams *Params{nullptr};
 
         ALfloat (*Buffer)[BUFFERSIZE];
         ALsizei Channels;
@@ -268,7 +324,7 @@ struct ALvoice {
 
     struct SendData {
         int FilterType;
-        SendParams Params[MAX_INPUT_CHANNELS];
+        SendParams *Params{nullptr};
 
         ALfloat (*Buffer)[BUFFERSIZE];
         ALsizei Channels;
@@ -287,6 +343,26 @@ struct ALvoice {
 };
 
 void DeinitVoice(ALvoice *voice) noexcept;
+/* Makes sure the voice has room for the given number of channels. Existing
+ * per-channel state isn't kept if it needs to grow. The mixer must not be
+ * using the voice.
+ */
+void ReserveVoiceChannels(ALvoice *voice, ALsizei numchans);
+/* Gives the voice HRTF filter state for its channels if the device renders
+ * with HRTF, and returns any it doesn't need to the context's pool. Must be
+ * called with the SourceLock held, while the mixer isn't using the voice.
+ */
+void UpdateVoiceHrtfState(ALCcontext *context, ALvoice *voice);
+
+/* Adds a voice that's now unused (stopped, with no source) to the context's
+ * free lists. Safe to call from the mixer.
+ */
+void RetireVoice(ALCcontext *context, ALvoice *voice) noexcept;
+/* Takes an unused voice from the context's free lists, preferring one that
+ * has room for the given number of channels. Returns null if there are none.
+ * Must be called with the SourceLock held.
+ */
+ALvoice *AcquireVoice(ALCcontext *context, ALsizei numchans) noexcept;
 
 
 using MixerFunc = void(*)(const ALfloat *data, const ALsizei OutChans,
@@ -295,12 +371,26 @@ using MixerFunc = void(*)(const ALfloat *data, const ALsizei OutChans,
 using RowMixerFunc = void(*)(ALfloat *OutBuffer, const ALfloat *gains,
     const ALfloat (*data)[BUFFERSIZE], const ALsizei InChans, const ALsizei InPos,
     const ALsizei BufferSize);
+/* Mixes InChans inputs to OutChans outputs, with output o's gains (one per
+ * input) starting at gains[o*GainStride].
+ */
+using MatrixMixerFunc = void(*)(ALfloat (*OutBuffer)[BUFFERSIZE], const ALsizei OutChans,
+    const ALfloat *gains, const ALsizei GainStride, const ALfloat (*data)[BUFFERSIZE],
+    const ALsizei InChans, const ALsizei InPos, const ALsizei BufferSize);
 using HrtfMixerFunc = void(*)(ALfloat *RESTRICT LeftOut, ALfloat *RESTRICT RightOut,
     const ALfloat *data, float2 *RESTRICT AccumSamples, const ALsizei OutPos, const ALsizei IrSize,
     MixHrtfParams *hrtfparams, const ALsizei BufferSize);
 using HrtfMixerBlendFunc = void(*)(ALfloat *RESTRICT LeftOut, ALfloat *RESTRICT RightOut,
     const ALfloat *data, float2 *RESTRICT AccumSamples, const ALsizei OutPos, const ALsizei IrSize,
     const HrtfParams *oldparams, MixHrtfParams *newparams, const ALsizei BufferSize);
+using HrtfFftMixerFunc = void(*)(ALfloat *RESTRICT LeftOut, ALfloat *RESTRICT RightOut,
+    const ALfloat *data, float2 *RESTRICT AccumSamples, const ALsizei OutPos, const ALsizei IrSize,
+    const HrtfSpectra *spectra, MixHrtfParams *hrtfparams, HrtfFftBuffers *buffers,
+    const ALsizei BufferSize);
+using HrtfFftMixerBlendFunc = void(*)(ALfloat *RESTRICT LeftOut, ALfloat *RESTRICT RightOut,
+    const ALfloat *data, float2 *RESTRICT AccumSamples, const ALsizei OutPos, const ALsizei IrSize,
+    const HrtfParams *oldparams, const HrtfSpectra *oldspectra, MixHrtfParams *newparams,
+    const HrtfSpectra *newspectra, HrtfFftBuffers *buffers, const ALsizei BufferSize);
 using HrtfDirectMixerFunc = void(*)(ALfloat *RESTRICT LeftOut, ALfloat *RESTRICT RightOut,
     const ALfloat (*data)[BUFFERSIZE], float2 *RESTRICT AccumSamples, DirectHrtfState *State,
     const ALsizei NumChans, const ALsizei BufferSize);
@@ -425,12 +515,17 @@ inline std::array<ALfloat,MAX_AMBI_CHANNELS> GetAmbiIdentityRow(size_t i) noexce
 
 void MixVoice(ALvoice *voice, ALvoice::State vstate, const ALuint SourceID, ALCcontext *Context, const ALsizei SamplesToDo);
 
+/* Converts and adds the given number of samples to dst. */
+void LoadSamples(ALfloat *RESTRICT dst, const ALvoid *RESTRICT src, ALint srcstep, FmtType srctype,
+    const ptrdiff_t samples);
+
 void aluMixData(ALCdevice *device, ALvoid *OutBuffer, ALsizei NumSamples);
 /* Caller must lock the device state, and the mixer must not be running. */
 void aluHandleDisconnect(ALCdevice *device, const char *msg, ...) DECL_FORMAT(printf, 2, 3);
 
 extern MixerFunc MixSamples;
 extern RowMixerFunc MixRowSamples;
+extern MatrixMixerFunc MixMatrixSamples;
 
 extern const ALfloat ConeScale;
 extern const ALfloat ZScale;
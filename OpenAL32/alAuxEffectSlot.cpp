@@ -35,6 +35,7 @@
 #include "alError.h"
 #include "alListener.h"
 #include "alSource.h"
+#include "alBuffer.h"
 
 #include "fpu_modes.h"
 #include "alexcpt.h"
@@ -69,6 +70,67 @@ inline ALeffect *LookupEffect(ALCdevice *device, ALuint id) noexcept
     return sublist.Effects + slidx;
 }
 
+inline ALbuffer *LookupBuffer(ALCdevice *device, ALuint id) noexcept
+{
+    ALuint lidx = (id-1) >> 6;
+    ALsizei slidx = (id-1) & 0x3f;
+
+    if(UNLIKELY(lidx >= device->BufferList.size()))
+        return nullptr;
+    BufferSubList &sublist = device->BufferList[lidx];
+    if(UNLIKELY(sublist.FreeMask & (1_u64 << slidx)))
+        return nullptr;
+    return sublist.Buffers + slidx;
+}
+
+
+/* Removes state references from old effect slot property updates. */
+void RemoveStaleStates(ALCcontext *Context)
+{
+    ALeffectslotProps *props{Context->FreeEffectslotProps.mFree.load()};
+    while(props)
+    {
+        if(props->State)
+            props->State->DecRef();
+        props->State = nullptr;
+        props = props->next.load(std::memory_order_relaxed);
+    }
+}
+
+/* Creates a new effect state of the given type, set up for the device and
+ * with the given buffer loaded.
+ */
+ALenum CreateEffectState(ALCdevice *Device, ALenum type, const ALbuffer *buffer,
+    EffectState **state)
+{
+    EffectStateFactory *factory{getFactoryByType(type)};
+    if(!factory)
+    {
+        ERR("Failed to find factory for effect type 0x%04x\n", type);
+        return AL_INVALID_ENUM;
+    }
+    EffectState *State{factory->create()};
+    if(!State) return AL_OUT_OF_MEMORY;
+
+    FPUCtl mixer_mode{};
+    std::unique_lock<std::mutex> statelock{Device->StateLock};
+    State->mOutBuffer = Device->Dry.Buffer;
+    State->mOutChannels = Device->Dry.NumChannels;
+    if(State->deviceUpdate(Device) == AL_FALSE)
+    {
+        statelock.unlock();
+        mixer_mode.leave();
+        State->DecRef();
+        return AL_OUT_OF_MEMORY;
+    }
+    if(buffer)
+        State->setBuffer(Device, buffer);
+    mixer_mode.leave();
+
+    *state = State;
+    return AL_NO_ERROR;
+}
+
 
 void AddActiveEffectSlots(const ALuint *slotids, ALsizei count, ALCcontext *context)
 {
@@ -424,6 +486,26 @@ START_API_FUNC
         slot->Target = target;
         break;
 
+    case AL_BUFFER:
+        device = context->Device;
+
+        { std::lock_guard<std::mutex> ___{device->BufferLock};
+            ALbuffer *buffer{value ? LookupBuffer(device, value) : nullptr};
+            if(!(value == 0 || buffer != nullptr))
+                SETERR_RETURN(context.get(), AL_INVALID_VALUE,, "Invalid buffer ID %u", value);
+            if(buffer && buffer->MappedAccess != 0 &&
+               !(buffer->MappedAccess&AL_MAP_PERSISTENT_BIT_SOFT))
+                SETERR_RETURN(context.get(), AL_INVALID_OPERATION,,
+                    "Setting non-persistently mapped buffer %u", buffer->id);
+            err = SetEffectSlotBuffer(context.get(), slot, buffer);
+        }
+        if(err != AL_NO_ERROR)
+        {
+            alSetError(context.get(), err, "Effect buffer initialization failed");
+            return;
+        }
+        break;
+
     default:
         SETERR_RETURN(context.get(), AL_INVALID_ENUM,,
                       "Invalid effect slot integer property 0x%04x", param);
@@ -440,6 +522,7 @@ START_API_FUNC
     case AL_EFFECTSLOT_EFFECT:
     case AL_EFFECTSLOT_AUXILIARY_SEND_AUTO:
     case AL_EFFECTSLOT_TARGET_SOFT:
+    case AL_BUFFER:
         alAuxiliaryEffectSloti(effectslot, param, values[0]);
         return;
     }
@@ -538,6 +621,10 @@ START_API_FUNC
         *value = slot->Target ? slot->Target->id : 0;
         break;
 
+    case AL_BUFFER:
+        *value = slot->Buffer ? slot->Buffer->id : 0;
+        break;
+
     default:
         SETERR_RETURN(context.get(), AL_INVALID_ENUM,,
                       "Invalid effect slot integer property 0x%04x", param);
@@ -553,6 +640,7 @@ START_API_FUNC
     case AL_EFFECTSLOT_EFFECT:
     case AL_EFFECTSLOT_AUXILIARY_SEND_AUTO:
     case AL_EFFECTSLOT_TARGET_SOFT:
+    case AL_BUFFER:
         alGetAuxiliaryEffectSloti(effectslot, param, values);
         return;
     }
@@ -631,28 +719,9 @@ ALenum InitializeEffect(ALCcontext *Context, ALeffectslot *EffectSlot, ALeffect
     ALenum newtype{effect ? effect->type : AL_EFFECT_NULL};
     if(newtype != EffectSlot->Effect.Type)
     {
-        EffectStateFactory *factory{getFactoryByType(newtype)};
-        if(!factory)
-        {
-            ERR("Failed to find factory for effect type 0x%04x\n", newtype);
-            return AL_INVALID_ENUM;
-        }
-        EffectState *State{factory->create()};
-        if(!State) return AL_OUT_OF_MEMORY;
-
-        FPUCtl mixer_mode{};
-        ALCdevice *Device{Context->Device};
-        std::unique_lock<std::mutex> statelock{Device->StateLock};
-        State->mOutBuffer = Device->Dry.Buffer;
-        State->mOutChannels = Device->Dry.NumChannels;
-        if(State->deviceUpdate(Device) == AL_FALSE)
-        {
-            statelock.unlock();
-            mixer_mode.leave();
-            State->DecRef();
-            return AL_OUT_OF_MEMORY;
-        }
-        mixer_mode.leave();
+        EffectState *State{};
+        ALenum err{CreateEffectState(Context->Device, newtype, EffectSlot->Buffer, &State)};
+        if(err != AL_NO_ERROR) return err;
 
         if(!effect)
         {
@@ -671,16 +740,43 @@ ALenum InitializeEffect(ALCcontext *Context, ALeffectslot *EffectSlot, ALeffect
     else if(effect)
         EffectSlot->Effect.Props = effect->Props;
 
-    /* Remove state references from old effect slot property updates. */
-    ALeffectslotProps *props{Context->FreeEffectslotProps.load()};
-    while(props)
+    RemoveStaleStates(Context);
+
+    return AL_NO_ERROR;
+}
+
+ALenum SetEffectSlotBuffer(ALCcontext *Context, ALeffectslot *EffectSlot, ALbuffer *buffer)
+{
+    /* Only the convolution effect uses the buffer. Other effects just hold
+     * the reference for when the slot changes to it, and keep their running
+     * state.
+     */
+    if(EffectSlot->Effect.Type != AL_EFFECT_CONVOLUTION_REVERB_SOFT)
     {
-        if(props->State)
-            props->State->DecRef();
-        props->State = nullptr;
-        props = props->next.load(std::memory_order_relaxed);
+        if(buffer) IncrementRef(&buffer->ref);
+        if(ALbuffer *oldbuffer{EffectSlot->Buffer})
+            DecrementRef(&oldbuffer->ref);
+        EffectSlot->Buffer = buffer;
+        return AL_NO_ERROR;
     }
 
+    /* Load the buffer into a new state for the effect, so the mixer can keep
+     * using the old one until the update goes through.
+     */
+    EffectState *State{};
+    ALenum err{CreateEffectState(Context->Device, EffectSlot->Effect.Type, buffer, &State)};
+    if(err != AL_NO_ERROR) return err;
+
+    if(buffer) IncrementRef(&buffer->ref);
+    if(ALbuffer *oldbuffer{EffectSlot->Buffer})
+        DecrementRef(&oldbuffer->ref);
+    EffectSlot->Buffer = buffer;
+
+    EffectSlot->Effect.State->DecRef();
+    EffectSlot->Effect.State = State;
+
+    RemoveStaleStates(Context);
+
     return AL_NO_ERROR;
 }
 
@@ -716,6 +812,9 @@ ALeffectslot::~ALeffectslot()
     if(Target)
         DecrementRef(&Target->ref);
     Target = nullptr;
+    if(Buffer)
+        DecrementRef(&Buffer->ref);
+    Buffer = nullptr;
 
     ALeffectslotProps *props{Update.load()};
     if(props)
@@ -734,17 +833,8 @@ ALeffectslot::~ALeffectslot()
 void UpdateEffectSlotProps(ALeffectslot *slot, ALCcontext *context)
 {
     /* Get an unused property container, or allocate a new one as needed. */
-    ALeffectslotProps *props{context->FreeEffectslotProps.load(std::memory_order_relaxed)};
-    if(!props)
-        props = static_cast<ALeffectslotProps*>(al_calloc(16, sizeof(*props)));
-    else
-    {
-        ALeffectslotProps *next;
-        do {
-            next = props->next.load(std::memory_order_relaxed);
-        } while(context->FreeEffectslotProps.compare_exchange_weak(props, next,
-                std::memory_order_seq_cst, std::memory_order_acquire) == 0);
-    }
+    ALeffectslotProps *props{context->FreeEffectslotProps.get(context, slot->Update,
+        []() -> ALeffectslotProps* { return static_cast<ALeffectslotProps*>(al_calloc(16, sizeof(ALeffectslotProps))); })};
 
     /* Copy in current property values. */
     props->Gain = slot->Gain;
@@ -770,7 +860,7 @@ void UpdateEffectSlotProps(ALeffectslot *slot, ALCcontext *context)
         if(props->State)
             props->State->DecRef();
         props->State = nullptr;
-        AtomicReplaceHead(context->FreeEffectslotProps, props);
+        context->FreeEffectslotProps.push(props);
     }
 
     if(oldstate)
@@ -417,17 +417,8 @@ END_API_FUNC
 void UpdateListenerProps(ALCcontext *context)
 {
     /* Get an unused proprty container, or allocate a new one as needed. */
-    ALlistenerProps *props{context->FreeListenerProps.load(std::memory_order_acquire)};
-    if(!props)
-        props = static_cast<ALlistenerProps*>(al_calloc(16, sizeof(*props)));
-    else
-    {
-        ALlistenerProps *next;
-        do {
-            next = props->next.load(std::memory_order_relaxed);
-        } while(context->FreeListenerProps.compare_exchange_weak(props, next,
-                std::memory_order_seq_cst, std::memory_order_acquire) == 0);
-    }
+    ALlistenerProps *props{context->FreeListenerProps.get(context, context->Listener.Update,
+        []() -> ALlistenerProps* { return static_cast<ALlistenerProps*>(al_calloc(16, sizeof(ALlistenerProps))); })};
 
     /* Copy in current property values. */
     ALlistener &listener = context->Listener;
@@ -444,6 +435,6 @@ void UpdateListenerProps(ALCcontext *context)
         /* If there was an unused update container, put it back in the
          * freelist.
          */
-        AtomicReplaceHead(context->FreeListenerProps, props);
+        context->FreeListenerProps.push(props);
     }
 }
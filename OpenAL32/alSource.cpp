@@ -43,6 +43,7 @@
 #include "alAuxEffectSlot.h"
 #include "ringbuffer.h"
 #include "bformatdec.h"
+#include "trace.h"
 
 #include "backends/base.h"
 
@@ -51,6 +52,14 @@
 #include "almalloc.h"
 
 
+struct SourceCmdQueue {
+    std::thread::id mOwner;
+    RingBufferPtr mCommands;
+    SourceCmdQueue *mNext{nullptr};
+
+    DEF_NEWDEL(SourceCmdQueue)
+};
+
 namespace {
 
 using namespace std::placeholders;
@@ -61,7 +70,7 @@ inline ALvoice *GetSourceVoice(ALsource *source, ALCcontext *context)
     if(idx >= 0 && idx < context->VoiceCount.load(std::memory_order_relaxed))
     {
         ALuint sid{source->id};
-        ALvoice *voice{context->Voices[idx]};
+        ALvoice *voice{(*context->Voices.load(std::memory_order_relaxed))[static_cast<size_t>(idx)]};
         if(voice->mSourceID.load(std::memory_order_acquire) == sid)
             return voice;
     }
@@ -69,20 +78,25 @@ inline ALvoice *GetSourceVoice(ALsource *source, ALCcontext *context)
     return nullptr;
 }
 
-void UpdateSourceProps(const ALsource *source, ALvoice *voice, ALCcontext *context)
+/* Sends the source's properties to its voice. Set backlocked if the backend
+ * lock is held, so it won't wait on the mixer for a property container.
+ */
+void UpdateSourceProps(ALsource *source, ALvoice *voice, ALCcontext *context,
+    bool backlocked=false)
 {
+    /* Note what changed since the last update, including an update the mixer
+     * hasn't taken yet, since this one replaces it. The mixer only reads the
+     * containers, so the pending one is safe to look at.
+     */
+    ALuint dirty{source->PropsDirty};
+    if(ALvoiceProps *pending{voice->mUpdate.load(std::memory_order_acquire)})
+        dirty |= pending->DirtyMask;
+    source->PropsDirty = 0u;
+
     /* Get an unused property container, or allocate a new one as needed. */
-    ALvoiceProps *props{context->FreeVoiceProps.load(std::memory_order_acquire)};
-    if(!props)
-        props = new ALvoiceProps{};
-    else
-    {
-        ALvoiceProps *next;
-        do {
-            next = props->next.load(std::memory_order_relaxed);
-        } while(context->FreeVoiceProps.compare_exchange_weak(props, next,
-                std::memory_order_acq_rel, std::memory_order_acquire) == 0);
-    }
+    ALvoiceProps *props{context->FreeVoiceProps.get(context, voice->mUpdate,
+        []() -> ALvoiceProps* { return new ALvoiceProps{}; }, !backlocked)};
+    props->DirtyMask = dirty;
 
     /* Copy in current property values. */
     props->Pitch = source->Pitch;
@@ -145,7 +159,7 @@ void UpdateSourceProps(const ALsource *source, ALvoice *voice, ALCcontext *conte
         /* If there was an unused update container, put it back in the
          * freelist.
          */
-        AtomicReplaceHead(context->FreeVoiceProps, props);
+        context->FreeVoiceProps.push(props);
     }
 }
 
@@ -361,19 +375,18 @@ ALdouble GetSourceOffset(ALsource *Source, ALenum name, ALCcontext *context)
 }
 
 
-/* GetSampleOffset
+/* CalcSampleOffset
  *
- * Retrieves the sample offset into the Source's queue (from the Sample, Byte
- * or Second offset supplied by the application). This takes into account the
- * fact that the buffer format may have been modifed since.
+ * Calculates the sample offset into the given queue from an offset of the
+ * given type. This takes into account the fact that the buffer format may
+ * have been modifed since. Returns AL_FALSE if the queue has no buffers.
  */
-ALboolean GetSampleOffset(ALsource *Source, ALuint *offset, ALsizei *frac)
+ALboolean CalcSampleOffset(const ALbufferlistitem *BufferList, ALenum OffsetType,
+    ALdouble Offset, ALuint *offset, ALsizei *frac)
 {
     const ALbuffer *BufferFmt{nullptr};
-    const ALbufferlistitem *BufferList;
- 
+
     /* Find the first valid Buffer in the Queue */
-    BufferList = Source->queue;
     while(BufferList)
     {
         for(ALsizei i{0};i < BufferList->num_buffers && !BufferFmt;i++)
@@ -382,18 +395,14 @@ ALboolean GetSampleOffset(ALsource *Source, ALuint *offset, ALsizei *frac)
         BufferList = BufferList->next.load(std::memory_order_relaxed);
     }
     if(!BufferFmt)
-    {
-        Source->OffsetType = AL_NONE;
-        Source->Offset = 0.0;
         return AL_FALSE;
-    }
 
     ALdouble dbloff, dblfrac;
-    switch(Source->OffsetType)
+    switch(OffsetType)
     {
     case AL_BYTE_OFFSET:
         /* Determine the ByteOffset (and ensure it is block aligned) */
-        *offset = static_cast<ALuint>(Source->Offset);
+        *offset = static_cast<ALuint>(Offset);
         if(BufferFmt->OriginalType == UserFmtIMA4)
         {
             ALsizei align = (BufferFmt->OriginalAlign-1)/2 + 4;
@@ -412,21 +421,33 @@ ALboolean GetSampleOffset(ALsource *Source, ALuint *offset, ALsizei *frac)
         break;
 
     case AL_SAMPLE_OFFSET:
-        dblfrac = modf(Source->Offset, &dbloff);
+        dblfrac = modf(Offset, &dbloff);
         *offset = static_cast<ALuint>(mind(dbloff, std::numeric_limits<unsigned int>::max()));
         *frac = static_cast<ALsizei>(mind(dblfrac*FRACTIONONE, FRACTIONONE-1.0));
         break;
 
     case AL_SEC_OFFSET:
-        dblfrac = modf(Source->Offset*BufferFmt->Frequency, &dbloff);
+        dblfrac = modf(Offset*BufferFmt->Frequency, &dbloff);
         *offset = static_cast<ALuint>(mind(dbloff, std::numeric_limits<unsigned int>::max()));
         *frac = static_cast<ALsizei>(mind(dblfrac*FRACTIONONE, FRACTIONONE-1.0));
         break;
     }
+    return AL_TRUE;
+}
+
+/* GetSampleOffset
+ *
+ * Retrieves the sample offset into the Source's queue (from the Sample, Byte
+ * or Second offset supplied by the application), and clears the stored
+ * offset.
+ */
+ALboolean GetSampleOffset(ALsource *Source, ALuint *offset, ALsizei *frac)
+{
+    const ALboolean ret{CalcSampleOffset(Source->queue, Source->OffsetType, Source->Offset,
+        offset, frac)};
     Source->OffsetType = AL_NONE;
     Source->Offset = 0.0;
-
-    return AL_TRUE;
+    return ret;
 }
 
 /* ApplyOffset
@@ -542,6 +563,8 @@ void FreeSource(ALCcontext *context, ALsource *source)
         ALvoice::State oldvstate{ALvoice::Playing};
         voice->mPlayState.compare_exchange_strong(oldvstate, ALvoice::Stopping,
             std::memory_order_acq_rel, std::memory_order_acquire);
+        if(oldvstate == ALvoice::Stopped)
+            RetireVoice(context, voice);
     }
     backlock.unlock();
 
@@ -693,12 +716,12 @@ inline ALenum GetSourceState(ALsource *source, ALvoice *voice)
 
 /**
  * Returns if the source should specify an update, given the context's
- * deferring state and the source's last known state.
+ * deferring or batching state and the source's last known state.
  */
 inline bool SourceShouldUpdate(ALsource *source, ALCcontext *context)
 {
     return !context->DeferUpdates.load(std::memory_order_acquire) &&
-           IsPlayingOrPaused(source);
+           !context->BatchSourceProps && IsPlayingOrPaused(source);
 }
 
 
@@ -971,6 +994,8 @@ ALint Int64ValsByProp(ALenum prop)
 ALboolean SetSourcefv(ALsource *Source, ALCcontext *Context, SourceProp prop, const ALfloat *values);
 ALboolean SetSourceiv(ALsource *Source, ALCcontext *Context, SourceProp prop, const ALint *values);
 ALboolean SetSourcei64v(ALsource *Source, ALCcontext *Context, SourceProp prop, const ALint64SOFT *values);
+ALboolean CheckSourcefv(ALsource *Source, ALCcontext *Context, SourceProp prop, const ALfloat *values);
+ALboolean CheckSourceiv(ALsource *Source, ALCcontext *Context, SourceProp prop, const ALint *values);
 
 #define CHECKVAL(x) do {                                                      \
     if(!(x))                                                                  \
@@ -980,15 +1005,274 @@ ALboolean SetSourcei64v(ALsource *Source, ALCcontext *Context, SourceProp prop,
     }                                                                         \
 } while(0)
 
-#define DO_UPDATEPROPS() do {                                                 \
+#define DO_UPDATEPROPS(dirty) do {                                            \
     ALvoice *voice;                                                           \
+    Source->PropsDirty |= (dirty);                                            \
     if(SourceShouldUpdate(Source, Context) &&                                 \
-       (voice=GetSourceVoice(Source, Context)) != nullptr)                       \
+       (voice=GetSourceVoice(Source, Context)) != nullptr)                    \
         UpdateSourceProps(Source, voice, Context);                            \
     else                                                                      \
         Source->PropsClean.clear(std::memory_order_release);                  \
 } while(0)
 
+/* Checks that an offset can be applied to the source, if it's playing. */
+ALboolean CheckSourceOffset(ALsource *Source, ALCcontext *Context, ALenum type, ALdouble value)
+{
+    if(!IsPlayingOrPaused(Source))
+        return AL_TRUE;
+
+    ALuint offset{0u};
+    ALsizei frac{0};
+    if(CalcSampleOffset(Source->queue, type, value, &offset, &frac))
+    {
+        ALuint totalBufferLen{0u};
+        const ALbufferlistitem *BufferList{Source->queue};
+        while(BufferList)
+        {
+            totalBufferLen += BufferList->max_samples;
+            if(totalBufferLen > offset)
+                return AL_TRUE;
+            BufferList = BufferList->next.load(std::memory_order_relaxed);
+        }
+    }
+    SETERR_RETURN(Context, AL_INVALID_VALUE, AL_FALSE, "Invalid offset");
+}
+
+/* These check the values for a property the same way the setters do, setting
+ * the same error on failure, but without changing the source. They let a
+ * batch of properties be validated before any of it is applied.
+ */
+ALboolean CheckSourcefv(ALsource *Source, ALCcontext *Context, SourceProp prop, const ALfloat *values)
+{
+    ALint ival;
+
+    switch(prop)
+    {
+        case AL_SEC_OFFSET_LATENCY_SOFT:
+        case AL_SEC_OFFSET_CLOCK_SOFT:
+            SETERR_RETURN(Context, AL_INVALID_OPERATION, AL_FALSE,
+                          "Setting read-only source property 0x%04x", prop);
+
+        case AL_PITCH:
+        case AL_GAIN:
+        case AL_MAX_DISTANCE:
+        case AL_ROLLOFF_FACTOR:
+        case AL_REFERENCE_DISTANCE:
+        case AL_MIN_GAIN:
+        case AL_MAX_GAIN:
+            CHECKVAL(*values >= 0.0f);
+            return AL_TRUE;
+
+        case AL_CONE_INNER_ANGLE:
+        case AL_CONE_OUTER_ANGLE:
+            CHECKVAL(*values >= 0.0f && *values <= 360.0f);
+            return AL_TRUE;
+
+        case AL_CONE_OUTER_GAIN:
+        case AL_CONE_OUTER_GAINHF:
+        case AL_DOPPLER_FACTOR:
+            CHECKVAL(*values >= 0.0f && *values <= 1.0f);
+            return AL_TRUE;
+
+        case AL_AIR_ABSORPTION_FACTOR:
+        case AL_ROOM_ROLLOFF_FACTOR:
+            CHECKVAL(*values >= 0.0f && *values <= 10.0f);
+            return AL_TRUE;
+
+        case AL_SEC_OFFSET:
+        case AL_SAMPLE_OFFSET:
+        case AL_BYTE_OFFSET:
+            CHECKVAL(*values >= 0.0f);
+            return CheckSourceOffset(Source, Context, prop, *values);
+
+        case AL_SOURCE_RADIUS:
+            CHECKVAL(*values >= 0.0f && std::isfinite(*values));
+            return AL_TRUE;
+
+        case AL_STEREO_ANGLES:
+            CHECKVAL(std::isfinite(values[0]) && std::isfinite(values[1]));
+            return AL_TRUE;
+
+        case AL_POSITION:
+        case AL_VELOCITY:
+        case AL_DIRECTION:
+            CHECKVAL(std::isfinite(values[0]) && std::isfinite(values[1]) && std::isfinite(values[2]));
+            return AL_TRUE;
+
+        case AL_ORIENTATION:
+            CHECKVAL(std::isfinite(values[0]) && std::isfinite(values[1]) && std::isfinite(values[2]) &&
+                     std::isfinite(values[3]) && std::isfinite(values[4]) && std::isfinite(values[5]));
+            return AL_TRUE;
+
+        case AL_SOURCE_RELATIVE:
+        case AL_LOOPING:
+        case AL_SOURCE_STATE:
+        case AL_SOURCE_TYPE:
+        case AL_DISTANCE_MODEL:
+        case AL_DIRECT_FILTER_GAINHF_AUTO:
+        case AL_AUXILIARY_SEND_FILTER_GAIN_AUTO:
+        case AL_AUXILIARY_SEND_FILTER_GAINHF_AUTO:
+        case AL_DIRECT_CHANNELS_SOFT:
+        case AL_SOURCE_RESAMPLER_SOFT:
+        case AL_SOURCE_SPATIALIZE_SOFT:
+            ival = static_cast<ALint>(values[0]);
+            return CheckSourceiv(Source, Context, prop, &ival);
+
+        case AL_BUFFERS_QUEUED:
+        case AL_BUFFERS_PROCESSED:
+            ival = static_cast<ALint>(static_cast<ALuint>(values[0]));
+            return CheckSourceiv(Source, Context, prop, &ival);
+
+        case AL_BUFFER:
+        case AL_DIRECT_FILTER:
+        case AL_AUXILIARY_SEND_FILTER:
+        case AL_SAMPLE_OFFSET_LATENCY_SOFT:
+        case AL_SAMPLE_OFFSET_CLOCK_SOFT:
+            break;
+    }
+
+    SETERR_RETURN(Context, AL_INVALID_ENUM, AL_FALSE, "Invalid source float property 0x%04x", prop);
+}
+
+ALboolean CheckSourceiv(ALsource *Source, ALCcontext *Context, SourceProp prop, const ALint *values)
+{
+    ALCdevice *device{Context->Device};
+    ALbuffer *buffer{nullptr};
+    ALfloat fvals[6];
+
+    switch(prop)
+    {
+        case AL_SOURCE_STATE:
+        case AL_SOURCE_TYPE:
+        case AL_BUFFERS_QUEUED:
+        case AL_BUFFERS_PROCESSED:
+            SETERR_RETURN(Context, AL_INVALID_OPERATION, AL_FALSE,
+                          "Setting read-only source property 0x%04x", prop);
+
+        case AL_SOURCE_RELATIVE:
+        case AL_LOOPING:
+        case AL_DIRECT_FILTER_GAINHF_AUTO:
+        case AL_AUXILIARY_SEND_FILTER_GAIN_AUTO:
+        case AL_AUXILIARY_SEND_FILTER_GAINHF_AUTO:
+        case AL_DIRECT_CHANNELS_SOFT:
+            CHECKVAL(*values == AL_FALSE || *values == AL_TRUE);
+            return AL_TRUE;
+
+        case AL_BUFFER:
+        {
+            std::lock_guard<std::mutex> _{device->BufferLock};
+            if(!(*values == 0 || (buffer=LookupBuffer(device, *values)) != nullptr))
+                SETERR_RETURN(Context, AL_INVALID_VALUE, AL_FALSE, "Invalid buffer ID %u",
+                              *values);
+            if(buffer && buffer->MappedAccess != 0 &&
+               !(buffer->MappedAccess&AL_MAP_PERSISTENT_BIT_SOFT))
+                SETERR_RETURN(Context, AL_INVALID_OPERATION, AL_FALSE,
+                              "Setting non-persistently mapped buffer %u", buffer->id);
+            if(IsPlayingOrPaused(Source))
+                SETERR_RETURN(Context, AL_INVALID_OPERATION, AL_FALSE,
+                              "Setting buffer on playing or paused source %u", Source->id);
+            return AL_TRUE;
+        }
+
+        case AL_SEC_OFFSET:
+        case AL_SAMPLE_OFFSET:
+        case AL_BYTE_OFFSET:
+            CHECKVAL(*values >= 0);
+            return CheckSourceOffset(Source, Context, prop, *values);
+
+        case AL_DIRECT_FILTER:
+        {
+            std::lock_guard<std::mutex> _{device->FilterLock};
+            if(!(*values == 0 || LookupFilter(device, *values) != nullptr))
+                SETERR_RETURN(Context, AL_INVALID_VALUE, AL_FALSE, "Invalid filter ID %u",
+                              *values);
+            return AL_TRUE;
+        }
+
+        case AL_DISTANCE_MODEL:
+            CHECKVAL(*values == AL_NONE ||
+                     *values == AL_INVERSE_DISTANCE ||
+                     *values == AL_INVERSE_DISTANCE_CLAMPED ||
+                     *values == AL_LINEAR_DISTANCE ||
+                     *values == AL_LINEAR_DISTANCE_CLAMPED ||
+                     *values == AL_EXPONENT_DISTANCE ||
+                     *values == AL_EXPONENT_DISTANCE_CLAMPED);
+            return AL_TRUE;
+
+        case AL_SOURCE_RESAMPLER_SOFT:
+            CHECKVAL(*values >= 0 && *values <= ResamplerMax);
+            return AL_TRUE;
+
+        case AL_SOURCE_SPATIALIZE_SOFT:
+            CHECKVAL(*values >= AL_FALSE && *values <= AL_AUTO_SOFT);
+            return AL_TRUE;
+
+        case AL_AUXILIARY_SEND_FILTER:
+        {
+            std::lock_guard<std::mutex> _{Context->EffectSlotLock};
+            if(!(values[0] == 0 || LookupEffectSlot(Context, values[0]) != nullptr))
+                SETERR_RETURN(Context, AL_INVALID_VALUE, AL_FALSE, "Invalid effect ID %u",
+                              values[0]);
+            if(static_cast<ALuint>(values[1]) >= static_cast<ALuint>(device->NumAuxSends))
+                SETERR_RETURN(Context, AL_INVALID_VALUE, AL_FALSE, "Invalid send %u", values[1]);
+
+            std::lock_guard<std::mutex> __{device->FilterLock};
+            if(!(values[2] == 0 || LookupFilter(device, values[2]) != nullptr))
+                SETERR_RETURN(Context, AL_INVALID_VALUE, AL_FALSE, "Invalid filter ID %u",
+                              values[2]);
+            return AL_TRUE;
+        }
+
+        /* 1x float */
+        case AL_CONE_INNER_ANGLE:
+        case AL_CONE_OUTER_ANGLE:
+        case AL_PITCH:
+        case AL_GAIN:
+        case AL_MIN_GAIN:
+        case AL_MAX_GAIN:
+        case AL_REFERENCE_DISTANCE:
+        case AL_ROLLOFF_FACTOR:
+        case AL_CONE_OUTER_GAIN:
+        case AL_MAX_DISTANCE:
+        case AL_DOPPLER_FACTOR:
+        case AL_CONE_OUTER_GAINHF:
+        case AL_AIR_ABSORPTION_FACTOR:
+        case AL_ROOM_ROLLOFF_FACTOR:
+        case AL_SOURCE_RADIUS:
+            fvals[0] = static_cast<ALfloat>(*values);
+            return CheckSourcefv(Source, Context, prop, fvals);
+
+        /* 3x float */
+        case AL_POSITION:
+        case AL_VELOCITY:
+        case AL_DIRECTION:
+            fvals[0] = static_cast<ALfloat>(values[0]);
+            fvals[1] = static_cast<ALfloat>(values[1]);
+            fvals[2] = static_cast<ALfloat>(values[2]);
+            return CheckSourcefv(Source, Context, prop, fvals);
+
+        /* 6x float */
+        case AL_ORIENTATION:
+            fvals[0] = static_cast<ALfloat>(values[0]);
+            fvals[1] = static_cast<ALfloat>(values[1]);
+            fvals[2] = static_cast<ALfloat>(values[2]);
+            fvals[3] = static_cast<ALfloat>(values[3]);
+            fvals[4] = static_cast<ALfloat>(values[4]);
+            fvals[5] = static_cast<ALfloat>(values[5]);
+            return CheckSourcefv(Source, Context, prop, fvals);
+
+        case AL_SAMPLE_OFFSET_LATENCY_SOFT:
+        case AL_SEC_OFFSET_LATENCY_SOFT:
+        case AL_SEC_OFFSET_CLOCK_SOFT:
+        case AL_SAMPLE_OFFSET_CLOCK_SOFT:
+        case AL_STEREO_ANGLES:
+            break;
+    }
+
+    SETERR_RETURN(Context, AL_INVALID_ENUM, AL_FALSE, "Invalid source integer property 0x%04x",
+                  prop);
+}
+
 ALboolean SetSourcefv(ALsource *Source, ALCcontext *Context, SourceProp prop, const ALfloat *values)
 {
     ALint ival;
@@ -1005,98 +1289,98 @@ ALboolean SetSourcefv(ALsource *Source, ALCcontext *Context, SourceProp prop, co
             CHECKVAL(*values >= 0.0f);
 
             Source->Pitch = *values;
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_PITCH);
             return AL_TRUE;
 
         case AL_CONE_INNER_ANGLE:
             CHECKVAL(*values >= 0.0f && *values <= 360.0f);
 
             Source->InnerAngle = *values;
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_OTHER);
             return AL_TRUE;
 
         case AL_CONE_OUTER_ANGLE:
             CHECKVAL(*values >= 0.0f && *values <= 360.0f);
 
             Source->OuterAngle = *values;
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_OTHER);
             return AL_TRUE;
 
         case AL_GAIN:
             CHECKVAL(*values >= 0.0f);
 
             Source->Gain = *values;
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_GAIN);
             return AL_TRUE;
 
         case AL_MAX_DISTANCE:
             CHECKVAL(*values >= 0.0f);
 
             Source->MaxDistance = *values;
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_OTHER);
             return AL_TRUE;
 
         case AL_ROLLOFF_FACTOR:
             CHECKVAL(*values >= 0.0f);
 
             Source->RolloffFactor = *values;
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_OTHER);
             return AL_TRUE;
 
         case AL_REFERENCE_DISTANCE:
             CHECKVAL(*values >= 0.0f);
 
             Source->RefDistance = *values;
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_OTHER);
             return AL_TRUE;
 
         case AL_MIN_GAIN:
             CHECKVAL(*values >= 0.0f);
 
             Source->MinGain = *values;
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_GAIN);
             return AL_TRUE;
 
         case AL_MAX_GAIN:
             CHECKVAL(*values >= 0.0f);
 
             Source->MaxGain = *values;
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_GAIN);
             return AL_TRUE;
 
         case AL_CONE_OUTER_GAIN:
             CHECKVAL(*values >= 0.0f && *values <= 1.0f);
 
             Source->OuterGain = *values;
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_OTHER);
             return AL_TRUE;
 
         case AL_CONE_OUTER_GAINHF:
             CHECKVAL(*values >= 0.0f && *values <= 1.0f);
 
             Source->OuterGainHF = *values;
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_OTHER);
             return AL_TRUE;
 
         case AL_AIR_ABSORPTION_FACTOR:
             CHECKVAL(*values >= 0.0f && *values <= 10.0f);
 
             Source->AirAbsorptionFactor = *values;
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_OTHER);
             return AL_TRUE;
 
         case AL_ROOM_ROLLOFF_FACTOR:
             CHECKVAL(*values >= 0.0f && *values <= 10.0f);
 
             Source->RoomRolloffFactor = *values;
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_OTHER);
             return AL_TRUE;
 
         case AL_DOPPLER_FACTOR:
             CHECKVAL(*values >= 0.0f && *values <= 1.0f);
 
             Source->DopplerFactor = *values;
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_PITCH);
             return AL_TRUE;
 
         case AL_SEC_OFFSET:
@@ -1126,7 +1410,7 @@ ALboolean SetSourcefv(ALsource *Source, ALCcontext *Context, SourceProp prop, co
             CHECKVAL(*values >= 0.0f && std::isfinite(*values));
 
             Source->Radius = *values;
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_OTHER);
             return AL_TRUE;
 
         case AL_STEREO_ANGLES:
@@ -1134,7 +1418,7 @@ ALboolean SetSourcefv(ALsource *Source, ALCcontext *Context, SourceProp prop, co
 
             Source->StereoPan[0] = values[0];
             Source->StereoPan[1] = values[1];
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_OTHER);
             return AL_TRUE;
 
 
@@ -1144,7 +1428,7 @@ ALboolean SetSourcefv(ALsource *Source, ALCcontext *Context, SourceProp prop, co
             Source->Position[0] = values[0];
             Source->Position[1] = values[1];
             Source->Position[2] = values[2];
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_OTHER);
             return AL_TRUE;
 
         case AL_VELOCITY:
@@ -1153,7 +1437,7 @@ ALboolean SetSourcefv(ALsource *Source, ALCcontext *Context, SourceProp prop, co
             Source->Velocity[0] = values[0];
             Source->Velocity[1] = values[1];
             Source->Velocity[2] = values[2];
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_PITCH);
             return AL_TRUE;
 
         case AL_DIRECTION:
@@ -1162,7 +1446,7 @@ ALboolean SetSourcefv(ALsource *Source, ALCcontext *Context, SourceProp prop, co
             Source->Direction[0] = values[0];
             Source->Direction[1] = values[1];
             Source->Direction[2] = values[2];
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_OTHER);
             return AL_TRUE;
 
         case AL_ORIENTATION:
@@ -1175,7 +1459,7 @@ ALboolean SetSourcefv(ALsource *Source, ALCcontext *Context, SourceProp prop, co
             Source->OrientUp[0] = values[3];
             Source->OrientUp[1] = values[4];
             Source->OrientUp[2] = values[5];
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_OTHER);
             return AL_TRUE;
 
 
@@ -1236,7 +1520,7 @@ ALboolean SetSourceiv(ALsource *Source, ALCcontext *Context, SourceProp prop, co
             CHECKVAL(*values == AL_FALSE || *values == AL_TRUE);
 
             Source->HeadRelative = static_cast<ALboolean>(*values);
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_OTHER);
             return AL_TRUE;
 
         case AL_LOOPING:
@@ -1364,35 +1648,35 @@ ALboolean SetSourceiv(ALsource *Source, ALCcontext *Context, SourceProp prop, co
                 Source->Direct.LFReference = filter->LFReference;
             }
             filtlock.unlock();
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_OTHER);
             return AL_TRUE;
 
         case AL_DIRECT_FILTER_GAINHF_AUTO:
             CHECKVAL(*values == AL_FALSE || *values == AL_TRUE);
 
             Source->DryGainHFAuto = *values;
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_OTHER);
             return AL_TRUE;
 
         case AL_AUXILIARY_SEND_FILTER_GAIN_AUTO:
             CHECKVAL(*values == AL_FALSE || *values == AL_TRUE);
 
             Source->WetGainAuto = *values;
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_OTHER);
             return AL_TRUE;
 
         case AL_AUXILIARY_SEND_FILTER_GAINHF_AUTO:
             CHECKVAL(*values == AL_FALSE || *values == AL_TRUE);
 
             Source->WetGainHFAuto = *values;
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_OTHER);
             return AL_TRUE;
 
         case AL_DIRECT_CHANNELS_SOFT:
             CHECKVAL(*values == AL_FALSE || *values == AL_TRUE);
 
             Source->DirectChannels = *values;
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_OTHER);
             return AL_TRUE;
 
         case AL_DISTANCE_MODEL:
@@ -1406,21 +1690,21 @@ ALboolean SetSourceiv(ALsource *Source, ALCcontext *Context, SourceProp prop, co
 
             Source->mDistanceModel = static_cast<DistanceModel>(*values);
             if(Context->SourceDistanceModel)
-                DO_UPDATEPROPS();
+                DO_UPDATEPROPS(VOICE_DIRTY_OTHER);
             return AL_TRUE;
 
         case AL_SOURCE_RESAMPLER_SOFT:
             CHECKVAL(*values >= 0 && *values <= ResamplerMax);
 
             Source->mResampler = static_cast<Resampler>(*values);
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_PITCH);
             return AL_TRUE;
 
         case AL_SOURCE_SPATIALIZE_SOFT:
             CHECKVAL(*values >= AL_FALSE && *values <= AL_AUTO_SOFT);
 
             Source->mSpatialize = static_cast<SpatializeMode>(*values);
-            DO_UPDATEPROPS();
+            DO_UPDATEPROPS(VOICE_DIRTY_OTHER);
             return AL_TRUE;
 
 
@@ -1467,6 +1751,7 @@ ALboolean SetSourceiv(ALsource *Source, ALCcontext *Context, SourceProp prop, co
                 /* We must force an update if the auxiliary slot changed on an
                  * active source, in case the slot is about to be deleted.
                  */
+                Source->PropsDirty |= VOICE_DIRTY_OTHER;
                 ALvoice *voice{GetSourceVoice(Source, Context)};
                 if(voice) UpdateSourceProps(Source, voice, Context);
                 else Source->PropsClean.clear(std::memory_order_release);
@@ -1477,7 +1762,7 @@ ALboolean SetSourceiv(ALsource *Source, ALCcontext *Context, SourceProp prop, co
                 if(Source->Send[values[1]].Slot)
                     DecrementRef(&Source->Send[values[1]].Slot->ref);
                 Source->Send[values[1]].Slot = slot;
-                DO_UPDATEPROPS();
+                DO_UPDATEPROPS(VOICE_DIRTY_OTHER);
             }
 
             return AL_TRUE;
@@ -2109,6 +2394,637 @@ ALboolean GetSourcei64v(ALsource *Source, ALCcontext *Context, SourceProp prop,
                   prop);
 }
 
+/* A source call recorded with AL_DEFERRED_COMMANDS_SOFT enabled. Property
+ * values are stored as they get passed to the Set* functions.
+ */
+struct SourceCmd {
+    enum Type : ALenum {
+        Float, Int, Int64,
+        Play, Pause, Stop, Rewind
+    };
+    Type mType;
+    ALuint mSourceId;
+    SourceProp mProp;
+    union {
+        ALfloat f[6];
+        ALint i[6];
+        ALint64SOFT i64[6];
+    } mValues;
+};
+
+/* Commands a thread can have waiting before its calls go back to taking the
+ * locks (which applies what's waiting first, keeping them in order).
+ */
+constexpr size_t SourceCmdQueueSize{4096};
+
+/* Gets the calling thread's command queue for the context, creating it if
+ * needed. Queues are only removed with the context, so a thread that ends
+ * leaves its queue to the next thread given the same ID.
+ */
+SourceCmdQueue *GetThreadCmdQueue(ALCcontext *context)
+{
+    struct CachedQueue {
+        ALuint serial;
+        SourceCmdQueue *queue;
+    };
+    static thread_local CachedQueue cache{0u, nullptr};
+    if(LIKELY(cache.serial == context->SourceCmdSerial))
+        return cache.queue;
+
+    const std::thread::id self{std::this_thread::get_id()};
+    SourceCmdQueue *queue{context->SourceCmdQueues.load(std::memory_order_acquire)};
+    while(queue && queue->mOwner != self)
+        queue = queue->mNext;
+    if(!queue)
+    {
+        queue = new SourceCmdQueue{};
+        queue->mOwner = self;
+        queue->mCommands = CreateRingBuffer(SourceCmdQueueSize, sizeof(SourceCmd), 1);
+        queue->mNext = context->SourceCmdQueues.load(std::memory_order_relaxed);
+        while(!context->SourceCmdQueues.compare_exchange_weak(queue->mNext, queue,
+            std::memory_order_acq_rel, std::memory_order_relaxed))
+        {
+            /* Retry with the new list head. */
+        }
+    }
+    cache = CachedQueue{context->SourceCmdSerial, queue};
+    return queue;
+}
+
+/* Records a source command if the context has deferred commands enabled.
+ * Returns false if it wasn't recorded, because commands aren't deferred or the
+ * thread's queue is full, and the caller needs to apply it directly.
+ */
+bool DeferSourceCmd(ALCcontext *context, const SourceCmd &cmd)
+{
+    if(!context->DeferCommands.load(std::memory_order_acquire))
+        return false;
+    SourceCmdQueue *queue{GetThreadCmdQueue(context)};
+    return queue->mCommands->write(&cmd, 1) == 1;
+}
+
+/* Properties that name another object are applied directly, since the object
+ * may be deleted before the command would be.
+ */
+inline bool IsObjectProp(ALenum param)
+{
+    return param == AL_BUFFER || param == AL_DIRECT_FILTER || param == AL_AUXILIARY_SEND_FILTER;
+}
+
+bool DeferSourceProp(ALCcontext *context, ALuint sid, ALenum param, const ALfloat *values,
+    ALint count)
+{
+    if(!context->DeferCommands.load(std::memory_order_relaxed))
+        return false;
+    SourceCmd cmd{SourceCmd::Float, sid, static_cast<SourceProp>(param), {}};
+    std::copy_n(values, count, cmd.mValues.f);
+    return DeferSourceCmd(context, cmd);
+}
+
+bool DeferSourceProp(ALCcontext *context, ALuint sid, ALenum param, const ALint *values,
+    ALint count)
+{
+    if(!context->DeferCommands.load(std::memory_order_relaxed) || IsObjectProp(param))
+        return false;
+    SourceCmd cmd{SourceCmd::Int, sid, static_cast<SourceProp>(param), {}};
+    std::copy_n(values, count, cmd.mValues.i);
+    return DeferSourceCmd(context, cmd);
+}
+
+bool DeferSourceProp(ALCcontext *context, ALuint sid, ALenum param, const ALint64SOFT *values,
+    ALint count)
+{
+    if(!context->DeferCommands.load(std::memory_order_relaxed) || IsObjectProp(param))
+        return false;
+    SourceCmd cmd{SourceCmd::Int64, sid, static_cast<SourceProp>(param), {}};
+    std::copy_n(values, count, cmd.mValues.i64);
+    return DeferSourceCmd(context, cmd);
+}
+
+bool DeferSourceState(ALCcontext *context, SourceCmd::Type type, ALuint sid)
+{
+    SourceCmd cmd{type, sid, static_cast<SourceProp>(AL_NONE), {}};
+    return DeferSourceCmd(context, cmd);
+}
+
+/* Starts or restarts playing the given sources. The SourceLock must be held.
+ */
+void PlaySources(ALCcontext *context, const ALuint *sources, ALsizei n)
+{
+    auto sources_end = sources+n;
+    auto bad_sid = std::find_if_not(sources, sources_end,
+        [context](ALuint sid) -> bool
+        {
+            ALsource *source{LookupSource(context, sid)};
+            return LIKELY(source != nullptr);
+        }
+    );
+    if(UNLIKELY(bad_sid != sources+n))
+        SETERR_RETURN(context, AL_INVALID_NAME,, "Invalid source ID %u", *bad_sid);
+
+    ALCdevice *device{context->Device};
+    /* Check the number of reusable voices. More voices are added without the
+     * backend lock, as the existing ones don't move and the mixer won't touch
+     * the new ones until they're in use.
+     */
+    const ALsizei free_voices{context->FreeVoiceCount.load(std::memory_order_acquire)};
+    if(UNLIKELY(n > free_voices))
+    {
+        /* Increment the number of voices to handle the request. */
+        const ALsizei need_voices{n - free_voices};
+        const auto max_voices = static_cast<ALsizei>(
+            context->Voices.load(std::memory_order_relaxed)->size());
+        const ALsizei rem_voices{max_voices - context->VoiceCount.load(std::memory_order_relaxed)};
+
+        if(UNLIKELY(need_voices > rem_voices))
+        {
+            /* Allocate more voices to get enough. */
+            const ALsizei alloc_count{need_voices - rem_voices};
+            if(UNLIKELY(max_voices > std::numeric_limits<ALsizei>::max()-VOICE_CLUSTER_SIZE -
+                    alloc_count))
+                SETERR_RETURN(context, AL_OUT_OF_MEMORY,,
+                    "Overflow increasing voice count to %d + %d", max_voices, alloc_count);
+
+            AllocateVoices(context, max_voices + alloc_count, device->NumAuxSends);
+        }
+
+        const ALsizei oldcount{context->VoiceCount.load(std::memory_order_relaxed)};
+        ALvoice **voices{context->Voices.load(std::memory_order_relaxed)->data()};
+        std::for_each(voices+oldcount, voices+oldcount+need_voices,
+            [context](ALvoice *voice) noexcept -> void { RetireVoice(context, voice); });
+        context->VoiceCount.store(oldcount+need_voices, std::memory_order_release);
+    }
+
+    BackendLockGuard _{*device->Backend};
+    /* If the device is disconnected, go right to stopped. */
+    if(UNLIKELY(!device->Connected.load(std::memory_order_acquire)))
+    {
+        /* TODO: Send state change event? */
+        std::for_each(sources, sources_end,
+            [context](ALuint sid) -> void
+            {
+                ALsource *source{LookupSource(context, sid)};
+                source->OffsetType = AL_NONE;
+                source->Offset = 0.0;
+                source->state = AL_STOPPED;
+            }
+        );
+        return;
+    }
+
+    auto start_source = [context,device](ALuint sid) -> void
+    {
+        ALsource *source{LookupSource(context, sid)};
+        /* Check that there is a queue containing at least one valid, non zero
+         * length buffer.
+         */
+        ALbufferlistitem *BufferList{source->queue};
+        while(BufferList && BufferList->max_samples == 0)
+            BufferList = BufferList->next.load(std::memory_order_relaxed);
+
+        /* If there's nothing to play, go right to stopped. */
+        if(UNLIKELY(!BufferList))
+        {
+            /* NOTE: A source without any playable buffers should not have an
+             * ALvoice since it shouldn't be in a playing or paused state. So
+             * there's no need to look up its voice and clear the source.
+             */
+            ALenum oldstate{GetSourceState(source, nullptr)};
+            source->OffsetType = AL_NONE;
+            source->Offset = 0.0;
+            if(oldstate != AL_STOPPED)
+            {
+                source->state = AL_STOPPED;
+                SendStateChangeEvent(context, source->id, AL_STOPPED);
+            }
+            return;
+        }
+
+        ALvoice *voice{GetSourceVoice(source, context)};
+        switch(GetSourceState(source, voice))
+        {
+        case AL_PLAYING:
+            assert(voice != nullptr);
+            /* A source that's already playing is restarted from the beginning. */
+            voice->mCurrentBuffer.store(BufferList, std::memory_order_relaxed);
+            voice->mPosition.store(0u, std::memory_order_relaxed);
+            voice->mPositionFrac.store(0, std::memory_order_release);
+            return;
+
+        case AL_PAUSED:
+            assert(voice != nullptr);
+            /* A source that's paused simply resumes. */
+            voice->mPlayState.store(ALvoice::Playing, std::memory_order_release);
+            source->state = AL_PLAYING;
+            SendStateChangeEvent(context, source->id, AL_PLAYING);
+            return;
+
+        default:
+            assert(voice == nullptr);
+            break;
+        }
+
+        auto buffers_end = BufferList->buffers + BufferList->num_buffers;
+        auto buffer = std::find_if(BufferList->buffers, buffers_end,
+            std::bind(std::not_equal_to<const ALbuffer*>{}, _1, nullptr));
+        const ALsizei numchans{(buffer != buffers_end) ?
+            ChannelsFromFmt((*buffer)->mFmtChannels) : 1};
+
+        /* Take an unused voice to play this source with, preferring one that
+         * already has room for the buffer's channels.
+         */
+        voice = AcquireVoice(context, numchans);
+        assert(voice != nullptr);
+        const ALint vidx{voice->mIndex};
+        voice->mPlayState.store(ALvoice::Stopped, std::memory_order_release);
+
+        source->PropsClean.test_and_set(std::memory_order_acquire);
+        source->PropsDirty = VOICE_DIRTY_ALL;
+        UpdateSourceProps(source, voice, context, true);
+
+        /* A source that's not playing or paused has any offset applied when it
+         * starts playing.
+         */
+        if(source->Looping)
+            voice->mLoopBuffer.store(source->queue, std::memory_order_relaxed);
+        else
+            voice->mLoopBuffer.store(nullptr, std::memory_order_relaxed);
+        voice->mCurrentBuffer.store(BufferList, std::memory_order_relaxed);
+        voice->mPosition.store(0u, std::memory_order_relaxed);
+        voice->mPositionFrac.store(0, std::memory_order_relaxed);
+        bool start_fading{false};
+        if(ApplyOffset(source, voice) != AL_FALSE)
+            start_fading = voice->mPosition.load(std::memory_order_relaxed) != 0 ||
+                voice->mPositionFrac.load(std::memory_order_relaxed) != 0 ||
+                voice->mCurrentBuffer.load(std::memory_order_relaxed) != BufferList;
+
+        if(buffer != buffers_end)
+        {
+            voice->mFrequency = (*buffer)->Frequency;
+            voice->mFmtChannels = (*buffer)->mFmtChannels;
+            voice->mNumChannels = numchans;
+            voice->mSampleSize  = BytesFromFmt((*buffer)->mFmtType);
+        }
+        ReserveVoiceChannels(voice, voice->mNumChannels);
+        UpdateVoiceHrtfState(context, voice);
+
+        /* Clear previous samples. */
+        std::for_each(voice->mPrevSamples, voice->mPrevSamples+voice->mNumChannels,
+            [](ALvoice::ResamplePaddingArray &samples) -> void
+            { std::fill(std::begin(samples), std::end(samples), 0.0f); });
+
+        /* Clear the stepping value so the mixer knows not to mix this until
+         * the update gets applied.
+         */
+        voice->mStep = 0;
+
+        voice->mFlags = start_fading ? VOICE_IS_FADING : 0;
+        if(source->SourceType == AL_STATIC) voice->mFlags |= VOICE_IS_STATIC;
+
+        /* Don't need to set the VOICE_IS_AMBISONIC flag if the device is
+         * mixing in first order. No HF scaling is necessary to mix it.
+         */
+        if((voice->mFmtChannels == FmtBFormat2D || voice->mFmtChannels == FmtBFormat3D) &&
+           device->mAmbiOrder > 1)
+        {
+            auto scales = BFormatDec::GetHFOrderScales(1, device->mAmbiOrder);
+            if(voice->mFmtChannels == FmtBFormat2D)
+            {
+                static constexpr int Order2DFromChan[MAX_AMBI2D_CHANNELS]{
+                    0, 1,1, 2,2, 3,3
+                };
+                const size_t count{Ambi2DChannelsFromOrder(1u)};
+                std::transform(Order2DFromChan, Order2DFromChan+count, voice->mAmbiScales,
+                    [&scales](size_t idx) -> ALfloat { return scales[idx]; });
+            }
+            else
+            {
+                static constexpr int OrderFromChan[MAX_AMBI_CHANNELS]{
+                    0, 1,1,1, 2,2,2,2,2, 3,3,3,3,3,3,3,
+                };
+                const size_t count{Ambi2DChannelsFromOrder(1u)};
+                std::transform(OrderFromChan, OrderFromChan+count, voice->mAmbiScales,
+                    [&scales](size_t idx) -> ALfloat { return scales[idx]; });
+            }
+
+            voice->mAmbiSplitter[0].init(400.0f / static_cast<ALfloat>(device->Frequency));
+            std::fill_n(voice->mAmbiSplitter+1, voice->mNumChannels-1,
+                voice->mAmbiSplitter[0]);
+            voice->mFlags |= VOICE_IS_AMBISONIC;
+        }
+
+        std::fill_n(voice->mDirect.Params, voice->mNumChannels, DirectParams{});
+        std::for_each(voice->mHrtfState.begin(), voice->mHrtfState.begin()+voice->mNumChannels,
+            [](VoiceHrtfState *state) -> void
+            { if(state) *state = VoiceHrtfState{}; }
+        );
+        std::for_each(voice->mSend.begin(), voice->mSend.end(),
+            [voice](ALvoice::SendData &send) -> void
+            { std::fill_n(send.Params, voice->mNumChannels, SendParams{}); }
+        );
+
+        if(device->AvgSpeakerDist > 0.0f)
+        {
+            ALfloat w1 = SPEEDOFSOUNDMETRESPERSEC /
+                         (device->AvgSpeakerDist * device->Frequency);
+            std::for_each(voice->mDirect.Params+0, voice->mDirect.Params+voice->mNumChannels,
+                [w1](DirectParams &parms) noexcept -> void
+                { parms.NFCtrlFilter.init(w1); }
+            );
+        }
+
+        voice->mSourceID.store(source->id, std::memory_order_relaxed);
+        voice->mPlayState.store(ALvoice::Playing, std::memory_order_release);
+        source->state = AL_PLAYING;
+        source->VoiceIdx = vidx;
+
+        SendStateChangeEvent(context, source->id, AL_PLAYING);
+    };
+    std::for_each(sources, sources_end, start_source);
+}
+
+/* Pauses the given sources. The SourceLock must be held.
+ */
+void PauseSources(ALCcontext *context, const ALuint *sources, ALsizei n)
+{
+    for(ALsizei i{0};i < n;i++)
+    {
+        if(!LookupSource(context, sources[i]))
+            SETERR_RETURN(context, AL_INVALID_NAME,, "Invalid source ID %u", sources[i]);
+    }
+
+    ALCdevice *device{context->Device};
+    BackendLockGuard _{*device->Backend};
+    for(ALsizei i{0};i < n;i++)
+    {
+        ALsource *source{LookupSource(context, sources[i])};
+        ALvoice *voice{GetSourceVoice(source, context)};
+        if(voice)
+        {
+            std::atomic_thread_fence(std::memory_order_release);
+            ALvoice::State oldvstate{ALvoice::Playing};
+            voice->mPlayState.compare_exchange_strong(oldvstate, ALvoice::Stopping,
+                std::memory_order_acq_rel, std::memory_order_acquire);
+        }
+        if(GetSourceState(source, voice) == AL_PLAYING)
+        {
+            source->state = AL_PAUSED;
+            SendStateChangeEvent(context, source->id, AL_PAUSED);
+        }
+    }
+}
+
+/* Stops the given sources. The SourceLock must be held.
+ */
+void StopSources(ALCcontext *context, const ALuint *sources, ALsizei n)
+{
+    for(ALsizei i{0};i < n;i++)
+    {
+        if(!LookupSource(context, sources[i]))
+            SETERR_RETURN(context, AL_INVALID_NAME,, "Invalid source ID %u", sources[i]);
+    }
+
+    ALCdevice *device{context->Device};
+    BackendLockGuard _{*device->Backend};
+    for(ALsizei i{0};i < n;i++)
+    {
+        ALsource *source{LookupSource(context, sources[i])};
+        ALvoice *voice{GetSourceVoice(source, context)};
+        if(voice != nullptr)
+        {
+            voice->mCurrentBuffer.store(nullptr, std::memory_order_relaxed);
+            voice->mLoopBuffer.store(nullptr, std::memory_order_relaxed);
+            voice->mSourceID.store(0u, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            ALvoice::State oldvstate{ALvoice::Playing};
+            voice->mPlayState.compare_exchange_strong(oldvstate, ALvoice::Stopping,
+                std::memory_order_acq_rel, std::memory_order_acquire);
+            /* A paused voice is already stopped, so it's free now. */
+            if(oldvstate == ALvoice::Stopped)
+                RetireVoice(context, voice);
+            voice = nullptr;
+        }
+        ALenum oldstate{GetSourceState(source, voice)};
+        if(oldstate != AL_INITIAL && oldstate != AL_STOPPED)
+        {
+            source->state = AL_STOPPED;
+            SendStateChangeEvent(context, source->id, AL_STOPPED);
+        }
+        source->OffsetType = AL_NONE;
+        source->Offset = 0.0;
+    }
+}
+
+/* Rewinds the given sources to the initial state. The SourceLock must be held.
+ */
+void RewindSources(ALCcontext *context, const ALuint *sources, ALsizei n)
+{
+    for(ALsizei i{0};i < n;i++)
+    {
+        if(!LookupSource(context, sources[i]))
+            SETERR_RETURN(context, AL_INVALID_NAME,, "Invalid source ID %u", sources[i]);
+    }
+
+    ALCdevice *device{context->Device};
+    BackendLockGuard _{*device->Backend};
+    for(ALsizei i{0};i < n;i++)
+    {
+        ALsource *source{LookupSource(context, sources[i])};
+        ALvoice *voice{GetSourceVoice(source, context)};
+        if(voice != nullptr)
+        {
+            voice->mCurrentBuffer.store(nullptr, std::memory_order_relaxed);
+            voice->mLoopBuffer.store(nullptr, std::memory_order_relaxed);
+            voice->mSourceID.store(0u, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            ALvoice::State oldvstate{ALvoice::Playing};
+            voice->mPlayState.compare_exchange_strong(oldvstate, ALvoice::Stopping,
+                std::memory_order_acq_rel, std::memory_order_acquire);
+            /* A paused voice is already stopped, so it's free now. */
+            if(oldvstate == ALvoice::Stopped)
+                RetireVoice(context, voice);
+            voice = nullptr;
+        }
+        if(GetSourceState(source, voice) != AL_INITIAL)
+        {
+            source->state = AL_INITIAL;
+            SendStateChangeEvent(context, source->id, AL_INITIAL);
+        }
+        source->OffsetType = AL_NONE;
+        source->Offset = 0.0;
+    }
+}
+
+/* Applies the commands waiting in all the context's queues, keeping the order
+ * each thread made them in. The PropLock and SourceLock must be held.
+ */
+void ApplySourceCmds(ALCcontext *context)
+{
+    /* Consecutive state changes are applied together, as a *v call would. */
+    SourceCmd::Type statetype{SourceCmd::Play};
+    ALuint stateids[64];
+    ALsizei statecount{0};
+    auto apply_state = [context,&statetype,&stateids,&statecount]() -> void
+    {
+        if(statecount == 0) return;
+        switch(statetype)
+        {
+        case SourceCmd::Play: PlaySources(context, stateids, statecount); break;
+        case SourceCmd::Pause: PauseSources(context, stateids, statecount); break;
+        case SourceCmd::Stop: StopSources(context, stateids, statecount); break;
+        case SourceCmd::Rewind: RewindSources(context, stateids, statecount); break;
+        case SourceCmd::Float: case SourceCmd::Int: case SourceCmd::Int64: break;
+        }
+        statecount = 0;
+    };
+
+    SourceCmdQueue *queue{context->SourceCmdQueues.load(std::memory_order_acquire)};
+    for(;queue;queue = queue->mNext)
+    {
+        SourceCmd cmd;
+        while(queue->mCommands->read(&cmd, 1) == 1)
+        {
+            ALsource *source{LookupSource(context, cmd.mSourceId)};
+            if(UNLIKELY(!source))
+            {
+                alSetError(context, AL_INVALID_NAME, "Invalid source ID %u", cmd.mSourceId);
+                continue;
+            }
+
+            switch(cmd.mType)
+            {
+            case SourceCmd::Float:
+                apply_state();
+                SetSourcefv(source, context, cmd.mProp, cmd.mValues.f);
+                break;
+            case SourceCmd::Int:
+                apply_state();
+                SetSourceiv(source, context, cmd.mProp, cmd.mValues.i);
+                break;
+            case SourceCmd::Int64:
+                apply_state();
+                SetSourcei64v(source, context, cmd.mProp, cmd.mValues.i64);
+                break;
+
+            case SourceCmd::Play:
+            case SourceCmd::Pause:
+            case SourceCmd::Stop:
+            case SourceCmd::Rewind:
+                if(cmd.mType != statetype || statecount == static_cast<ALsizei>(COUNTOF(stateids)))
+                    apply_state();
+                statetype = cmd.mType;
+                stateids[statecount++] = cmd.mSourceId;
+                break;
+            }
+        }
+        apply_state();
+    }
+}
+
+/* Holds the SourceLock for a call that has to come after any deferred source
+ * commands, applying them first. The PropLock is also held while commands are
+ * deferred or any are waiting, since applying them updates properties.
+ */
+class FlushedSourceLock {
+    std::unique_lock<std::mutex> mPropLock;
+    std::lock_guard<std::mutex> mSourceLock;
+
+    static std::unique_lock<std::mutex> LockForCmds(ALCcontext *context)
+    {
+        if(!context->DeferCommands.load(std::memory_order_acquire))
+        {
+            const SourceCmdQueue *queue{context->SourceCmdQueues.load(std::memory_order_acquire)};
+            while(queue && queue->mCommands->readSpace() == 0)
+                queue = queue->mNext;
+            if(!queue) return std::unique_lock<std::mutex>{};
+        }
+        return std::unique_lock<std::mutex>{context->PropLock};
+    }
+
+public:
+    explicit FlushedSourceLock(ALCcontext *context)
+      : mPropLock{LockForCmds(context)}, mSourceLock{context->SourceLock}
+    {
+        if(mPropLock.owns_lock())
+            ApplySourceCmds(context);
+    }
+    ~FlushedSourceLock();
+};
+FlushedSourceLock::~FlushedSourceLock() = default;
+
+/* Sets properties on a number of sources with one lock and lookup pass. Every
+ * value is checked before any is set, so an error leaves all of the sources
+ * as they were. The resulting voice updates are published together, so the
+ * mixer applies them in the same update.
+ */
+template<typename T>
+void SetSourcesProps(ALCcontext *context, ALsizei count, const ALuint *sources,
+    const ALenum *params, const T *values, ALint (&ValsByProp)(ALenum),
+    ALboolean (&CheckSourceProp)(ALsource*,ALCcontext*,SourceProp,const T*),
+    ALboolean (&SetSourceProp)(ALsource*,ALCcontext*,SourceProp,const T*))
+{
+    if(count < 0)
+        SETERR_RETURN(context, AL_INVALID_VALUE,, "Setting %d source properties", count);
+    if(count == 0) return;
+    if(!sources || !params || !values)
+        SETERR_RETURN(context, AL_INVALID_VALUE,, "NULL pointer");
+
+    std::lock_guard<std::mutex> _{context->PropLock};
+    std::lock_guard<std::mutex> __{context->SourceLock};
+    ApplySourceCmds(context);
+
+    al::vector<ALsource*> srclist(count);
+    for(ALsizei i{0};i < count;++i)
+    {
+        srclist[i] = LookupSource(context, sources[i]);
+        if(UNLIKELY(!srclist[i]))
+            SETERR_RETURN(context, AL_INVALID_NAME,, "Invalid source ID %u", sources[i]);
+        if(ValsByProp(params[i]) < 1)
+            SETERR_RETURN(context, AL_INVALID_ENUM,, "Invalid source property 0x%04x",
+                params[i]);
+    }
+
+    /* Check all of the values first, so an invalid one leaves every source
+     * unchanged.
+     */
+    const T *vals{values};
+    for(ALsizei i{0};i < count;++i)
+    {
+        if(!CheckSourceProp(srclist[i], context, static_cast<SourceProp>(params[i]), vals))
+            return;
+        vals += ValsByProp(params[i]);
+    }
+
+    /* Only mark the sources as changed while setting the properties, then
+     * update each playing source's voice once.
+     */
+    context->BatchSourceProps = true;
+    for(ALsizei i{0};i < count;++i)
+    {
+        if(!SetSourceProp(srclist[i], context, static_cast<SourceProp>(params[i]), values))
+            break;
+        values += ValsByProp(params[i]);
+    }
+    context->BatchSourceProps = false;
+
+    if(context->DeferUpdates.load(std::memory_order_acquire))
+        return;
+
+    context->HoldUpdates.store(true, std::memory_order_release);
+    while((context->UpdateCount.load(std::memory_order_acquire)&1) != 0)
+        std::this_thread::yield();
+    std::for_each(srclist.cbegin(), srclist.cend(),
+        [context](ALsource *source) -> void
+        {
+            if(!IsPlayingOrPaused(source)) return;
+            ALvoice *voice{GetSourceVoice(source, context)};
+            if(voice && !source->PropsClean.test_and_set(std::memory_order_acq_rel))
+                UpdateSourceProps(source, voice, context);
+        }
+    );
+    context->HoldUpdates.store(false, std::memory_order_release);
+}
+
 } // namespace
 
 AL_API ALvoid AL_APIENTRY alGenSources(ALsizei n, ALuint *sources)
@@ -2154,7 +3070,7 @@ START_API_FUNC
     if(n < 0)
         SETERR_RETURN(context.get(), AL_INVALID_VALUE,, "Deleting %d sources", n);
 
-    std::lock_guard<std::mutex> _{context->SourceLock};
+    FlushedSourceLock _{context.get()};
 
     /* Check that all Sources are valid */
     const ALuint *sources_end = sources + n;
@@ -2204,8 +3120,13 @@ START_API_FUNC
     ContextRef context{GetContextRef()};
     if(UNLIKELY(!context)) return;
 
+    if(FloatValsByProp(param) == 1 && DeferSourceProp(context.get(), source, param, &value, 1))
+        return;
+
     std::lock_guard<std::mutex> _{context->PropLock};
     std::lock_guard<std::mutex> __{context->SourceLock};
+    ApplySourceCmds(context.get());
+
     ALsource *Source = LookupSource(context.get(), source);
     if(UNLIKELY(!Source))
         alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
@@ -2222,18 +3143,21 @@ START_API_FUNC
     ContextRef context{GetContextRef()};
     if(UNLIKELY(!context)) return;
 
+    const ALfloat fvals[3]{ value1, value2, value3 };
+    if(FloatValsByProp(param) == 3 && DeferSourceProp(context.get(), source, param, fvals, 3))
+        return;
+
     std::lock_guard<std::mutex> _{context->PropLock};
     std::lock_guard<std::mutex> __{context->SourceLock};
+    ApplySourceCmds(context.get());
+
     ALsource *Source = LookupSource(context.get(), source);
     if(UNLIKELY(!Source))
         alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
     else if(FloatValsByProp(param) != 3)
         alSetError(context.get(), AL_INVALID_ENUM, "Invalid 3-float property 0x%04x", param);
     else
-    {
-        ALfloat fvals[3] = { value1, value2, value3 };
         SetSourcefv(Source, context.get(), static_cast<SourceProp>(param), fvals);
-    }
 }
 END_API_FUNC
 
@@ -2243,8 +3167,14 @@ START_API_FUNC
     ContextRef context{GetContextRef()};
     if(UNLIKELY(!context)) return;
 
+    if(values && FloatValsByProp(param) > 0 &&
+       DeferSourceProp(context.get(), source, param, values, FloatValsByProp(param)))
+        return;
+
     std::lock_guard<std::mutex> _{context->PropLock};
     std::lock_guard<std::mutex> __{context->SourceLock};
+    ApplySourceCmds(context.get());
+
     ALsource *Source = LookupSource(context.get(), source);
     if(UNLIKELY(!Source))
         alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
@@ -2264,18 +3194,21 @@ START_API_FUNC
     ContextRef context{GetContextRef()};
     if(UNLIKELY(!context)) return;
 
+    const ALfloat fval{static_cast<ALfloat>(value)};
+    if(DoubleValsByProp(param) == 1 && DeferSourceProp(context.get(), source, param, &fval, 1))
+        return;
+
     std::lock_guard<std::mutex> _{context->PropLock};
     std::lock_guard<std::mutex> __{context->SourceLock};
+    ApplySourceCmds(context.get());
+
     ALsource *Source = LookupSource(context.get(), source);
     if(UNLIKELY(!Source))
         alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
     else if(DoubleValsByProp(param) != 1)
         alSetError(context.get(), AL_INVALID_ENUM, "Invalid double property 0x%04x", param);
     else
-    {
-        ALfloat fval = static_cast<ALfloat>(value);
         SetSourcefv(Source, context.get(), static_cast<SourceProp>(param), &fval);
-    }
 }
 END_API_FUNC
 
@@ -2285,19 +3218,22 @@ START_API_FUNC
     ContextRef context{GetContextRef()};
     if(UNLIKELY(!context)) return;
 
+    const ALfloat fvals[3]{static_cast<ALfloat>(value1), static_cast<ALfloat>(value2),
+        static_cast<ALfloat>(value3)};
+    if(DoubleValsByProp(param) == 3 && DeferSourceProp(context.get(), source, param, fvals, 3))
+        return;
+
     std::lock_guard<std::mutex> _{context->PropLock};
     std::lock_guard<std::mutex> __{context->SourceLock};
+    ApplySourceCmds(context.get());
+
     ALsource *Source = LookupSource(context.get(), source);
     if(UNLIKELY(!Source))
         alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
     else if(DoubleValsByProp(param) != 3)
         alSetError(context.get(), AL_INVALID_ENUM, "Invalid 3-double property 0x%04x", param);
-    else {
-        ALfloat fvals[3] = {static_cast<ALfloat>(value1),
-                            static_cast<ALfloat>(value2),
-                            static_cast<ALfloat>(value3)};
+    else
         SetSourcefv(Source, context.get(), static_cast<SourceProp>(param), fvals);
-    }
 }
 END_API_FUNC
 
@@ -2307,28 +3243,29 @@ START_API_FUNC
     ContextRef context{GetContextRef()};
     if(UNLIKELY(!context)) return;
 
+    const ALint count{values ? DoubleValsByProp(param) : 0};
+    ALfloat fvals[6];
+    if(count > 0 && count <= 6)
+    {
+        std::transform(values, values+count, fvals,
+            [](const ALdouble val) noexcept -> ALfloat { return static_cast<ALfloat>(val); });
+        if(DeferSourceProp(context.get(), source, param, fvals, count))
+            return;
+    }
+
     std::lock_guard<std::mutex> _{context->PropLock};
     std::lock_guard<std::mutex> __{context->SourceLock};
+    ApplySourceCmds(context.get());
+
     ALsource *Source = LookupSource(context.get(), source);
     if(UNLIKELY(!Source))
         alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
     else if(!values)
         alSetError(context.get(), AL_INVALID_VALUE, "NULL pointer");
+    else if(count < 1 || count > 6)
+        alSetError(context.get(), AL_INVALID_ENUM, "Invalid double-vector property 0x%04x", param);
     else
-    {
-        ALint count{DoubleValsByProp(param)};
-        if(count < 1 || count > 6)
-            alSetError(context.get(), AL_INVALID_ENUM, "Invalid double-vector property 0x%04x", param);
-        else
-        {
-            ALfloat fvals[6];
-            ALint i;
-
-            for(i = 0;i < count;i++)
-                fvals[i] = static_cast<ALfloat>(values[i]);
-            SetSourcefv(Source, context.get(), static_cast<SourceProp>(param), fvals);
-        }
-    }
+        SetSourcefv(Source, context.get(), static_cast<SourceProp>(param), fvals);
 }
 END_API_FUNC
 
@@ -2339,8 +3276,13 @@ START_API_FUNC
     ContextRef context{GetContextRef()};
     if(UNLIKELY(!context)) return;
 
+    if(IntValsByProp(param) == 1 && DeferSourceProp(context.get(), source, param, &value, 1))
+        return;
+
     std::lock_guard<std::mutex> _{context->PropLock};
     std::lock_guard<std::mutex> __{context->SourceLock};
+    ApplySourceCmds(context.get());
+
     ALsource *Source = LookupSource(context.get(), source);
     if(UNLIKELY(!Source))
         alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
@@ -2357,18 +3299,21 @@ START_API_FUNC
     ContextRef context{GetContextRef()};
     if(UNLIKELY(!context)) return;
 
+    const ALint ivals[3]{ value1, value2, value3 };
+    if(IntValsByProp(param) == 3 && DeferSourceProp(context.get(), source, param, ivals, 3))
+        return;
+
     std::lock_guard<std::mutex> _{context->PropLock};
     std::lock_guard<std::mutex> __{context->SourceLock};
+    ApplySourceCmds(context.get());
+
     ALsource *Source = LookupSource(context.get(), source);
     if(UNLIKELY(!Source))
         alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
     else if(IntValsByProp(param) != 3)
         alSetError(context.get(), AL_INVALID_ENUM, "Invalid 3-integer property 0x%04x", param);
     else
-    {
-        ALint ivals[3] = { value1, value2, value3 };
         SetSourceiv(Source, context.get(), static_cast<SourceProp>(param), ivals);
-    }
 }
 END_API_FUNC
 
@@ -2378,8 +3323,14 @@ START_API_FUNC
     ContextRef context{GetContextRef()};
     if(UNLIKELY(!context)) return;
 
+    if(values && IntValsByProp(param) > 0 &&
+       DeferSourceProp(context.get(), source, param, values, IntValsByProp(param)))
+        return;
+
     std::lock_guard<std::mutex> _{context->PropLock};
     std::lock_guard<std::mutex> __{context->SourceLock};
+    ApplySourceCmds(context.get());
+
     ALsource *Source = LookupSource(context.get(), source);
     if(UNLIKELY(!Source))
         alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
@@ -2399,8 +3350,13 @@ START_API_FUNC
     ContextRef context{GetContextRef()};
     if(UNLIKELY(!context)) return;
 
+    if(Int64ValsByProp(param) == 1 && DeferSourceProp(context.get(), source, param, &value, 1))
+        return;
+
     std::lock_guard<std::mutex> _{context->PropLock};
     std::lock_guard<std::mutex> __{context->SourceLock};
+    ApplySourceCmds(context.get());
+
     ALsource *Source{LookupSource(context.get(), source)};
     if(UNLIKELY(!Source))
         alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
@@ -2417,18 +3373,21 @@ START_API_FUNC
     ContextRef context{GetContextRef()};
     if(UNLIKELY(!context)) return;
 
+    const ALint64SOFT i64vals[3]{ value1, value2, value3 };
+    if(Int64ValsByProp(param) == 3 && DeferSourceProp(context.get(), source, param, i64vals, 3))
+        return;
+
     std::lock_guard<std::mutex> _{context->PropLock};
     std::lock_guard<std::mutex> __{context->SourceLock};
+    ApplySourceCmds(context.get());
+
     ALsource *Source{LookupSource(context.get(), source)};
     if(UNLIKELY(!Source))
         alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
     else if(Int64ValsByProp(param) != 3)
         alSetError(context.get(), AL_INVALID_ENUM, "Invalid 3-integer64 property 0x%04x", param);
     else
-    {
-        ALint64SOFT i64vals[3] = { value1, value2, value3 };
         SetSourcei64v(Source, context.get(), static_cast<SourceProp>(param), i64vals);
-    }
 }
 END_API_FUNC
 
@@ -2438,8 +3397,14 @@ START_API_FUNC
     ContextRef context{GetContextRef()};
     if(UNLIKELY(!context)) return;
 
+    if(values && Int64ValsByProp(param) > 0 &&
+       DeferSourceProp(context.get(), source, param, values, Int64ValsByProp(param)))
+        return;
+
     std::lock_guard<std::mutex> _{context->PropLock};
     std::lock_guard<std::mutex> __{context->SourceLock};
+    ApplySourceCmds(context.get());
+
     ALsource *Source{LookupSource(context.get(), source)};
     if(UNLIKELY(!Source))
         alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
@@ -2453,13 +3418,36 @@ START_API_FUNC
 END_API_FUNC
 
 
+AL_API void AL_APIENTRY alSourcesfvSOFT(ALsizei count, const ALuint *sources, const ALenum *params, const ALfloat *values)
+START_API_FUNC
+{
+    ContextRef context{GetContextRef()};
+    if(UNLIKELY(!context)) return;
+
+    SetSourcesProps(context.get(), count, sources, params, values, FloatValsByProp, CheckSourcefv,
+        SetSourcefv);
+}
+END_API_FUNC
+
+AL_API void AL_APIENTRY alSourcesivSOFT(ALsizei count, const ALuint *sources, const ALenum *params, const ALint *values)
+START_API_FUNC
+{
+    ContextRef context{GetContextRef()};
+    if(UNLIKELY(!context)) return;
+
+    SetSourcesProps(context.get(), count, sources, params, values, IntValsByProp, CheckSourceiv,
+        SetSourceiv);
+}
+END_API_FUNC
+
+
 AL_API ALvoid AL_APIENTRY alGetSourcef(ALuint source, ALenum param, ALfloat *value)
 START_API_FUNC
 {
     ContextRef context{GetContextRef()};
     if(UNLIKELY(!context)) return;
 
-    std::lock_guard<std::mutex> _{context->SourceLock};
+    FlushedSourceLock _{context.get()};
     ALsource *Source{LookupSource(context.get(), source)};
     if(UNLIKELY(!Source))
         alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
@@ -2482,7 +3470,7 @@ START_API_FUNC
     ContextRef context{GetContextRef()};
     if(UNLIKELY(!context)) return;
 
-    std::lock_guard<std::mutex> _{context->SourceLock};
+    FlushedSourceLock _{context.get()};
     ALsource *Source{LookupSource(context.get(), source)};
     if(UNLIKELY(!Source))
         alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
@@ -2509,7 +3497,7 @@ START_API_FUNC
     ContextRef context{GetContextRef()};
     if(UNLIKELY(!context)) return;
 
-    std::lock_guard<std::mutex> _{context->SourceLock};
+    FlushedSourceLock _{context.get()};
     ALsource *Source{LookupSource(context.get(), source)};
     if(UNLIKELY(!Source))
         alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
@@ -2540,7 +3528,7 @@ START_API_FUNC
     ContextRef context{GetContextRef()};
     if(UNLIKELY(!context)) return;
 
-    std::lock_guard<std::mutex> _{context->SourceLock};
+    FlushedSourceLock _{context.get()};
     ALsource *Source{LookupSource(context.get(), source)};
     if(UNLIKELY(!Source))
         alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
@@ -2559,7 +3547,7 @@ START_API_FUNC
     ContextRef context{GetContextRef()};
     if(UNLIKELY(!context)) return;
 
-    std::lock_guard<std::mutex> _{context->SourceLock};
+    FlushedSourceLock _{context.get()};
     ALsource *Source{LookupSource(context.get(), source)};
     if(UNLIKELY(!Source))
         alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
@@ -2586,7 +3574,7 @@ START_API_FUNC
     ContextRef context{GetContextRef()};
     if(UNLIKELY(!context)) return;
 
-    std::lock_guard<std::mutex> _{context->SourceLock};
+    FlushedSourceLock _{context.get()};
     ALsource *Source{LookupSource(context.get(), source)};
     if(UNLIKELY(!Source))
         alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
@@ -2606,7 +3594,7 @@ START_API_FUNC
     ContextRef context{GetContextRef()};
     if(UNLIKELY(!context)) return;
 
-    std::lock_guard<std::mutex> _{context->SourceLock};
+    FlushedSourceLock _{context.get()};
     ALsource *Source{LookupSource(context.get(), source)};
     if(UNLIKELY(!Source))
         alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
@@ -2625,7 +3613,7 @@ START_API_FUNC
     ContextRef context{GetContextRef()};
     if(UNLIKELY(!context)) return;
 
-    std::lock_guard<std::mutex> _{context->SourceLock};
+    FlushedSourceLock _{context.get()};
     ALsource *Source{LookupSource(context.get(), source)};
     if(UNLIKELY(!Source))
         alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
@@ -2642,339 +3630,123 @@ START_API_FUNC
             *value2 = ivals[1];
             *value3 = ivals[2];
         }
-    }
-}
-END_API_FUNC
-
-AL_API void AL_APIENTRY alGetSourceiv(ALuint source, ALenum param, ALint *values)
-START_API_FUNC
-{
-    ContextRef context{GetContextRef()};
-    if(UNLIKELY(!context)) return;
-
-    std::lock_guard<std::mutex> _{context->SourceLock};
-    ALsource *Source{LookupSource(context.get(), source)};
-    if(UNLIKELY(!Source))
-        alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
-    else if(!values)
-        alSetError(context.get(), AL_INVALID_VALUE, "NULL pointer");
-    else if(IntValsByProp(param) < 1)
-        alSetError(context.get(), AL_INVALID_ENUM, "Invalid integer-vector property 0x%04x", param);
-    else
-        GetSourceiv(Source, context.get(), static_cast<SourceProp>(param), values);
-}
-END_API_FUNC
-
-
-AL_API void AL_APIENTRY alGetSourcei64SOFT(ALuint source, ALenum param, ALint64SOFT *value)
-START_API_FUNC
-{
-    ContextRef context{GetContextRef()};
-    if(UNLIKELY(!context)) return;
-
-    std::lock_guard<std::mutex> _{context->SourceLock};
-    ALsource *Source{LookupSource(context.get(), source)};
-    if(UNLIKELY(!Source))
-        alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
-    else if(!value)
-        alSetError(context.get(), AL_INVALID_VALUE, "NULL pointer");
-    else if(Int64ValsByProp(param) != 1)
-        alSetError(context.get(), AL_INVALID_ENUM, "Invalid integer64 property 0x%04x", param);
-    else
-        GetSourcei64v(Source, context.get(), static_cast<SourceProp>(param), value);
-}
-END_API_FUNC
-
-AL_API void AL_APIENTRY alGetSource3i64SOFT(ALuint source, ALenum param, ALint64SOFT *value1, ALint64SOFT *value2, ALint64SOFT *value3)
-START_API_FUNC
-{
-    ContextRef context{GetContextRef()};
-    if(UNLIKELY(!context)) return;
-
-    std::lock_guard<std::mutex> _{context->SourceLock};
-    ALsource *Source{LookupSource(context.get(), source)};
-    if(UNLIKELY(!Source))
-        alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
-    else if(!(value1 && value2 && value3))
-        alSetError(context.get(), AL_INVALID_VALUE, "NULL pointer");
-    else if(Int64ValsByProp(param) != 3)
-        alSetError(context.get(), AL_INVALID_ENUM, "Invalid 3-integer64 property 0x%04x", param);
-    else
-    {
-        ALint64SOFT i64vals[3];
-        if(GetSourcei64v(Source, context.get(), static_cast<SourceProp>(param), i64vals))
-        {
-            *value1 = i64vals[0];
-            *value2 = i64vals[1];
-            *value3 = i64vals[2];
-        }
-    }
-}
-END_API_FUNC
-
-AL_API void AL_APIENTRY alGetSourcei64vSOFT(ALuint source, ALenum param, ALint64SOFT *values)
-START_API_FUNC
-{
-    ContextRef context{GetContextRef()};
-    if(UNLIKELY(!context)) return;
-
-    std::lock_guard<std::mutex> _{context->SourceLock};
-    ALsource *Source{LookupSource(context.get(), source)};
-    if(UNLIKELY(!Source))
-        alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
-    else if(!values)
-        alSetError(context.get(), AL_INVALID_VALUE, "NULL pointer");
-    else if(Int64ValsByProp(param) < 1)
-        alSetError(context.get(), AL_INVALID_ENUM, "Invalid integer64-vector property 0x%04x", param);
-    else
-        GetSourcei64v(Source, context.get(), static_cast<SourceProp>(param), values);
-}
-END_API_FUNC
-
-
-AL_API ALvoid AL_APIENTRY alSourcePlay(ALuint source)
-START_API_FUNC
-{ alSourcePlayv(1, &source); }
-END_API_FUNC
-
-AL_API ALvoid AL_APIENTRY alSourcePlayv(ALsizei n, const ALuint *sources)
-START_API_FUNC
-{
-    ContextRef context{GetContextRef()};
-    if(UNLIKELY(!context)) return;
-
-    if(n < 0)
-        SETERR_RETURN(context.get(), AL_INVALID_VALUE,, "Playing %d sources", n);
-    if(n == 0) return;
-
-    std::lock_guard<std::mutex> _{context->SourceLock};
-    auto sources_end = sources+n;
-    auto bad_sid = std::find_if_not(sources, sources_end,
-        [&context](ALuint sid) -> bool
-        {
-            ALsource *source{LookupSource(context.get(), sid)};
-            return LIKELY(source != nullptr);
-        }
-    );
-    if(UNLIKELY(bad_sid != sources+n))
-        SETERR_RETURN(context.get(), AL_INVALID_NAME,, "Invalid source ID %u", *bad_sid);
-
-    ALCdevice *device{context->Device};
-    BackendLockGuard __{*device->Backend};
-    /* If the device is disconnected, go right to stopped. */
-    if(UNLIKELY(!device->Connected.load(std::memory_order_acquire)))
-    {
-        /* TODO: Send state change event? */
-        std::for_each(sources, sources_end,
-            [&context](ALuint sid) -> void
-            {
-                ALsource *source{LookupSource(context.get(), sid)};
-                source->OffsetType = AL_NONE;
-                source->Offset = 0.0;
-                source->state = AL_STOPPED;
-            }
-        );
-        return;
-    }
-
-    /* Count the number of reusable voices. */
-    auto voices_end = context->Voices + context->VoiceCount.load(std::memory_order_relaxed);
-    auto free_voices = std::accumulate(context->Voices, voices_end, ALsizei{0},
-        [](const ALsizei count, const ALvoice *voice) noexcept -> ALsizei
-        {
-            if(voice->mPlayState.load(std::memory_order_acquire) == ALvoice::Stopped &&
-                voice->mSourceID.load(std::memory_order_relaxed) == 0u)
-                return count + 1;
-            return count;
-        }
-    );
-    if(UNLIKELY(n > free_voices))
-    {
-        /* Increment the number of voices to handle the request. */
-        const ALsizei need_voices{n - free_voices};
-        const ALsizei rem_voices{context->MaxVoices -
-            context->VoiceCount.load(std::memory_order_relaxed)};
-
-        if(UNLIKELY(need_voices > rem_voices))
-        {
-            /* Allocate more voices to get enough. */
-            const ALsizei alloc_count{need_voices - rem_voices};
-            if(UNLIKELY(context->MaxVoices > std::numeric_limits<ALsizei>::max()-alloc_count))
-                SETERR_RETURN(context.get(), AL_OUT_OF_MEMORY,,
-                    "Overflow increasing voice count to %d + %d", context->MaxVoices, alloc_count);
-
-            const ALsizei newcount{context->MaxVoices + alloc_count};
-            AllocateVoices(context.get(), newcount, device->NumAuxSends);
-        }
-
-        context->VoiceCount.fetch_add(need_voices, std::memory_order_relaxed);
-    }
-
-    auto start_source = [&context,device](ALuint sid) -> void
-    {
-        ALsource *source{LookupSource(context.get(), sid)};
-        /* Check that there is a queue containing at least one valid, non zero
-         * length buffer.
-         */
-        ALbufferlistitem *BufferList{source->queue};
-        while(BufferList && BufferList->max_samples == 0)
-            BufferList = BufferList->next.load(std::memory_order_relaxed);
-
-        /* If there's nothing to play, go right to stopped. */
-        if(UNLIKELY(!BufferList))
-        {
-            /* NOTE: A source without any playable buffers should not have an
-             * ALvoice since it shouldn't be in a playing or paused state. So
-             * there's no need to look up its voice and clear the source.
-             */
-            ALenum oldstate{GetSourceState(source, nullptr)};
-            source->OffsetType = AL_NONE;
-            source->Offset = 0.0;
-            if(oldstate != AL_STOPPED)
-            {
-                source->state = AL_STOPPED;
-                SendStateChangeEvent(context.get(), source->id, AL_STOPPED);
-            }
-            return;
-        }
-
-        ALvoice *voice{GetSourceVoice(source, context.get())};
-        switch(GetSourceState(source, voice))
-        {
-        case AL_PLAYING:
-            assert(voice != nullptr);
-            /* A source that's already playing is restarted from the beginning. */
-            voice->mCurrentBuffer.store(BufferList, std::memory_order_relaxed);
-            voice->mPosition.store(0u, std::memory_order_relaxed);
-            voice->mPositionFrac.store(0, std::memory_order_release);
-            return;
+    }
+}
+END_API_FUNC
 
-        case AL_PAUSED:
-            assert(voice != nullptr);
-            /* A source that's paused simply resumes. */
-            voice->mPlayState.store(ALvoice::Playing, std::memory_order_release);
-            source->state = AL_PLAYING;
-            SendStateChangeEvent(context.get(), source->id, AL_PLAYING);
-            return;
+AL_API void AL_APIENTRY alGetSourceiv(ALuint source, ALenum param, ALint *values)
+START_API_FUNC
+{
+    ContextRef context{GetContextRef()};
+    if(UNLIKELY(!context)) return;
 
-        default:
-            assert(voice == nullptr);
-            break;
-        }
+    FlushedSourceLock _{context.get()};
+    ALsource *Source{LookupSource(context.get(), source)};
+    if(UNLIKELY(!Source))
+        alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
+    else if(!values)
+        alSetError(context.get(), AL_INVALID_VALUE, "NULL pointer");
+    else if(IntValsByProp(param) < 1)
+        alSetError(context.get(), AL_INVALID_ENUM, "Invalid integer-vector property 0x%04x", param);
+    else
+        GetSourceiv(Source, context.get(), static_cast<SourceProp>(param), values);
+}
+END_API_FUNC
 
-        /* Look for an unused voice to play this source with. */
-        auto voices_end = context->Voices + context->VoiceCount.load(std::memory_order_relaxed);
-        auto voice_iter = std::find_if(context->Voices, voices_end,
-            [](const ALvoice *voice) noexcept -> bool
-            {
-                return voice->mPlayState.load(std::memory_order_acquire) == ALvoice::Stopped &&
-                    voice->mSourceID.load(std::memory_order_relaxed) == 0u;
-            }
-        );
-        assert(voice_iter != voices_end);
-        auto vidx = static_cast<ALint>(std::distance(context->Voices, voice_iter));
-        voice = *voice_iter;
-        voice->mPlayState.store(ALvoice::Stopped, std::memory_order_release);
 
-        source->PropsClean.test_and_set(std::memory_order_acquire);
-        UpdateSourceProps(source, voice, context.get());
+AL_API void AL_APIENTRY alGetSourcei64SOFT(ALuint source, ALenum param, ALint64SOFT *value)
+START_API_FUNC
+{
+    ContextRef context{GetContextRef()};
+    if(UNLIKELY(!context)) return;
 
-        /* A source that's not playing or paused has any offset applied when it
-         * starts playing.
-         */
-        if(source->Looping)
-            voice->mLoopBuffer.store(source->queue, std::memory_order_relaxed);
-        else
-            voice->mLoopBuffer.store(nullptr, std::memory_order_relaxed);
-        voice->mCurrentBuffer.store(BufferList, std::memory_order_relaxed);
-        voice->mPosition.store(0u, std::memory_order_relaxed);
-        voice->mPositionFrac.store(0, std::memory_order_relaxed);
-        bool start_fading{false};
-        if(ApplyOffset(source, voice) != AL_FALSE)
-            start_fading = voice->mPosition.load(std::memory_order_relaxed) != 0 ||
-                voice->mPositionFrac.load(std::memory_order_relaxed) != 0 ||
-                voice->mCurrentBuffer.load(std::memory_order_relaxed) != BufferList;
+    FlushedSourceLock _{context.get()};
+    ALsource *Source{LookupSource(context.get(), source)};
+    if(UNLIKELY(!Source))
+        alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
+    else if(!value)
+        alSetError(context.get(), AL_INVALID_VALUE, "NULL pointer");
+    else if(Int64ValsByProp(param) != 1)
+        alSetError(context.get(), AL_INVALID_ENUM, "Invalid integer64 property 0x%04x", param);
+    else
+        GetSourcei64v(Source, context.get(), static_cast<SourceProp>(param), value);
+}
+END_API_FUNC
 
-        auto buffers_end = BufferList->buffers + BufferList->num_buffers;
-        auto buffer = std::find_if(BufferList->buffers, buffers_end,
-            std::bind(std::not_equal_to<const ALbuffer*>{}, _1, nullptr));
-        if(buffer != buffers_end)
+AL_API void AL_APIENTRY alGetSource3i64SOFT(ALuint source, ALenum param, ALint64SOFT *value1, ALint64SOFT *value2, ALint64SOFT *value3)
+START_API_FUNC
+{
+    ContextRef context{GetContextRef()};
+    if(UNLIKELY(!context)) return;
+
+    FlushedSourceLock _{context.get()};
+    ALsource *Source{LookupSource(context.get(), source)};
+    if(UNLIKELY(!Source))
+        alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
+    else if(!(value1 && value2 && value3))
+        alSetError(context.get(), AL_INVALID_VALUE, "NULL pointer");
+    else if(Int64ValsByProp(param) != 3)
+        alSetError(context.get(), AL_INVALID_ENUM, "Invalid 3-integer64 property 0x%04x", param);
+    else
+    {
+        ALint64SOFT i64vals[3];
+        if(GetSourcei64v(Source, context.get(), static_cast<SourceProp>(param), i64vals))
         {
-            voice->mFrequency = (*buffer)->Frequency;
-            voice->mFmtChannels = (*buffer)->mFmtChannels;
-            voice->mNumChannels = ChannelsFromFmt((*buffer)->mFmtChannels);
-            voice->mSampleSize  = BytesFromFmt((*buffer)->mFmtType);
+            *value1 = i64vals[0];
+            *value2 = i64vals[1];
+            *value3 = i64vals[2];
         }
+    }
+}
+END_API_FUNC
 
-        /* Clear previous samples. */
-        std::for_each(voice->mPrevSamples.begin(), voice->mPrevSamples.begin()+voice->mNumChannels,
-            [](std::array<ALfloat,MAX_RESAMPLE_PADDING*2> &samples) -> void
-            { std::fill(std::begin(samples), std::end(samples), 0.0f); });
-
-        /* Clear the stepping value so the mixer knows not to mix this until
-         * the update gets applied.
-         */
-        voice->mStep = 0;
+AL_API void AL_APIENTRY alGetSourcei64vSOFT(ALuint source, ALenum param, ALint64SOFT *values)
+START_API_FUNC
+{
+    ContextRef context{GetContextRef()};
+    if(UNLIKELY(!context)) return;
 
-        voice->mFlags = start_fading ? VOICE_IS_FADING : 0;
-        if(source->SourceType == AL_STATIC) voice->mFlags |= VOICE_IS_STATIC;
+    FlushedSourceLock _{context.get()};
+    ALsource *Source{LookupSource(context.get(), source)};
+    if(UNLIKELY(!Source))
+        alSetError(context.get(), AL_INVALID_NAME, "Invalid source ID %u", source);
+    else if(!values)
+        alSetError(context.get(), AL_INVALID_VALUE, "NULL pointer");
+    else if(Int64ValsByProp(param) < 1)
+        alSetError(context.get(), AL_INVALID_ENUM, "Invalid integer64-vector property 0x%04x", param);
+    else
+        GetSourcei64v(Source, context.get(), static_cast<SourceProp>(param), values);
+}
+END_API_FUNC
 
-        /* Don't need to set the VOICE_IS_AMBISONIC flag if the device is
-         * mixing in first order. No HF scaling is necessary to mix it.
-         */
-        if((voice->mFmtChannels == FmtBFormat2D || voice->mFmtChannels == FmtBFormat3D) &&
-           device->mAmbiOrder > 1)
-        {
-            auto scales = BFormatDec::GetHFOrderScales(1, device->mAmbiOrder);
-            if(voice->mFmtChannels == FmtBFormat2D)
-            {
-                static constexpr int Order2DFromChan[MAX_AMBI2D_CHANNELS]{
-                    0, 1,1, 2,2, 3,3
-                };
-                const size_t count{Ambi2DChannelsFromOrder(1u)};
-                std::transform(Order2DFromChan, Order2DFromChan+count, voice->mAmbiScales.begin(),
-                    [&scales](size_t idx) -> ALfloat { return scales[idx]; });
-            }
-            else
-            {
-                static constexpr int OrderFromChan[MAX_AMBI_CHANNELS]{
-                    0, 1,1,1, 2,2,2,2,2, 3,3,3,3,3,3,3,
-                };
-                const size_t count{Ambi2DChannelsFromOrder(1u)};
-                std::transform(OrderFromChan, OrderFromChan+count, voice->mAmbiScales.begin(),
-                    [&scales](size_t idx) -> ALfloat { return scales[idx]; });
-            }
 
-            voice->mAmbiSplitter[0].init(400.0f / static_cast<ALfloat>(device->Frequency));
-            std::fill_n(voice->mAmbiSplitter.begin()+1, voice->mNumChannels-1,
-                voice->mAmbiSplitter[0]);
-            voice->mFlags |= VOICE_IS_AMBISONIC;
-        }
+AL_API ALvoid AL_APIENTRY alSourcePlay(ALuint source)
+START_API_FUNC
+{ alSourcePlayv(1, &source); }
+END_API_FUNC
 
-        std::fill_n(std::begin(voice->mDirect.Params), voice->mNumChannels, DirectParams{});
-        std::for_each(voice->mSend.begin(), voice->mSend.end(),
-            [voice](ALvoice::SendData &send) -> void
-            { std::fill_n(std::begin(send.Params), voice->mNumChannels, SendParams{}); }
-        );
+AL_API ALvoid AL_APIENTRY alSourcePlayv(ALsizei n, const ALuint *sources)
+START_API_FUNC
+{
+    TraceSpan span{"alSourcePlayv"};
+    ContextRef context{GetContextRef()};
+    if(UNLIKELY(!context)) return;
 
-        if(device->AvgSpeakerDist > 0.0f)
-        {
-            ALfloat w1 = SPEEDOFSOUNDMETRESPERSEC /
-                         (device->AvgSpeakerDist * device->Frequency);
-            std::for_each(voice->mDirect.Params+0, voice->mDirect.Params+voice->mNumChannels,
-                [w1](DirectParams &parms) noexcept -> void
-                { parms.NFCtrlFilter.init(w1); }
-            );
-        }
+    if(n < 0)
+        SETERR_RETURN(context.get(), AL_INVALID_VALUE,, "Playing %d sources", n);
+    if(n == 0) return;
 
-        voice->mSourceID.store(source->id, std::memory_order_relaxed);
-        voice->mPlayState.store(ALvoice::Playing, std::memory_order_release);
-        source->state = AL_PLAYING;
-        source->VoiceIdx = vidx;
+    if(context->DeferCommands.load(std::memory_order_acquire))
+    {
+        auto defer_state = std::bind(DeferSourceState, context.get(), SourceCmd::Play, _1);
+        const ALuint *deferred_end{std::find_if_not(sources, sources+n, defer_state)};
+        if(deferred_end == sources+n) return;
+        n -= static_cast<ALsizei>(std::distance(sources, deferred_end));
+        sources = deferred_end;
+    }
 
-        SendStateChangeEvent(context.get(), source->id, AL_PLAYING);
-    };
-    std::for_each(sources, sources_end, start_source);
+    FlushedSourceLock _{context.get()};
+    PlaySources(context.get(), sources, n);
 }
 END_API_FUNC
 
@@ -2987,6 +3759,7 @@ END_API_FUNC
 AL_API ALvoid AL_APIENTRY alSourcePausev(ALsizei n, const ALuint *sources)
 START_API_FUNC
 {
+    TraceSpan span{"alSourcePausev"};
     ContextRef context{GetContextRef()};
     if(UNLIKELY(!context)) return;
 
@@ -2994,32 +3767,17 @@ START_API_FUNC
         SETERR_RETURN(context.get(), AL_INVALID_VALUE,, "Pausing %d sources", n);
     if(n == 0) return;
 
-    std::lock_guard<std::mutex> _{context->SourceLock};
-    for(ALsizei i{0};i < n;i++)
+    if(context->DeferCommands.load(std::memory_order_acquire))
     {
-        if(!LookupSource(context.get(), sources[i]))
-            SETERR_RETURN(context.get(), AL_INVALID_NAME,, "Invalid source ID %u", sources[i]);
+        auto defer_state = std::bind(DeferSourceState, context.get(), SourceCmd::Pause, _1);
+        const ALuint *deferred_end{std::find_if_not(sources, sources+n, defer_state)};
+        if(deferred_end == sources+n) return;
+        n -= static_cast<ALsizei>(std::distance(sources, deferred_end));
+        sources = deferred_end;
     }
 
-    ALCdevice *device{context->Device};
-    BackendLockGuard __{*device->Backend};
-    for(ALsizei i{0};i < n;i++)
-    {
-        ALsource *source{LookupSource(context.get(), sources[i])};
-        ALvoice *voice{GetSourceVoice(source, context.get())};
-        if(voice)
-        {
-            std::atomic_thread_fence(std::memory_order_release);
-            ALvoice::State oldvstate{ALvoice::Playing};
-            voice->mPlayState.compare_exchange_strong(oldvstate, ALvoice::Stopping,
-                std::memory_order_acq_rel, std::memory_order_acquire);
-        }
-        if(GetSourceState(source, voice) == AL_PLAYING)
-        {
-            source->state = AL_PAUSED;
-            SendStateChangeEvent(context.get(), source->id, AL_PAUSED);
-        }
-    }
+    FlushedSourceLock _{context.get()};
+    PauseSources(context.get(), sources, n);
 }
 END_API_FUNC
 
@@ -3032,6 +3790,7 @@ END_API_FUNC
 AL_API ALvoid AL_APIENTRY alSourceStopv(ALsizei n, const ALuint *sources)
 START_API_FUNC
 {
+    TraceSpan span{"alSourceStopv"};
     ContextRef context{GetContextRef()};
     if(UNLIKELY(!context)) return;
 
@@ -3039,39 +3798,17 @@ START_API_FUNC
         SETERR_RETURN(context.get(), AL_INVALID_VALUE,, "Stopping %d sources", n);
     if(n == 0) return;
 
-    std::lock_guard<std::mutex> _{context->SourceLock};
-    for(ALsizei i{0};i < n;i++)
+    if(context->DeferCommands.load(std::memory_order_acquire))
     {
-        if(!LookupSource(context.get(), sources[i]))
-            SETERR_RETURN(context.get(), AL_INVALID_NAME,, "Invalid source ID %u", sources[i]);
+        auto defer_state = std::bind(DeferSourceState, context.get(), SourceCmd::Stop, _1);
+        const ALuint *deferred_end{std::find_if_not(sources, sources+n, defer_state)};
+        if(deferred_end == sources+n) return;
+        n -= static_cast<ALsizei>(std::distance(sources, deferred_end));
+        sources = deferred_end;
     }
 
-    ALCdevice *device{context->Device};
-    BackendLockGuard __{*device->Backend};
-    for(ALsizei i{0};i < n;i++)
-    {
-        ALsource *source{LookupSource(context.get(), sources[i])};
-        ALvoice *voice{GetSourceVoice(source, context.get())};
-        if(voice != nullptr)
-        {
-            voice->mCurrentBuffer.store(nullptr, std::memory_order_relaxed);
-            voice->mLoopBuffer.store(nullptr, std::memory_order_relaxed);
-            voice->mSourceID.store(0u, std::memory_order_relaxed);
-            std::atomic_thread_fence(std::memory_order_release);
-            ALvoice::State oldvstate{ALvoice::Playing};
-            voice->mPlayState.compare_exchange_strong(oldvstate, ALvoice::Stopping,
-                std::memory_order_acq_rel, std::memory_order_acquire);
-            voice = nullptr;
-        }
-        ALenum oldstate{GetSourceState(source, voice)};
-        if(oldstate != AL_INITIAL && oldstate != AL_STOPPED)
-        {
-            source->state = AL_STOPPED;
-            SendStateChangeEvent(context.get(), source->id, AL_STOPPED);
-        }
-        source->OffsetType = AL_NONE;
-        source->Offset = 0.0;
-    }
+    FlushedSourceLock _{context.get()};
+    StopSources(context.get(), sources, n);
 }
 END_API_FUNC
 
@@ -3084,6 +3821,7 @@ END_API_FUNC
 AL_API ALvoid AL_APIENTRY alSourceRewindv(ALsizei n, const ALuint *sources)
 START_API_FUNC
 {
+    TraceSpan span{"alSourceRewindv"};
     ContextRef context{GetContextRef()};
     if(UNLIKELY(!context)) return;
 
@@ -3091,38 +3829,17 @@ START_API_FUNC
         SETERR_RETURN(context.get(), AL_INVALID_VALUE,, "Rewinding %d sources", n);
     if(n == 0) return;
 
-    std::lock_guard<std::mutex> _{context->SourceLock};
-    for(ALsizei i{0};i < n;i++)
+    if(context->DeferCommands.load(std::memory_order_acquire))
     {
-        if(!LookupSource(context.get(), sources[i]))
-            SETERR_RETURN(context.get(), AL_INVALID_NAME,, "Invalid source ID %u", sources[i]);
+        auto defer_state = std::bind(DeferSourceState, context.get(), SourceCmd::Rewind, _1);
+        const ALuint *deferred_end{std::find_if_not(sources, sources+n, defer_state)};
+        if(deferred_end == sources+n) return;
+        n -= static_cast<ALsizei>(std::distance(sources, deferred_end));
+        sources = deferred_end;
     }
 
-    ALCdevice *device{context->Device};
-    BackendLockGuard __{*device->Backend};
-    for(ALsizei i{0};i < n;i++)
-    {
-        ALsource *source{LookupSource(context.get(), sources[i])};
-        ALvoice *voice{GetSourceVoice(source, context.get())};
-        if(voice != nullptr)
-        {
-            voice->mCurrentBuffer.store(nullptr, std::memory_order_relaxed);
-            voice->mLoopBuffer.store(nullptr, std::memory_order_relaxed);
-            voice->mSourceID.store(0u, std::memory_order_relaxed);
-            std::atomic_thread_fence(std::memory_order_release);
-            ALvoice::State oldvstate{ALvoice::Playing};
-            voice->mPlayState.compare_exchange_strong(oldvstate, ALvoice::Stopping,
-                std::memory_order_acq_rel, std::memory_order_acquire);
-            voice = nullptr;
-        }
-        if(GetSourceState(source, voice) != AL_INITIAL)
-        {
-            source->state = AL_INITIAL;
-            SendStateChangeEvent(context.get(), source->id, AL_INITIAL);
-        }
-        source->OffsetType = AL_NONE;
-        source->Offset = 0.0;
-    }
+    FlushedSourceLock _{context.get()};
+    RewindSources(context.get(), sources, n);
 }
 END_API_FUNC
 
@@ -3137,7 +3854,7 @@ START_API_FUNC
         SETERR_RETURN(context.get(), AL_INVALID_VALUE,, "Queueing %d buffers", nb);
     if(nb == 0) return;
 
-    std::lock_guard<std::mutex> _{context->SourceLock};
+    FlushedSourceLock _{context.get()};
     ALsource *source{LookupSource(context.get(),src)};
     if(UNLIKELY(!source))
         SETERR_RETURN(context.get(), AL_INVALID_NAME,, "Invalid source ID %u", src);
@@ -3256,7 +3973,7 @@ START_API_FUNC
         SETERR_RETURN(context.get(), AL_INVALID_VALUE,, "Queueing %d buffer layers", nb);
     if(nb == 0) return;
 
-    std::lock_guard<std::mutex> _{context->SourceLock};
+    FlushedSourceLock _{context.get()};
     ALsource *source{LookupSource(context.get(),src)};
     if(UNLIKELY(!source))
         SETERR_RETURN(context.get(), AL_INVALID_NAME,, "Invalid source ID %u", src);
@@ -3366,7 +4083,7 @@ START_API_FUNC
         SETERR_RETURN(context.get(), AL_INVALID_VALUE,, "Unqueueing %d buffers", nb);
     if(nb == 0) return;
 
-    std::lock_guard<std::mutex> _{context->SourceLock};
+    FlushedSourceLock _{context.get()};
     ALsource *source{LookupSource(context.get(),src)};
     if(UNLIKELY(!source))
         SETERR_RETURN(context.get(), AL_INVALID_NAME,, "Invalid source ID %u", src);
@@ -3516,6 +4233,7 @@ ALsource::ALsource(ALsizei num_sends)
     queue = nullptr;
 
     PropsClean.test_and_set(std::memory_order_relaxed);
+    PropsDirty = VOICE_DIRTY_ALL;
 
     VoiceIdx = -1;
 }
@@ -3548,8 +4266,8 @@ ALsource::~ALsource()
 
 void UpdateAllSourceProps(ALCcontext *context)
 {
-    auto voices_end = context->Voices + context->VoiceCount.load(std::memory_order_relaxed);
-    std::for_each(context->Voices, voices_end,
+    ALvoice **voices{context->Voices.load(std::memory_order_relaxed)->data()};
+    std::for_each(voices, voices+context->VoiceCount.load(std::memory_order_relaxed),
         [context](ALvoice *voice) -> void
         {
             ALuint sid{voice->mSourceID.load(std::memory_order_acquire)};
@@ -3560,6 +4278,29 @@ void UpdateAllSourceProps(ALCcontext *context)
     );
 }
 
+void ProcessSourceCmds(ALCcontext *context)
+{
+    if(!context->SourceCmdQueues.load(std::memory_order_acquire))
+        return;
+    std::lock_guard<std::mutex> _{context->SourceLock};
+    ApplySourceCmds(context);
+}
+
+void FreeSourceCmdQueues(ALCcontext *context)
+{
+    size_t count{0};
+    SourceCmdQueue *queue{context->SourceCmdQueues.exchange(nullptr, std::memory_order_acquire)};
+    while(queue)
+    {
+        SourceCmdQueue *next{queue->mNext};
+        count += queue->mCommands->readSpace();
+        delete queue;
+        queue = next;
+    }
+    if(count > 0)
+        WARN("%zu deferred source command%s not applied\n", count, (count==1)?"":"s");
+}
+
 SourceSubList::~SourceSubList()
 {
     uint64_t usemask{~FreeMask};
@@ -29,6 +29,8 @@
 #include "alcontext.h"
 #include "alu.h"
 #include "alError.h"
+#include "alSource.h"
+#include "trace.h"
 #include "alexcpt.h"
 
 #include "backends/base.h"
@@ -91,6 +93,10 @@ START_API_FUNC
         DO_UPDATEPROPS();
         break;
 
+    case AL_DEFERRED_COMMANDS_SOFT:
+        context->DeferCommands.store(true, std::memory_order_release);
+        break;
+
     default:
         alSetError(context.get(), AL_INVALID_VALUE, "Invalid enable property 0x%04x", capability);
     }
@@ -111,6 +117,12 @@ START_API_FUNC
         DO_UPDATEPROPS();
         break;
 
+    case AL_DEFERRED_COMMANDS_SOFT:
+        /* Apply what was recorded, so later calls happen after it. */
+        context->DeferCommands.store(false, std::memory_order_release);
+        ProcessSourceCmds(context.get());
+        break;
+
     default:
         alSetError(context.get(), AL_INVALID_VALUE, "Invalid disable property 0x%04x", capability);
     }
@@ -131,6 +143,10 @@ START_API_FUNC
         value = context->SourceDistanceModel;
         break;
 
+    case AL_DEFERRED_COMMANDS_SOFT:
+        value = context->DeferCommands.load(std::memory_order_acquire) ? AL_TRUE : AL_FALSE;
+        break;
+
     default:
         alSetError(context.get(), AL_INVALID_VALUE, "Invalid is enabled property 0x%04x", capability);
     }
@@ -772,6 +788,7 @@ END_API_FUNC
 AL_API ALvoid AL_APIENTRY alProcessUpdatesSOFT(void)
 START_API_FUNC
 {
+    TraceSpan span{"alProcessUpdatesSOFT"};
     ContextRef context{GetContextRef()};
     if(UNLIKELY(!context)) return;
 
@@ -815,17 +832,8 @@ END_API_FUNC
 void UpdateContextProps(ALCcontext *context)
 {
     /* Get an unused proprty container, or allocate a new one as needed. */
-    ALcontextProps *props{context->FreeContextProps.load(std::memory_order_acquire)};
-    if(!props)
-        props = static_cast<ALcontextProps*>(al_calloc(16, sizeof(*props)));
-    else
-    {
-        ALcontextProps *next;
-        do {
-            next = props->next.load(std::memory_order_relaxed);
-        } while(context->FreeContextProps.compare_exchange_weak(props, next,
-                std::memory_order_seq_cst, std::memory_order_acquire) == 0);
-    }
+    ALcontextProps *props{context->FreeContextProps.get(context, context->Update,
+        []() -> ALcontextProps* { return static_cast<ALcontextProps*>(al_calloc(16, sizeof(ALcontextProps))); })};
 
     /* Copy in current property values. */
     props->MetersPerUnit = context->MetersPerUnit;
@@ -844,6 +852,6 @@ void UpdateContextProps(ALCcontext *context)
         /* If there was an unused update container, put it back in the
          * freelist.
          */
-        AtomicReplaceHead(context->FreeContextProps, props);
+        context->FreeContextProps.push(props);
     }
 }
@@ -12,6 +12,7 @@
 #include "alError.h"
 #include "alAuxEffectSlot.h"
 #include "ringbuffer.h"
+#include "trace.h"
 #include "threads.h"
 #include "alexcpt.h"
 
@@ -30,6 +31,7 @@ static int EventThread(ALCcontext *context)
         }
 
         std::lock_guard<std::mutex> _{context->EventCbLock};
+        TraceSpan span{"EventThread"};
         do {
             auto &evt = *reinterpret_cast<AsyncEvent*>(evt_data.buf);
             evt_data.buf += sizeof(AsyncEvent);
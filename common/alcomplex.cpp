@@ -3,74 +3,376 @@
 
 #include "alcomplex.h"
 
+#include <algorithm>
 #include <cmath>
+#include <memory>
+#include <mutex>
+
+#ifdef HAVE_SSE_INTRINSICS
+#include <xmmintrin.h>
+#elif defined(HAVE_NEON) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define USE_NEON_FFT
+#endif
 
 namespace {
 
 constexpr double Pi{3.141592653589793238462643383279502884};
 
-} // namespace
+/* Largest transform size with a cached plan. */
+constexpr size_t FFTTableSize{4096};
+constexpr size_t FFTTableBits{12};
+
+
+/* One pass over the buffer, doing two radix-2 stages with half-sizes m and 2m
+ * at once. Each group of four points is combined with the twiddles w (for the
+ * first stage) and v (for the second, where the upper half needs v rotated by
+ * a quarter turn). The twiddles are stored for the forward transform, and
+ * conjugated for the inverse.
+ */
+template<typename T>
+void FusedPassC(std::complex<T> *buffer, const size_t n, const size_t m,
+    const std::complex<T> *RESTRICT w, const std::complex<T> *RESTRICT v, const bool inverse)
+{
+    const T conj{inverse ? T{-1} : T{1}};
+    for(size_t b{0};b < n;b += m*4)
+    {
+        std::complex<T> *RESTRICT x0{buffer + b};
+        std::complex<T> *RESTRICT x1{x0 + m};
+        std::complex<T> *RESTRICT x2{x1 + m};
+        std::complex<T> *RESTRICT x3{x2 + m};
+        for(size_t j{0};j < m;j++)
+        {
+            const T wr{w[j].real()}, wi{w[j].imag() * conj};
+            const T vr{v[j].real()}, vi{v[j].imag() * conj};
+
+            T tr{x1[j].real()*wr - x1[j].imag()*wi};
+            T ti{x1[j].real()*wi + x1[j].imag()*wr};
+            const T y0r{x0[j].real() + tr}, y0i{x0[j].imag() + ti};
+            const T y1r{x0[j].real() - tr}, y1i{x0[j].imag() - ti};
+
+            tr = x3[j].real()*wr - x3[j].imag()*wi;
+            ti = x3[j].real()*wi + x3[j].imag()*wr;
+            const T y2r{x2[j].real() + tr}, y2i{x2[j].imag() + ti};
+            const T y3r{x2[j].real() - tr}, y3i{x2[j].imag() - ti};
+
+            tr = y2r*vr - y2i*vi;
+            ti = y2r*vi + y2i*vr;
+            x0[j] = std::complex<T>{y0r + tr, y0i + ti};
+            x2[j] = std::complex<T>{y0r - tr, y0i - ti};
+
+            /* Multiply by v, then by -i (forward) or +i (inverse). */
+            const T ur{y3r*vr - y3i*vi}, ui{y3r*vi + y3i*vr};
+            tr =  ui * conj;
+            ti = -ur * conj;
+            x1[j] = std::complex<T>{y1r + tr, y1i + ti};
+            x3[j] = std::complex<T>{y1r - tr, y1i - ti};
+        }
+    }
+}
+
+template<typename T>
+void FusedPass(std::complex<T> *buffer, const size_t n, const size_t m,
+    const std::complex<T> *RESTRICT w, const std::complex<T> *RESTRICT v, const bool inverse)
+{ FusedPassC(buffer, n, m, w, v, inverse); }
+
+#ifdef HAVE_SSE_INTRINSICS
+
+using vec4 = __m128;
+inline vec4 Splat4(float a) { return _mm_set1_ps(a); }
+inline vec4 Add4(vec4 a, vec4 b) { return _mm_add_ps(a, b); }
+inline vec4 Sub4(vec4 a, vec4 b) { return _mm_sub_ps(a, b); }
+inline vec4 Mul4(vec4 a, vec4 b) { return _mm_mul_ps(a, b); }
+
+/* Loads four complex values into separate real and imaginary vectors. */
+inline void Load4(const std::complex<float> *src, vec4 &re, vec4 &im)
+{
+    const __m128 lo{_mm_loadu_ps(reinterpret_cast<const float*>(src))};
+    const __m128 hi{_mm_loadu_ps(reinterpret_cast<const float*>(src+2))};
+    re = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2,0,2,0));
+    im = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3,1,3,1));
+}
+inline void Store4(std::complex<float> *dst, const vec4 re, const vec4 im)
+{
+    _mm_storeu_ps(reinterpret_cast<float*>(dst), _mm_unpacklo_ps(re, im));
+    _mm_storeu_ps(reinterpret_cast<float*>(dst+2), _mm_unpackhi_ps(re, im));
+}
+#define HAVE_SIMD_FFT
 
-void complex_fft(std::complex<double> *FFTBuffer, int FFTSize, double Sign)
+#elif defined(USE_NEON_FFT)
+
+using vec4 = float32x4_t;
+inline vec4 Splat4(float a) { return vdupq_n_f32(a); }
+inline vec4 Add4(vec4 a, vec4 b) { return vaddq_f32(a, b); }
+inline vec4 Sub4(vec4 a, vec4 b) { return vsubq_f32(a, b); }
+inline vec4 Mul4(vec4 a, vec4 b) { return vmulq_f32(a, b); }
+
+inline void Load4(const std::complex<float> *src, vec4 &re, vec4 &im)
+{
+    const float32x4x2_t vals{vld2q_f32(reinterpret_cast<const float*>(src))};
+    re = vals.val[0];
+    im = vals.val[1];
+}
+inline void Store4(std::complex<float> *dst, const vec4 re, const vec4 im)
 {
-    /* Bit-reversal permutation applied to a sequence of FFTSize items */
-    for(int i{1};i < FFTSize-1;i++)
+    float32x4x2_t vals;
+    vals.val[0] = re;
+    vals.val[1] = im;
+    vst2q_f32(reinterpret_cast<float*>(dst), vals);
+}
+#define HAVE_SIMD_FFT
+#endif
+
+#ifdef HAVE_SIMD_FFT
+/* Vectorized passes, doing four butterflies at a time. */
+template<>
+void FusedPass<float>(std::complex<float> *buffer, const size_t n, const size_t m,
+    const std::complex<float> *RESTRICT w, const std::complex<float> *RESTRICT v,
+    const bool inverse)
+{
+    /* The first pass may have too few twiddles per group to fill a vector. */
+    if(m < 4)
     {
-        int j{0};
-        for(int mask{1};mask < FFTSize;mask <<= 1)
+        FusedPassC(buffer, n, m, w, v, inverse);
+        return;
+    }
+
+    const vec4 conj4{Splat4(inverse ? -1.0f : 1.0f)};
+    const vec4 zero4{Splat4(0.0f)};
+    for(size_t b{0};b < n;b += m*4)
+    {
+        std::complex<float> *RESTRICT x0{buffer + b};
+        std::complex<float> *RESTRICT x1{x0 + m};
+        std::complex<float> *RESTRICT x2{x1 + m};
+        std::complex<float> *RESTRICT x3{x2 + m};
+        for(size_t j{0};j < m;j+=4)
         {
-            if((i&mask) != 0)
-                j++;
-            j <<= 1;
+            vec4 wr, wi, vr, vi;
+            Load4(w+j, wr, wi);
+            Load4(v+j, vr, vi);
+            wi = Mul4(wi, conj4);
+            vi = Mul4(vi, conj4);
+
+            vec4 ar, ai, br, bi;
+            Load4(x0+j, ar, ai);
+            Load4(x1+j, br, bi);
+            vec4 tr{Sub4(Mul4(br, wr), Mul4(bi, wi))};
+            vec4 ti{Add4(Mul4(br, wi), Mul4(bi, wr))};
+            const vec4 y0r{Add4(ar, tr)}, y0i{Add4(ai, ti)};
+            const vec4 y1r{Sub4(ar, tr)}, y1i{Sub4(ai, ti)};
+
+            Load4(x2+j, ar, ai);
+            Load4(x3+j, br, bi);
+            tr = Sub4(Mul4(br, wr), Mul4(bi, wi));
+            ti = Add4(Mul4(br, wi), Mul4(bi, wr));
+            const vec4 y2r{Add4(ar, tr)}, y2i{Add4(ai, ti)};
+            const vec4 y3r{Sub4(ar, tr)}, y3i{Sub4(ai, ti)};
+
+            tr = Sub4(Mul4(y2r, vr), Mul4(y2i, vi));
+            ti = Add4(Mul4(y2r, vi), Mul4(y2i, vr));
+            Store4(x0+j, Add4(y0r, tr), Add4(y0i, ti));
+            Store4(x2+j, Sub4(y0r, tr), Sub4(y0i, ti));
+
+            const vec4 ur{Sub4(Mul4(y3r, vr), Mul4(y3i, vi))};
+            const vec4 ui{Add4(Mul4(y3r, vi), Mul4(y3i, vr))};
+            tr = Mul4(ui, conj4);
+            ti = Sub4(zero4, Mul4(ur, conj4));
+            Store4(x1+j, Add4(y1r, tr), Add4(y1i, ti));
+            Store4(x3+j, Sub4(y1r, tr), Sub4(y1i, ti));
         }
-        j >>= 1;
+    }
+}
+#endif
+
+} // namespace
+
+
+template<typename T>
+ComplexFftPlan<T>::ComplexFftPlan(size_t size) : mSize{size}
+{
+    /* Bit-reversal permutation, stored as the index pairs to swap. */
+    for(size_t i{1}, j{0};i < size;i++)
+    {
+        size_t bit{size >> 1};
+        for(;j&bit;bit >>= 1)
+            j ^= bit;
+        j ^= bit;
 
         if(i < j)
-            std::swap(FFTBuffer[i], FFTBuffer[j]);
+            mSwaps.emplace_back(static_cast<unsigned int>(i), static_cast<unsigned int>(j));
     }
 
-    /* Iterative form of DanielsonLanczos lemma */
-    int step{2};
-    for(int i{1};i < FFTSize;i<<=1, step<<=1)
+    /* With an odd number of stages, the first is done alone (it needs no
+     * twiddle factors). The rest are done in pairs, each pair storing its
+     * exp(-i*pi*j/m) and exp(-i*pi*j/(2m)) factors contiguously.
+     */
+    size_t bits{0};
+    while((size_t{1}<<bits) < size)
+        ++bits;
+    mOddPass = (bits&1) != 0;
+
+    for(size_t m{mOddPass ? 2u : 1u};m*4 <= size;m *= 4)
     {
-        int step2{step >> 1};
-        double arg{Pi / step2};
+        for(size_t j{0};j < m;j++)
+        {
+            const double arg{Pi * static_cast<double>(j) / static_cast<double>(m)};
+            mTwiddles.emplace_back(static_cast<T>(std::cos(arg)), static_cast<T>(-std::sin(arg)));
+        }
+        for(size_t j{0};j < m;j++)
+        {
+            const double arg{Pi * static_cast<double>(j) / static_cast<double>(m*2)};
+            mTwiddles.emplace_back(static_cast<T>(std::cos(arg)), static_cast<T>(-std::sin(arg)));
+        }
+    }
+}
+
+template<typename T>
+ComplexFftPlan<T>::~ComplexFftPlan() = default;
 
-        std::complex<double> w{std::cos(arg), std::sin(arg)*Sign};
-        std::complex<double> u{1.0, 0.0};
-        for(int j{0};j < step2;j++)
+template<typename T>
+void ComplexFftPlan<T>::transform(std::complex<T> *buffer, bool inverse) const
+{
+    for(const auto &swap : mSwaps)
+        std::swap(buffer[swap.first], buffer[swap.second]);
+
+    size_t m{1};
+    if(mOddPass)
+    {
+        for(size_t k{0};k < mSize;k+=2)
         {
-            for(int k{j};k < FFTSize;k+=step)
-            {
-                std::complex<double> temp{FFTBuffer[k+step2] * u};
-                FFTBuffer[k+step2] = FFTBuffer[k] - temp;
-                FFTBuffer[k] += temp;
-            }
-
-            u *= w;
+            const std::complex<T> temp{buffer[k+1]};
+            buffer[k+1] = buffer[k] - temp;
+            buffer[k] += temp;
         }
+        m = 2;
+    }
+
+    const std::complex<T> *twiddles{mTwiddles.data()};
+    for(;m*4 <= mSize;m *= 4)
+    {
+        FusedPass(buffer, mSize, m, twiddles, twiddles+m, inverse);
+        twiddles += m*2;
     }
 }
 
-void complex_hilbert(std::complex<double> *Buffer, int size)
+
+template<typename T>
+RealFftPlan<T>::RealFftPlan(size_t size) : mHalf{size/2}
 {
-    const double inverse_size = 1.0/static_cast<double>(size);
+    /* The quarter turn of exp(-i*2*pi*k/size) needed to split the half-size
+     * transform.
+     */
+    for(size_t k{0};k <= size/4;k++)
+    {
+        const double arg{2.0*Pi * static_cast<double>(k) / static_cast<double>(size)};
+        mTwiddles.emplace_back(static_cast<T>(std::cos(arg)), static_cast<T>(-std::sin(arg)));
+    }
+}
 
-    for(int i{0};i < size;i++)
-        Buffer[i].imag(0.0);
+template<typename T>
+RealFftPlan<T>::~RealFftPlan() = default;
 
-    complex_fft(Buffer, size, 1.0);
+template<typename T>
+void RealFftPlan<T>::forward(const T *in, std::complex<T> *out) const
+{
+    const size_t half{mHalf.size()};
 
-    int todo{size>>1};
-    int i{0};
+    /* Transform the even and odd samples as the real and imaginary parts of a
+     * complex signal.
+     */
+    T *packed{reinterpret_cast<T*>(out)};
+    if(in != packed)
+        std::copy_n(in, half*2, packed);
+    mHalf.forward(out);
 
-    Buffer[i++] *= inverse_size;
-    while(i < todo)
-        Buffer[i++] *= 2.0*inverse_size;
-    Buffer[i++] *= inverse_size;
+    /* Separate the spectra of the even (Fe) and odd (Fo) samples, which are
+     * then combined as Fe[k] + exp(-i*2*pi*k/size)*Fo[k].
+     */
+    const std::complex<T> z0{out[0]};
+    out[0] = std::complex<T>{z0.real() + z0.imag(), T{0}};
+    out[half] = std::complex<T>{z0.real() - z0.imag(), T{0}};
+    for(size_t k{1};k < half-k;k++)
+    {
+        const std::complex<T> a{out[k]}, b{out[half-k]};
+        const T fer{(a.real() + b.real()) * T{0.5}}, fei{(a.imag() - b.imag()) * T{0.5}};
+        const T for_{(a.imag() + b.imag()) * T{0.5}}, foi{(b.real() - a.real()) * T{0.5}};
+        const T wr{mTwiddles[k].real()}, wi{mTwiddles[k].imag()};
+        const T tr{for_*wr - foi*wi}, ti{for_*wi + foi*wr};
+        out[k] = std::complex<T>{fer + tr, fei + ti};
+        out[half-k] = std::complex<T>{fer - tr, ti - fei};
+    }
+    if(half > 1)
+        out[half/2] = std::conj(out[half/2]);
+}
 
-    for(;i < size;i++)
-        Buffer[i] = std::complex<double>{};
+template<typename T>
+void RealFftPlan<T>::inverse(const std::complex<T> *in, T *out) const
+{
+    const size_t half{mHalf.size()};
+
+    /* Recombine the spectra of the even and odd samples as Fe[k] + i*Fo[k],
+     * the transform of the interleaved complex signal (scaled by 2).
+     */
+    std::complex<T> *packed{reinterpret_cast<std::complex<T>*>(out)};
+    const T dc{in[0].real()}, nyq{in[half].real()};
+    for(size_t k{1};k < half-k;k++)
+    {
+        const std::complex<T> a{in[k]}, b{in[half-k]};
+        const T fer{a.real() + b.real()}, fei{a.imag() - b.imag()};
+        const T dr{a.real() - b.real()}, di{a.imag() + b.imag()};
+        const T wr{mTwiddles[k].real()}, wi{-mTwiddles[k].imag()};
+        const T for_{dr*wr - di*wi}, foi{dr*wi + di*wr};
+        packed[k] = std::complex<T>{fer - foi, fei + for_};
+        packed[half-k] = std::complex<T>{fer + foi, for_ - fei};
+    }
+    if(half > 1)
+        packed[half/2] = std::conj(in[half/2]) * T{2};
+    packed[0] = std::complex<T>{dc + nyq, dc - nyq};
+
+    mHalf.inverse(packed);
+}
 
-    complex_fft(Buffer, size, -1.0);
+template class ComplexFftPlan<float>;
+template class ComplexFftPlan<double>;
+template class RealFftPlan<float>;
+template class RealFftPlan<double>;
+
+
+namespace {
+
+/* Plans for each size up to FFTTableSize, created as needed. */
+template<typename PlanType>
+const PlanType &GetCachedPlan(size_t size)
+{
+    struct PlanCache {
+        std::once_flag mOnce[FFTTableBits+1];
+        std::unique_ptr<PlanType> mPlans[FFTTableBits+1];
+    };
+    static PlanCache cache;
+
+    size_t bits{0};
+    while((size_t{1}<<bits) < size)
+        ++bits;
+    std::call_once(cache.mOnce[bits],
+        [bits]() { cache.mPlans[bits].reset(new PlanType{size_t{1}<<bits}); });
+    return *cache.mPlans[bits];
+}
+
+} // namespace
+
+void complex_fft(std::complex<float> *FFTBuffer, int FFTSize, float Sign)
+{
+    const size_t size{static_cast<size_t>(FFTSize)};
+    if(size <= FFTTableSize)
+    {
+        const ComplexFftPlan<float> &plan = GetCachedPlan<ComplexFftPlan<float>>(size);
+        if(Sign < 0.0f) plan.forward(FFTBuffer);
+        else plan.inverse(FFTBuffer);
+    }
+    else
+    {
+        const ComplexFftPlan<float> plan{size};
+        if(Sign < 0.0f) plan.forward(FFTBuffer);
+        else plan.inverse(FFTBuffer);
+    }
 }
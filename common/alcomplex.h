@@ -2,23 +2,82 @@
 #define ALCOMPLEX_H
 
 #include <complex>
+#include <utility>
+#include <vector>
 
 /**
- * Iterative implementation of 2-radix FFT (In-place algorithm). Sign = -1 is
- * FFT and 1 is iFFT (inverse). Fills FFTBuffer[0...FFTSize-1] with the
- * Discrete Fourier Transform (DFT) of the time domain data stored in
- * FFTBuffer[0...FFTSize-1]. FFTBuffer is an array of complex numbers, FFTSize
- * MUST BE power of two.
+ * Precomputed plan for complex FFTs of one power-of-two size. Holds the bit-
+ * reversal swaps and the twiddle factors for each pass, so transforms don't
+ * need to calculate any sines or cosines. Passes combine two radix-2 stages
+ * at a time, and the float version uses SSE or NEON for the butterflies when
+ * available. A plan is immutable once created, so it may be shared between
+ * threads.
  */
-void complex_fft(std::complex<double> *FFTBuffer, int FFTSize, double Sign);
+template<typename T>
+class ComplexFftPlan {
+    size_t mSize;
+    bool mOddPass;
+    std::vector<std::pair<unsigned int,unsigned int>> mSwaps;
+    std::vector<std::complex<T>> mTwiddles;
+
+    void transform(std::complex<T> *buffer, bool inverse) const;
+
+public:
+    explicit ComplexFftPlan(size_t size);
+    ~ComplexFftPlan();
+
+    size_t size() const noexcept { return mSize; }
+
+    /* In-place forward (exp(-i...)) and inverse (exp(+i...)) transforms. The
+     * results are not scaled, so an inverse of a forward transform is scaled
+     * by the size.
+     */
+    void forward(std::complex<T> *buffer) const { transform(buffer, false); }
+    void inverse(std::complex<T> *buffer) const { transform(buffer, true); }
+};
+
+/**
+ * Precomputed plan for FFTs of real signals of one power-of-two size. The
+ * signal is transformed as a complex signal of half the size, which is then
+ * split into the size/2+1 bins of the real signal's spectrum (the remaining
+ * bins being the complex conjugates of these).
+ */
+template<typename T>
+class RealFftPlan {
+    ComplexFftPlan<T> mHalf;
+    std::vector<std::complex<T>> mTwiddles;
+
+public:
+    explicit RealFftPlan(size_t size);
+    ~RealFftPlan();
+
+    size_t size() const noexcept { return mHalf.size() * 2; }
+
+    /* Transforms size real samples into size/2+1 frequency bins. The output
+     * may occupy the same memory as the input (which then needs room for the
+     * extra bin).
+     */
+    void forward(const T *in, std::complex<T> *out) const;
+    /* Transforms size/2+1 frequency bins into size real samples, ignoring the
+     * imaginary part of the DC and Nyquist bins. The result is not scaled. The
+     * output may occupy the same memory as the input.
+     */
+    void inverse(const std::complex<T> *in, T *out) const;
+};
+
+extern template class ComplexFftPlan<float>;
+extern template class ComplexFftPlan<double>;
+extern template class RealFftPlan<float>;
+extern template class RealFftPlan<double>;
 
 /**
- * Calculate the complex helical sequence (discrete-time analytical signal) of
- * the given input using the discrete Hilbert transform (In-place algorithm).
- * Fills Buffer[0...size-1] with the discrete-time analytical signal stored in
- * Buffer[0...size-1]. Buffer is an array of complex numbers, size MUST BE
- * power of two.
+ * In-place complex FFT. Sign = -1 is FFT and 1 is iFFT (inverse). Fills
+ * FFTBuffer[0...FFTSize-1] with the Discrete Fourier Transform (DFT) of the
+ * time domain data stored in FFTBuffer[0...FFTSize-1]. FFTBuffer is an array
+ * of complex numbers, FFTSize MUST BE power of two. Plans for sizes up to
+ * 4096 are created on first use and kept. Larger sizes create a plan for each
+ * call, so anything doing those regularly should keep its own ComplexFftPlan.
  */
-void complex_hilbert(std::complex<double> *Buffer, int size);
+void complex_fft(std::complex<float> *FFTBuffer, int FFTSize, float Sign);
 
 #endif /* ALCOMPLEX_H */
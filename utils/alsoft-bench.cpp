@@ -0,0 +1,663 @@
+/*
+ * OpenAL Soft mixer benchmark
+ *
+ * Renders a scene on a loopback device as fast as possible, and reports the
+ * real-time factor and the time spent per voice-sample as JSON. The scene's
+ * voice count, buffer format, resampler, HRTF use, output layout, effect
+ * slots, and source movement are set from the command line, so results can
+ * be compared between builds.
+ *
+ * This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ *  License along with this library; if not, write to the
+ *  Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * Or go to http://www.gnu.org/copyleft/lgpl.html
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "AL/al.h"
+#include "AL/alc.h"
+#include "AL/alext.h"
+#include "AL/efx.h"
+
+#include "inprogext.h"
+
+
+namespace {
+
+constexpr double Pi{3.141592653589793238462643383279502884};
+
+struct FormatInfo {
+    const char *name;
+    ALenum format;
+    int channels;
+    int bytes;
+};
+constexpr FormatInfo BufferFormats[]{
+    { "mono8", AL_FORMAT_MONO8, 1, 1 },
+    { "mono16", AL_FORMAT_MONO16, 1, 2 },
+    { "monof32", AL_FORMAT_MONO_FLOAT32, 1, 4 },
+    { "stereo8", AL_FORMAT_STEREO8, 2, 1 },
+    { "stereo16", AL_FORMAT_STEREO16, 2, 2 },
+    { "stereof32", AL_FORMAT_STEREO_FLOAT32, 2, 4 },
+    { "bformat3d16", AL_FORMAT_BFORMAT3D_16, 4, 2 },
+};
+
+struct LayoutInfo {
+    const char *name;
+    ALCenum channels;
+    int count;
+};
+constexpr LayoutInfo OutputLayouts[]{
+    { "mono", ALC_MONO_SOFT, 1 },
+    { "stereo", ALC_STEREO_SOFT, 2 },
+    { "quad", ALC_QUAD_SOFT, 4 },
+    { "5.1", ALC_5POINT1_SOFT, 6 },
+    { "6.1", ALC_6POINT1_SOFT, 7 },
+    { "7.1", ALC_7POINT1_SOFT, 8 },
+};
+
+struct EffectInfo {
+    const char *name;
+    ALenum type;
+};
+constexpr EffectInfo EffectTypes[]{
+    { "reverb", AL_EFFECT_REVERB },
+    { "eaxreverb", AL_EFFECT_EAXREVERB },
+    { "chorus", AL_EFFECT_CHORUS },
+    { "flanger", AL_EFFECT_FLANGER },
+    { "echo", AL_EFFECT_ECHO },
+    { "distortion", AL_EFFECT_DISTORTION },
+    { "equalizer", AL_EFFECT_EQUALIZER },
+    { "compressor", AL_EFFECT_COMPRESSOR },
+    { "modulator", AL_EFFECT_RING_MODULATOR },
+    { "pshifter", AL_EFFECT_PITCH_SHIFTER },
+    { "autowah", AL_EFFECT_AUTOWAH },
+    { "convolution", AL_EFFECT_CONVOLUTION_REVERB_SOFT },
+};
+
+/* Names of the stages reported by ALC_MIX_STAGE_TIMES_*_SOFT. */
+constexpr const char *StageNames[]{
+    "params", "voices", "effects", "post_process", "stablizer", "limiter",
+    "distance_comp", "dither", "write", "total"
+};
+constexpr size_t StageCount{sizeof(StageNames)/sizeof(StageNames[0])};
+
+
+struct SceneOptions {
+    int voices{64};
+    const FormatInfo *format{&BufferFormats[1]};
+    std::string resampler;
+    bool hrtf{false};
+    const LayoutInfo *layout{&OutputLayouts[1]};
+    int slots{0};
+    const EffectInfo *effect{&EffectTypes[0]};
+    bool moving{false};
+    bool check_batch{false};
+    int rate{48000};
+    int buffer_rate{44100};
+    int update_size{1024};
+    double seconds{10.0};
+    int runs{3};
+};
+
+
+LPALCLOOPBACKOPENDEVICESOFT p_alcLoopbackOpenDeviceSOFT;
+LPALCRENDERSAMPLESSOFT p_alcRenderSamplesSOFT;
+LPALCGETINTEGER64VSOFT p_alcGetInteger64vSOFT;
+LPALGETSTRINGISOFT p_alGetStringiSOFT;
+LPALDEFERUPDATESSOFT p_alDeferUpdatesSOFT;
+LPALPROCESSUPDATESSOFT p_alProcessUpdatesSOFT;
+LPALGENEFFECTS p_alGenEffects;
+LPALDELETEEFFECTS p_alDeleteEffects;
+LPALEFFECTI p_alEffecti;
+LPALGENAUXILIARYEFFECTSLOTS p_alGenAuxiliaryEffectSlots;
+LPALDELETEAUXILIARYEFFECTSLOTS p_alDeleteAuxiliaryEffectSlots;
+LPALAUXILIARYEFFECTSLOTI p_alAuxiliaryEffectSloti;
+LPALSOURCESFVSOFT p_alSourcesfvSOFT;
+LPALSOURCESIVSOFT p_alSourcesivSOFT;
+
+template<typename T>
+void LoadProc(T &func, const char *name)
+{ func = reinterpret_cast<T>(alGetProcAddress(name)); }
+
+template<typename T>
+void LoadDeviceProc(T &func, const char *name)
+{ func = reinterpret_cast<T>(alcGetProcAddress(nullptr, name)); }
+
+
+template<typename T, size_t N>
+const T *FindByName(const T (&list)[N], const char *name)
+{
+    for(const T &entry : list)
+    {
+        if(strcmp(entry.name, name) == 0)
+            return &entry;
+    }
+    fprintf(stderr, "Unknown value '%s', expected one of:", name);
+    for(const T &entry : list)
+        fprintf(stderr, " %s", entry.name);
+    fputc('\n', stderr);
+    return nullptr;
+}
+
+void PrintUsage(const char *argv0)
+{
+    fprintf(stderr, "Usage: %s [options]\n"
+        "  --voices <n>          Number of playing sources (default 64)\n"
+        "  --format <name>       Buffer format: mono8, mono16, monof32, stereo8,\n"
+        "                        stereo16, stereof32, bformat3d16 (default mono16)\n"
+        "  --resampler <name>    Source resampler name (default the device's)\n"
+        "  --hrtf <on|off>       Request HRTF rendering (default off)\n"
+        "  --layout <name>       Output: mono, stereo, quad, 5.1, 6.1, 7.1\n"
+        "                        (default stereo)\n"
+        "  --slots <n>           Number of effect slots sources send to (default 0)\n"
+        "  --effect <name>       Slot effect: reverb, eaxreverb, chorus, flanger,\n"
+        "                        echo, distortion, equalizer, compressor, modulator,\n"
+        "                        pshifter, autowah, convolution (default reverb)\n"
+        "  --moving              Move the sources every update\n"
+        "  --check-batch         Check that a source batch with a bad value changes\n"
+        "                        nothing before rendering (needs 3+ voices)\n"
+        "  --rate <hz>           Output sample rate (default 48000)\n"
+        "  --buffer-rate <hz>    Buffer sample rate (default 44100)\n"
+        "  --update-size <n>     Samples rendered per call (default 1024)\n"
+        "  --seconds <s>         Seconds of audio rendered per run (default 10)\n"
+        "  --runs <n>            Number of timed runs (default 3)\n", argv0);
+}
+
+bool ParseArgs(int argc, char **argv, SceneOptions &opts)
+{
+    for(int i{1};i < argc;i++)
+    {
+        const char *arg{argv[i]};
+        if(strcmp(arg, "--moving") == 0)
+        {
+            opts.moving = true;
+            continue;
+        }
+        if(strcmp(arg, "--check-batch") == 0)
+        {
+            opts.check_batch = true;
+            continue;
+        }
+        if(strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0 || i+1 >= argc)
+            return false;
+
+        const char *value{argv[++i]};
+        if(strcmp(arg, "--voices") == 0)
+            opts.voices = atoi(value);
+        else if(strcmp(arg, "--format") == 0)
+            opts.format = FindByName(BufferFormats, value);
+        else if(strcmp(arg, "--resampler") == 0)
+            opts.resampler = value;
+        else if(strcmp(arg, "--hrtf") == 0)
+            opts.hrtf = (strcmp(value, "on") == 0 || strcmp(value, "1") == 0);
+        else if(strcmp(arg, "--layout") == 0)
+            opts.layout = FindByName(OutputLayouts, value);
+        else if(strcmp(arg, "--slots") == 0)
+            opts.slots = atoi(value);
+        else if(strcmp(arg, "--effect") == 0)
+            opts.effect = FindByName(EffectTypes, value);
+        else if(strcmp(arg, "--rate") == 0)
+            opts.rate = atoi(value);
+        else if(strcmp(arg, "--buffer-rate") == 0)
+            opts.buffer_rate = atoi(value);
+        else if(strcmp(arg, "--update-size") == 0)
+            opts.update_size = atoi(value);
+        else if(strcmp(arg, "--seconds") == 0)
+            opts.seconds = atof(value);
+        else if(strcmp(arg, "--runs") == 0)
+            opts.runs = atoi(value);
+        else
+        {
+            fprintf(stderr, "Unknown option: %s\n", arg);
+            return false;
+        }
+
+        if(!opts.format || !opts.layout || !opts.effect)
+            return false;
+    }
+    if(opts.voices < 1 || opts.slots < 0 || opts.rate < 1 || opts.buffer_rate < 1
+        || opts.update_size < 1 || !(opts.seconds > 0.0) || opts.runs < 1
+        || (opts.check_batch && opts.voices < 3))
+    {
+        fprintf(stderr, "Invalid scene parameters\n");
+        return false;
+    }
+    return true;
+}
+
+
+/* Makes a second of a detuned saw wave with some noise, different for each
+ * channel, in the requested sample type.
+ */
+std::vector<char> MakeBufferData(const FormatInfo &fmt, int rate)
+{
+    std::vector<char> data(static_cast<size_t>(rate) * fmt.channels * fmt.bytes);
+    std::mt19937 rng{22050u};
+    std::uniform_real_distribution<float> noise{-0.05f, 0.05f};
+
+    for(int i{0};i < rate;i++)
+    {
+        for(int c{0};c < fmt.channels;c++)
+        {
+            const double freq{110.0 * (c+1) + 0.5*c};
+            const double phase{std::fmod(freq * i / rate, 1.0)};
+            const float value{static_cast<float>(phase*0.8 - 0.4) + noise(rng)};
+
+            const size_t idx{static_cast<size_t>(i)*fmt.channels + c};
+            if(fmt.bytes == 1)
+                data[idx] = static_cast<char>(static_cast<unsigned char>(
+                    std::lround(value*127.0f) + 128));
+            else if(fmt.bytes == 2)
+            {
+                const short sval{static_cast<short>(std::lround(value*32767.0f))};
+                memcpy(&data[idx*2], &sval, sizeof(sval));
+            }
+            else
+                memcpy(&data[idx*4], &value, sizeof(value));
+        }
+    }
+    return data;
+}
+
+/* Makes a second and a half of exponentially decaying noise, long enough to
+ * use the convolution effect's background tail.
+ */
+std::vector<float> MakeImpulseResponse(int rate)
+{
+    std::vector<float> data(static_cast<size_t>(rate) * 3 / 2);
+    std::mt19937 rng{44100u};
+    std::uniform_real_distribution<float> noise{-0.1f, 0.1f};
+
+    for(size_t i{0};i < data.size();i++)
+        data[i] = noise(rng) * static_cast<float>(std::exp(-4.0 * i / rate));
+    return data;
+}
+
+void PlaceSources(const std::vector<ALuint> &sources, double time)
+{
+    const size_t count{sources.size()};
+    for(size_t i{0};i < count;i++)
+    {
+        const double angle{2.0*Pi*i/count + time*(0.5 + 0.25*(i%4))};
+        const float dist{2.0f + static_cast<float>(i%8)};
+        alSource3f(sources[i], AL_POSITION, static_cast<float>(std::sin(angle))*dist,
+            0.5f - static_cast<float>(i%3)*0.5f, -static_cast<float>(std::cos(angle))*dist);
+    }
+}
+
+
+/* Sets source batches that each end with an invalid value, and checks that
+ * they fail without changing any of the sources, then that a valid batch is
+ * applied.
+ */
+bool CheckSourceBatch(const std::vector<ALuint> &sources)
+{
+    if(!p_alSourcesfvSOFT || !p_alSourcesivSOFT)
+    {
+        fprintf(stderr, "AL_SOFT_source_batch not available\n");
+        return false;
+    }
+
+    const ALuint ids[3]{sources[0], sources[1], sources[2]};
+    ALfloat gains[3], pitch;
+    for(int i{0};i < 3;i++)
+        alGetSourcef(ids[i], AL_GAIN, &gains[i]);
+    alGetSourcef(ids[0], AL_PITCH, &pitch);
+    ALint looping;
+    alGetSourcei(ids[1], AL_LOOPING, &looping);
+
+    auto unchanged = [&ids,&gains,pitch,looping]() -> bool
+    {
+        for(int i{0};i < 3;i++)
+        {
+            ALfloat gain;
+            alGetSourcef(ids[i], AL_GAIN, &gain);
+            if(gain != gains[i]) return false;
+        }
+        ALfloat newpitch;
+        alGetSourcef(ids[0], AL_PITCH, &newpitch);
+        ALint newlooping;
+        alGetSourcei(ids[1], AL_LOOPING, &newlooping);
+        return newpitch == pitch && newlooping == looping;
+    };
+
+    alGetError();
+    const ALenum fparams[4]{AL_GAIN, AL_GAIN, AL_PITCH, AL_GAIN};
+    const ALuint fsources[4]{ids[0], ids[1], ids[0], ids[2]};
+    const ALfloat fvalues[4]{0.5f, 0.25f, 2.0f, -1.0f};
+    p_alSourcesfvSOFT(4, fsources, fparams, fvalues);
+    if(alGetError() != AL_INVALID_VALUE || !unchanged())
+    {
+        fprintf(stderr, "Float source batch with a bad value was not rejected whole\n");
+        return false;
+    }
+
+    /* A playing source can't have its buffer set. */
+    const ALenum iparams[3]{AL_LOOPING, AL_SOURCE_RELATIVE, AL_BUFFER};
+    const ALuint isources[3]{ids[1], ids[0], ids[2]};
+    const ALint ivalues[3]{AL_FALSE, AL_TRUE, 0};
+    p_alSourcesivSOFT(3, isources, iparams, ivalues);
+    if(alGetError() != AL_INVALID_OPERATION || !unchanged())
+    {
+        fprintf(stderr, "Integer source batch with a bad value was not rejected whole\n");
+        return false;
+    }
+
+    p_alSourcesfvSOFT(3, fsources, fparams, fvalues);
+    ALfloat gain0, gain1;
+    alGetSourcef(ids[0], AL_GAIN, &gain0);
+    alGetSourcef(ids[1], AL_GAIN, &gain1);
+    if(alGetError() != AL_NO_ERROR || gain0 != 0.5f || gain1 != 0.25f)
+    {
+        fprintf(stderr, "Valid source batch was not applied\n");
+        return false;
+    }
+    const ALenum gainparams[3]{AL_GAIN, AL_GAIN, AL_GAIN};
+    p_alSourcesfvSOFT(3, ids, gainparams, gains);
+    alSourcef(ids[0], AL_PITCH, pitch);
+    return alGetError() == AL_NO_ERROR;
+}
+
+int RunBench(const SceneOptions &opts)
+{
+    LoadDeviceProc(p_alcLoopbackOpenDeviceSOFT, "alcLoopbackOpenDeviceSOFT");
+    LoadDeviceProc(p_alcRenderSamplesSOFT, "alcRenderSamplesSOFT");
+    LoadDeviceProc(p_alcGetInteger64vSOFT, "alcGetInteger64vSOFT");
+    if(!p_alcLoopbackOpenDeviceSOFT || !p_alcRenderSamplesSOFT)
+    {
+        fprintf(stderr, "ALC_SOFT_loopback not available\n");
+        return 1;
+    }
+
+    ALCdevice *device{p_alcLoopbackOpenDeviceSOFT(nullptr)};
+    if(!device)
+    {
+        fprintf(stderr, "Failed to open loopback device\n");
+        return 1;
+    }
+
+    const ALCint attrs[]{
+        ALC_FORMAT_CHANNELS_SOFT, opts.layout->channels,
+        ALC_FORMAT_TYPE_SOFT, ALC_FLOAT_SOFT,
+        ALC_FREQUENCY, opts.rate,
+        ALC_HRTF_SOFT, opts.hrtf ? ALC_TRUE : ALC_FALSE,
+        ALC_MONO_SOURCES, opts.voices,
+        ALC_STEREO_SOURCES, opts.voices,
+        ALC_MAX_AUXILIARY_SENDS, (opts.slots > 0) ? 1 : 0,
+        0
+    };
+    ALCcontext *context{alcCreateContext(device, attrs)};
+    if(!context || alcMakeContextCurrent(context) == ALC_FALSE)
+    {
+        fprintf(stderr, "Failed to create context for the scene\n");
+        if(context)
+            alcDestroyContext(context);
+        alcCloseDevice(device);
+        return 1;
+    }
+
+    ALCint hrtf_status{ALC_FALSE};
+    alcGetIntegerv(device, ALC_HRTF_SOFT, 1, &hrtf_status);
+    const bool have_stats{alcIsExtensionPresent(device, "ALC_SOFTX_mixer_stats") != ALC_FALSE
+        && p_alcGetInteger64vSOFT != nullptr};
+
+    LoadProc(p_alGetStringiSOFT, "alGetStringiSOFT");
+    LoadProc(p_alDeferUpdatesSOFT, "alDeferUpdatesSOFT");
+    LoadProc(p_alProcessUpdatesSOFT, "alProcessUpdatesSOFT");
+    LoadProc(p_alGenEffects, "alGenEffects");
+    LoadProc(p_alDeleteEffects, "alDeleteEffects");
+    LoadProc(p_alEffecti, "alEffecti");
+    LoadProc(p_alGenAuxiliaryEffectSlots, "alGenAuxiliaryEffectSlots");
+    LoadProc(p_alDeleteAuxiliaryEffectSlots, "alDeleteAuxiliaryEffectSlots");
+    LoadProc(p_alAuxiliaryEffectSloti, "alAuxiliaryEffectSloti");
+    LoadProc(p_alSourcesfvSOFT, "alSourcesfvSOFT");
+    LoadProc(p_alSourcesivSOFT, "alSourcesivSOFT");
+
+    int retval{1};
+    ALuint buffer{0}, effect{0}, irbuffer{0};
+    std::vector<ALuint> slots;
+    std::vector<ALuint> sources;
+    std::vector<float> output;
+    std::vector<double> run_times;
+    ALint resampler{-1};
+    std::string resampler_name;
+    ALint64SOFT stage_avg[StageCount]{};
+    ALint64SOFT dsp_load[3]{};
+
+    const std::vector<char> data{MakeBufferData(*opts.format, opts.buffer_rate)};
+    alGenBuffers(1, &buffer);
+    alBufferData(buffer, opts.format->format, data.data(), static_cast<ALsizei>(data.size()),
+        opts.buffer_rate);
+    if(alGetError() != AL_NO_ERROR)
+    {
+        fprintf(stderr, "Failed to load %s buffer\n", opts.format->name);
+        goto done;
+    }
+
+    if(p_alGetStringiSOFT)
+    {
+        if(opts.resampler.empty())
+            resampler = alGetInteger(AL_DEFAULT_RESAMPLER_SOFT);
+        else
+        {
+            const ALint num_resamplers{alGetInteger(AL_NUM_RESAMPLERS_SOFT)};
+            for(ALint i{0};i < num_resamplers;i++)
+            {
+                if(opts.resampler == p_alGetStringiSOFT(AL_RESAMPLER_NAME_SOFT, i))
+                    resampler = i;
+            }
+            if(resampler < 0)
+            {
+                fprintf(stderr, "Unknown resampler '%s', expected one of:\n",
+                    opts.resampler.c_str());
+                for(ALint i{0};i < num_resamplers;i++)
+                    fprintf(stderr, "  %s\n", p_alGetStringiSOFT(AL_RESAMPLER_NAME_SOFT, i));
+                goto done;
+            }
+        }
+        resampler_name = p_alGetStringiSOFT(AL_RESAMPLER_NAME_SOFT, resampler);
+    }
+    else if(!opts.resampler.empty())
+    {
+        fprintf(stderr, "AL_SOFT_source_resampler not available\n");
+        goto done;
+    }
+
+    if(opts.slots > 0)
+    {
+        if(!p_alGenEffects || !p_alGenAuxiliaryEffectSlots)
+        {
+            fprintf(stderr, "ALC_EXT_EFX not available\n");
+            goto done;
+        }
+        p_alGenEffects(1, &effect);
+        p_alEffecti(effect, AL_EFFECT_TYPE, opts.effect->type);
+
+        slots.resize(static_cast<size_t>(opts.slots));
+        p_alGenAuxiliaryEffectSlots(opts.slots, slots.data());
+        for(ALuint slot : slots)
+            p_alAuxiliaryEffectSloti(slot, AL_EFFECTSLOT_EFFECT, static_cast<ALint>(effect));
+        if(opts.effect->type == AL_EFFECT_CONVOLUTION_REVERB_SOFT)
+        {
+            const std::vector<float> ir{MakeImpulseResponse(opts.rate)};
+            alGenBuffers(1, &irbuffer);
+            alBufferData(irbuffer, AL_FORMAT_MONO_FLOAT32, ir.data(),
+                static_cast<ALsizei>(ir.size()*sizeof(float)), opts.rate);
+            for(ALuint slot : slots)
+                p_alAuxiliaryEffectSloti(slot, AL_BUFFER, static_cast<ALint>(irbuffer));
+        }
+        if(alGetError() != AL_NO_ERROR)
+        {
+            fprintf(stderr, "Failed to set up %d %s effect slot(s)\n", opts.slots,
+                opts.effect->name);
+            goto done;
+        }
+    }
+
+    sources.resize(static_cast<size_t>(opts.voices));
+    alGenSources(opts.voices, sources.data());
+    if(alGetError() != AL_NO_ERROR)
+    {
+        fprintf(stderr, "Failed to create %d sources\n", opts.voices);
+        goto done;
+    }
+    for(size_t i{0};i < sources.size();i++)
+    {
+        alSourcei(sources[i], AL_BUFFER, static_cast<ALint>(buffer));
+        alSourcei(sources[i], AL_LOOPING, AL_TRUE);
+        alSourcef(sources[i], AL_GAIN, 1.0f / static_cast<float>(opts.voices));
+        if(resampler >= 0)
+            alSourcei(sources[i], AL_SOURCE_RESAMPLER_SOFT, resampler);
+        if(!slots.empty())
+            alSource3i(sources[i], AL_AUXILIARY_SEND_FILTER,
+                static_cast<ALint>(slots[i%slots.size()]), 0, AL_FILTER_NULL);
+        /* Spread the play positions so the voices don't all line up. */
+        alSourcei(sources[i], AL_SAMPLE_OFFSET,
+            static_cast<ALint>(i*7919 % static_cast<size_t>(opts.buffer_rate)));
+    }
+    PlaceSources(sources, 0.0);
+    alSourcePlayv(opts.voices, sources.data());
+    if(alGetError() != AL_NO_ERROR)
+    {
+        fprintf(stderr, "Failed to set up the sources\n");
+        goto done;
+    }
+    if(opts.check_batch && !CheckSourceBatch(sources))
+        goto done;
+
+    {
+        const ALCsizei update_size{opts.update_size};
+        const size_t total_frames{static_cast<size_t>(opts.seconds * opts.rate)};
+        output.resize(static_cast<size_t>(update_size) * opts.layout->count);
+
+        /* Warm up, so the first run isn't paying for first-touch allocations. */
+        p_alcRenderSamplesSOFT(device, output.data(), update_size);
+
+        double audio_time{0.0};
+        for(int run{0};run < opts.runs;run++)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            for(size_t done{0};done < total_frames;)
+            {
+                if(opts.moving)
+                {
+                    if(p_alDeferUpdatesSOFT) p_alDeferUpdatesSOFT();
+                    PlaceSources(sources, audio_time);
+                    if(p_alProcessUpdatesSOFT) p_alProcessUpdatesSOFT();
+                }
+
+                const ALCsizei todo{static_cast<ALCsizei>(
+                    std::min<size_t>(static_cast<size_t>(update_size), total_frames-done))};
+                p_alcRenderSamplesSOFT(device, output.data(), todo);
+                done += static_cast<size_t>(todo);
+                audio_time += static_cast<double>(todo) / opts.rate;
+            }
+            const std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+            run_times.push_back(elapsed.count());
+        }
+
+        if(have_stats)
+        {
+            p_alcGetInteger64vSOFT(device, ALC_MIX_STAGE_TIMES_AVERAGE_SOFT,
+                static_cast<ALsizei>(StageCount), stage_avg);
+            p_alcGetInteger64vSOFT(device, ALC_MIX_DSP_LOAD_SOFT, 3, dsp_load);
+        }
+
+        std::vector<double> sorted{run_times};
+        std::sort(sorted.begin(), sorted.end());
+        const double best{sorted.front()};
+        const double median{sorted[sorted.size()/2]};
+        const double frames{static_cast<double>(total_frames)};
+        const double voice_samples{frames * opts.voices};
+
+        printf("{\n");
+        printf("  \"scene\": {\n");
+        printf("    \"voices\": %d,\n", opts.voices);
+        printf("    \"format\": \"%s\",\n", opts.format->name);
+        printf("    \"buffer_rate\": %d,\n", opts.buffer_rate);
+        printf("    \"resampler\": \"%s\",\n", resampler_name.c_str());
+        printf("    \"hrtf_requested\": %s,\n", opts.hrtf ? "true" : "false");
+        printf("    \"hrtf\": %s,\n", hrtf_status ? "true" : "false");
+        printf("    \"layout\": \"%s\",\n", opts.layout->name);
+        printf("    \"rate\": %d,\n", opts.rate);
+        printf("    \"update_size\": %d,\n", opts.update_size);
+        printf("    \"slots\": %d,\n", opts.slots);
+        printf("    \"effect\": \"%s\",\n", (opts.slots > 0) ? opts.effect->name : "none");
+        printf("    \"moving\": %s\n", opts.moving ? "true" : "false");
+        printf("  },\n");
+        printf("  \"frames_per_run\": %zu,\n", total_frames);
+        printf("  \"run_seconds\": [");
+        for(size_t i{0};i < run_times.size();i++)
+            printf("%s%.6f", i ? ", " : "", run_times[i]);
+        printf("],\n");
+        printf("  \"realtime_factor\": %.3f,\n", frames / opts.rate / best);
+        printf("  \"realtime_factor_median\": %.3f,\n", frames / opts.rate / median);
+        printf("  \"ns_per_voice_sample\": %.3f,\n", best*1e9 / voice_samples);
+        printf("  \"ns_per_voice_sample_median\": %.3f", median*1e9 / voice_samples);
+        if(have_stats)
+        {
+            printf(",\n  \"stage_ns_average\": {");
+            for(size_t i{0};i < StageCount;i++)
+                printf("%s\"%s\": %lld", i ? ", " : "", StageNames[i],
+                    static_cast<long long>(stage_avg[i]));
+            printf("},\n");
+            printf("  \"dsp_load_average_percent\": %.2f", static_cast<double>(dsp_load[1])/100.0);
+        }
+        printf("\n}\n");
+        retval = 0;
+    }
+
+done:
+    if(!sources.empty())
+    {
+        alSourceStopv(static_cast<ALsizei>(sources.size()), sources.data());
+        alDeleteSources(static_cast<ALsizei>(sources.size()), sources.data());
+    }
+    if(!slots.empty())
+        p_alDeleteAuxiliaryEffectSlots(static_cast<ALsizei>(slots.size()), slots.data());
+    if(effect)
+        p_alDeleteEffects(1, &effect);
+    if(irbuffer)
+        alDeleteBuffers(1, &irbuffer);
+    alDeleteBuffers(1, &buffer);
+
+    alcMakeContextCurrent(nullptr);
+    alcDestroyContext(context);
+    alcCloseDevice(device);
+    return retval;
+}
+
+} // namespace
+
+
+int main(int argc, char *argv[])
+{
+    SceneOptions opts;
+    if(!ParseArgs(argc, argv, opts))
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    return RunBench(opts);
+}
@@ -0,0 +1,160 @@
+/*
+ * FFT benchmark
+ *
+ * Times the precomputed-plan FFTs against the original double-precision
+ * radix-2 routine they replace, for the transform sizes the effects and
+ * mixers use, and checks they produce the same results.
+ *
+ * This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ *  License along with this library; if not, write to the
+ *  Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * Or go to http://www.gnu.org/copyleft/lgpl.html
+ */
+
+#include "config.h"
+
+#include <cmath>
+#include <cstdio>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <complex>
+#include <algorithm>
+
+#include "alcomplex.h"
+
+
+namespace {
+
+using complex_d = std::complex<double>;
+using complex_f = std::complex<float>;
+
+constexpr double Pi{3.141592653589793238462643383279502884};
+
+/* The original complex_fft, which recalculates its twiddle factors by
+ * recurrence on each call.
+ */
+void reference_fft(complex_d *FFTBuffer, int FFTSize, double Sign)
+{
+    for(int i{1};i < FFTSize-1;i++)
+    {
+        int j{0};
+        for(int mask{1};mask < FFTSize;mask <<= 1)
+        {
+            if((i&mask) != 0)
+                j++;
+            j <<= 1;
+        }
+        j >>= 1;
+
+        if(i < j)
+            std::swap(FFTBuffer[i], FFTBuffer[j]);
+    }
+
+    int step{2};
+    for(int i{1};i < FFTSize;i<<=1, step<<=1)
+    {
+        int step2{step >> 1};
+        double arg{Pi / step2};
+
+        complex_d w{std::cos(arg), std::sin(arg)*Sign};
+        complex_d u{1.0, 0.0};
+        for(int j{0};j < step2;j++)
+        {
+            for(int k{j};k < FFTSize;k+=step)
+            {
+                complex_d temp{FFTBuffer[k+step2] * u};
+                FFTBuffer[k+step2] = FFTBuffer[k] - temp;
+                FFTBuffer[k] += temp;
+            }
+
+            u *= w;
+        }
+    }
+}
+
+/* Runs the function until at least 100ms have passed, and returns the average
+ * time per call in nanoseconds.
+ */
+template<typename F>
+double TimeIt(F func)
+{
+    using clock = std::chrono::steady_clock;
+
+    func();
+    size_t count{0};
+    const auto start = clock::now();
+    auto now = start;
+    do {
+        for(int i{0};i < 16;i++)
+            func();
+        count += 16;
+        now = clock::now();
+    } while(now-start < std::chrono::milliseconds{100});
+
+    return std::chrono::duration<double,std::nano>(now-start).count() / static_cast<double>(count);
+}
+
+} // namespace
+
+
+int main()
+{
+    std::mt19937 rng{12345};
+    std::uniform_real_distribution<float> dist{-1.0f, 1.0f};
+
+    printf("%6s %12s %12s %12s %10s %10s %10s\n", "size", "ref ns", "cplx ns", "real ns",
+        "cplx x", "real x", "err dB");
+    for(size_t size{64};size <= 8192;size <<= 1)
+    {
+        std::vector<float> signal(size);
+        std::generate(signal.begin(), signal.end(), [&rng,&dist]() { return dist(rng); });
+
+        std::vector<complex_d> refbuf(size);
+        const double reftime{TimeIt([&signal,&refbuf,size]()
+        {
+            std::transform(signal.begin(), signal.end(), refbuf.begin(),
+                [](float s) { return complex_d{s, 0.0}; });
+            reference_fft(refbuf.data(), static_cast<int>(size), -1.0);
+        })};
+
+        const ComplexFftPlan<float> cplan{size};
+        std::vector<complex_f> cbuf(size);
+        const double ctime{TimeIt([&signal,&cbuf,&cplan]()
+        {
+            std::transform(signal.begin(), signal.end(), cbuf.begin(),
+                [](float s) { return complex_f{s, 0.0f}; });
+            cplan.forward(cbuf.data());
+        })};
+
+        const RealFftPlan<float> rplan{size};
+        std::vector<complex_f> rbuf(size/2 + 1);
+        const double rtime{TimeIt([&signal,&rbuf,&rplan]()
+        { rplan.forward(signal.data(), rbuf.data()); })};
+
+        /* Compare both against the reference's (positive frequency) bins. */
+        double err{0.0}, pow{0.0};
+        for(size_t i{0};i <= size/2;i++)
+        {
+            err += std::norm(complex_d{cbuf[i]} - refbuf[i]);
+            err += std::norm(complex_d{rbuf[i]} - refbuf[i]);
+            pow += std::norm(refbuf[i]) * 2.0;
+        }
+
+        printf("%6zu %12.1f %12.1f %12.1f %10.2f %10.2f %10.1f\n", size, reftime, ctime, rtime,
+            reftime/ctime, reftime/rtime, 10.0*std::log10(err/pow));
+    }
+
+    return 0;
+}
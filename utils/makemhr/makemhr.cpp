@@ -89,9 +89,12 @@
 #include <numeric>
 #include <algorithm>
 #include <functional>
+#include <memory>
+#include <mutex>
 
 #include "mysofa.h"
 
+#include "alcomplex.h"
 #include "makemhr.h"
 #include "loaddef.h"
 #include "loadsofa.h"
@@ -238,66 +241,36 @@ static void TpdfDither(double *RESTRICT out, const double *RESTRICT in, const do
 }
 
 /* Fast Fourier transform routines. The number of points must be a power of
- * two.
+ * two. The transform plans are kept for reuse, since only a few sizes are
+ * used.
  */
 
-// Performs bit-reversal ordering.
-static void FftArrange(const uint n, complex_d *inout)
+// Gets the (shared) transform plan for the given number of points.
+static const ComplexFftPlan<double> &GetFftPlan(const uint n)
 {
-    // Handle in-place arrangement.
-    uint rk{0u};
-    for(uint k{0u};k < n;k++)
-    {
-        if(rk > k)
-            std::swap(inout[rk], inout[k]);
-
-        uint m{n};
-        while(rk&(m >>= 1))
-            rk &= ~m;
-        rk |= m;
-    }
-}
-
-// Performs the summation.
-static void FftSummation(const int n, const double s, complex_d *cplx)
-{
-    double pi;
-    int m, m2;
-    int i, k, mk;
+    static std::mutex planLock;
+    static std::vector<std::unique_ptr<ComplexFftPlan<double>>> plans;
 
-    pi = s * M_PI;
-    for(m = 1, m2 = 2;m < n; m <<= 1, m2 <<= 1)
+    std::lock_guard<std::mutex> _{planLock};
+    for(auto &plan : plans)
     {
-        // v = Complex (-2.0 * sin (0.5 * pi / m) * sin (0.5 * pi / m), -sin (pi / m))
-        double sm = sin(0.5 * pi / m);
-        auto v = complex_d{-2.0*sm*sm, -sin(pi / m)};
-        auto w = complex_d{1.0, 0.0};
-        for(i = 0;i < m;i++)
-        {
-            for(k = i;k < n;k += m2)
-            {
-                mk = k + m;
-                auto t = w * cplx[mk];
-                cplx[mk] = cplx[k] - t;
-                cplx[k] = cplx[k] + t;
-            }
-            w += v*w;
-        }
+        if(plan->size() == n)
+            return *plan;
     }
+    plans.emplace_back(new ComplexFftPlan<double>{n});
+    return *plans.back();
 }
 
 // Performs a forward FFT.
 void FftForward(const uint n, complex_d *inout)
 {
-    FftArrange(n, inout);
-    FftSummation(n, 1.0, inout);
+    GetFftPlan(n).forward(inout);
 }
 
 // Performs an inverse FFT.
 void FftInverse(const uint n, complex_d *inout)
 {
-    FftArrange(n, inout);
-    FftSummation(n, -1.0, inout);
+    GetFftPlan(n).inverse(inout);
     double f{1.0 / n};
     for(uint i{0};i < n;i++)
         inout[i] *= f;
@@ -0,0 +1,1060 @@
+/*
+ * Mixer kernel benchmark
+ *
+ * Times each CPU-specific version of the resamplers, mixers, HRTF mixers,
+ * filters, and sample loaders over a range of block sizes and buffer offsets,
+ * and checks each one produces the same results as the plain C reference.
+ * An optional argument only runs the kernels whose name contains it.
+ *
+ * This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ *  License along with this library; if not, write to the
+ *  Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * Or go to http://www.gnu.org/copyleft/lgpl.html
+ */
+
+#include "config.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <algorithm>
+
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#define HAVE_CYCLE_COUNTER
+#elif defined(_M_IX86) || defined(_M_X64)
+#include <intrin.h>
+#define HAVE_CYCLE_COUNTER
+#endif
+
+#include "alMain.h"
+#include "alu.h"
+#include "alBuffer.h"
+#include "sample_cvt.h"
+#include "logging.h"
+#include "cpu_caps.h"
+#include "hrtf.h"
+#include "mastering.h"
+#include "uhjfilter.h"
+#include "vector.h"
+#include "filters/biquad.h"
+#include "filters/splitter.h"
+#include "filters/nfc.h"
+#include "mixer/defs.h"
+
+
+/* Globals the library code refers to, normally defined in alc.cpp. */
+FILE *gLogFile{stderr};
+LogLevel gLogLevel{LogWarning};
+ALint RTPrioLevel{1};
+
+namespace {
+
+/* The block sizes each kernel is run with. These go up to BUFFERSIZE, less
+ * the largest offset, and include sizes that don't fill a SIMD vector.
+ */
+constexpr int BlockSizes[]{1, 13, 64, 255, BUFFERSIZE-4};
+/* Sample offsets for buffers a kernel can take at any alignment, and for the
+ * mixer output positions, which must keep 16-byte alignment.
+ */
+constexpr int Offsets[]{0, 1};
+constexpr int AlignedOffsets[]{0, 4};
+
+const char *KernelFilter{nullptr};
+int NumFailures{0};
+
+std::mt19937 Rng{12345};
+
+bool HaveCaps(int caps)
+{ return (CPUCapFlags&caps) == caps; }
+
+bool WantKernel(const char *name)
+{ return !KernelFilter || strstr(name, KernelFilter) != nullptr; }
+
+void FillNoise(float *dst, size_t count, float scale=1.0f)
+{
+    std::uniform_real_distribution<float> dist{-scale, scale};
+    std::generate_n(dst, count, [&dist]() { return dist(Rng); });
+}
+
+/* Largest difference between the test and reference output, relative to the
+ * reference's peak (or absolute, for quieter signals).
+ */
+float MaxError(const float *test, const float *ref, size_t count)
+{
+    float diff{0.0f}, peak{1.0f};
+    for(size_t i{0};i < count;++i)
+    {
+        diff = std::max(diff, std::fabs(test[i] - ref[i]));
+        peak = std::max(peak, std::fabs(ref[i]));
+        if(std::isnan(test[i]) != std::isnan(ref[i]))
+            return INFINITY;
+    }
+    return diff / peak;
+}
+
+
+uint64_t ReadCycles()
+{
+#ifdef HAVE_CYCLE_COUNTER
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+struct Timing {
+    double ns;
+    double cycles;
+};
+
+/* Runs the function until at least 5ms have passed, and returns the average
+ * time per call in nanoseconds and (time stamp counter) cycles.
+ */
+template<typename F>
+Timing TimeIt(F func)
+{
+    using clock = std::chrono::steady_clock;
+
+    func();
+    size_t count{0};
+    const auto start = clock::now();
+    const uint64_t startcycles{ReadCycles()};
+    auto now = start;
+    do {
+        for(int i{0};i < 8;i++)
+            func();
+        count += 8;
+        now = clock::now();
+    } while(now-start < std::chrono::milliseconds{5});
+    const uint64_t endcycles{ReadCycles()};
+
+    const double calls{static_cast<double>(count)};
+    return Timing{std::chrono::duration<double,std::nano>(now-start).count() / calls,
+        static_cast<double>(endcycles-startcycles) / calls};
+}
+
+/* Prints a result row. A negative tolerance marks the reference version,
+ * which isn't checked.
+ */
+void Report(const char *kernel, const char *variant, int block, int offset, const Timing &time,
+    double samples, float error, float tolerance)
+{
+    char check[32];
+    if(tolerance < 0.0f)
+        snprintf(check, sizeof(check), "ref");
+    else if(error <= tolerance)
+        snprintf(check, sizeof(check), "ok %.1e", error);
+    else
+    {
+        snprintf(check, sizeof(check), "FAIL %.1e", error);
+        ++NumFailures;
+    }
+
+#ifdef HAVE_CYCLE_COUNTER
+    printf("%-20s %-7s %6d %6d %10.3f %10.3f  %s\n", kernel, variant, block, offset,
+        time.cycles/samples, time.ns/samples, check);
+#else
+    printf("%-20s %-7s %6d %6d %10s %10.3f  %s\n", kernel, variant, block, offset, "-",
+        time.ns/samples, check);
+#endif
+}
+
+
+struct ResamplerInfo {
+    const char *kernel;
+    const char *variant;
+    int caps;
+    ResamplerFunc func;
+    ResamplerFunc ref;
+    const BSincTable *table;
+};
+const ResamplerInfo Resamplers[]{
+    { "Resample point", "C", 0, Resample_<PointTag,CTag>, Resample_<PointTag,CTag>, nullptr },
+    { "Resample lerp", "C", 0, Resample_<LerpTag,CTag>, Resample_<LerpTag,CTag>, nullptr },
+#ifdef HAVE_SSE2
+    { "Resample lerp", "SSE2", CPU_CAP_SSE2, Resample_<LerpTag,SSE2Tag>, Resample_<LerpTag,CTag>, nullptr },
+#endif
+#ifdef HAVE_SSE4_1
+    { "Resample lerp", "SSE4.1", CPU_CAP_SSE4_1, Resample_<LerpTag,SSE4Tag>, Resample_<LerpTag,CTag>, nullptr },
+#endif
+#ifdef HAVE_NEON
+    { "Resample lerp", "Neon", CPU_CAP_NEON, Resample_<LerpTag,NEONTag>, Resample_<LerpTag,CTag>, nullptr },
+#endif
+    { "Resample cubic", "C", 0, Resample_<CubicTag,CTag>, Resample_<CubicTag,CTag>, nullptr },
+    { "Resample bsinc12", "C", 0, Resample_<BSincTag,CTag>, Resample_<BSincTag,CTag>, &bsinc12 },
+#ifdef HAVE_SSE
+    { "Resample bsinc12", "SSE", CPU_CAP_SSE, Resample_<BSincTag,SSETag>, Resample_<BSincTag,CTag>, &bsinc12 },
+#endif
+#ifdef HAVE_NEON
+    { "Resample bsinc12", "Neon", CPU_CAP_NEON, Resample_<BSincTag,NEONTag>, Resample_<BSincTag,CTag>, &bsinc12 },
+#endif
+    { "Resample bsinc24", "C", 0, Resample_<BSincTag,CTag>, Resample_<BSincTag,CTag>, &bsinc24 },
+#ifdef HAVE_SSE
+    { "Resample bsinc24", "SSE", CPU_CAP_SSE, Resample_<BSincTag,SSETag>, Resample_<BSincTag,CTag>, &bsinc24 },
+#endif
+#ifdef HAVE_NEON
+    { "Resample bsinc24", "Neon", CPU_CAP_NEON, Resample_<BSincTag,NEONTag>, Resample_<BSincTag,CTag>, &bsinc24 },
+#endif
+};
+
+void BenchResamplers()
+{
+    /* Resampling from 44.1khz to 48khz. */
+    constexpr ALint increment{FRACTIONONE*44100/48000};
+    constexpr ALsizei frac{1234};
+
+    al::vector<float,16> srcbuf(BUFFERSIZE*2 + MAX_RESAMPLE_PADDING*2);
+    FillNoise(srcbuf.data(), srcbuf.size());
+    al::vector<float,16> dst(BUFFERSIZE), refdst(BUFFERSIZE);
+
+    for(const ResamplerInfo &info : Resamplers)
+    {
+        if(!WantKernel(info.kernel) || !HaveCaps(info.caps))
+            continue;
+
+        InterpState state{};
+        if(info.table)
+            BsincPrepare(increment, &state.bsinc, info.table);
+
+        for(const int block : BlockSizes)
+        {
+            for(const int offset : Offsets)
+            {
+                const float *src{srcbuf.data() + MAX_RESAMPLE_PADDING + offset};
+                const float *refout{info.ref(&state, src, frac, increment, refdst.data(), block)};
+                const float *out{info.func(&state, src, frac, increment, dst.data(), block)};
+                const float error{MaxError(out, refout, static_cast<size_t>(block))};
+
+                float *dstptr{dst.data()};
+                const ResamplerFunc func{info.func};
+                const Timing time{TimeIt([func,&state,src,dstptr,block]()
+                { func(&state, src, frac, increment, dstptr, block); })};
+                Report(info.kernel, info.variant, block, offset, time, block, error,
+                    (info.func == info.ref) ? -1.0f : 1e-5f);
+            }
+        }
+    }
+}
+
+
+template<typename F>
+struct KernelInfo {
+    const char *variant;
+    int caps;
+    F func;
+};
+
+const KernelInfo<MixerFunc> Mixers[]{
+    { "C", 0, Mix_<CTag> },
+#ifdef HAVE_SSE
+    { "SSE", CPU_CAP_SSE, Mix_<SSETag> },
+#endif
+#ifdef HAVE_NEON
+    { "Neon", CPU_CAP_NEON, Mix_<NEONTag> },
+#endif
+};
+
+void BenchMixers()
+{
+    if(!WantKernel("Mix"))
+        return;
+
+    /* Mixes one input to four outputs, with three fading over the first 64
+     * samples.
+     */
+    constexpr ALsizei NumChans{4};
+    constexpr ALsizei Counter{64};
+    static const ALfloat StartGains[NumChans]{0.5f, 0.25f, 1.0f, 0.75f};
+    static const ALfloat TargetGains[NumChans]{0.25f, 0.25f, 0.5f, 0.0f};
+
+    al::vector<float,16> data(BUFFERSIZE);
+    FillNoise(data.data(), data.size());
+    auto out = al::vector<std::array<float,BUFFERSIZE>,16>(NumChans);
+    auto refout = al::vector<std::array<float,BUFFERSIZE>,16>(NumChans);
+    auto outbuf = reinterpret_cast<ALfloat(*)[BUFFERSIZE]>(out.data());
+    auto refbuf = reinterpret_cast<ALfloat(*)[BUFFERSIZE]>(refout.data());
+
+    for(const auto &info : Mixers)
+    {
+        if(!HaveCaps(info.caps))
+            continue;
+
+        for(const int block : BlockSizes)
+        {
+            for(const int offset : AlignedOffsets)
+            {
+                ALfloat gains[NumChans];
+                std::fill_n(out[0].begin(), NumChans*BUFFERSIZE, 0.0f);
+                std::fill_n(refout[0].begin(), NumChans*BUFFERSIZE, 0.0f);
+                std::copy_n(StartGains, NumChans, gains);
+                Mix_<CTag>(data.data(), NumChans, refbuf, gains, TargetGains, Counter, offset,
+                    block);
+                std::copy_n(StartGains, NumChans, gains);
+                info.func(data.data(), NumChans, outbuf, gains, TargetGains, Counter, offset,
+                    block);
+                const float error{MaxError(out[0].data(), refout[0].data(), NumChans*BUFFERSIZE)};
+
+                const MixerFunc func{info.func};
+                const float *src{data.data()};
+                const Timing time{TimeIt([func,src,outbuf,&gains,offset,block]()
+                {
+                    std::copy_n(StartGains, NumChans, gains);
+                    func(src, NumChans, outbuf, gains, TargetGains, Counter, offset, block);
+                })};
+                Report("Mix", info.variant, block, offset, time, block*NumChans, error,
+                    (info.func == Mix_<CTag>) ? -1.0f : 1e-6f);
+            }
+        }
+    }
+}
+
+
+const KernelInfo<RowMixerFunc> RowMixers[]{
+    { "C", 0, MixRow_<CTag> },
+#ifdef HAVE_SSE
+    { "SSE", CPU_CAP_SSE, MixRow_<SSETag> },
+#endif
+#ifdef HAVE_NEON
+    { "Neon", CPU_CAP_NEON, MixRow_<NEONTag> },
+#endif
+};
+
+void BenchRowMixers()
+{
+    if(!WantKernel("MixRow"))
+        return;
+
+    /* Mixes four inputs to one output, one of them silent. */
+    constexpr ALsizei NumChans{4};
+    static const ALfloat Gains[NumChans]{0.5f, 0.0f, 0.3f, 0.8f};
+
+    auto data = al::vector<std::array<float,BUFFERSIZE>,16>(NumChans);
+    FillNoise(data[0].data(), NumChans*BUFFERSIZE);
+    auto databuf = reinterpret_cast<const ALfloat(*)[BUFFERSIZE]>(data.data());
+    al::vector<float,16> out(BUFFERSIZE), refout(BUFFERSIZE);
+
+    for(const auto &info : RowMixers)
+    {
+        if(!HaveCaps(info.caps))
+            continue;
+
+        for(const int block : BlockSizes)
+        {
+            for(const int offset : AlignedOffsets)
+            {
+                std::fill(out.begin(), out.end(), 0.0f);
+                std::fill(refout.begin(), refout.end(), 0.0f);
+                MixRow_<CTag>(refout.data(), Gains, databuf, NumChans, offset, block);
+                info.func(out.data(), Gains, databuf, NumChans, offset, block);
+                const float error{MaxError(out.data(), refout.data(), out.size())};
+
+                const RowMixerFunc func{info.func};
+                float *dst{out.data()};
+                const Timing time{TimeIt([func,dst,databuf,offset,block]()
+                { func(dst, Gains, databuf, NumChans, offset, block); })};
+                Report("MixRow", info.variant, block, offset, time, block*NumChans, error,
+                    (info.func == MixRow_<CTag>) ? -1.0f : 1e-6f);
+            }
+        }
+    }
+}
+
+
+const KernelInfo<MatrixMixerFunc> MatrixMixers[]{
+    { "C", 0, MixMatrix_<CTag> },
+#ifdef HAVE_SSE
+    { "SSE", CPU_CAP_SSE, MixMatrix_<SSETag> },
+#endif
+#ifdef HAVE_NEON
+    { "Neon", CPU_CAP_NEON, MixMatrix_<NEONTag> },
+#endif
+};
+
+void BenchMatrixMixers()
+{
+    if(!WantKernel("MixMatrix"))
+        return;
+
+    /* Decodes third-order ambisonics to 7.1, with one silent output and one
+     * input no output uses, as the blocked mixers skip those. The SIMD
+     * versions add each output's terms in the same order as the C version,
+     * so their results must match exactly.
+     */
+    constexpr ALsizei NumIns{16};
+    constexpr ALsizei NumOuts{8};
+    ALfloat Gains[NumOuts][NumIns];
+    FillNoise(&Gains[0][0], NumOuts*NumIns, 0.5f);
+    std::fill(std::begin(Gains[3]), std::end(Gains[3]), 0.0f);
+    for(auto &row : Gains)
+        row[9] = 0.0f;
+
+    auto data = al::vector<std::array<float,BUFFERSIZE>,16>(NumIns);
+    FillNoise(data[0].data(), NumIns*BUFFERSIZE);
+    auto databuf = reinterpret_cast<const ALfloat(*)[BUFFERSIZE]>(data.data());
+    auto out = al::vector<std::array<float,BUFFERSIZE>,16>(NumOuts);
+    auto refout = al::vector<std::array<float,BUFFERSIZE>,16>(NumOuts);
+    auto outbuf = reinterpret_cast<ALfloat(*)[BUFFERSIZE]>(out.data());
+    auto refbuf = reinterpret_cast<ALfloat(*)[BUFFERSIZE]>(refout.data());
+
+    for(const auto &info : MatrixMixers)
+    {
+        if(!HaveCaps(info.caps))
+            continue;
+
+        for(const int block : BlockSizes)
+        {
+            for(const int offset : AlignedOffsets)
+            {
+                std::fill_n(outbuf[0], NumOuts*BUFFERSIZE, 0.0f);
+                std::fill_n(refbuf[0], NumOuts*BUFFERSIZE, 0.0f);
+                MixMatrix_<CTag>(refbuf, NumOuts, &Gains[0][0], NumIns, databuf, NumIns, offset,
+                    block);
+                info.func(outbuf, NumOuts, &Gains[0][0], NumIns, databuf, NumIns, offset, block);
+                const float error{MaxError(outbuf[0], refbuf[0], NumOuts*BUFFERSIZE)};
+
+                const MatrixMixerFunc func{info.func};
+                const ALfloat *gains{&Gains[0][0]};
+                const Timing time{TimeIt([func,outbuf,gains,databuf,offset,block]()
+                { func(outbuf, NumOuts, gains, NumIns, databuf, NumIns, offset, block); })};
+                Report("MixMatrix", info.variant, block, offset, time, block*NumIns*NumOuts,
+                    error, (info.func == MixMatrix_<CTag>) ? -1.0f : 0.0f);
+            }
+        }
+    }
+}
+
+struct HrtfMixerInfo {
+    const char *kernel;
+    const char *variant;
+    int caps;
+    HrtfMixerFunc func;
+    HrtfMixerFunc ref;
+    HrtfMixerBlendFunc blendfunc;
+    HrtfMixerBlendFunc blendref;
+    ALsizei irsize;
+};
+const HrtfMixerInfo HrtfMixers[]{
+    { "MixHrtf", "C", 0, MixHrtf_<CTag>, MixHrtf_<CTag>, nullptr, nullptr, 64 },
+#ifdef HAVE_SSE
+    { "MixHrtf", "SSE", CPU_CAP_SSE, MixHrtf_<SSETag>, MixHrtf_<CTag>, nullptr, nullptr, 64 },
+#endif
+#ifdef HAVE_NEON
+    { "MixHrtf", "Neon", CPU_CAP_NEON, MixHrtf_<NEONTag>, MixHrtf_<CTag>, nullptr, nullptr, 64 },
+#endif
+    { "MixHrtfBlend", "C", 0, nullptr, nullptr, MixHrtfBlend_<CTag>, MixHrtfBlend_<CTag>, 64 },
+#ifdef HAVE_SSE
+    { "MixHrtfBlend", "SSE", CPU_CAP_SSE, nullptr, nullptr, MixHrtfBlend_<SSETag>, MixHrtfBlend_<CTag>, 64 },
+#endif
+#ifdef HAVE_NEON
+    { "MixHrtfBlend", "Neon", CPU_CAP_NEON, nullptr, nullptr, MixHrtfBlend_<NEONTag>, MixHrtfBlend_<CTag>, 64 },
+#endif
+    /* Full-length HRIRs, to compare with the FFT mixers. */
+    { "MixHrtf", "C", 0, MixHrtf_<CTag>, MixHrtf_<CTag>, nullptr, nullptr, HRIR_LENGTH },
+#ifdef HAVE_SSE
+    { "MixHrtf", "SSE", CPU_CAP_SSE, MixHrtf_<SSETag>, MixHrtf_<CTag>, nullptr, nullptr, HRIR_LENGTH },
+#endif
+#ifdef HAVE_NEON
+    { "MixHrtf", "Neon", CPU_CAP_NEON, MixHrtf_<NEONTag>, MixHrtf_<CTag>, nullptr, nullptr, HRIR_LENGTH },
+#endif
+    { "MixHrtfBlend", "C", 0, nullptr, nullptr, MixHrtfBlend_<CTag>, MixHrtfBlend_<CTag>, HRIR_LENGTH },
+#ifdef HAVE_SSE
+    { "MixHrtfBlend", "SSE", CPU_CAP_SSE, nullptr, nullptr, MixHrtfBlend_<SSETag>, MixHrtfBlend_<CTag>, HRIR_LENGTH },
+#endif
+#ifdef HAVE_NEON
+    { "MixHrtfBlend", "Neon", CPU_CAP_NEON, nullptr, nullptr, MixHrtfBlend_<NEONTag>, MixHrtfBlend_<CTag>, HRIR_LENGTH },
+#endif
+};
+
+void BenchHrtfMixers()
+{
+    /* Two decaying noise responses, for the old and new filters. */
+    auto params = al::vector<HrtfParams,16>(2);
+    for(HrtfParams &hrtf : params)
+    {
+        for(size_t i{0};i < hrtf.Coeffs.size();++i)
+        {
+            const float scale{std::exp(-static_cast<float>(i) / 24.0f)};
+            FillNoise(hrtf.Coeffs[i].data(), 2, scale);
+        }
+        hrtf.Delay[0] = 3;
+        hrtf.Delay[1] = 11;
+        hrtf.Gain = 0.75f;
+    }
+    params[1].Delay[0] = 9;
+    params[1].Delay[1] = 1;
+
+    al::vector<float,16> data(HRTF_HISTORY_LENGTH + BUFFERSIZE);
+    FillNoise(data.data(), data.size());
+    auto accum = al::vector<float2,16>(BUFFERSIZE + HRIR_LENGTH);
+    auto refaccum = al::vector<float2,16>(BUFFERSIZE + HRIR_LENGTH);
+    al::vector<float,16> out(BUFFERSIZE*2), refout(BUFFERSIZE*2);
+
+    for(const HrtfMixerInfo &info : HrtfMixers)
+    {
+        if(!WantKernel(info.kernel) || !HaveCaps(info.caps))
+            continue;
+
+        const ALsizei irsize{info.irsize};
+        for(const int block : BlockSizes)
+        {
+            for(const int offset : Offsets)
+            {
+                const MixHrtfParams startparams{&params[1].Coeffs, {params[1].Delay[0],
+                    params[1].Delay[1]}, (info.func ? 0.75f : 0.0f), 0.25f/block};
+
+                auto run = [&info,&params,&data,startparams,irsize,offset,block](
+                    const HrtfMixerFunc func, const HrtfMixerBlendFunc blendfunc, float *outbuf,
+                    float2 *accumbuf) -> void
+                {
+                    MixHrtfParams hrtfparams{startparams};
+                    if(func)
+                        func(outbuf, outbuf+BUFFERSIZE, data.data(), accumbuf, offset, irsize,
+                            &hrtfparams, block);
+                    else
+                        blendfunc(outbuf, outbuf+BUFFERSIZE, data.data(), accumbuf, offset,
+                            irsize, &params[0], &hrtfparams, block);
+                };
+
+                std::fill(out.begin(), out.end(), 0.0f);
+                std::fill(refout.begin(), refout.end(), 0.0f);
+                std::fill(accum.begin(), accum.end(), float2{});
+                std::fill(refaccum.begin(), refaccum.end(), float2{});
+                run(info.ref, info.blendref, refout.data(), refaccum.data());
+                run(info.func, info.blendfunc, out.data(), accum.data());
+                const float error{MaxError(out.data(), refout.data(), out.size())};
+
+                float *outbuf{out.data()};
+                float2 *accumbuf{accum.data()};
+                const Timing time{TimeIt([&run,&info,outbuf,accumbuf]()
+                { run(info.func, info.blendfunc, outbuf, accumbuf); })};
+                const bool isref{info.func ? (info.func == info.ref)
+                    : (info.blendfunc == info.blendref)};
+                Report(info.kernel, info.variant, block, offset, time, block, error,
+                    isref ? -1.0f : 1e-5f);
+            }
+        }
+    }
+}
+
+
+struct HrtfFftMixerInfo {
+    const char *kernel;
+    const char *variant;
+    int caps;
+    HrtfFftMixerFunc func;
+    HrtfFftMixerBlendFunc blendfunc;
+};
+const HrtfFftMixerInfo HrtfFftMixers[]{
+    { "MixHrtfFft", "C", 0, MixHrtfFft_<CTag>, nullptr },
+#ifdef HAVE_SSE
+    { "MixHrtfFft", "SSE", CPU_CAP_SSE, MixHrtfFft_<SSETag>, nullptr },
+#endif
+#ifdef HAVE_NEON
+    { "MixHrtfFft", "Neon", CPU_CAP_NEON, MixHrtfFft_<NEONTag>, nullptr },
+#endif
+    { "MixHrtfFftBlend", "C", 0, nullptr, MixHrtfFftBlend_<CTag> },
+};
+
+/* The FFT mixers are checked against the C time-domain mixers, using the same
+ * filters. The spectra are calculated once, as the mixer does for unchanged
+ * filters.
+ */
+void BenchHrtfFftMixers()
+{
+    auto params = al::vector<HrtfParams,16>(2);
+    for(HrtfParams &hrtf : params)
+    {
+        for(size_t i{0};i < hrtf.Coeffs.size();++i)
+        {
+            const float scale{std::exp(-static_cast<float>(i) / 24.0f)};
+            FillNoise(hrtf.Coeffs[i].data(), 2, scale);
+        }
+        hrtf.Delay[0] = 3;
+        hrtf.Delay[1] = 11;
+        hrtf.Gain = 0.75f;
+    }
+    params[1].Delay[0] = 9;
+    params[1].Delay[1] = 1;
+
+    auto buffers = al::vector<HrtfFftBuffers,16>(1);
+    auto spectra = al::vector<HrtfSpectra,16>(2);
+    CalcHrtfSpectra(params[0].Coeffs, HRIR_LENGTH, spectra[0], buffers[0].Plan);
+    CalcHrtfSpectra(params[1].Coeffs, HRIR_LENGTH, spectra[1], buffers[0].Plan);
+
+    al::vector<float,16> data(HRTF_HISTORY_LENGTH + BUFFERSIZE);
+    FillNoise(data.data(), data.size());
+    auto accum = al::vector<float2,16>(BUFFERSIZE + HRIR_LENGTH);
+    auto refaccum = al::vector<float2,16>(BUFFERSIZE + HRIR_LENGTH);
+    al::vector<float,16> out(BUFFERSIZE*2), refout(BUFFERSIZE*2);
+
+    for(const HrtfFftMixerInfo &info : HrtfFftMixers)
+    {
+        if(!WantKernel(info.kernel) || !HaveCaps(info.caps))
+            continue;
+
+        for(const int block : BlockSizes)
+        {
+            for(const int offset : Offsets)
+            {
+                const MixHrtfParams startparams{&params[1].Coeffs, {params[1].Delay[0],
+                    params[1].Delay[1]}, (info.func ? 0.75f : 0.0f), 0.25f/block};
+
+                std::fill(out.begin(), out.end(), 0.0f);
+                std::fill(refout.begin(), refout.end(), 0.0f);
+                std::fill(accum.begin(), accum.end(), float2{});
+                std::fill(refaccum.begin(), refaccum.end(), float2{});
+                MixHrtfParams refparams{startparams};
+                if(info.func)
+                    MixHrtf_<CTag>(refout.data(), refout.data()+BUFFERSIZE, data.data(),
+                        refaccum.data(), offset, HRIR_LENGTH, &refparams, block);
+                else
+                    MixHrtfBlend_<CTag>(refout.data(), refout.data()+BUFFERSIZE, data.data(),
+                        refaccum.data(), offset, HRIR_LENGTH, &params[0], &refparams, block);
+
+                auto run = [&info,&params,&data,&spectra,&buffers,startparams,offset,block](
+                    float *outbuf, float2 *accumbuf) -> void
+                {
+                    MixHrtfParams hrtfparams{startparams};
+                    if(info.func)
+                        info.func(outbuf, outbuf+BUFFERSIZE, data.data(), accumbuf, offset,
+                            HRIR_LENGTH, &spectra[1], &hrtfparams, buffers.data(), block);
+                    else
+                        info.blendfunc(outbuf, outbuf+BUFFERSIZE, data.data(), accumbuf, offset,
+                            HRIR_LENGTH, &params[0], &spectra[0], &hrtfparams, &spectra[1],
+                            buffers.data(), block);
+                };
+                run(out.data(), accum.data());
+                const float error{MaxError(out.data(), refout.data(), out.size())};
+
+                float *outbuf{out.data()};
+                float2 *accumbuf{accum.data()};
+                const Timing time{TimeIt([&run,outbuf,accumbuf]() { run(outbuf, accumbuf); })};
+                Report(info.kernel, info.variant, block, offset, time, block, error, 1e-5f);
+            }
+        }
+    }
+}
+
+
+/* Runs each lane's filter on its own for reference, and the same filters
+ * together in banks of 4 and 8 lanes.
+ */
+void BenchBiquads()
+{
+    if(!WantKernel("Biquad"))
+        return;
+
+    static const BiquadType Types[]{BiquadType::LowPass, BiquadType::HighShelf,
+        BiquadType::Peaking, BiquadType::HighPass, BiquadType::LowShelf, BiquadType::BandPass,
+        BiquadType::LowPass, BiquadType::Peaking};
+    constexpr size_t MaxLanes{8};
+
+    BiquadFilter filters[MaxLanes];
+    for(size_t i{0};i < MaxLanes;++i)
+    {
+        const float f0norm{(500.0f + 1500.0f*i) / 48000.0f};
+        filters[i].setParams(Types[i], 0.5f, f0norm, calc_rcpQ_from_slope(0.5f, 1.0f));
+    }
+
+    al::vector<float,16> input(MaxLanes*(BUFFERSIZE+4));
+    FillNoise(input.data(), input.size());
+    al::vector<float,16> output(MaxLanes*(BUFFERSIZE+4)), refoutput(MaxLanes*(BUFFERSIZE+4));
+
+    for(const int block : BlockSizes)
+    {
+        for(const int offset : Offsets)
+        {
+            const float *src[MaxLanes];
+            float *dst[MaxLanes], *refdst[MaxLanes];
+            for(size_t i{0};i < MaxLanes;++i)
+            {
+                src[i] = input.data() + i*(BUFFERSIZE+4) + offset;
+                dst[i] = output.data() + i*(BUFFERSIZE+4) + offset;
+                refdst[i] = refoutput.data() + i*(BUFFERSIZE+4) + offset;
+            }
+
+            for(size_t i{0};i < MaxLanes;++i)
+            {
+                BiquadFilter filter{filters[i]};
+                filter.process(refdst[i], src[i], block);
+            }
+            BiquadFilter single{filters[0]};
+            Report("Biquad", "C", block, offset, TimeIt([&single,&src,&dst,block]()
+                { single.process(dst[0], src[0], block); }), block, 0.0f, -1.0f);
+
+            BiquadBank<4> bank4;
+            for(size_t i{0};i < 4;++i)
+                bank4.load(i, filters[i]);
+            bank4.process(dst, src, 4, block);
+            float error{0.0f};
+            for(size_t i{0};i < 4;++i)
+                error = std::max(error, MaxError(dst[i], refdst[i], static_cast<size_t>(block)));
+            Report("Biquad", "lanes4", block, offset, TimeIt([&bank4,&src,&dst,block]()
+                { bank4.process(dst, src, 4, block); }), block*4.0, error, 1e-5f);
+
+            BiquadBank<8> bank8;
+            for(size_t i{0};i < MaxLanes;++i)
+                bank8.load(i, filters[i]);
+            bank8.process(dst, src, MaxLanes, block);
+            error = 0.0f;
+            for(size_t i{0};i < MaxLanes;++i)
+                error = std::max(error, MaxError(dst[i], refdst[i], static_cast<size_t>(block)));
+            Report("Biquad", "lanes8", block, offset, TimeIt([&bank8,&src,&dst,block]()
+                { bank8.process(dst, src, MaxLanes, block); }), block*8.0, error, 1e-5f);
+        }
+    }
+}
+
+void BenchBandSplitters()
+{
+    if(!WantKernel("BandSplitter"))
+        return;
+
+    constexpr size_t MaxLanes{8};
+    constexpr float f0norm{400.0f / 48000.0f};
+
+    al::vector<float,16> input(MaxLanes*(BUFFERSIZE+4));
+    FillNoise(input.data(), input.size());
+    al::vector<float,16> output(MaxLanes*2*(BUFFERSIZE+4)), refoutput(MaxLanes*2*(BUFFERSIZE+4));
+
+    for(const int block : BlockSizes)
+    {
+        for(const int offset : Offsets)
+        {
+            const float *src[MaxLanes];
+            float *hp[MaxLanes], *lp[MaxLanes], *refhp[MaxLanes], *reflp[MaxLanes];
+            for(size_t i{0};i < MaxLanes;++i)
+            {
+                src[i] = input.data() + i*(BUFFERSIZE+4) + offset;
+                hp[i] = output.data() + i*2*(BUFFERSIZE+4) + offset;
+                lp[i] = hp[i] + (BUFFERSIZE+4);
+                refhp[i] = refoutput.data() + i*2*(BUFFERSIZE+4) + offset;
+                reflp[i] = refhp[i] + (BUFFERSIZE+4);
+            }
+
+            BandSplitter splitter;
+            splitter.init(f0norm);
+            for(size_t i{0};i < MaxLanes;++i)
+            {
+                splitter.clear();
+                splitter.process(refhp[i], reflp[i], src[i], block);
+            }
+            Report("BandSplitter", "C", block, offset, TimeIt([&splitter,&src,&hp,&lp,block]()
+                { splitter.process(hp[0], lp[0], src[0], block); }), block, 0.0f, -1.0f);
+
+            auto check = [&hp,&lp,&refhp,&reflp,block](size_t numlanes) -> float
+            {
+                float error{0.0f};
+                for(size_t i{0};i < numlanes;++i)
+                {
+                    error = std::max(error, MaxError(hp[i], refhp[i], static_cast<size_t>(block)));
+                    error = std::max(error, MaxError(lp[i], reflp[i], static_cast<size_t>(block)));
+                }
+                return error;
+            };
+
+            BandSplitterBank<4> bank4;
+            bank4.init(f0norm);
+            bank4.process(hp, lp, src, 4, block);
+            const float error4{check(4)};
+            Report("BandSplitter", "lanes4", block, offset, TimeIt([&bank4,&src,&hp,&lp,block]()
+                { bank4.process(hp, lp, src, 4, block); }), block*4.0, error4, 1e-5f);
+
+            BandSplitterBank<8> bank8;
+            bank8.init(f0norm);
+            bank8.process(hp, lp, src, MaxLanes, block);
+            const float error8{check(MaxLanes)};
+            Report("BandSplitter", "lanes8", block, offset, TimeIt([&bank8,&src,&hp,&lp,block]()
+                { bank8.process(hp, lp, src, MaxLanes, block); }), block*8.0, error8, 1e-5f);
+        }
+    }
+}
+
+/* Runs the first through fourth order filters one at a time for reference,
+ * then all orders together, and four first-order filters together.
+ */
+void BenchNfcFilters()
+{
+    if(!WantKernel("NfcFilter"))
+        return;
+
+    constexpr size_t MaxOrder{4};
+    NfcFilter filter;
+    filter.init(343.3f / (1.5f * 48000.0f));
+    filter.adjust(343.3f / (0.5f * 48000.0f));
+
+    al::vector<float,16> input(MaxOrder*(BUFFERSIZE+4));
+    FillNoise(input.data(), input.size());
+    al::vector<float,16> output(MaxOrder*(BUFFERSIZE+4)), refoutput(MaxOrder*(BUFFERSIZE+4));
+
+    for(const int block : BlockSizes)
+    {
+        for(const int offset : Offsets)
+        {
+            const float *src[MaxOrder];
+            float *dst[MaxOrder], *refdst[MaxOrder];
+            for(size_t i{0};i < MaxOrder;++i)
+            {
+                src[i] = input.data() + i*(BUFFERSIZE+4) + offset;
+                dst[i] = output.data() + i*(BUFFERSIZE+4) + offset;
+                refdst[i] = refoutput.data() + i*(BUFFERSIZE+4) + offset;
+            }
+
+            NfcFilter single{filter};
+            single.process1(refdst[0], src[0], block);
+            single = filter;
+            single.process2(refdst[1], src[0], block);
+            single = filter;
+            single.process3(refdst[2], src[0], block);
+            single = filter;
+            single.process4(refdst[3], src[0], block);
+            Report("NfcFilter", "C", block, offset, TimeIt([&single,&src,&dst,block]()
+            {
+                single.process1(dst[0], src[0], block);
+                single.process2(dst[1], src[0], block);
+                single.process3(dst[2], src[0], block);
+                single.process4(dst[3], src[0], block);
+            }), block*4.0, 0.0f, -1.0f);
+
+            NfcFilter orders{filter};
+            orders.processOrders(dst, src[0], MaxOrder, block);
+            float error{0.0f};
+            for(size_t i{0};i < MaxOrder;++i)
+                error = std::max(error, MaxError(dst[i], refdst[i], static_cast<size_t>(block)));
+            Report("NfcFilter", "orders", block, offset, TimeIt([&orders,&src,&dst,block]()
+                { orders.processOrders(dst, src[0], MaxOrder, block); }), block*4.0, error,
+                1e-5f);
+
+            for(size_t i{0};i < MaxOrder;++i)
+            {
+                single = filter;
+                single.process1(refdst[i], src[i], block);
+            }
+            NfcFilter chans[MaxOrder]{filter, filter, filter, filter};
+            NfcFilter::process1(chans, dst, src, MaxOrder, block);
+            error = 0.0f;
+            for(size_t i{0};i < MaxOrder;++i)
+                error = std::max(error, MaxError(dst[i], refdst[i], static_cast<size_t>(block)));
+            Report("NfcFilter", "lanes4", block, offset, TimeIt([&chans,&src,&dst,block]()
+                { NfcFilter::process1(chans, dst, src, MaxOrder, block); }), block*4.0, error,
+                1e-5f);
+        }
+    }
+}
+
+
+/* The compressor and UHJ encoder only have the one version, so are just
+ * timed.
+ */
+void BenchCompressor()
+{
+    if(!WantKernel("Compressor"))
+        return;
+
+    constexpr ALsizei NumChans{2};
+    /* The same settings as the output limiter. */
+    std::unique_ptr<Compressor> comp{CompressorInit(NumChans, 48000, AL_TRUE, AL_TRUE, AL_TRUE,
+        AL_TRUE, AL_TRUE, 0.001f, 0.002f, 0.0f, 0.0f, -3.0f, INFINITY, 0.0f, 0.020f, 0.200f)};
+
+    auto input = al::vector<std::array<float,BUFFERSIZE>,16>(NumChans);
+    FillNoise(input[0].data(), NumChans*BUFFERSIZE);
+    auto buffer = al::vector<std::array<float,BUFFERSIZE>,16>(NumChans);
+    auto samples = reinterpret_cast<ALfloat(*)[BUFFERSIZE]>(buffer.data());
+    for(const int block : BlockSizes)
+    {
+        /* The compressor works in place, so it gets a fresh copy of the input
+         * each time.
+         */
+        Compressor *compptr{comp.get()};
+        const Timing time{TimeIt([compptr,&input,&buffer,samples,block]()
+        {
+            std::copy(input.cbegin(), input.cend(), buffer.begin());
+            compptr->process(block, samples);
+        })};
+        Report("Compressor", "C", block, 0, time, block*NumChans, 0.0f, -1.0f);
+    }
+}
+
+void BenchUhjEncoder()
+{
+    if(!WantKernel("Uhj2Encoder"))
+        return;
+
+    auto input = al::vector<std::array<float,BUFFERSIZE>,16>(3);
+    FillNoise(input[0].data(), 3*BUFFERSIZE);
+    auto insamples = reinterpret_cast<ALfloat(*)[BUFFERSIZE]>(input.data());
+    al::vector<float,16> left(BUFFERSIZE), right(BUFFERSIZE);
+
+    std::unique_ptr<Uhj2Encoder> encoder{new Uhj2Encoder{}};
+    for(const int block : BlockSizes)
+    {
+        Uhj2Encoder *enc{encoder.get()};
+        float *lout{left.data()}, *rout{right.data()};
+        const Timing time{TimeIt([enc,lout,rout,insamples,block]()
+        { enc->encode(lout, rout, insamples, block); })};
+        Report("Uhj2Encoder", "C", block, 0, time, block, 0.0f, -1.0f);
+    }
+}
+
+
+struct SampleTypeInfo {
+    const char *kernel;
+    FmtType type;
+    size_t size;
+};
+const SampleTypeInfo SampleTypes[]{
+    { "LoadSamples ubyte", FmtUByte, sizeof(ALubyte) },
+    { "LoadSamples short", FmtShort, sizeof(ALshort) },
+    { "LoadSamples float", FmtFloat, sizeof(ALfloat) },
+    { "LoadSamples double", FmtDouble, sizeof(ALdouble) },
+    { "LoadSamples mulaw", FmtMulaw, sizeof(ALubyte) },
+    { "LoadSamples alaw", FmtAlaw, sizeof(ALubyte) },
+};
+
+/* Converts a sample the straightforward way, to check LoadSamples against. */
+float ConvertSample(FmtType type, const ALubyte *src)
+{
+    switch(type)
+    {
+        case FmtUByte: return (src[0]-128) * (1.0f/128.0f);
+        case FmtShort:
+        {
+            ALshort val;
+            memcpy(&val, src, sizeof(val));
+            return val * (1.0f/32768.0f);
+        }
+        case FmtFloat:
+        {
+            ALfloat val;
+            memcpy(&val, src, sizeof(val));
+            return val;
+        }
+        case FmtDouble:
+        {
+            ALdouble val;
+            memcpy(&val, src, sizeof(val));
+            return static_cast<float>(val);
+        }
+        case FmtMulaw: return muLawDecompressionTable[src[0]] * (1.0f/32768.0f);
+        case FmtAlaw: return aLawDecompressionTable[src[0]] * (1.0f/32768.0f);
+    }
+    return 0.0f;
+}
+
+/* Loads a mono and an interleaved stereo channel, with the source and
+ * destination offset by the given number of samples.
+ */
+void BenchLoadSamples()
+{
+    constexpr ALint MaxStep{2};
+    al::vector<ALubyte,16> input((BUFFERSIZE+4) * MaxStep * sizeof(ALdouble));
+    al::vector<float,16> dst(BUFFERSIZE+4), refdst(BUFFERSIZE+4);
+
+    for(const SampleTypeInfo &info : SampleTypes)
+    {
+        if(!WantKernel(info.kernel))
+            continue;
+
+        const size_t count{input.size() / info.size};
+        if(info.type == FmtFloat || info.type == FmtDouble)
+        {
+            std::uniform_real_distribution<double> dist{-1.0, 1.0};
+            for(size_t i{0};i < count;++i)
+            {
+                if(info.type == FmtFloat)
+                {
+                    const float val{static_cast<float>(dist(Rng))};
+                    memcpy(&input[i*sizeof(val)], &val, sizeof(val));
+                }
+                else
+                {
+                    const double val{dist(Rng)};
+                    memcpy(&input[i*sizeof(val)], &val, sizeof(val));
+                }
+            }
+        }
+        else
+        {
+            std::uniform_int_distribution<int> dist{0, 255};
+            std::generate(input.begin(), input.end(), [&dist]()
+            { return static_cast<ALubyte>(dist(Rng)); });
+        }
+
+        for(ALint step{1};step <= MaxStep;++step)
+        {
+            for(const int block : BlockSizes)
+            {
+                for(const int offset : Offsets)
+                {
+                    const ALubyte *src{input.data() + offset*info.size};
+                    float *out{dst.data() + offset};
+                    std::fill(dst.begin(), dst.end(), 0.0f);
+                    LoadSamples(out, src, step, info.type, block);
+                    for(int i{0};i < block;++i)
+                        refdst[i] = ConvertSample(info.type, src + i*step*info.size);
+                    const float error{MaxError(out, refdst.data(), static_cast<size_t>(block))};
+
+                    const FmtType type{info.type};
+                    const Timing time{TimeIt([out,src,step,type,block]()
+                    { LoadSamples(out, src, step, type, block); })};
+                    Report(info.kernel, (step == 1) ? "mono" : "stereo", block, offset, time,
+                        block, error, 0.0f);
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+
+int main(int argc, char *argv[])
+{
+    if(argc > 1)
+        KernelFilter = argv[1];
+
+    FillCPUCaps(~0);
+    printf("Extensions:%s%s%s%s%s\n", (CPUCapFlags&CPU_CAP_SSE) ? " SSE" : "",
+        (CPUCapFlags&CPU_CAP_SSE2) ? " SSE2" : "", (CPUCapFlags&CPU_CAP_SSE3) ? " SSE3" : "",
+        (CPUCapFlags&CPU_CAP_SSE4_1) ? " SSE4.1" : "", (CPUCapFlags&CPU_CAP_NEON) ? " Neon" : "");
+    printf("%-20s %-7s %6s %6s %10s %10s  %s\n", "kernel", "version", "block", "offset",
+        "cyc/smp", "ns/smp", "check");
+
+    BenchResamplers();
+    BenchMixers();
+    BenchRowMixers();
+    BenchMatrixMixers();
+    BenchHrtfMixers();
+    BenchHrtfFftMixers();
+    BenchBiquads();
+    BenchBandSplitters();
+    BenchNfcFilters();
+    BenchCompressor();
+    BenchUhjEncoder();
+    BenchLoadSamples();
+
+    if(NumFailures > 0)
+    {
+        printf("%d result%s did not match the reference\n", NumFailures,
+            (NumFailures == 1) ? "" : "s");
+        return 1;
+    }
+    return 0;
+}